@@ -0,0 +1,634 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    bench_lib_2d.cpp
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains several benchmarks for the library, reporting the time and the number of heap allocations per run
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <new>
+
+#include "../lib_2d.h"
+
+using namespace std;
+using namespace lib_2d;
+
+#ifdef USE_LDOUBLE
+using T = long double;
+#elif USE_FLOAT
+using T = float;
+#else
+using T = double;
+#endif
+
+//------------------------------------------------------------------------------
+
+static size_t nAllocations(0);
+
+//kept out of line, otherwise gcc sees malloc / free within new / delete and reports a mismatch
+#ifdef __GNUC__
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE void* operator new(size_t size) {
+    ++nAllocations;
+    if(void *p = malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+BENCH_NOINLINE void operator delete(void *p) noexcept {
+    free(p);
+}
+
+//------------------------------------------------------------------------------
+
+template <typename F>
+void bench(const std::string &name, size_t nRuns, F f) {
+    nAllocations = 0;
+    auto start = chrono::high_resolution_clock::now();
+    for(size_t i = 0; i < nRuns; ++i)
+        f();
+    auto stop = chrono::high_resolution_clock::now();
+    size_t allocations = nAllocations;
+
+    double ms = chrono::duration<double, milli>(stop - start).count();
+    cout << left << setw(50) << name
+         << right << setw(12) << fixed << setprecision(4) << ms / nRuns << " ms"
+         << setw(12) << (double)allocations / nRuns << " allocations" << endl;
+}
+
+PointCloud<T> random_cloud(size_t n, unsigned int seed = 1337) {
+    mt19937 gen(seed);
+    uniform_real_distribution<T> dist(-100.0, 100.0);
+    PointCloud<T> out(n);
+    for(size_t i = 0; i < n; ++i)
+        out.push_back(dist(gen), dist(gen));
+    return out;
+}
+
+//------------------------------------------------------------------------------
+
+int main() {
+    const auto a = random_cloud(1000, 1);
+    const auto b = random_cloud(1000, 2);
+    const auto c = random_cloud(1000, 3);
+    volatile size_t sink(0);
+
+    cout << "---- PointCloud chains ----" << endl;
+
+    bench("a + b + c + a", 1000, [&]() {
+        auto r = a + b + c + a;
+        sink += r.size();
+    });
+
+    bench("copy, move_by, rotate, sort_x", 1000, [&]() {
+        auto r = a;
+        r.move_by(1, 2).rotate(0.3).sort_x();
+        sink += r.size();
+    });
+
+    bench("tmp += temporary cloud (x10)", 1000, [&]() {
+        PointCloud<T> r;
+        for(size_t i = 0; i < 10; ++i)
+            r += PointCloud<T>(a);
+        sink += r.size();
+    });
+
+    bench("range(100, 899)", 1000, [&]() {
+        auto r = a;
+        r.range(100, 899);
+        sink += r.size();
+    });
+
+    bench("reduce_points(1.0) of 1000 points", 1000, [&]() {
+        auto r = a;
+        r.sort_x().reduce_points(1.0);
+        sink += r.size();
+    });
+
+    cout << "---- Topology / KdTree ----" << endl;
+
+    bench("Topology<1> += temporary (x100)", 1000, [&]() {
+        Topology<1> r;
+        for(size_t i = 0; i < 100; ++i) {
+            Topology<1> tmp;
+            tmp.push_back(std::array<size_t, 1>{i});
+            r += std::move(tmp);
+        }
+        sink += r.n_elements();
+    });
+
+    auto shared = make_shared<PointCloud<T> >(random_cloud(100000));
+    auto ordered = make_shared<OrderedPointCloud<T> >(shared);
+
+    bench("KdTree build 100k", 10, [&]() {
+        KdTree<T> tree(ordered);
+        sink += tree.size();
+    });
+
+    KdTree<T> tree(ordered);
+    bench("KdTree k_nearest(10) x1000", 10, [&]() {
+        for(size_t i = 0; i < 1000; ++i)
+            sink += tree.k_nearest(a[i], 10).n_elements();
+    });
+
+    MonotonicResource arena(1 << 20);
+    bench("KdTree k_nearest(10) x1000 within arena", 10, [&]() {
+        ScopedResource scope(&arena);
+        for(size_t i = 0; i < 1000; ++i)
+            sink += tree.k_nearest(a[i], 10).n_elements();
+        arena.release();
+    });
+
+    cout << "---- SpatialGrid ----" << endl;
+
+    bench("SpatialGrid build 100k", 10, [&]() {
+        SpatialGrid<T> grid(ordered);
+        sink += grid.size();
+    });
+
+    SpatialGrid<T> grid(ordered);
+    bench("SpatialGrid k_nearest(10) x1000", 10, [&]() {
+        for(size_t i = 0; i < 1000; ++i)
+            sink += grid.k_nearest(a[i], 10).n_elements();
+    });
+
+    bench("SpatialGrid in_circle(2.0) x1000", 10, [&]() {
+        for(size_t i = 0; i < 1000; ++i)
+            sink += grid.in_circle(a[i], 2.0).n_elements();
+    });
+
+    bench("SpatialGrid move x1000", 10, [&]() {
+        for(size_t i = 0; i < 1000; ++i)
+            grid.move(i, b[i]);
+        sink += grid.size();
+    });
+
+    cout << "---- QuadTree ----" << endl;
+
+    bench("QuadTree build 100k", 10, [&]() {
+        QuadTree<T> quad(ordered);
+        sink += quad.size();
+    });
+
+    QuadTree<T> quad(ordered);
+    bench("QuadTree k_nearest(10) x1000", 10, [&]() {
+        for(size_t i = 0; i < 1000; ++i)
+            sink += quad.k_nearest(a[i], 10).n_elements();
+    });
+
+    bench("QuadTree move x1000", 10, [&]() {
+        for(size_t i = 0; i < 1000; ++i)
+            quad.move(i, c[i]);
+        sink += quad.size();
+    });
+
+    bench("QuadTree count_in_box(50, 50) x1000", 10, [&]() {
+        for(size_t i = 0; i < 1000; ++i)
+            sink += quad.count_in_box(a[i], 50.0, 50.0);
+    });
+
+    cout << "---- RTree ----" << endl;
+
+    PointCloud<T> road(10000); //random walk, similar to a road or contour line
+    {
+        mt19937 gen(4);
+        uniform_real_distribution<T> step(-1.0, 1.0);
+        Point<T> current{0, 0};
+        for(size_t i = 0; i < 10000; ++i) {
+            current = Point<T>{current.x + step(gen), current.y + step(gen)};
+            road.push_back(current);
+        }
+    }
+    const auto probe = random_cloud(10, 5);
+
+    bench("PointCloud::intersections_with 10k x 10", 10, [&]() {
+        sink += road.intersections_with(probe).size();
+    });
+
+    bench("RTree build 10k segments", 10, [&]() {
+        RTree<T> network(road.view());
+        sink += network.size();
+    });
+
+    RTree<T> network(road.view());
+    bench("RTree::intersections_with 10k x 10", 10, [&]() {
+        sink += network.intersections_with(probe).size();
+    });
+
+    bench("RTree nearest segment x1000", 10, [&]() {
+        for(size_t i = 0; i < 1000; ++i)
+            sink += network.nearest(a[i])[1];
+    });
+
+    cout << "---- Factory2D ----" << endl;
+
+    auto million = make_shared<PointCloud<T> >(random_cloud(1000000, 6));
+    bench("concave_hull(k = 10) 100k", 1, [&]() {
+        sink += Factory2D<T>::concave_hull(shared, 10)->n_elements();
+    });
+
+    bench("concave_hull(k = 10) 1M", 1, [&]() {
+        sink += Factory2D<T>::concave_hull(million, 10)->n_elements();
+    });
+
+    bench("PointCloud::convex_hull 1M", 1, [&]() {
+        sink += million->convex_hull().size();
+    });
+
+    bench("convex_hull 1M, single thread", 1, [&]() {
+        sink += Factory2D<T>::convex_hull(million, true, 1)->n_elements();
+    });
+
+    bench("convex_hull 1M", 1, [&]() {
+        sink += Factory2D<T>::convex_hull(million)->n_elements();
+    });
+
+    auto tenMillion = make_shared<PointCloud<T> >(random_cloud(10000000, 7));
+    bench("convex_hull 10M", 1, [&]() {
+        sink += Factory2D<T>::convex_hull(tenMillion)->n_elements();
+    });
+
+    cout << "---- RotatingCalipers ----" << endl;
+
+    auto tenMillionHull = Factory2D<T>::convex_hull(tenMillion)->as_pointcloud();
+    bench("diameter + width + min_area_rectangle", 100, [&]() {
+        sink += RotatingCalipers<T>::diameter(tenMillionHull).length();
+        sink += RotatingCalipers<T>::width(tenMillionHull);
+        sink += RotatingCalipers<T>::min_area_rectangle(tenMillionHull).get_width();
+    });
+
+    cout << "---- EnclosingCircle ----" << endl;
+
+    bench("center + furthest_apart 1M", 1, [&]() {
+        auto c = million->center();
+        sink += c.distance_to((*million)[million->furthest_apart(c)]);
+    });
+
+    bench("EnclosingCircle 1M", 1, [&]() {
+        sink += EnclosingCircle<T>(*million).get_radius();
+    });
+
+    bench("EnclosingCircle::extend 1M", 1, [&]() {
+        sink += EnclosingCircle<T>().extend(*million).get_radius();
+    });
+
+    cout << "---- closest pair ----" << endl;
+
+    bench("closest_pair 1M", 1, [&]() {
+        sink += Factory2D<T>::closest_pair(*million)[0];
+    });
+
+    auto thousand = make_shared<PointCloud<T> >(random_cloud(1000, 8));
+    auto tenThousand = make_shared<PointCloud<T> >(random_cloud(10000, 9));
+    bench("PointCloud::closest 1k x 10k", 1, [&]() {
+        sink += thousand->closest(*tenThousand);
+    });
+
+    bench("closest_pair 1k x 10k", 10, [&]() {
+        sink += Factory2D<T>::closest_pair(thousand, tenThousand)[0];
+    });
+
+    cout << "---- PathDistance ----" << endl;
+
+    auto pathA = make_shared<PointCloud<T> >();
+    auto pathB = make_shared<PointCloud<T> >();
+    for(size_t i = 0; i < 10000; ++i) {
+        pathA->push_back(T(i) / 100, std::sin(T(i) / 100));
+        pathB->push_back(T(i) / 100, std::cos(T(i) / 100));
+    }
+    bench("furthest_apart (directed Hausdorff) 10k x 10k", 1, [&]() {
+        sink += pathA->furthest_apart(*pathB);
+    });
+
+    const KdTree<T>
+        treeA(make_shared<OrderedPointCloud<T> >(pathA)),
+        treeB(make_shared<OrderedPointCloud<T> >(pathB));
+    bench("hausdorff 10k x 10k, prebuilt trees", 10, [&]() {
+        sink += PathDistance<T>::hausdorff(treeA, treeB);
+    });
+
+    bench("hausdorff 10k x 10k, bound 0.5", 10, [&]() {
+        sink += PathDistance<T>::hausdorff(treeA, treeB, 0.5);
+    });
+
+    auto shortA = pathA->view(0, 999), shortB = pathB->view(0, 999);
+    bench("discrete_frechet 1k x 1k", 10, [&]() {
+        sink += PathDistance<T>::discrete_frechet(shortA, shortB);
+    });
+
+    bench("frechet 1k x 1k", 1, [&]() {
+        sink += PathDistance<T>::frechet(shortA, shortB);
+    });
+
+    cout << "---- point in polygon ----" << endl;
+
+    const Arc<T> polygon(150, 10000, true);
+    bench("PointCloud::point_is_inside 10k vertices x1000", 1, [&]() {
+        for(size_t i = 0; i < 1000; ++i)
+            sink += polygon.point_is_inside(a[i]);
+    });
+
+    bench("PreparedPolygon build 10k vertices", 10, [&]() {
+        sink += PreparedPolygon<T>(polygon).n_entries();
+    });
+
+    const PreparedPolygon<T> prepared(polygon);
+    bench("PreparedPolygon::inside 10k vertices x1M", 1, [&]() {
+        sink += prepared.inside(*million).n_elements();
+    });
+
+    cout << "---- PolygonClipping ----" << endl;
+
+    std::vector<Rectangle<T> > smallPolygons;
+    for(size_t i = 0; i < 100000; ++i)
+        smallPolygons.push_back(Rectangle<T>(2, 1, true, (*million)[i], T(i % 360)));
+    std::vector<PointCloudView<T> > smallViews;
+    for(const auto &r : smallPolygons)
+        smallViews.push_back(r.view());
+    const Rectangle<T> clipWindow(100, 100, true, Point<T>({0, 0}), 0.3);
+
+    bench("clip_convex 100k rectangles", 1, [&]() {
+        sink += PolygonClipping<T>::clip_convex(smallViews, clipWindow, true, 1).size();
+    });
+
+    bench("clip_convex 100k rectangles (threaded)", 1, [&]() {
+        sink += PolygonClipping<T>::clip_convex(smallViews, clipWindow).size();
+    });
+
+    const std::vector<PointCloudView<T> > clipWindows(1, clipWindow.view());
+    bench("compute_each intersection 100k rectangles", 1, [&]() {
+        sink += PolygonClipping<T>::compute_each(smallViews, clipWindows, PolygonClipping<T>::INTERSECTION).size();
+    });
+
+    const Arc<T>
+        circleA(100, 20000, true),
+        circleB(100, 20000, true, 0, LIB_2D_2PI, Point<T>({30, 10}));
+    bench("union 20k x 20k vertices", 1, [&]() {
+        sink += PolygonClipping<T>::unite(circleA, circleB).size();
+    });
+
+    cout << "---- Delaunay ----" << endl;
+
+    for(size_t n : {10000, 100000, 1000000}) {
+        const PointCloud<T> cloud = random_cloud(n, 29);
+        bench("Delaunay " + std::to_string(n) + " points", n < 1000000 ? 10 : 1, [&]() {
+            sink += Delaunay<T>(cloud, 1).n_triangles();
+        });
+    }
+
+    bench("Delaunay 1M points (4 strips)", 1, [&]() {
+        sink += Delaunay<T>(*million, 4).n_triangles();
+    });
+
+    bench("Delaunay 1M points (threaded)", 1, [&]() {
+        sink += Delaunay<T>(*million).n_triangles();
+    });
+
+    cout << "---- Voronoi ----" << endl;
+
+    {
+        const Voronoi<T> voronoi(random_cloud(100000, 31));
+        std::vector<size_t> nearest;
+        bench("Voronoi nearest 1M queries (100k sites, 1 thread)", 1, [&]() {
+            voronoi.nearest(*million, nearest, 1);
+            sink += nearest[0];
+        });
+        bench("Voronoi nearest 1M queries (100k sites, threaded)", 1, [&]() {
+            voronoi.nearest(*million, nearest);
+            sink += nearest[0];
+        });
+
+        std::vector<T> values(100000, 1), interpolated;
+        bench("Voronoi interpolate 1M queries (100k sites, threaded)", 1, [&]() {
+            voronoi.interpolate(*million, values, interpolated);
+            sink += interpolated[0];
+        });
+
+        const Rectangle<T> bounds(200, 200);
+        bench("Voronoi cells (100k sites, threaded)", 1, [&]() {
+            sink += voronoi.cells(bounds).size();
+        });
+    }
+
+    cout << "---- PolygonTriangulation ----" << endl;
+
+    {
+        PolygonTriangulation<T> triangulation;
+        const Ellipse<T> ellipse(100, 60, 1000000, false);
+        bench("PolygonTriangulation ellipse 1M points", 1, [&]() {
+            sink += triangulation.triangulate(ellipse.view()).n_elements();
+        });
+
+        std::vector<Rectangle<T>> rectangles;
+        for(size_t i = 0; i < 100000; ++i)
+            rectangles.push_back(Rectangle<T>(1, 2, true, Point<T>{T(i % 1000), T(i / 1000)}, T(0.01 * i)));
+        std::vector<PointCloudView<T>> polygons;
+        for(const auto &rectangle : rectangles)
+            polygons.push_back(rectangle.view());
+        bench("PolygonTriangulation 100k rectangles (threaded)", 1, [&]() {
+            sink += PolygonTriangulation<T>::triangulate_each(polygons).size();
+        });
+    }
+
+    cout << "---- MinimumSpanningTree ----" << endl;
+
+    bench("MinimumSpanningTree 1M points (1 thread)", 1, [&]() {
+        sink += MinimumSpanningTree<T>(*million, 1).edges().n_elements();
+    });
+
+    bench("MinimumSpanningTree 1M points (threaded)", 1, [&]() {
+        sink += MinimumSpanningTree<T>(*million).edges().n_elements();
+    });
+
+    bench("MinimumSpanningTree 10M points (threaded)", 1, [&]() {
+        sink += MinimumSpanningTree<T>(*tenMillion).edges().n_elements();
+    });
+
+    {
+        const MinimumSpanningTree<T> tree(*million);
+        std::vector<size_t> labels;
+        bench("MinimumSpanningTree single linkage 1M", 10, [&]() {
+            sink += tree.single_linkage(0.1, labels);
+        });
+    }
+
+    cout << "---- Dbscan ----" << endl;
+
+    bench("Dbscan 1M points (1 thread)", 1, [&]() {
+        sink += Dbscan<T>(million, 0.2, 5, 1).n_clusters();
+    });
+
+    bench("Dbscan 1M points (threaded)", 1, [&]() {
+        sink += Dbscan<T>(million, 0.2, 5).n_clusters();
+    });
+
+    bench("Dbscan 10M points (threaded)", 1, [&]() {
+        sink += Dbscan<T>(tenMillion, 0.1, 5).n_clusters();
+    });
+
+    cout << "---- IterativeClosestPoint ----" << endl;
+
+    {
+        auto target = make_shared<PointCloud<T>>(random_cloud(100000, 7));
+        PointCloud<T> source;
+        for(size_t i = 0; i < target->size(); i += 10)
+            source.push_back((*target)[i]);
+        source.rotate(0.001).move_by(0.01, -0.01);
+
+        bench("IterativeClosestPoint build 100k target", 1, [&]() {
+            sink += IterativeClosestPoint<T>(target).n_target();
+        });
+
+        const IterativeClosestPoint<T> icp(target);
+        IterativeClosestPoint<T>::Settings settings;
+        settings.maxIterations = 20;
+        settings.tolerance = 0;
+        bench("IterativeClosestPoint 10k onto 100k, 20 iterations", 10, [&]() {
+            sink += icp.align(source.view(), IterativeClosestPoint<T>::Transform(), settings).log.size();
+        });
+        settings.metric = IterativeClosestPoint<T>::POINT_TO_LINE;
+        settings.trimRatio = 0.9;
+        bench("IterativeClosestPoint 10k onto 100k, 20 iterations, point to line, trimmed", 10, [&]() {
+            sink += icp.align(source.view(), IterativeClosestPoint<T>::Transform(), settings).log.size();
+        });
+    }
+
+    cout << "---- Ransac ----" << endl;
+
+    {
+        //a circle of 100k points within 900k outliers
+        PointCloud<T> scan = random_cloud(900000, 11);
+        for(size_t i = 0; i < 100000; ++i)
+            scan.push_back(20 + 30 * cos(i * 6.28e-5), -10 + 30 * sin(i * 6.28e-5));
+        const Ransac<T> ransac(scan.view());
+        Ransac<T>::Settings settings;
+        settings.threshold = 0.05;
+        settings.maxIterations = 2000;
+
+        settings.nThreads = 1;
+        bench("Ransac circle 1M points (1 thread)", 1, [&]() {
+            sink += ransac.circle(settings).inliers.n_elements();
+        });
+        settings.nThreads = 0;
+        bench("Ransac circle 1M points (threaded)", 1, [&]() {
+            sink += ransac.circle(settings).inliers.n_elements();
+        });
+        bench("Ransac line 1M points (threaded)", 1, [&]() {
+            sink += ransac.line(settings).inliers.n_elements();
+        });
+        bench("Ransac ellipse 1M points (threaded)", 1, [&]() {
+            sink += ransac.ellipse(settings).inliers.n_elements();
+        });
+    }
+
+    cout << "---- DistanceJoin ----" << endl;
+
+    {
+        std::vector<size_t> offsets, ids;
+        bench("DistanceJoin build 1M", 1, [&]() {
+            sink += DistanceJoin<T>(million->view(), 0.2).size();
+        });
+
+        const DistanceJoin<T> join(million->view(), 0.2);
+        bench("DistanceJoin self join 1M r=0.2 (1 thread)", 1, [&]() {
+            join.self_join(offsets, ids, 1);
+            sink += ids.size();
+        });
+        bench("DistanceJoin self join 1M r=0.2 (threaded)", 1, [&]() {
+            join.self_join(offsets, ids);
+            sink += ids.size();
+        });
+        bench("DistanceJoin 1M queries r=0.2 (threaded)", 1, [&]() {
+            join.join(random_cloud(1000000, 5).view(), offsets, ids);
+            sink += ids.size();
+        });
+        bench("DistanceJoin self pairs streamed 1M r=0.2 (threaded)", 1, [&]() {
+            join.for_each_self_pair([&](const DistanceJoin<T>::Pair *first, const DistanceJoin<T>::Pair *last) {
+                sink += last - first;
+            });
+        });
+    }
+
+    cout << "---- ReverseKNearest ----" << endl;
+
+    {
+        std::vector<size_t> offsets, ids;
+        bench("ReverseKNearest build 1M k=8 (threaded)", 1, [&]() {
+            sink += ReverseKNearest<T>(million->view(), 8).n_clients();
+        });
+
+        ReverseKNearest<T> rknn(million->view(), 8);
+        bench("ReverseKNearest 1M probes k=8 (threaded)", 1, [&]() {
+            rknn.query(random_cloud(1000000, 6).view(), offsets, ids);
+            sink += ids.size();
+        });
+        bench("ReverseKNearest 100k single probes k=8", 1, [&]() {
+            for(const auto &p : random_cloud(100000, 7))
+                sink += rknn.query(p).n_elements();
+        });
+        bench("ReverseKNearest 100k inserts k=8", 1, [&]() {
+            for(const auto &p : random_cloud(100000, 8))
+                sink += rknn.insert(p);
+        });
+    }
+
+    cout << "---- MarchingSquares ----" << endl;
+
+    {
+        const size_t n = 2048;
+        std::vector<T> values(n * n);
+        for(size_t iy = 0; iy < n; ++iy) {
+            for(size_t ix = 0; ix < n; ++ix)
+                values[iy * n + ix] = std::sin(T(0.01) * ix) * std::cos(T(0.013) * iy) + T(0.3) * std::sin(T(0.05) * ix + T(0.02) * iy);
+        }
+        const MarchingSquares<T> ms(std::move(values), n, n);
+        bench("MarchingSquares 2048x2048 one level (1 thread)", 1, [&]() {
+            sink += ms.contour(0, true, 1).size();
+        });
+        bench("MarchingSquares 2048x2048 one level (threaded)", 1, [&]() {
+            sink += ms.contour(0).size();
+        });
+        bench("MarchingSquares 2048x2048 five levels (threaded)", 1, [&]() {
+            sink += ms.contours(std::vector<T>{T(-0.8), T(-0.4), 0, T(0.4), T(0.8)}).size();
+        });
+    }
+
+    cout << "---- OnlineHull ----" << endl;
+
+    bench("OnlineHull build 1M", 1, [&]() {
+        OnlineHull<T> online(million);
+        sink += online.n_vertices();
+    });
+
+    OnlineHull<T> online(make_shared<PointCloud<T> >(*million));
+    bench("OnlineHull insert x1000 + hull", 10, [&]() {
+        for(size_t i = 0; i < 1000; ++i)
+            sink += online.insert(a[i]);
+        sink += online.hull()->n_elements();
+    });
+
+    return 0;
+}
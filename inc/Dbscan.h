@@ -0,0 +1,299 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    Dbscan.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class Dbscan, density based clustering of a PointCloud
+ *          the points are sorted into a grid of cells smaller than the radius (SortedGrid), so a cell with enough points only contains core points
+ *          and neighbouring cells are merged as soon as a single pair of their core points is within the radius
+ */
+
+#ifndef DBSCAN_H_INCLUDED
+#define DBSCAN_H_INCLUDED
+
+#include <vector>
+#include <array>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+#include "Point.h"
+#include "PointCloud.h"
+#include "OrderedPointCloud.h"
+#include "Topology.h"
+#include "DisjointSets.h"
+#include "SortedGrid.h"
+#include "parallel.h"
+
+namespace lib_2d {
+
+template <typename T>
+class Dbscan {
+
+public:
+    enum : size_t {NOISE = static_cast<size_t>(-1)};
+
+private:
+    using Grid = SortedGrid<T>;
+    using Range = typename Grid::Range;
+    using Neighbours = typename Grid::Cursor;
+
+    std::shared_ptr<PointCloud<T>> pc;
+    std::vector<size_t> pointLabels;
+    std::vector<char> cores;
+    size_t nClusters;
+
+//------------------------------------------------------------------------------
+
+public:
+
+    ///a point is a core point if at least minPoints points (including itself) are within radius
+    ///core points within radius of each other form a cluster, other points within radius of a core point are added to the cluster of the nearest one
+    ///all remaining points are NOISE
+    Dbscan(std::shared_ptr<PointCloud<T>> points, T radius, size_t minPoints, size_t nThreads = 0) :
+        pc(points),
+        pointLabels(points->size(), NOISE),
+        cores(points->size(), false),
+        nClusters(0) {
+
+        if(!(radius > 0))
+            throw std::out_of_range ("Dbscan requires a positive radius");
+
+        const size_t n = pc->size();
+        if(n == 0)
+            return;
+
+        //cells of radius / 1.5 have a diagonal below the radius, so any two points of a cell are within it (compact)
+        //only huge extents require larger cells, the bound leaves room for rounding
+        const T sqrRadius = radius * radius;
+        const Grid grid(pc->view(), radius, radius / T(1.5), nThreads);
+        const bool compact = 2 * grid.cellSize * grid.cellSize <= T(0.9) * sqrRadius;
+        const size_t nCells = grid.keys.size();
+        const size_t nChunks = n_chunks(nCells, nThreads, 1 << 10);
+
+        //core points, counting stops as soon as there are enough neighbours
+        std::vector<char> sortedCores(n, false);
+        std::vector<size_t> firstCores(nCells, n);
+        parallel_chunks(nCells, nChunks, [&](size_t first, size_t last, size_t) {
+            Neighbours neighbours(grid);
+            for(size_t cell = first; cell < last; ++cell) {
+                const size_t cellFirst = grid.starts[cell], cellLast = grid.starts[cell + 1];
+                if(compact && cellLast - cellFirst >= minPoints) {
+                    std::fill(sortedCores.begin() + cellFirst, sortedCores.begin() + cellLast, true);
+                    firstCores[cell] = cellFirst;
+                    continue;
+                }
+                const auto &ranges = neighbours.of(grid.keys[cell]);
+                for(size_t i = cellFirst; i < cellLast; ++i) {
+                    if(count_within(grid, compact, cell, ranges, i, sqrRadius, minPoints) < minPoints)
+                        continue;
+                    sortedCores[i] = true;
+                    if(firstCores[cell] == n)
+                        firstCores[cell] = i;
+                }
+            }
+        });
+
+        //clusters of the core points
+        DisjointSets sets(n);
+        Neighbours neighbours(grid);
+        for(size_t cell = 0; cell < nCells; ++cell) {
+            const size_t firstCore = firstCores[cell];
+            if(firstCore == n)
+                continue;
+            const size_t cellLast = grid.starts[cell + 1];
+            if(compact) {
+                for(size_t i = firstCore + 1; i < cellLast; ++i) {
+                    if(sortedCores[i])
+                        sets.unite(firstCore, i);
+                }
+            }
+            for(const auto &range : neighbours.of(grid.keys[cell])) {
+                for(size_t other = std::max(range.first, cell + (compact ? 1 : 0)); other < range.second; ++other) {
+                    if(firstCores[other] == n)
+                        continue;
+                    if(compact) {
+                        if(!sets.same(firstCore, firstCores[other]) && any_pair_within(grid, sortedCores, cell, other, sqrRadius))
+                            sets.unite(firstCore, firstCores[other]);
+                    }
+                    else
+                        unite_pairs_within(grid, sortedCores, cell, other, sqrRadius, sets);
+                }
+            }
+        }
+
+        //labels in the order of the first point of each cluster
+        std::vector<size_t> positions(n);
+        for(size_t i = 0; i < n; ++i)
+            positions[grid.ids[i]] = i;
+        std::vector<size_t> labelOfRoot(n, NOISE);
+        std::vector<size_t> sortedLabels(n, NOISE);
+        for(size_t id = 0; id < n; ++id) {
+            const size_t i = positions[id];
+            if(!sortedCores[i])
+                continue;
+            const size_t root = sets.find(i);
+            if(labelOfRoot[root] == NOISE)
+                labelOfRoot[root] = nClusters++;
+            sortedLabels[i] = labelOfRoot[root];
+            pointLabels[id] = sortedLabels[i];
+            cores[id] = true;
+        }
+
+        //border points join the cluster of their nearest core point
+        parallel_chunks(nCells, nChunks, [&](size_t first, size_t last, size_t) {
+            Neighbours neighbours(grid);
+            for(size_t cell = first; cell < last; ++cell) {
+                const std::vector<Range> *ranges = nullptr;
+                for(size_t i = grid.starts[cell]; i < grid.starts[cell + 1]; ++i) {
+                    if(sortedCores[i])
+                        continue;
+                    if(!ranges)
+                        ranges = &neighbours.of(grid.keys[cell]);
+                    size_t nearest = NOISE;
+                    T sqrDistanceNearest = sqrRadius;
+                    for(const auto &range : *ranges) {
+                        for(size_t j = grid.starts[range.first]; j < grid.starts[range.second]; ++j) {
+                            if(!sortedCores[j])
+                                continue;
+                            const T sqrDistance = sqr_distance(grid, i, j);
+                            if(sqrDistance < sqrDistanceNearest || (nearest == NOISE && sqrDistance <= sqrRadius)) {
+                                nearest = j;
+                                sqrDistanceNearest = sqrDistance;
+                            }
+                        }
+                    }
+                    if(nearest != NOISE)
+                        pointLabels[grid.ids[i]] = sortedLabels[nearest];
+                }
+            }
+        });
+    }
+
+//------------------------------------------------------------------------------
+
+    size_t n_points() const {
+        return pointLabels.size();
+    }
+
+    size_t n_clusters() const {
+        return nClusters;
+    }
+
+    ///the cluster of each point or NOISE
+    const std::vector<size_t>& labels() const {
+        return pointLabels;
+    }
+
+    bool is_core(size_t i) const {
+        return cores[i];
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the points of a single cluster, in the order of the parent
+    std::shared_ptr<OrderedPointCloud<T>> cluster(size_t label) const {
+        if(label >= nClusters)
+            throw std::out_of_range ("Dbscan has no cluster with this label");
+        return with_label(label);
+    }
+
+    ///all clusters at once, indexed by their label
+    std::vector<std::shared_ptr<OrderedPointCloud<T>>> clusters() const {
+        std::vector<std::shared_ptr<OrderedPointCloud<T>>> result(nClusters);
+        for(auto &c : result)
+            c = std::make_shared<OrderedPointCloud<T>>(pc, Topology<1>());
+        for(size_t i = 0; i < pointLabels.size(); ++i) {
+            if(pointLabels[i] != NOISE)
+                result[pointLabels[i]]->push_back_id(i);
+        }
+        return result;
+    }
+
+    ///the points which aren't part of any cluster
+    std::shared_ptr<OrderedPointCloud<T>> noise() const {
+        return with_label(NOISE);
+    }
+
+//------------------------------------------------------------------------------
+
+private:
+
+    std::shared_ptr<OrderedPointCloud<T>> with_label(size_t label) const {
+        auto result = std::make_shared<OrderedPointCloud<T>>(pc, Topology<1>());
+        for(size_t i = 0; i < pointLabels.size(); ++i) {
+            if(pointLabels[i] == label)
+                result->push_back_id(i);
+        }
+        return result;
+    }
+
+//------------------------------------------------------------------------------
+
+    static inline T sqr_distance(const Grid &grid, size_t i, size_t j) {
+        return grid.sqr_distance(grid.xs[i], grid.ys[i], j);
+    }
+
+    ///the number of points within the radius of i, but at most limit
+    static size_t count_within(const Grid &grid, bool compact, size_t cell, const std::vector<Range> &ranges, size_t i, T sqrRadius, size_t limit) {
+        size_t count(0);
+        for(const auto &range : ranges) {
+            for(size_t other = range.first; other < range.second; ++other) {
+                if(other == cell && compact) {
+                    count += grid.starts[cell + 1] - grid.starts[cell];
+                }
+                else {
+                    for(size_t j = grid.starts[other]; j < grid.starts[other + 1]; ++j) {
+                        if(sqr_distance(grid, i, j) <= sqrRadius)
+                            ++count;
+                    }
+                }
+                if(count >= limit)
+                    return count;
+            }
+        }
+        return count;
+    }
+
+    static bool any_pair_within(const Grid &grid, const std::vector<char> &sortedCores, size_t cell, size_t other, T sqrRadius) {
+        for(size_t i = grid.starts[cell]; i < grid.starts[cell + 1]; ++i) {
+            if(!sortedCores[i])
+                continue;
+            for(size_t j = grid.starts[other]; j < grid.starts[other + 1]; ++j) {
+                if(sortedCores[j] && sqr_distance(grid, i, j) <= sqrRadius)
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    static void unite_pairs_within(const Grid &grid, const std::vector<char> &sortedCores, size_t cell, size_t other, T sqrRadius, DisjointSets &sets) {
+        for(size_t i = grid.starts[cell]; i < grid.starts[cell + 1]; ++i) {
+            if(!sortedCores[i])
+                continue;
+            for(size_t j = (other == cell ? i + 1 : grid.starts[other]); j < grid.starts[other + 1]; ++j) {
+                if(sortedCores[j] && sqr_distance(grid, i, j) <= sqrRadius)
+                    sets.unite(i, j);
+            }
+        }
+    }
+};
+
+} //lib_2d
+
+#endif // DBSCAN_H_INCLUDED
@@ -0,0 +1,975 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    Delaunay.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class Delaunay, the Delaunay triangulation of a PointCloud
+ *          points are inserted incrementally (Bowyer-Watson) in BRIO order, rounds of doubling size each sorted along a Hilbert curve,
+ *          so the walk locating the next point starts close to it
+ *          the mesh is stored as half edges within flat arrays, triangles outside of the convex hull are closed by ghost triangles
+ *          with several threads vertical strips are triangulated independently and the triangles near their borders recomputed
+ */
+
+#ifndef DELAUNAY_H_INCLUDED
+#define DELAUNAY_H_INCLUDED
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <cstdint>
+#include <cmath>
+#include <memory>
+#include <functional>
+
+#include "Point.h"
+#include "PointCloudView.h"
+#include "Topology.h"
+#include "parallel.h"
+
+namespace lib_2d {
+
+template <typename T>
+class Delaunay {
+
+protected:
+    using Element = std::array<size_t, 3>;
+    using Index = uint32_t; //half the memory of size_t, limits the triangulation to 2^32 - 1 points
+    using Real = typename std::conditional<std::is_same<T, float>::value, double, T>::type; //precision of the predicates
+
+    enum : Index {GHOST = std::numeric_limits<Index>::max()}; //the vertex at infinity of the ghost triangles
+
+    std::vector<Point<T>> points; //in insertion order
+    std::vector<size_t> ids; //index of each point within the source PointCloud
+
+    std::vector<Index> vertices; //three per triangle, counter clockwise, half edge i goes from vertices[i] to vertices[next(i)], ghosts are stored last
+    std::vector<Index> twins; //the opposite half edge of each half edge
+
+    size_t nReal = 0; //number of triangles which aren't ghosts
+    Topology<2> ignored; //each duplicate and the equal point triangulated instead, as indices within the source
+
+//------------------------------------------------------------------------------
+
+public:
+
+    ///triangulates all points, duplicates are ignored (the one with the lowest index is kept), collinear inputs result in no triangles
+    ///with more than one thread the points are split into vertical strips (at least 2^16 points each)
+    explicit Delaunay(const PointCloudView<T> &source, size_t nThreads = 0) {
+        const size_t n = source.size();
+        if(n >= size_t(GHOST))
+            throw std::out_of_range ("Delaunay supports at most 2^32 - 2 points");
+
+        const size_t nStrips = n_chunks(n, nThreads, 1 << 16);
+        if(nStrips > 1 && triangulate_strips(source, nStrips, nThreads))
+            return;
+
+        ignored = Topology<2>();
+        points.assign(source.begin(), source.end());
+        ids.resize(n);
+        std::iota(ids.begin(), ids.end(), size_t(0));
+        triangulate();
+    }
+
+//------------------------------------------------------------------------------
+
+    size_t n_triangles() const {
+        return nReal;
+    }
+
+    ///number of points which were ignored, since they equal another one
+    size_t n_duplicates() const {
+        return ignored.n_elements();
+    }
+
+    ///all triangles (counter clockwise) with the indices of their points within the source
+    Topology<3> triangles() const {
+        Topology<3> res;
+        res.reserve_elements(nReal);
+        for(size_t t = 0; t < vertices.size() / 3; ++t) {
+            if(!is_ghost(t))
+                res.push_back(Element{ids[vertices[3*t]], ids[vertices[3*t+1]], ids[vertices[3*t+2]]});
+        }
+        return res;
+    }
+
+    ///every edge of the triangulation once, with the indices of its points within the source
+    Topology<2> edges() const {
+        Topology<2> res;
+        res.reserve_elements(3 * nReal / 2 + 2);
+        for(size_t he = 0; he < 3 * nReal; ++he) {
+            if(twins[he] > he) //ghosts are stored last, so all hull edges are taken from their real triangle
+                res.push_back(std::array<size_t, 2>{{ids[vertices[he]], ids[vertices[next(he)]]}});
+        }
+        return res;
+    }
+
+    ///each ignored duplicate and the point equal to it which was triangulated (the one with the lowest index), as indices within the source
+    const Topology<2>& duplicates() const {
+        return ignored;
+    }
+
+//------------------------------------------------------------------------------
+
+protected:
+
+    Delaunay(std::vector<Point<T>> &&ps, std::vector<size_t> &&sourceIds) :
+        points(std::move(ps)),
+        ids(std::move(sourceIds)) {
+        triangulate();
+    }
+
+    static inline size_t next(size_t he) {
+        return he % 3 == 2 ? he - 2 : he + 1;
+    }
+
+    static inline size_t prev(size_t he) {
+        return he % 3 == 0 ? he + 2 : he - 1;
+    }
+
+    ///the ghost vertex is always the last one of a ghost triangle, so its first half edge is the hull edge
+    inline bool is_ghost(size_t t) const {
+        return vertices[3*t+2] == GHOST;
+    }
+
+    ///positive if c is left of a -> b
+    ///the sign is exact, if rounding could flip it the determinant is evaluated with expansions (Shewchuk)
+    static inline Real orient(const Point<T> &a, const Point<T> &b, const Point<T> &c) {
+        const Real
+            left = (Real(b.x) - a.x) * (Real(c.y) - a.y),
+            right = (Real(b.y) - a.y) * (Real(c.x) - a.x),
+            det = left - right,
+            eps = std::numeric_limits<Real>::epsilon() / 2;
+        if(std::abs(det) > (3 + 16 * eps) * eps * (std::abs(left) + std::abs(right)))
+            return det;
+
+        const Expansion<2>
+            bax = Expansion<2>::diff(b.x, a.x), bay = Expansion<2>::diff(b.y, a.y),
+            cax = Expansion<2>::diff(c.x, a.x), cay = Expansion<2>::diff(c.y, a.y);
+        return Expansion<8>::product(bax, cay).minus(Expansion<8>::product(bay, cax)).estimate();
+    }
+
+    ///positive if d is within the circumcircle of the counter clockwise triangle a b c, the sign is exact
+    static inline Real in_circle(const Point<T> &a, const Point<T> &b, const Point<T> &c, const Point<T> &d) {
+        const Real
+            adx = Real(a.x) - d.x, ady = Real(a.y) - d.y,
+            bdx = Real(b.x) - d.x, bdy = Real(b.y) - d.y,
+            cdx = Real(c.x) - d.x, cdy = Real(c.y) - d.y,
+            bc = bdx * cdy, cb = cdx * bdy,
+            ca = cdx * ady, ac = adx * cdy,
+            ab = adx * bdy, ba = bdx * ady,
+            aLift = adx * adx + ady * ady,
+            bLift = bdx * bdx + bdy * bdy,
+            cLift = cdx * cdx + cdy * cdy,
+            det = aLift * (bc - cb) + bLift * (ca - ac) + cLift * (ab - ba),
+            permanent = (std::abs(bc) + std::abs(cb)) * aLift + (std::abs(ca) + std::abs(ac)) * bLift + (std::abs(ab) + std::abs(ba)) * cLift,
+            eps = std::numeric_limits<Real>::epsilon() / 2;
+        if(std::abs(det) > (10 + 96 * eps) * eps * permanent)
+            return det;
+
+        const Expansion<2>
+            ax = Expansion<2>::diff(a.x, d.x), ay = Expansion<2>::diff(a.y, d.y),
+            bx = Expansion<2>::diff(b.x, d.x), by = Expansion<2>::diff(b.y, d.y),
+            cx = Expansion<2>::diff(c.x, d.x), cy = Expansion<2>::diff(c.y, d.y);
+        const auto
+            aTerm = Expansion<512>::product(lift(ax, ay), cross(bx, by, cx, cy)),
+            bTerm = Expansion<512>::product(lift(bx, by), cross(cx, cy, ax, ay)),
+            cTerm = Expansion<512>::product(lift(cx, cy), cross(ax, ay, bx, by));
+        return Expansion<1536>::sum(Expansion<1024>::sum(aTerm, bTerm), cTerm).estimate();
+    }
+
+    static Point<T> circumcenter(const Point<T> &a, const Point<T> &b, const Point<T> &c) {
+        const Real
+            bx = Real(b.x) - a.x, by = Real(b.y) - a.y,
+            cx = Real(c.x) - a.x, cy = Real(c.y) - a.y,
+            d = 2 * (bx * cy - by * cx),
+            b2 = bx * bx + by * by,
+            c2 = cx * cx + cy * cy;
+        return Point<T>{T(a.x + (cy * b2 - by * c2) / d), T(a.y + (bx * c2 - cx * b2) / d)};
+    }
+
+//------------------------------------------------------------------------------
+
+private:
+
+    ///exact sum of up to N non overlapping Reals of increasing magnitude (Shewchuk's expansions), without zero components
+    template <size_t N>
+    struct Expansion {
+        std::array<Real, N> c;
+        size_t n = 0;
+
+        static inline void two_sum(Real a, Real b, Real &x, Real &y) {
+            x = a + b;
+            const Real bv = x - a, av = x - bv;
+            y = (a - av) + (b - bv);
+        }
+
+        static inline void split(Real a, Real &hi, Real &lo) {
+            const Real
+                splitter = Real(uint64_t(1) << ((std::numeric_limits<Real>::digits + 1) / 2)) + 1,
+                big = splitter * a;
+            hi = big - (big - a);
+            lo = a - hi;
+        }
+
+        static inline void two_product(Real a, Real b, Real &x, Real &y) {
+            x = a * b;
+            Real aHi, aLo, bHi, bLo;
+            split(a, aHi, aLo);
+            split(b, bHi, bLo);
+            y = aLo * bLo - (((x - aHi * bHi) - aLo * bHi) - aHi * bLo);
+        }
+
+        inline void add(Real x) {
+            if(x != 0)
+                c[n++] = x;
+        }
+
+        ///the exact difference a - b
+        static Expansion diff(Real a, Real b) {
+            Expansion res;
+            Real x, y;
+            two_sum(a, -b, x, y);
+            res.add(y);
+            res.add(x);
+            return res;
+        }
+
+        template <size_t A, size_t B>
+        static Expansion sum(const Expansion<A> &e, const Expansion<B> &f) {
+            static_assert(A + B <= N, "the sum may need A + B components");
+            Expansion res;
+            merge(e.c.data(), e.n, f.c.data(), f.n, res);
+            return res;
+        }
+
+        ///merges both by magnitude, summing up with error free transformations, the result must fit into N components
+        static void merge(const Real *e, size_t ne, const Real *f, size_t nf, Expansion &res) {
+            res.n = 0;
+            size_t i(0), j(0);
+            auto take = [&]() {
+                return j >= nf || (i < ne && std::abs(e[i]) < std::abs(f[j])) ? e[i++] : f[j++];
+            };
+            Real q = i < ne || j < nf ? take() : Real(0);
+            while(i < ne || j < nf) {
+                Real x, y;
+                two_sum(q, take(), x, y);
+                res.add(y);
+                q = x;
+            }
+            res.add(q);
+        }
+
+        template <size_t A>
+        static Expansion scale(const Expansion<A> &e, Real b) {
+            static_assert(2 * A <= N, "scaling may need 2A components");
+            Expansion res;
+            if(e.n == 0 || b == 0)
+                return res;
+            Real q, y;
+            two_product(e.c[0], b, q, y);
+            res.add(y);
+            for(size_t i = 1; i < e.n; ++i) {
+                Real high, low, x;
+                two_product(e.c[i], b, high, low);
+                two_sum(q, low, x, y);
+                res.add(y);
+                q = high + x; //high is at least as large as x, so this is a fast two sum
+                res.add(x - (q - high));
+            }
+            res.add(q);
+            return res;
+        }
+
+        template <size_t A, size_t B>
+        static Expansion product(const Expansion<A> &e, const Expansion<B> &f) {
+            static_assert(2 * A * B <= N, "the product may need 2AB components");
+            Expansion res, other; //after j rows at most 2Aj components
+            Expansion *from = &res, *to = &other;
+            for(size_t j = 0; j < f.n; ++j) {
+                const Expansion<2 * A> row = Expansion<2 * A>::scale(e, f.c[j]);
+                merge(from->c.data(), from->n, row.c.data(), row.n, *to);
+                std::swap(from, to);
+            }
+            if(from != &res) {
+                std::copy(other.c.begin(), other.c.begin() + other.n, res.c.begin());
+                res.n = other.n;
+            }
+            return res;
+        }
+
+        template <size_t B>
+        Expansion<N + B> minus(const Expansion<B> &f) const {
+            Expansion<B> negated(f);
+            for(size_t j = 0; j < negated.n; ++j)
+                negated.c[j] = -negated.c[j];
+            return Expansion<N + B>::sum(*this, negated);
+        }
+
+        ///the largest component has the sign of the exact value
+        Real estimate() const {
+            Real res(0);
+            for(size_t i = 0; i < n; ++i)
+                res += c[i];
+            return res;
+        }
+    };
+
+    static Expansion<16> lift(const Expansion<2> &x, const Expansion<2> &y) {
+        return Expansion<16>::sum(Expansion<8>::product(x, x), Expansion<8>::product(y, y));
+    }
+
+    static Expansion<16> cross(const Expansion<2> &ax, const Expansion<2> &ay, const Expansion<2> &bx, const Expansion<2> &by) {
+        return Expansion<8>::product(ax, by).minus(Expansion<8>::product(ay, bx));
+    }
+
+    ///scratch space of the insertions
+    struct Builder {
+        std::vector<unsigned int> marks; //per triangle, 'stamp' if within the cavity, 'stamp + 1' if tested and outside
+        unsigned int stamp = 1;
+        std::vector<Index> cavity;
+        std::vector<std::array<Index, 3>> boundary; //start, end and outer twin of the cavity border
+        std::vector<Index> byStart; //new triangle by the start of its border edge, the ghost vertex is stored last
+        Index last = 0; //start of the next walk
+    };
+
+    ///cocircular points are resolved by a symbolic perturbation (lifting each point by eps^sourceIndex), so the triangulation is unique
+    ///of equal points the one with the lowest source index is kept, so this also holds with duplicates
+    bool perturbed_in_circle(Index a, Index b, Index c, Index d) const {
+        const Point<T> &pa = points[a], &pb = points[b], &pc = points[c], &pd = points[d];
+        std::array<std::pair<size_t, Real>, 4> terms{{
+            std::make_pair(ids[a],  orient(pb, pc, pd)),
+            std::make_pair(ids[b], -orient(pa, pc, pd)),
+            std::make_pair(ids[c],  orient(pa, pb, pd)),
+            std::make_pair(ids[d], -orient(pa, pb, pc))}};
+        std::sort(terms.begin(), terms.end(), [](const std::pair<size_t, Real> &lhs, const std::pair<size_t, Real> &rhs) {
+            return lhs.first < rhs.first;
+        });
+        for(const auto &term : terms) {
+            if(term.second != 0)
+                return term.second > 0;
+        }
+        return false;
+    }
+
+    ///whether the circumcircle of t contains the point, for ghosts whether the point is outside of their hull edge
+    bool conflicts(size_t t, Index v) const {
+        const Index
+            a = vertices[3*t],
+            b = vertices[3*t+1],
+            c = vertices[3*t+2];
+        const Point<T> &p = points[v];
+        if(c == GHOST) {
+            const Real o = orient(points[a], points[b], p);
+            if(o != 0)
+                return o > 0;
+            const Point<T> &pa = points[a], &pb = points[b];
+            return (Real(p.x) - pa.x) * (Real(pb.x) - pa.x) + (Real(p.y) - pa.y) * (Real(pb.y) - pa.y) > 0
+                && (Real(p.x) - pb.x) * (Real(pa.x) - pb.x) + (Real(p.y) - pb.y) * (Real(pa.y) - pb.y) > 0;
+        }
+        const Real d = in_circle(points[a], points[b], points[c], p);
+        if(d != 0)
+            return d > 0;
+        return perturbed_in_circle(a, b, c, v);
+    }
+
+//------------------------------------------------------------------------------
+
+protected:
+
+    ///visibility walk towards p, returns the triangle containing it or the ghost triangle whose hull edge it is outside of
+    size_t locate(const Point<T> &p, size_t t) const {
+        if(is_ghost(t))
+            t = twins[3*t] / 3;
+
+        const size_t maxSteps = vertices.size();
+        uint32_t random = 2463534242u;
+        for(size_t step = 0; step < maxSteps; ++step) {
+            random ^= random << 13; random ^= random >> 17; random ^= random << 5; //xorshift, a fixed order of the edges could cycle
+            const size_t rotation = random % 3;
+            bool moved = false;
+            for(size_t k = 0; k < 3; ++k) {
+                const size_t he = 3*t + (k + rotation) % 3;
+                if(orient(points[vertices[he]], points[vertices[next(he)]], p) < 0) {
+                    t = twins[he] / 3;
+                    moved = true;
+                    break;
+                }
+            }
+            if(!moved || is_ghost(t))
+                return t;
+        }
+        return locate_linear(p);
+    }
+
+    size_t locate_linear(const Point<T> &p) const {
+        for(size_t t = 0; t < vertices.size() / 3; ++t) {
+            if(is_ghost(t))
+                continue;
+            if(   orient(points[vertices[3*t]], points[vertices[3*t+1]], p) >= 0
+               && orient(points[vertices[3*t+1]], points[vertices[3*t+2]], p) >= 0
+               && orient(points[vertices[3*t+2]], points[vertices[3*t]], p) >= 0)
+                return t;
+        }
+        for(size_t t = 0; t < vertices.size() / 3; ++t) {
+            if(is_ghost(t) && orient(points[vertices[3*t]], points[vertices[3*t+1]], p) > 0)
+                return t;
+        }
+        return 0;
+    }
+
+//------------------------------------------------------------------------------
+
+private:
+
+    ///orders points and ids in rounds (BRIO), each point is within the last round with probability 1/2, the one before with 1/4 ...
+    ///the points of a round are sorted along a Hilbert curve
+    ///equal points share their round and position along the curve, so they end up next to each other (the lowest source index first)
+    ///only that one is kept, the others are moved to 'ignored', the insertion requires distinct points
+    void brio_order() {
+        const size_t m = points.size();
+        T minX(points[0].x), maxX(points[0].x), minY(points[0].y), maxY(points[0].y);
+        for(const auto &p : points) {
+            minX = std::min(minX, p.x); maxX = std::max(maxX, p.x);
+            minY = std::min(minY, p.y); maxY = std::max(maxY, p.y);
+        }
+        const Real
+            scaleX = maxX > minX ? Real(65535) / (Real(maxX) - minX) : Real(0),
+            scaleY = maxY > minY ? Real(65535) / (Real(maxY) - minY) : Real(0);
+
+        uint64_t nRounds(1);
+        while((m >> nRounds) > 128)
+            ++nRounds;
+
+        const std::hash<T> hash;
+        std::vector<std::pair<uint64_t, Index>> keys(m);
+        for(size_t i = 0; i < m; ++i) {
+            const Point<T> &p = points[i];
+            //the trailing zeros of a hash of the position are geometrically distributed
+            const uint64_t position = uint64_t(hash(p.x)) * 0x9E3779B97F4A7C15ull ^ uint64_t(hash(p.y));
+            uint32_t h = uint32_t(position ^ (position >> 32)) * 0x9E3779B1u;
+            h ^= h >> 15; h *= 0x85EBCA6Bu; h ^= h >> 13;
+            uint64_t round(0);
+            while(round + 1 < nRounds && (h & 1) == 0) {
+                h >>= 1;
+                ++round;
+            }
+            keys[i] = std::make_pair(((nRounds - 1 - round) << 32) | hilbert(uint32_t((Real(p.x) - minX) * scaleX), uint32_t((Real(p.y) - minY) * scaleY)), Index(i));
+        }
+        std::sort(keys.begin(), keys.end(), [this](const std::pair<uint64_t, Index> &lhs, const std::pair<uint64_t, Index> &rhs) {
+            if(lhs.first != rhs.first)
+                return lhs.first < rhs.first;
+            const Point<T> &l = points[lhs.second], &r = points[rhs.second];
+            if(l.x != r.x)
+                return l.x < r.x;
+            if(l.y != r.y)
+                return l.y < r.y;
+            return ids[lhs.second] < ids[rhs.second];
+        });
+
+        std::vector<Point<T>> ps;
+        std::vector<size_t> sourceIds;
+        ps.reserve(m);
+        sourceIds.reserve(m);
+        for(size_t i = 0; i < m; ++i) {
+            const Index v = keys[i].second;
+            if(i > 0 && points[v] == ps.back())
+                ignored.push_back(std::array<size_t, 2>{{ids[v], sourceIds.back()}});
+            else {
+                ps.push_back(points[v]);
+                sourceIds.push_back(ids[v]);
+            }
+        }
+        points.swap(ps);
+        ids.swap(sourceIds);
+    }
+
+    ///position of (x, y) along a Hilbert curve through a 2^16 x 2^16 grid
+    ///branch free, the rotations of all levels are found by a prefix scan over the bits (Fabian Giesen)
+    static uint32_t hilbert(uint32_t x, uint32_t y) {
+        uint32_t A, B, C, D;
+        {
+            const uint32_t
+                a = x ^ y,
+                b = 0xFFFF ^ a,
+                c = 0xFFFF ^ (x | y),
+                d = x & (y ^ 0xFFFF);
+            A = a | (b >> 1);
+            B = (a >> 1) ^ a;
+            C = ((c >> 1) ^ (b & (d >> 1))) ^ c;
+            D = ((a & (c >> 1)) ^ (d >> 1)) ^ d;
+        }
+        for(uint32_t shift = 2; shift <= 8; shift *= 2) {
+            const uint32_t a = A, b = B, c = C, d = D;
+            A = (a & (a >> shift)) ^ (b & (b >> shift));
+            B = (a & (b >> shift)) ^ (b & ((a ^ b) >> shift));
+            C ^= (a & (c >> shift)) ^ (b & (d >> shift));
+            D ^= (b & (c >> shift)) ^ ((a ^ b) & (d >> shift));
+        }
+        const uint32_t
+            a = C ^ (C >> 1),
+            b = D ^ (D >> 1),
+            i0 = x ^ y,
+            i1 = b | (0xFFFF ^ (i0 | a));
+        return (interleave(i1) << 1) | interleave(i0);
+    }
+
+    ///spreads the lower 16 bits to the even bits
+    static inline uint32_t interleave(uint32_t x) {
+        x = (x | (x << 8)) & 0x00FF00FF;
+        x = (x | (x << 4)) & 0x0F0F0F0F;
+        x = (x | (x << 2)) & 0x33333333;
+        x = (x | (x << 1)) & 0x55555555;
+        return x;
+    }
+
+//------------------------------------------------------------------------------
+
+    void triangulate() {
+        if(points.empty())
+            return;
+        brio_order();
+        if(points.size() < 3)
+            return;
+        insert_all();
+        if(vertices.empty())
+            return;
+
+        //ghosts are moved behind all other triangles, so the triangles are indexed as within triangles()
+        const size_t nT = vertices.size() / 3;
+        nReal = 0;
+        for(size_t t = 0; t < nT; ++t) {
+            if(!is_ghost(t))
+                ++nReal;
+        }
+        std::vector<Index> moved(nT);
+        for(size_t t = 0, real = 0, ghost = nReal; t < nT; ++t)
+            moved[t] = Index(is_ghost(t) ? ghost++ : real++);
+        std::vector<Index>
+            movedVertices(vertices.size()),
+            movedTwins(twins.size());
+        for(size_t he = 0; he < vertices.size(); ++he) {
+            const size_t target = 3 * moved[he / 3] + he % 3;
+            movedVertices[target] = vertices[he];
+            movedTwins[target] = Index(3 * moved[twins[he] / 3] + twins[he] % 3);
+        }
+        vertices.swap(movedVertices);
+        twins.swap(movedTwins);
+    }
+
+    ///inserts all points in their current order
+    void insert_all() {
+        const size_t m = points.size();
+
+        //the first triangle, of the first two points and the next one not collinear to both
+        Index a(0), b(1), c(0);
+        for(c = b + 1; c < m; ++c) {
+            if(orient(points[a], points[b], points[c]) != 0)
+                break;
+        }
+        if(c >= m)
+            return;
+        const Index first[3] = {a, b, c};
+        if(orient(points[a], points[b], points[c]) < 0)
+            std::swap(b, c);
+
+        vertices = {a, b, c,  b, a, GHOST,  c, b, GHOST,  a, c, GHOST};
+        twins.assign(12, 0);
+        for(size_t he = 0; he < 12; ++he) {
+            for(size_t other = 0; other < 12; ++other) {
+                if(vertices[he] == vertices[next(other)] && vertices[next(he)] == vertices[other])
+                    twins[he] = Index(other);
+            }
+        }
+
+        vertices.reserve(6 * m + 6); //2m - 2 - h triangles and h ghosts
+        twins.reserve(6 * m + 6);
+        Builder builder;
+        builder.marks.reserve(2 * m + 2);
+        builder.marks.assign(4, 0);
+        builder.byStart.resize(m + 1);
+        for(size_t v = 0; v < m; ++v) {
+            if(v == first[0] || v == first[1] || v == first[2])
+                continue;
+            insert(Index(v), builder);
+        }
+    }
+
+    ///Bowyer-Watson, removes all triangles in conflict with the point and connects the border of the cavity to it
+    void insert(Index v, Builder &builder) {
+        const Point<T> &p = points[v];
+        const size_t t = locate(p, builder.last);
+
+        if(builder.stamp >= std::numeric_limits<unsigned int>::max() - 2) {
+            std::fill(builder.marks.begin(), builder.marks.end(), 0);
+            builder.stamp = 1;
+        }
+        builder.stamp += 2;
+        const unsigned int
+            inside = builder.stamp,
+            outside = builder.stamp + 1;
+
+        //the cavity is grown while triangles are in conflict,
+        //or if the new triangle at an edge wouldn't be counter clockwise (only possible due to rounding)
+        auto &cavity = builder.cavity;
+        cavity.assign(1, Index(t));
+        builder.marks[t] = inside;
+        for(size_t k = 0; k < cavity.size(); ++k) {
+            const size_t c = cavity[k];
+            for(size_t i = 0; i < 3; ++i) {
+                const size_t he = 3*c + i;
+                const size_t neighbour = twins[he] / 3;
+                if(builder.marks[neighbour] == inside)
+                    continue;
+                const Index
+                    from = vertices[he],
+                    to = vertices[next(he)];
+                const bool flat = from != GHOST && to != GHOST && orient(points[from], points[to], p) <= 0;
+                if(flat || (builder.marks[neighbour] != outside && conflicts(neighbour, v))) {
+                    builder.marks[neighbour] = inside;
+                    cavity.push_back(Index(neighbour));
+                }
+                else
+                    builder.marks[neighbour] = outside;
+            }
+        }
+
+        auto &boundary = builder.boundary;
+        boundary.clear();
+        for(auto c : cavity) {
+            for(size_t i = 0; i < 3; ++i) {
+                const size_t he = 3*c + i;
+                if(builder.marks[twins[he] / 3] != inside)
+                    boundary.push_back(std::array<Index, 3>{{vertices[he], vertices[next(he)], twins[he]}});
+            }
+        }
+
+        const size_t
+            m = points.size(),
+            nCavity = cavity.size();
+        std::vector<Index> &byStart = builder.byStart;
+        for(size_t k = 0; k < boundary.size(); ++k) {
+            const Index
+                from = boundary[k][0],
+                to = boundary[k][1];
+            const size_t nt = new_triangle(k < nCavity ? cavity[k] : GHOST, builder);
+            if(from == GHOST)
+                set_triangle(nt, to, v, GHOST);
+            else if(to == GHOST)
+                set_triangle(nt, v, from, GHOST);
+            else
+                set_triangle(nt, from, to, v);
+
+            const size_t he = 3*nt + local(nt, from);
+            twins[he] = boundary[k][2];
+            twins[boundary[k][2]] = Index(he);
+            byStart[from == GHOST ? m : from] = Index(nt);
+            if(k < nCavity)
+                cavity[k] = Index(nt);
+            else
+                cavity.push_back(Index(nt));
+        }
+        for(size_t k = 0; k < boundary.size(); ++k) {
+            const Index to = boundary[k][1];
+            const size_t
+                nt = cavity[k],
+                other = byStart[to == GHOST ? m : to],
+                he = 3*nt + local(nt, to),
+                otherHe = 3*other + local(other, v);
+            twins[he] = Index(otherHe);
+            twins[otherHe] = Index(he);
+        }
+        builder.last = cavity[0];
+    }
+
+    ///reuses a slot of the cavity, or appends a triangle
+    size_t new_triangle(Index slot, Builder &builder) {
+        if(slot != GHOST)
+            return slot;
+        vertices.resize(vertices.size() + 3);
+        twins.resize(twins.size() + 3);
+        builder.marks.push_back(0);
+        return vertices.size() / 3 - 1;
+    }
+
+    inline void set_triangle(size_t t, Index a, Index b, Index c) {
+        vertices[3*t] = a;
+        vertices[3*t+1] = b;
+        vertices[3*t+2] = c;
+    }
+
+    inline size_t local(size_t t, Index v) const {
+        return vertices[3*t] == v ? 0 : (vertices[3*t+1] == v ? 1 : 2);
+    }
+
+//------------------------------------------------------------------------------
+
+    ///strips are triangulated on their own, triangles whose circumcircle is within their strip are part of the result
+    ///the remaining region is triangulated from the points of the remaining triangles and the hulls of the strips
+    ///returns false if the result is inconsistent (due to rounding), the serial version is used then
+    bool triangulate_strips(const PointCloudView<T> &source, size_t nStrips, size_t nThreads) {
+        const size_t n = source.size();
+
+        std::vector<T> xs(n);
+        for(size_t i = 0; i < n; ++i)
+            xs[i] = source[i].x;
+        std::vector<T> cuts;
+        for(size_t k = 1; k < nStrips; ++k) {
+            auto nth = xs.begin() + k * n / nStrips;
+            std::nth_element(xs.begin() + (k - 1) * n / nStrips, nth, xs.end());
+            if(cuts.empty() || *nth > cuts.back())
+                cuts.push_back(*nth);
+        }
+        nStrips = cuts.size() + 1;
+
+        std::vector<std::vector<Point<T>>> stripPoints(nStrips);
+        std::vector<std::vector<size_t>> stripIds(nStrips);
+        for(size_t i = 0; i < n; ++i) {
+            const size_t k = std::upper_bound(cuts.begin(), cuts.end(), source[i].x) - cuts.begin();
+            stripPoints[k].push_back(source[i]);
+            stripIds[k].push_back(i);
+        }
+        std::vector<Real>
+            minX(nStrips, std::numeric_limits<Real>::max()),
+            maxX(nStrips, std::numeric_limits<Real>::lowest());
+        for(size_t k = 0; k < nStrips; ++k) {
+            for(const auto &p : stripPoints[k]) {
+                minX[k] = std::min(minX[k], Real(p.x));
+                maxX[k] = std::max(maxX[k], Real(p.x));
+            }
+        }
+
+        struct Strip {
+            std::unique_ptr<Delaunay> mesh;
+            std::vector<Index> finished; //new index of each triangle, GHOST if it's not finished
+            size_t nFinished = 0;
+            std::vector<std::array<size_t, 2>> borders; //edges of finished triangles next to unfinished ones, finished on the left
+            std::vector<size_t> remaining; //source indices of the points to triangulate again
+        };
+        std::vector<Strip> strips(nStrips);
+
+        parallel_for(nStrips, n_chunks(nStrips, nThreads, 1), [&](size_t k) {
+            Strip &strip = strips[k];
+            strip.mesh.reset(new Delaunay(std::move(stripPoints[k]), std::move(stripIds[k])));
+            const Delaunay &mesh = *strip.mesh;
+            if(mesh.nReal == 0) {
+                strip.remaining = mesh.ids;
+                return;
+            }
+
+            const Real
+                left = k > 0 ? maxX[k-1] : std::numeric_limits<Real>::lowest(),
+                right = k + 1 < nStrips ? minX[k+1] : std::numeric_limits<Real>::max();
+            const size_t nT = mesh.vertices.size() / 3;
+            strip.finished.assign(nT, GHOST);
+            for(size_t t = 0; t < nT; ++t) {
+                if(!mesh.is_ghost(t) && mesh.circle_within(t, left, right))
+                    strip.finished[t] = Index(strip.nFinished++);
+            }
+
+            std::vector<bool> remaining(mesh.points.size(), false);
+            for(size_t t = 0; t < nT; ++t) {
+                if(strip.finished[t] != GHOST) {
+                    for(size_t i = 0; i < 3; ++i) {
+                        const size_t he = 3*t + i;
+                        if(strip.finished[mesh.twins[he] / 3] == GHOST)
+                            strip.borders.push_back(std::array<size_t, 2>{{mesh.ids[mesh.vertices[he]], mesh.ids[mesh.vertices[next(he)]]}});
+                    }
+                }
+                else {
+                    for(size_t i = 0; i < 3; ++i) {
+                        const Index v = mesh.vertices[3*t + i];
+                        if(v != GHOST)
+                            remaining[v] = true;
+                    }
+                }
+            }
+            for(size_t v = 0; v < remaining.size(); ++v) {
+                if(remaining[v])
+                    strip.remaining.push_back(mesh.ids[v]);
+            }
+        });
+
+        std::vector<Point<T>> seamPoints;
+        std::vector<size_t> seamIds;
+        std::vector<size_t>
+            pointOffsets(nStrips + 1, 0),
+            triangleOffsets(nStrips + 1, 0);
+        size_t nBorders(0);
+        for(size_t k = 0; k < nStrips; ++k) {
+            const Strip &strip = strips[k];
+            ignored.push_back(strip.mesh->ignored);
+            nBorders += strip.borders.size();
+            pointOffsets[k + 1] = pointOffsets[k] + strip.mesh->points.size();
+            triangleOffsets[k + 1] = triangleOffsets[k] + strip.nFinished;
+            for(auto id : strip.remaining) {
+                seamPoints.push_back(source[id]);
+                seamIds.push_back(id);
+            }
+        }
+        const size_t nFinished = triangleOffsets[nStrips];
+        const Delaunay seam(std::move(seamPoints), std::move(seamIds));
+
+        //the borders of the finished region are edges of the seam triangulation, its triangles on their finished side
+        //and all reachable from them without crossing a border are already covered
+        const size_t nSeamTriangles = seam.vertices.size() / 3;
+        std::vector<std::array<size_t, 3>> seamEdges; //source indices of start and end, half edge
+        for(size_t he = 0; he < seam.vertices.size(); ++he) {
+            if(seam.vertices[he] != GHOST && seam.vertices[next(he)] != GHOST)
+                seamEdges.push_back(std::array<size_t, 3>{{seam.ids[seam.vertices[he]], seam.ids[seam.vertices[next(he)]], he}});
+        }
+        std::sort(seamEdges.begin(), seamEdges.end());
+
+        std::vector<bool>
+            blocked(seam.vertices.size(), false),
+            covered(nSeamTriangles, false);
+        std::vector<size_t> stack;
+        for(const auto &strip : strips) {
+            for(const auto &border : strip.borders) {
+                auto it = std::lower_bound(seamEdges.begin(), seamEdges.end(), std::array<size_t, 3>{{border[0], border[1], 0}});
+                if(it == seamEdges.end() || (*it)[0] != border[0] || (*it)[1] != border[1])
+                    return false;
+                const size_t he = (*it)[2];
+                blocked[he] = blocked[seam.twins[he]] = true;
+                if(!covered[he / 3]) {
+                    covered[he / 3] = true;
+                    stack.push_back(he / 3);
+                }
+            }
+        }
+        if(nBorders == 0 && nFinished > 0)
+            std::fill(covered.begin(), covered.end(), true);
+        while(!stack.empty()) {
+            const size_t t = stack.back();
+            stack.pop_back();
+            for(size_t i = 0; i < 3; ++i) {
+                const size_t he = 3*t + i;
+                const size_t neighbour = seam.twins[he] / 3;
+                if(blocked[he] || covered[neighbour] || seam.is_ghost(neighbour))
+                    continue;
+                covered[neighbour] = true;
+                stack.push_back(neighbour);
+            }
+        }
+
+        std::vector<Index> seamIndex(nSeamTriangles, GHOST); //new index of the uncovered seam triangles
+        size_t nUncovered(0);
+        for(size_t t = 0; t < nSeamTriangles; ++t) {
+            if(!seam.is_ghost(t) && !covered[t])
+                seamIndex[t] = Index(nFinished + nUncovered++);
+        }
+
+        //Euler: a triangulation of V points with H of them on the hull has 2V - 2 - H triangles
+        const size_t
+            nHull = nSeamTriangles - seam.nReal,
+            nVertices = pointOffsets[nStrips];
+        if(seam.nReal == 0 || nFinished + nUncovered + 2 + nHull != 2 * nVertices)
+            return false;
+
+        //the points keep the order of the strips, the finished triangles keep their twins
+        nReal = nFinished + nUncovered;
+        points.resize(nVertices);
+        ids.resize(nVertices);
+        vertices.resize(3 * nReal);
+        twins.resize(3 * nReal);
+        std::vector<Index> local(n);
+        parallel_for(nStrips, n_chunks(nStrips, nThreads, 1), [&](size_t k) {
+            const Strip &strip = strips[k];
+            const Delaunay &mesh = *strip.mesh;
+            const size_t offset = pointOffsets[k];
+            std::copy(mesh.points.begin(), mesh.points.end(), points.begin() + offset);
+            std::copy(mesh.ids.begin(), mesh.ids.end(), ids.begin() + offset);
+            for(size_t v = 0; v < mesh.ids.size(); ++v)
+                local[mesh.ids[v]] = Index(offset + v);
+
+            for(size_t t = 0; t < strip.finished.size(); ++t) {
+                if(strip.finished[t] == GHOST)
+                    continue;
+                const size_t nt = triangleOffsets[k] + strip.finished[t];
+                for(size_t i = 0; i < 3; ++i) {
+                    const size_t twin = mesh.twins[3*t + i];
+                    const Index other = strip.finished[twin / 3];
+                    vertices[3*nt + i] = Index(offset + mesh.vertices[3*t + i]);
+                    twins[3*nt + i] = other == GHOST ? GHOST : Index(3 * (triangleOffsets[k] + other) + twin % 3);
+                }
+            }
+        });
+        for(size_t t = 0; t < nSeamTriangles; ++t) {
+            if(seamIndex[t] == GHOST)
+                continue;
+            const size_t nt = seamIndex[t];
+            for(size_t i = 0; i < 3; ++i) {
+                const size_t twin = seam.twins[3*t + i];
+                const Index other = seamIndex[twin / 3];
+                vertices[3*nt + i] = local[seam.ids[seam.vertices[3*t + i]]];
+                twins[3*nt + i] = other == GHOST ? GHOST : Index(3 * other + twin % 3);
+            }
+        }
+
+        //half edges between finished and seam triangles are matched, the remaining ones are on the hull
+        std::vector<std::array<Index, 3>> open;
+        for(size_t he = 0; he < twins.size(); ++he) {
+            if(twins[he] == GHOST)
+                open.push_back(std::array<Index, 3>{{vertices[he], vertices[next(he)], Index(he)}});
+        }
+        std::sort(open.begin(), open.end());
+        std::vector<Index> ghostByFirst(n, GHOST);
+        std::vector<Index> hull;
+        for(const auto &edge : open) {
+            auto it = std::lower_bound(open.begin(), open.end(), std::array<Index, 3>{{edge[1], edge[0], 0}});
+            if(it != open.end() && (*it)[0] == edge[1] && (*it)[1] == edge[0])
+                twins[edge[2]] = (*it)[2];
+            else
+                hull.push_back(edge[2]);
+        }
+        for(auto he : hull) {
+            const size_t g = vertices.size() / 3;
+            const Index
+                from = vertices[he],
+                to = vertices[next(he)];
+            vertices.insert(vertices.end(), {to, from, GHOST});
+            twins.insert(twins.end(), {he, GHOST, GHOST});
+            twins[he] = Index(3*g);
+            ghostByFirst[to] = Index(g);
+        }
+        for(size_t t = nReal; t < vertices.size() / 3; ++t) {
+            const size_t other = ghostByFirst[vertices[3*t+1]];
+            twins[3*t+1] = Index(3*other + 2);
+            twins[3*other+2] = Index(3*t + 1);
+        }
+        return true;
+    }
+
+    ///whether the circumcircle of t is within (left, right), with a margin for rounding
+    bool circle_within(size_t t, Real left, Real right) const {
+        const Point<T> &a = points[vertices[3*t]];
+        const Point<T> center = circumcenter(a, points[vertices[3*t+1]], points[vertices[3*t+2]]);
+        const Real
+            dx = Real(center.x) - a.x,
+            dy = Real(center.y) - a.y,
+            radius = std::sqrt(dx * dx + dy * dy),
+            margin = std::sqrt(std::numeric_limits<Real>::epsilon()) * (radius + std::fabs(Real(center.x)));
+        return center.x - radius - margin > left && center.x + radius + margin < right;
+    }
+};
+
+} //lib_2d
+
+#endif // DELAUNAY_H_INCLUDED
@@ -0,0 +1,119 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    DisjointSets.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class DisjointSets, union-find over the indices [0, n)
+ *          union by size and path compression, so any sequence of operations takes almost linear time
+ */
+
+#ifndef DISJOINTSETS_H_INCLUDED
+#define DISJOINTSETS_H_INCLUDED
+
+#include <vector>
+#include <numeric>
+#include <utility>
+#include <cstddef>
+
+namespace lib_2d {
+
+class DisjointSets {
+
+private:
+    std::vector<size_t> parents;
+    std::vector<size_t> sizes; //only valid for roots
+    size_t nSets;
+
+//------------------------------------------------------------------------------
+
+public:
+
+    ///n sets, each containing a single index
+    explicit DisjointSets(size_t n = 0) :
+        parents(n),
+        sizes(n, 1),
+        nSets(n) {
+        std::iota(parents.begin(), parents.end(), size_t(0));
+    }
+
+//------------------------------------------------------------------------------
+
+    size_t size() const {
+        return parents.size();
+    }
+
+    size_t n_sets() const {
+        return nSets;
+    }
+
+    ///number of indices within the set of i
+    size_t set_size(size_t i) {
+        return sizes[find(i)];
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the representative of the set of i, all indices on the way are linked to it directly
+    size_t find(size_t i) {
+        size_t root = i;
+        while(parents[root] != root)
+            root = parents[root];
+        while(parents[i] != root) {
+            const size_t parent = parents[i];
+            parents[i] = root;
+            i = parent;
+        }
+        return root;
+    }
+
+    bool same(size_t a, size_t b) {
+        return find(a) == find(b);
+    }
+
+    ///merges the sets of a and b, false if they already were the same
+    bool unite(size_t a, size_t b) {
+        a = find(a);
+        b = find(b);
+        if(a == b)
+            return false;
+        if(sizes[a] < sizes[b])
+            std::swap(a, b);
+        parents[b] = a;
+        sizes[a] += sizes[b];
+        --nSets;
+        return true;
+    }
+
+    ///the index of the set of each index, sets are numbered in the order of their first index
+    size_t labels(std::vector<size_t> &result) {
+        const size_t NONE = parents.size();
+        std::vector<size_t> labelOfRoot(parents.size(), NONE);
+        result.resize(parents.size());
+        size_t nLabels(0);
+        for(size_t i = 0; i < parents.size(); ++i) {
+            const size_t root = find(i);
+            if(labelOfRoot[root] == NONE)
+                labelOfRoot[root] = nLabels++;
+            result[i] = labelOfRoot[root];
+        }
+        return nLabels;
+    }
+};
+
+} //lib_2d
+
+#endif // DISJOINTSETS_H_INCLUDED
@@ -0,0 +1,262 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    DistanceJoin.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class DistanceJoin, all pairs of points of two PointClouds (or of one) within a fixed radius
+ *          the indexed points are sorted into grid cells of the radius (SortedGrid), the queries are sorted into the same cells
+ *          and processed in that order in parallel chunks, so each chunk walks the grid like a sweep line
+ *          results are written as compressed rows (counted first, then filled without any allocation per query) or streamed to a sink
+ */
+
+#ifndef DISTANCEJOIN_H_INCLUDED
+#define DISTANCEJOIN_H_INCLUDED
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+#include "Point.h"
+#include "PointCloudView.h"
+#include "SortedGrid.h"
+#include "parallel.h"
+
+namespace lib_2d {
+
+template <typename T>
+class DistanceJoin {
+
+public:
+    using Pair = std::pair<size_t, size_t>;
+
+private:
+    using Grid = SortedGrid<T>;
+    using Range = typename Grid::Range;
+    using Order = typename Grid::Order;
+    using Cursor = typename Grid::Cursor;
+
+    enum : size_t {BATCH = 4096};
+
+    T
+        r,
+        sqrRadius;
+
+    Grid grid; //with cells of the radius, so pairs are at most one cell apart
+
+//------------------------------------------------------------------------------
+
+public:
+
+    ///indexes points for joins with radius
+    DistanceJoin(const PointCloudView<T> &points, T radius, size_t nThreads = 0) :
+        r(checked(radius)),
+        sqrRadius(radius * radius),
+        grid(points, radius, radius, nThreads) {}
+
+//------------------------------------------------------------------------------
+
+    size_t size() const {
+        return grid.ids.size();
+    }
+
+    T radius() const {
+        return r;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the indexed points within the radius of each query as compressed rows
+    ///the ids of the neighbours of query i are result[offsets[i]] to result[offsets[i+1] - 1], ascending
+    void join(const PointCloudView<T> &queries, std::vector<size_t> &offsets, std::vector<size_t> &result, size_t nThreads = 0) const {
+        Order order;
+        grid.sorted(queries, order, nThreads);
+        const size_t nChunks = n_chunks(order.size(), nThreads, 1 << 12);
+
+        offsets.assign(queries.size() + 1, 0);
+        for_each_query(queries, order, nChunks, [&](size_t q, T x, T y, const std::vector<Range> &ranges) {
+            offsets[q + 1] = count(x, y, ranges);
+        });
+        to_offsets(offsets, result);
+
+        for_each_query(queries, order, nChunks, [&](size_t q, T x, T y, const std::vector<Range> &ranges) {
+            fill(x, y, ranges, result.begin() + offsets[q], result.begin() + offsets[q + 1], size_t(-1));
+        });
+    }
+
+    ///for each indexed point the other indexed points within the radius, as compressed rows (each pair is contained twice)
+    void self_join(std::vector<size_t> &offsets, std::vector<size_t> &result, size_t nThreads = 0) const {
+        const size_t nChunks = n_chunks(grid.keys.size(), nThreads, 1 << 10);
+        const auto &ids = grid.ids;
+
+        offsets.assign(ids.size() + 1, 0);
+        for_each_indexed(nChunks, [&](size_t i, const std::vector<Range> &ranges) {
+            offsets[ids[i] + 1] = count(grid.xs[i], grid.ys[i], ranges) - 1;
+        });
+        to_offsets(offsets, result);
+
+        for_each_indexed(nChunks, [&](size_t i, const std::vector<Range> &ranges) {
+            fill(grid.xs[i], grid.ys[i], ranges, result.begin() + offsets[ids[i]], result.begin() + offsets[ids[i] + 1], ids[i]);
+        });
+    }
+
+//------------------------------------------------------------------------------
+
+    ///streams all pairs {query, indexed point} within the radius to sink(const Pair *first, const Pair *last)
+    ///the pairs are passed in batches in no particular order, calls of sink are serialized
+    template <typename Sink>
+    void for_each_pair(const PointCloudView<T> &queries, Sink sink, size_t nThreads = 0) const {
+        Order order;
+        grid.sorted(queries, order, nThreads);
+        const size_t nChunks = n_chunks(order.size(), nThreads, 1 << 12);
+        std::mutex mutex;
+
+        parallel_chunks(order.size(), nChunks, [&](size_t first, size_t last, size_t) {
+            std::vector<Pair> batch;
+            batch.reserve(BATCH);
+            Cursor cursor(grid);
+            for(size_t k = first; k < last; ++k) {
+                const size_t q = order[k].second;
+                const Point<T> &p = queries[q];
+                for(const auto &range : cursor.of(order[k].first)) {
+                    for(size_t j = grid.starts[range.first]; j < grid.starts[range.second]; ++j) {
+                        if(grid.sqr_distance(p.x, p.y, j) <= sqrRadius)
+                            emit(Pair(q, grid.ids[j]), batch, sink, mutex);
+                    }
+                }
+            }
+            flush(batch, sink, mutex);
+        });
+    }
+
+    ///streams each unordered pair of indexed points within the radius once, as {i, j} with i < j
+    template <typename Sink>
+    void for_each_self_pair(Sink sink, size_t nThreads = 0) const {
+        const size_t nChunks = n_chunks(grid.keys.size(), nThreads, 1 << 10);
+        const auto &ids = grid.ids;
+        std::mutex mutex;
+
+        parallel_chunks(grid.keys.size(), nChunks, [&](size_t first, size_t last, size_t) {
+            std::vector<Pair> batch;
+            batch.reserve(BATCH);
+            Cursor cursor(grid);
+            for(size_t cell = first; cell < last; ++cell) {
+                const std::vector<Range> &ranges = cursor.of(grid.keys[cell]);
+                for(size_t i = grid.starts[cell]; i < grid.starts[cell + 1]; ++i) {
+                    for(const auto &range : ranges) {
+                        for(size_t j = std::max(grid.starts[range.first], i + 1); j < grid.starts[range.second]; ++j) {
+                            if(grid.sqr_distance(grid.xs[i], grid.ys[i], j) <= sqrRadius)
+                                emit(Pair(std::min(ids[i], ids[j]), std::max(ids[i], ids[j])), batch, sink, mutex);
+                        }
+                    }
+                }
+            }
+            flush(batch, sink, mutex);
+        });
+    }
+
+//------------------------------------------------------------------------------
+
+private:
+
+    static T checked(T radius) {
+        if(!(radius > 0))
+            throw std::out_of_range ("DistanceJoin requires a positive radius");
+        return radius;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///calls f(query, x, y, ranges) in parallel chunks of the queries in the order of their cells
+    template <typename F>
+    void for_each_query(const PointCloudView<T> &queries, const Order &order, size_t nChunks, F f) const {
+        parallel_chunks(order.size(), nChunks, [&](size_t first, size_t last, size_t) {
+            Cursor cursor(grid);
+            for(size_t k = first; k < last; ++k) {
+                const Point<T> &p = queries[order[k].second];
+                f(order[k].second, p.x, p.y, cursor.of(order[k].first));
+            }
+        });
+    }
+
+    ///calls f(i, ranges) for all indexed points (by their sorted position) in parallel chunks of cells
+    template <typename F>
+    void for_each_indexed(size_t nChunks, F f) const {
+        parallel_chunks(grid.keys.size(), nChunks, [&](size_t first, size_t last, size_t) {
+            Cursor cursor(grid);
+            for(size_t cell = first; cell < last; ++cell) {
+                const std::vector<Range> &ranges = cursor.of(grid.keys[cell]);
+                for(size_t i = grid.starts[cell]; i < grid.starts[cell + 1]; ++i)
+                    f(i, ranges);
+            }
+        });
+    }
+
+    inline size_t count(T x, T y, const std::vector<Range> &ranges) const {
+        size_t result(0);
+        for(const auto &range : ranges) {
+            for(size_t j = grid.starts[range.first]; j < grid.starts[range.second]; ++j)
+                result += grid.sqr_distance(x, y, j) <= sqrRadius;
+        }
+        return result;
+    }
+
+    ///the ids within the radius, except skip, sorted
+    template <typename Iterator>
+    void fill(T x, T y, const std::vector<Range> &ranges, Iterator first, Iterator last, size_t skip) const {
+        Iterator out = first;
+        for(const auto &range : ranges) {
+            for(size_t j = grid.starts[range.first]; j < grid.starts[range.second]; ++j) {
+                if(grid.ids[j] != skip && grid.sqr_distance(x, y, j) <= sqrRadius)
+                    *out++ = grid.ids[j];
+            }
+        }
+        std::sort(first, last);
+    }
+
+    ///the counts at offsets[i + 1] become the start of each row
+    static void to_offsets(std::vector<size_t> &offsets, std::vector<size_t> &result) {
+        for(size_t i = 1; i < offsets.size(); ++i)
+            offsets[i] += offsets[i - 1];
+        result.resize(offsets.back());
+    }
+
+//------------------------------------------------------------------------------
+
+    template <typename Sink>
+    static inline void emit(const Pair &pair, std::vector<Pair> &batch, Sink &sink, std::mutex &mutex) {
+        batch.push_back(pair);
+        if(batch.size() >= BATCH)
+            flush(batch, sink, mutex);
+    }
+
+    template <typename Sink>
+    static void flush(std::vector<Pair> &batch, Sink &sink, std::mutex &mutex) {
+        if(batch.empty())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            sink(batch.data(), batch.data() + batch.size());
+        }
+        batch.clear();
+    }
+};
+
+} //lib_2d
+
+#endif // DISTANCEJOIN_H_INCLUDED
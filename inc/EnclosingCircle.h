@@ -0,0 +1,200 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    EnclosingCircle.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class EnclosingCircle, the smallest circle containing all points of a PointCloud
+ *          computed with the randomized incremental algorithm of Welzl in expected O(n)
+ *          extend() grows the circle point by point, for data which doesn't fit into memory (within 1.5 of the optimum)
+ */
+
+#ifndef ENCLOSINGCIRCLE_H_INCLUDED
+#define ENCLOSINGCIRCLE_H_INCLUDED
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "constants.h"
+#include "Point.h"
+#include "PointCloudView.h"
+#include "PointCloud.h"
+#include "Arc.h"
+
+namespace lib_2d {
+
+template <typename T>
+class EnclosingCircle {
+
+private:
+    Point<T> m_center;
+    T radius; //negative for an empty circle
+
+public:
+
+//------------------------------------------------------------------------------
+
+    ///an empty circle, which can be grown with extend()
+    EnclosingCircle() :
+        m_center(Point<T>{}),
+        radius(-1) {}
+
+    ///the smallest circle containing all points
+    ///if filterByHull is set, only the points of the convex hull are considered (O(n log n), but fewer points for the randomized part)
+    explicit EnclosingCircle(const PointCloudView<T> &points, bool filterByHull = false, unsigned int seed = 5489u) :
+        EnclosingCircle() {
+
+        if(points.empty())
+            return;
+
+        std::vector<Point<T>> ps;
+        if(filterByHull) {
+            PointCloud<T> hull = PointCloud<T>(points.begin(), points.end()).convex_hull(false);
+            ps.assign(hull.begin(), hull.end());
+        }
+        else
+            ps.assign(points.begin(), points.end());
+
+        std::mt19937 gen(seed);
+        std::shuffle(ps.begin(), ps.end(), gen);
+        welzl(ps);
+    }
+
+//------------------------------------------------------------------------------
+
+    bool empty() const {
+        return radius < 0;
+    }
+
+    Point<T> center() const {
+        return m_center;
+    }
+
+    T get_radius() const {
+        return empty() ? 0 : radius;
+    }
+
+    T get_diameter() const {
+        return 2 * get_radius();
+    }
+
+    ///whether p lies within the circle, with a tolerance relative to the radius
+    bool contains(const Point<T> &p) const {
+        return !empty() && !outside(p);
+    }
+
+//------------------------------------------------------------------------------
+
+    ///grows the circle just enough to contain p, keeping the old circle within the new one
+    ///streaming all points through extend() results in a circle at most 1.5 times larger than the smallest one
+    EnclosingCircle& extend(const Point<T> &p) {
+        if(empty()) {
+            m_center = p;
+            radius = 0;
+        }
+        else if(outside(p)) {
+            T distance = m_center.distance_to(p);
+            T newRadius = (radius + distance) / 2;
+            T shift = (newRadius - radius) / distance;
+            m_center = Point<T>{m_center.x + (p.x - m_center.x) * shift, m_center.y + (p.y - m_center.y) * shift};
+            radius = std::max(newRadius, m_center.distance_to(p));
+        }
+        return *this;
+    }
+
+    EnclosingCircle& extend(const PointCloudView<T> &points) {
+        for(const auto &p : points)
+            extend(p);
+        return *this;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the circle as Arc (full circle) with nPoints
+    Arc<T> to_arc(unsigned int nPoints, bool closePath = true) const {
+        return Arc<T>(get_diameter(), nPoints, closePath, 0, LIB_2D_2PI, m_center);
+    }
+
+//------------------------------------------------------------------------------
+
+private:
+
+    inline bool outside(const Point<T> &p) const {
+        const T tolerance = radius * 64 * std::numeric_limits<T>::epsilon();
+        return m_center.distance_to(p) > radius + tolerance;
+    }
+
+    void set(const Point<T> &a, const Point<T> &b) {
+        m_center = Point<T>{(a.x + b.x) / 2, (a.y + b.y) / 2};
+        radius = std::max(m_center.distance_to(a), m_center.distance_to(b));
+    }
+
+    ///circumcircle of the three points, the circle through the two furthest apart for (almost) collinear points
+    void set(const Point<T> &a, const Point<T> &b, const Point<T> &c) {
+        const T
+            bx = b.x - a.x,
+            by = b.y - a.y,
+            cx = c.x - a.x,
+            cy = c.y - a.y,
+            d = 2 * (bx * cy - by * cx);
+
+        const T
+            b2 = bx * bx + by * by,
+            c2 = cx * cx + cy * cy;
+
+        if(std::fabs(d) <= std::numeric_limits<T>::epsilon() * (b2 + c2)) {
+            const T bc = b.sqr_distance_to(c);
+            if(b2 >= c2 && b2 >= bc)
+                set(a, b);
+            else if(c2 >= bc)
+                set(a, c);
+            else
+                set(b, c);
+            return;
+        }
+
+        m_center = Point<T>{a.x + (cy * b2 - by * c2) / d, a.y + (bx * c2 - cx * b2) / d};
+        radius = std::max(std::max(m_center.distance_to(a), m_center.distance_to(b)), m_center.distance_to(c));
+    }
+
+    ///iterative version of Welzl, the points have to be shuffled for the expected O(n)
+    void welzl(const std::vector<Point<T>> &ps) {
+        m_center = ps[0];
+        radius = 0;
+        for(size_t i = 1; i < ps.size(); ++i) {
+            if(!outside(ps[i]))
+                continue;
+            m_center = ps[i];
+            radius = 0;
+            for(size_t j = 0; j < i; ++j) {
+                if(!outside(ps[j]))
+                    continue;
+                set(ps[i], ps[j]);
+                for(size_t k = 0; k < j; ++k) {
+                    if(outside(ps[k]))
+                        set(ps[i], ps[j], ps[k]);
+                }
+            }
+        }
+    }
+};
+
+} //lib_2d
+
+#endif // ENCLOSINGCIRCLE_H_INCLUDED
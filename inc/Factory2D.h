@@ -24,15 +24,24 @@
 #define FACTORY2D_H_INCLUDED
 
 #include <set>
+#include <numeric>
 #include <algorithm>
 #include <utility>
 #include <iostream>
 #include <memory>
+#include <vector>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
 
+#include "constants.h"
 #include "calc.h"
 #include "Point.h"
 #include "PointCloud.h"
 #include "KdTree.h"
+#include "PreparedPolygon.h"
+#include "parallel.h"
 
 namespace lib_2d {
 
@@ -43,57 +52,573 @@ public:
 
 //------------------------------------------------------------------------------
 
-    //gift wrapping combined with knearest
-    ///@todo consider benchmarking against gift-opening algorithm
+    ///k-nearest neighbours approach (gift wrapping restricted to the nNearest closest points), traversing counter clockwise from the leftmost point
+    ///nNearest is increased until a hull without self intersections which contains all points is found
+    ///of equal points only the first one is used, collinear input or running out of attempts results in the convex hull
+    ///a walk reaching maxIter steps ends the search, its shortened (open) path is returned without further attempts
     static std::unique_ptr<OrderedPointCloud<T>> concave_hull(std::shared_ptr<PointCloud<T>> pc, size_t nNearest, int maxIter = -1, bool closePath = true) {
-        auto path = std::make_shared<OrderedPointCloud<T>>(pc);
         auto hull = std::unique_ptr<OrderedPointCloud<T>>(new OrderedPointCloud<T>());
-        hull->set_parent(path->get_parent());
-        if(path->n_elements() < 3) return hull;
-        if(nNearest > path->n_elements()) return hull;
+        hull->set_parent(pc);
+        if(pc->size() < 3) return hull;
+        if(nNearest > pc->size()) return hull;
 
-        path->sort_x();
+        const PointCloud<T> &points = *pc;
 
+        //lexicographic order, equal points are skipped, so the walks can't get stuck between them
+        std::vector<size_t> order(points.size());
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::sort(order.begin(), order.end(), [&points](size_t lhs, size_t rhs) {
+            if(points[lhs].x != points[rhs].x)
+                return points[lhs].x < points[rhs].x;
+            if(points[lhs].y != points[rhs].y)
+                return points[lhs].y < points[rhs].y;
+            return lhs < rhs;
+        });
+        auto path = std::make_shared<OrderedPointCloud<T>>();
+        path->set_parent(pc);
+        path->reserve(points.size());
+        bool collinear(true);
+        size_t second(0);
+        for(size_t i = 0; i < order.size(); ++i) {
+            const size_t id = order[i];
+            if(i > 0 && points[id] == points[order[i-1]])
+                continue;
+            if(path->n_elements() == 1)
+                second = id;
+            else if(collinear && path->n_elements() > 1)
+                collinear = cross(vect(points[order[0]], points[second]), vect(points[order[0]], points[id])) == 0;
+            path->push_back_id(id);
+        }
+        if(collinear)
+            return convex_hull(pc, closePath);
+
+        const size_t
+            nUnique = path->n_elements(),
+            start = path->first_id(); //smallest by x, then y
         const KdTree<T> tree(path);
 
-        const size_t start = path->get_id(0);
-        size_t prev = start;
-        hull->push_back_id(path->get_id(1));
-        for(int i = 2; maxIter == -1 || i < maxIter ; ++i) {
-            auto pPrev = path->get_point(prev);
-            size_t next;
+        //buffers shared by all attempts, so the hull walks don't allocate
+        std::vector<bool> used(points.size(), false);
+        std::vector<std::pair<T, size_t> > candidates;
+        std::vector<std::pair<T, size_t> > byAngle;
+        std::vector<size_t> ids;
+        HullEdges edges(points, std::max(nNearest, size_t(3)));
+
+        //k grows by one at first, then by a quarter, so hopeless inputs end after a few attempts
+        bool found(false);
+        size_t k = std::max(nNearest, size_t(3));
+        for(size_t attempt = 0; attempt < MAX_HULL_ATTEMPTS && k < nUnique; ++attempt, k += std::max(size_t(1), k / 4)) {
+            const Walk walk = k_nearest_hull(points, tree, edges, start, k, maxIter, nUnique, used, candidates, byAngle, ids);
+            if(walk == WALK_LIMITED || (walk == WALK_CLOSED && contains_all(points, ids))) {
+                found = true;
+                break;
+            }
+        }
+        if(!found)
+            return convex_hull(pc, closePath);
+
+        const bool closed = ids.size() > 1 && ids.back() == start;
+        for(size_t i = 0; i < ids.size(); ++i) {
+            if(closed && !closePath && i + 1 == ids.size())
+                break;
+            hull->push_back_id(ids[i]);
+        }
+        return hull;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the convex hull as ids into pc, counter clockwise starting at the smallest point (by x, then y)
+    ///points within the polygon of the up to eight extreme points are discarded first (Akl-Toussaint)
+    ///the remaining points of each chunk are reduced to their own hull in parallel, a final monotone chain merges these hulls
+    static std::unique_ptr<OrderedPointCloud<T>> convex_hull(std::shared_ptr<PointCloud<T>> pc, bool closePath = true, size_t nThreads = 0) {
+        auto hull = std::unique_ptr<OrderedPointCloud<T>>(new OrderedPointCloud<T>());
+        hull->set_parent(pc);
+        const PointCloud<T> &points = *pc;
+        const size_t n = points.size();
+        if(n == 0) return hull;
+
+        const size_t nChunks = n_chunks(n, nThreads);
+
+        //extreme points in counter clockwise order: min y, max x-y, max x, max x+y, max y, min x-y, min x, min x+y
+        std::vector< std::array<size_t, 8> > chunkExtremes(nChunks);
+        parallel_chunks(n, nChunks, [&](size_t first, size_t last, size_t chunk) {
+            std::array<size_t, 8> e;
+            e.fill(first);
+            const Point<T> &p0 = points[first];
+            std::array<T, 8> best = {{-p0.y, p0.x - p0.y, p0.x, p0.x + p0.y, p0.y, p0.y - p0.x, -p0.x, -p0.x - p0.y}};
+            for(size_t i = first + 1; i < last; ++i) {
+                const Point<T> &p = points[i];
+                const std::array<T, 8> values = {{-p.y, p.x - p.y, p.x, p.x + p.y, p.y, p.y - p.x, -p.x, -p.x - p.y}};
+                for(size_t j = 0; j < 8; ++j) { //selects instead of branches, to allow vectorization
+                    const bool better = values[j] > best[j];
+                    best[j] = better ? values[j] : best[j];
+                    e[j] = better ? i : e[j];
+                }
+            }
+            chunkExtremes[chunk] = e;
+        });
+        std::array<size_t, 8> extremes = chunkExtremes[0];
+        for(size_t c = 1; c < nChunks; ++c) {
+            for(auto i : chunkExtremes[c])
+                update_extremes(points, extremes, i);
+        }
+
+        std::vector<Point<T> > polygon;
+        for(auto i : extremes) {
+            if(polygon.empty() || (!(polygon.back() == points[i]) && !(polygon.front() == points[i])))
+                polygon.push_back(points[i]);
+        }
+
+        //the edges of the polygon as a x + b y + c > 0 for points strictly inside, padded with always true edges
+        std::array<T, 8> ea, eb, ec;
+        ea.fill(0); eb.fill(0); ec.fill(1);
+        const bool filter = polygon.size() >= 3;
+        for(size_t j = 0; filter && j < polygon.size(); ++j) {
+            const Point<T> &a = polygon[j];
+            const Point<T> &b = polygon[(j + 1) % polygon.size()];
+            ea[j] = -(b.y - a.y);
+            eb[j] = b.x - a.x;
+            ec[j] = (b.y - a.y) * a.x - (b.x - a.x) * a.y;
+        }
+
+        //filtering and hulls per chunk, the inside test is branch free over a fixed number of edges, so it can be vectorized
+        std::vector< std::vector<size_t> > chunkHulls(nChunks);
+        parallel_chunks(n, nChunks, [&](size_t first, size_t last, size_t chunk) {
+            std::vector<size_t> candidates;
+            for(size_t i = first; i < last; ++i) {
+                const Point<T> &p = points[i];
+                bool inside = filter;
+                for(size_t j = 0; j < 8; ++j)
+                    inside &= ea[j] * p.x + eb[j] * p.y + ec[j] > 0;
+                if(!inside)
+                    candidates.push_back(i);
+            }
+            monotone_chain(points, candidates, chunkHulls[chunk]);
+        });
+
+        std::vector<size_t> merged;
+        for(const auto &chunkHull : chunkHulls)
+            merged.insert(merged.end(), chunkHull.begin(), chunkHull.end());
 
-            auto candidates = tree.k_nearest(pPrev, nNearest);
+        std::vector<size_t> ids;
+        monotone_chain(points, merged, ids);
 
-            std::sort(candidates.begin(), candidates.end(), [&](Element ip1, Element ip2){
-                auto p1 = path->get_point(ip1[0]);
-                auto p2 = path->get_point(ip2[0]);
+        for(auto id : ids)
+            hull->push_back_id(id);
+        if(closePath && !ids.empty())
+            hull->push_back_id(ids[0]);
+        return hull;
+    }
+
+//------------------------------------------------------------------------------
 
-                bool p1Elem = any_of(hull->begin(), hull->end(), [&p1, &path](Element h){return path->get_point(h[0]) == p1;});
-                bool p2Elem = any_of(hull->begin(), hull->end(), [&p2, &path](Element h){return path->get_point(h[0]) == p2;});
+    ///ids (smaller first) of the two points of pc closest to each other, divide and conquer in O(n log n)
+    ///the cloud is split into slabs along x which are solved on their own threads, pairs across slabs are found within strips around their borders
+    static std::array<size_t, 2> closest_pair(const PointCloudView<T> &pc, size_t nThreads = 0) {
+        const size_t n = pc.size();
+        if(n < 2)
+            throw std::out_of_range ("closest_pair requires at least two points");
 
-                if      (p1Elem && !p2Elem) return false;
-                else if (!p1Elem && p2Elem) return true;
-                else if (p1Elem && p2Elem) return false;
+        std::vector<IdPoint> byX(n);
+        for(size_t i = 0; i < n; ++i)
+            byX[i] = IdPoint{pc[i], i};
+        std::sort(byX.begin(), byX.end(), [](const IdPoint &lhs, const IdPoint &rhs) {
+            return lhs.p.x < rhs.p.x;
+        });
 
-                auto trn = turn(pPrev, p1, p2);
-                if      (trn < 0) return false;
-                else if (trn > 0) return true;
+        const size_t nChunks = n_chunks(n, nThreads);
+        std::vector<IdPoint>
+            items(byX),
+            buffer(n);
+        std::vector<Pair> bests(nChunks, Pair{});
+        parallel_chunks(n, nChunks, [&](size_t first, size_t last, size_t chunk) {
+            closest_pair_slab(&items[first], last - first, &buffer[first], bests[chunk]);
+        });
 
-                if(pPrev.sqr_distance_to(p1) < pPrev.sqr_distance_to(p2)) return false;
+        Pair best;
+        for(const auto &b : bests)
+            update(best, b);
 
-                return true;
+        //pairs across the borders of the slabs, the strips are taken from the points sorted by x
+        std::vector<Pair> borderBests(nChunks, best);
+        parallel_for(nChunks - 1, nChunks - 1, [&](size_t border) {
+            const T borderX = byX[(border + 1) * n / nChunks].p.x;
+            const T distance = std::sqrt(best.sqrDistance);
+            auto first = std::lower_bound(byX.begin(), byX.end(), borderX - distance, [](const IdPoint &lhs, T x) {
+                return lhs.p.x < x;
             });
+            auto last = std::upper_bound(byX.begin(), byX.end(), borderX + distance, [](T x, const IdPoint &rhs) {
+                return x < rhs.p.x;
+            });
+            std::vector<IdPoint> strip(first, last);
+            std::sort(strip.begin(), strip.end(), LessY());
+            check_strip(strip.data(), strip.size(), borderBests[border]);
+        });
+        for(const auto &b : borderBests)
+            update(best, b);
+
+        return std::array<size_t, 2>{{best.a, best.b}};
+    }
 
-            if(candidates.n_elements() < 1) continue;
-            next = candidates[0][0];
+    ///the id within queries and the id within the parent of tree of the closest pair between both, one nearest neighbour search per point of queries
+    static std::array<size_t, 2> closest_pair(const PointCloudView<T> &queries, const KdTree<T> &tree, size_t nThreads = 0) {
+        if(queries.empty() || tree.size() == 0)
+            throw std::out_of_range ("closest_pair between two clouds requires both of them to be non-empty");
 
-            hull->push_back_id(next);
-            prev = next;
-            if(next == start) break;
+        const PointCloud<T> &points = *(tree.get_parent()->get_parent());
+        const size_t nChunks = n_chunks(queries.size(), nThreads, 1 << 10);
+        std::vector<Pair> bests(nChunks, Pair{});
+        parallel_chunks(queries.size(), nChunks, [&](size_t first, size_t last, size_t chunk) {
+            Pair &best = bests[chunk];
+            for(size_t i = first; i < last; ++i) {
+                size_t id = tree.nearest(queries[i]);
+                T sqrDistance = queries[i].sqr_distance_to(points[id]);
+                if(sqrDistance < best.sqrDistance)
+                    best = Pair{sqrDistance, i, id};
+            }
+        });
+
+        Pair best;
+        for(const auto &b : bests) {
+            if(b.sqrDistance < best.sqrDistance)
+                best = b;
         }
-        if(closePath) hull->push_back_id(start);
-        return hull;
+        return std::array<size_t, 2>{{best.a, best.b}};
+    }
+
+    ///the id within a and the id within b of the closest pair between both clouds, the KdTree is built over the smaller one
+    static std::array<size_t, 2> closest_pair(std::shared_ptr<PointCloud<T>> a, std::shared_ptr<PointCloud<T>> b, size_t nThreads = 0) {
+        const bool swapped = a->size() < b->size();
+        const KdTree<T> tree(std::make_shared<OrderedPointCloud<T>>(swapped ? a : b));
+        auto ids = closest_pair(swapped ? *b : *a, tree, nThreads);
+        if(swapped)
+            std::swap(ids[0], ids[1]);
+        return ids;
+    }
+
+//------------------------------------------------------------------------------
+
+private:
+
+    struct IdPoint {
+        Point<T> p;
+        size_t id;
+    };
+
+    struct Pair {
+        T sqrDistance = std::numeric_limits<T>::max();
+        size_t a = 0, b = 0;
+
+        Pair() {}
+        Pair(T sqrDistance, size_t a, size_t b) :
+            sqrDistance(sqrDistance), a(a), b(b) {}
+    };
+
+    struct LessY {
+        inline bool operator()(const IdPoint &lhs, const IdPoint &rhs) const {
+            return lhs.p.y < rhs.p.y;
+        }
+    };
+
+    static inline void update(Pair &best, const Pair &other) {
+        if(other.sqrDistance < best.sqrDistance)
+            best = other;
+    }
+
+    static inline void update(Pair &best, const IdPoint &lhs, const IdPoint &rhs) {
+        T sqrDistance = lhs.p.sqr_distance_to(rhs.p);
+        if(sqrDistance < best.sqrDistance)
+            best = Pair(sqrDistance, std::min(lhs.id, rhs.id), std::max(lhs.id, rhs.id));
+    }
+
+    ///the points of a strip sorted by y, only the following ones closer in y than the best distance have to be checked
+    static void check_strip(const IdPoint *strip, size_t n, Pair &best) {
+        for(size_t i = 0; i < n; ++i) {
+            for(size_t j = i + 1; j < n; ++j) {
+                const T dy = strip[j].p.y - strip[i].p.y;
+                if(dy * dy >= best.sqrDistance)
+                    break;
+                update(best, strip[i], strip[j]);
+            }
+        }
+    }
+
+    ///expects items sorted by x, leaves them sorted by y
+    static void closest_pair_slab(IdPoint *items, size_t n, IdPoint *buffer, Pair &best) {
+        if(n <= 8) {
+            for(size_t i = 0; i < n; ++i) {
+                for(size_t j = i + 1; j < n; ++j)
+                    update(best, items[i], items[j]);
+            }
+            std::sort(items, items + n, LessY());
+            return;
+        }
+
+        const size_t mid = n / 2;
+        const T midX = items[mid].p.x;
+        closest_pair_slab(items, mid, buffer, best);
+        closest_pair_slab(items + mid, n - mid, buffer, best);
+
+        std::merge(items, items + mid, items + mid, items + n, buffer, LessY());
+        std::copy(buffer, buffer + n, items);
+
+        size_t nStrip = 0;
+        for(size_t i = 0; i < n; ++i) {
+            const T dx = items[i].p.x - midX;
+            if(dx * dx < best.sqrDistance)
+                buffer[nStrip++] = items[i];
+        }
+        check_strip(buffer, nStrip, best);
+    }
+
+//------------------------------------------------------------------------------
+
+    static bool contains_all(const PointCloud<T> &points, const std::vector<size_t> &ids) {
+        std::vector<Point<T>> polygon;
+        polygon.reserve(ids.size());
+        for(auto id : ids)
+            polygon.push_back(points[id]);
+
+        const PreparedPolygon<T> prepared(polygon);
+        for(size_t i = 0; i < points.size(); ++i) {
+            if(!prepared.contains(points[i]))
+                return false;
+        }
+        return true;
+    }
+
+    static inline void update_extremes(const PointCloud<T> &points, std::array<size_t, 8> &e, size_t i) {
+        const Point<T> &p = points[i];
+        if(p.y < points[e[0]].y)                         e[0] = i;
+        if(p.x - p.y > points[e[1]].x - points[e[1]].y)  e[1] = i;
+        if(p.x > points[e[2]].x)                         e[2] = i;
+        if(p.x + p.y > points[e[3]].x + points[e[3]].y)  e[3] = i;
+        if(p.y > points[e[4]].y)                         e[4] = i;
+        if(p.x - p.y < points[e[5]].x - points[e[5]].y)  e[5] = i;
+        if(p.x < points[e[6]].x)                         e[6] = i;
+        if(p.x + p.y < points[e[7]].x + points[e[7]].y)  e[7] = i;
+    }
+
+    ///Andrew's monotone chain over ids, 'ids' gets sorted, 'hull' is counter clockwise without repeating the first id
+    static void monotone_chain(const PointCloud<T> &points, std::vector<size_t> &ids, std::vector<size_t> &hull) {
+        std::sort(ids.begin(), ids.end(), [&points](size_t lhs, size_t rhs) {
+            return points[lhs] < points[rhs] || (points[lhs] == points[rhs] && lhs < rhs);
+        });
+
+        hull.clear();
+        const size_t n = ids.size();
+        if(n < 3) {
+            for(auto id : ids) {
+                if(hull.empty() || !(points[hull.back()] == points[id]))
+                    hull.push_back(id);
+            }
+            return;
+        }
+
+        auto ccw = [&points](size_t a, size_t b, size_t c) {
+            return cross(vect(points[a], points[b]), vect(points[a], points[c]));
+        };
+
+        hull.resize(2 * n);
+        size_t k(0);
+        for(size_t i = 0; i < n; ++i) { //lower chain
+            while(k >= 2 && ccw(hull[k-2], hull[k-1], ids[i]) <= 0)
+                --k;
+            hull[k++] = ids[i];
+        }
+        for(size_t i = n - 1, lower = k + 1; i > 0; --i) { //upper chain
+            while(k >= lower && ccw(hull[k-2], hull[k-1], ids[i-1]) <= 0)
+                --k;
+            hull[k++] = ids[i-1];
+        }
+        hull.resize(k > 1 ? k - 1 : k); //the last id equals the first one
+    }
+
+//------------------------------------------------------------------------------
+
+    ///incremental index of the hull edges within a uniform grid, to find self intersections without checking all edges
+    class HullEdges {
+        const PointCloud<T> *points;
+        T minX, minY, cellSize;
+        size_t nX, nY;
+        std::vector< std::vector<size_t> > cells; //edge ids per cell
+        std::vector<size_t> touched;              //cells which aren't empty, to reset quickly
+        std::vector<std::pair<size_t, size_t> > segments;
+        std::vector<size_t> checked;              //per edge, the query it was last checked by
+        size_t query;
+
+    public:
+        HullEdges(const PointCloud<T> &points, size_t k) :
+            points(&points),
+            minX(points.get_min_x()),
+            minY(points.get_min_y()),
+            cellSize(1),
+            nX(1),
+            nY(1),
+            query(0) {
+
+            const T
+                width = points.get_max_x() - minX,
+                height = points.get_max_y() - minY,
+                area = width * height;
+
+            //hull edges are about as long as the distance to the kth nearest neighbour
+            if(area > 0)
+                cellSize = std::sqrt(area * k / points.size());
+            else if(std::max(width, height) > 0)
+                cellSize = std::max(width, height) * k / points.size();
+
+            nX = static_cast<size_t>(width / cellSize) + 1;
+            nY = static_cast<size_t>(height / cellSize) + 1;
+            cells.resize(nX * nY);
+        }
+
+        void clear() {
+            for(auto c : touched)
+                cells[c].clear();
+            touched.clear();
+            segments.clear();
+            checked.clear();
+        }
+
+        size_t size() const {
+            return segments.size();
+        }
+
+        void add(size_t from, size_t to) {
+            const size_t id = segments.size();
+            segments.push_back(std::make_pair(from, to));
+            checked.push_back(0);
+            for_each_cell(from, to, [&](size_t c) {
+                if(cells[c].empty())
+                    touched.push_back(c);
+                cells[c].push_back(id);
+            });
+        }
+
+        ///whether the edge [from, to] intersects any of the edges, except the ones with the ids ignore1 and ignore2
+        bool intersects(size_t from, size_t to, size_t ignore1, size_t ignore2) {
+            ++query;
+            const auto &p1 = (*points)[from];
+            const auto &p2 = (*points)[to];
+            bool found(false);
+            for_each_cell(from, to, [&](size_t c) {
+                for(auto id : cells[c]) {
+                    if(found || id == ignore1 || id == ignore2 || checked[id] == query)
+                        continue;
+                    checked[id] = query;
+                    if(segments_intersect(p1, p2, (*points)[segments[id].first], (*points)[segments[id].second]))
+                        found = true;
+                }
+            });
+            return found;
+        }
+
+    private:
+        template <typename F>
+        void for_each_cell(size_t from, size_t to, F f) const {
+            const auto &p1 = (*points)[from];
+            const auto &p2 = (*points)[to];
+            const size_t
+                x0 = index(std::min(p1.x, p2.x) - minX, nX),
+                x1 = index(std::max(p1.x, p2.x) - minX, nX),
+                y0 = index(std::min(p1.y, p2.y) - minY, nY),
+                y1 = index(std::max(p1.y, p2.y) - minY, nY);
+            for(size_t y = y0; y <= y1; ++y)
+                for(size_t x = x0; x <= x1; ++x)
+                    f(y * nX + x);
+        }
+
+        size_t index(T offset, size_t n) const {
+            if(!(offset > 0))
+                return 0;
+            return std::min(static_cast<size_t>(offset / cellSize), n - 1);
+        }
+    };
+
+//------------------------------------------------------------------------------
+
+    enum Walk {WALK_CLOSED, WALK_STUCK, WALK_LIMITED};
+
+    static const size_t MAX_HULL_ATTEMPTS = 16; //of concave_hull, k reaches about 20 times nNearest
+
+    ///a single hull walk for a fixed k, WALK_STUCK if every candidate caused self intersections, WALK_LIMITED after maxIter steps
+    static Walk k_nearest_hull(
+        const PointCloud<T> &points,
+        const KdTree<T> &tree,
+        HullEdges &edges,
+        size_t start,
+        size_t k,
+        int maxIter,
+        size_t nPoints,
+        std::vector<bool> &used,
+        std::vector<std::pair<T, size_t> > &candidates,
+        std::vector<std::pair<T, size_t> > &byAngle,
+        std::vector<size_t> &ids) {
+
+        std::fill(used.begin(), used.end(), false);
+        edges.clear();
+        ids.clear();
+
+        ids.push_back(start);
+        used[start] = true;
+        size_t
+            current = start,
+            nRemaining = nPoints - 1;
+        Point<T> back{0, 1}; //traversing counter clockwise from the leftmost point starts downwards
+
+        auto unused = [&used](size_t id) { return !used[id]; };
+
+        for(size_t step = 2; current != start || step == 2; ++step) {
+            if(maxIter != -1 && step >= static_cast<size_t>(maxIter))
+                return WALK_LIMITED;
+            if(step == 5) { //allow closing the hull
+                used[start] = false;
+                ++nRemaining;
+            }
+            if(nRemaining == 0)
+                return WALK_STUCK;
+
+            const auto &pCurrent = points[current];
+            tree.k_nearest(pCurrent, k, candidates, unused);
+
+            //prefer the largest right hand turn, measured clockwise from the direction back to the previous point
+            byAngle.clear();
+            for(const auto &c : candidates) {
+                const Point<T> v = vect(pCurrent, points[c.second]);
+                T angle = -std::atan2(cross(back, v), dot(back, v));
+                if(angle < 0)
+                    angle += LIB_2D_2PI;
+                byAngle.push_back(std::make_pair(angle, c.second));
+            }
+            std::sort(byAngle.begin(), byAngle.end(), [](const std::pair<T, size_t> &lhs, const std::pair<T, size_t> &rhs) {
+                return lhs.first > rhs.first;
+            });
+
+            const size_t
+                lastEdge = edges.size() > 0 ? edges.size() - 1 : static_cast<size_t>(-1),
+                firstEdge = 0;
+
+            size_t next = static_cast<size_t>(-1);
+            for(const auto &c : byAngle) {
+                const size_t ignore = c.second == start ? firstEdge : static_cast<size_t>(-1);
+                if(!edges.intersects(current, c.second, lastEdge, ignore)) {
+                    next = c.second;
+                    break;
+                }
+            }
+            if(next == static_cast<size_t>(-1))
+                return WALK_STUCK;
+
+            edges.add(current, next);
+            ids.push_back(next);
+            used[next] = true;
+            --nRemaining;
+            back = vect(points[next], pCurrent);
+            current = next;
+        }
+        return WALK_CLOSED;
     }
 };
 
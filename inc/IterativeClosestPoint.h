@@ -0,0 +1,367 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    IterativeClosestPoint.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class IterativeClosestPoint, rigid or similarity registration of PointClouds onto a fixed target
+ *          the KdTree and the normals of the target are built once and reused by every alignment
+ *          correspondences are searched in parallel, starting at the match of the previous iteration
+ *          each step is solved in closed form (point to point) or with a small linear system (point to line)
+ */
+
+#ifndef ITERATIVECLOSESTPOINT_H_INCLUDED
+#define ITERATIVECLOSESTPOINT_H_INCLUDED
+
+#include <vector>
+#include <array>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <limits>
+#include <chrono>
+#include <cmath>
+
+#include "Point.h"
+#include "PointCloud.h"
+#include "PointCloudView.h"
+#include "OrderedPointCloud.h"
+#include "KdTree.h"
+#include "parallel.h"
+
+namespace lib_2d {
+
+template <typename T>
+class IterativeClosestPoint {
+
+public:
+    enum Metric {POINT_TO_POINT, POINT_TO_LINE};
+
+    ///p -> factor * R(angle) * p + translation
+    ///applied to a PointCloud via rotate(angle), scale(factor) and move_by(translation)
+    struct Transform {
+        T angle;
+        T factor;
+        Point<T> translation;
+
+        Transform(T angle = 0, T factor = 1, Point<T> translation = Point<T>{0, 0}) :
+            angle(angle),
+            factor(factor),
+            translation(translation) {}
+
+        inline Point<T> apply(const Point<T> &p) const {
+            const T c = factor * std::cos(angle), s = factor * std::sin(angle);
+            return Point<T>{c * p.x - s * p.y + translation.x, s * p.x + c * p.y + translation.y};
+        }
+
+        PointCloud<T>& apply(PointCloud<T> &pc) const {
+            return pc.rotate(angle).scale(factor).move_by(translation);
+        }
+
+        ///first this, then other
+        Transform then(const Transform &other) const {
+            const Point<T> moved = Transform(other.angle, other.factor).apply(translation);
+            return Transform(angle + other.angle, factor * other.factor,
+                             Point<T>{moved.x + other.translation.x, moved.y + other.translation.y});
+        }
+
+        Transform inverse() const {
+            const Transform reverse(-angle, 1 / factor);
+            const Point<T> moved = reverse.apply(translation);
+            return Transform(-angle, 1 / factor, Point<T>{-moved.x, -moved.y});
+        }
+    };
+
+    struct Settings {
+        Metric metric = POINT_TO_POINT;
+        bool similarity = false; //whether the scale is estimated aswell
+        size_t maxIterations = 50;
+        T tolerance = T(1e-6); //converged once angle, scale change and translation (relative to the spread of the points) of a step are below
+        T maxDistance = std::numeric_limits<T>::max(); //correspondences further apart are rejected
+        T trimRatio = 1; //only this fraction of the closest correspondences is used
+        size_t nThreads = 0;
+    };
+
+    ///one entry of the convergence log
+    struct Iteration {
+        size_t nCorrespondences;
+        T rmsError; //of the correspondences before the step
+        Transform step;
+        double seconds;
+    };
+
+    struct Result {
+        Transform transform;
+        bool converged = false;
+        T rmsError = 0;
+        std::vector<Iteration> log;
+    };
+
+private:
+    using Correspondence = std::pair<T, size_t>; //{squared residual, index of the source point}
+
+    std::shared_ptr<PointCloud<T>> target;
+    KdTree<T> tree;
+    std::vector<Point<T>> normals;
+
+//------------------------------------------------------------------------------
+
+public:
+
+    ///the normal of each target point is the direction of least variance of its nNeighbours nearest neighbours
+    explicit IterativeClosestPoint(std::shared_ptr<PointCloud<T>> target, size_t nNeighbours = 5, size_t nThreads = 0) :
+        target(target),
+        tree(std::make_shared<OrderedPointCloud<T>>(target)),
+        normals(target->size(), Point<T>{0, 0}) {
+
+        const size_t n = target->size();
+        parallel_chunks(n, n_chunks(n, nThreads, 1 << 12), [&](size_t first, size_t last, size_t) {
+            std::vector<std::pair<T, size_t>> neighbours;
+            neighbours.reserve(nNeighbours + 1);
+            for(size_t i = first; i < last; ++i) {
+                tree.k_nearest((*this->target)[i], nNeighbours, neighbours);
+                normals[i] = normal(neighbours);
+            }
+        });
+    }
+
+//------------------------------------------------------------------------------
+
+    size_t n_target() const {
+        return target->size();
+    }
+
+    const std::vector<Point<T>>& target_normals() const {
+        return normals;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the transform which moves source onto the target, starting at initial
+    Result align(const PointCloudView<T> &source, const Transform &initial = Transform(), const Settings &settings = Settings()) const {
+        Result result;
+        result.transform = initial;
+        const size_t n = source.size();
+        if(n == 0 || target->size() == 0)
+            return result;
+
+        const size_t nChunks = n_chunks(n, settings.nThreads, 1 << 12);
+        std::vector<Point<T>> moved(n);
+        std::vector<size_t> matches(n);
+        std::vector<Correspondence> correspondences(n);
+        const T maxSqrDistance = settings.maxDistance < std::sqrt(std::numeric_limits<T>::max())
+            ? settings.maxDistance * settings.maxDistance
+            : std::numeric_limits<T>::max();
+
+        for(size_t iteration = 0; iteration < settings.maxIterations; ++iteration) {
+            const auto start = std::chrono::steady_clock::now();
+
+            parallel_chunks(n, nChunks, [&](size_t first, size_t last, size_t) {
+                for(size_t i = first; i < last; ++i) {
+                    moved[i] = result.transform.apply(source[i]);
+                    matches[i] = iteration == 0 ? tree.nearest(moved[i]) : tree.nearest(moved[i], matches[i]);
+                    const T sqrDistance = moved[i].sqr_distance_to((*target)[matches[i]]);
+                    correspondences[i] = Correspondence(sqrDistance <= maxSqrDistance ? residual(moved[i], matches[i], settings.metric) : -1, i);
+                }
+            });
+
+            std::vector<Correspondence> kept;
+            kept.reserve(n);
+            for(const auto &c : correspondences) {
+                if(c.first >= 0)
+                    kept.push_back(c);
+            }
+            if(settings.trimRatio < 1) {
+                const size_t nKept = std::max(size_t(1), size_t(std::ceil(settings.trimRatio * kept.size())));
+                if(nKept < kept.size()) {
+                    std::nth_element(kept.begin(), kept.begin() + nKept, kept.end());
+                    kept.resize(nKept);
+                }
+            }
+            if(kept.size() < n_required(settings))
+                break;
+
+            T sqrError(0);
+            for(const auto &c : kept)
+                sqrError += c.first;
+            result.rmsError = std::sqrt(sqrError / kept.size());
+
+            T spread(0);
+            const Transform step = settings.metric == POINT_TO_POINT
+                ? point_to_point(moved, matches, kept, settings.similarity, spread)
+                : point_to_line(moved, matches, kept, settings.similarity, spread);
+            result.transform = result.transform.then(step);
+
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            result.log.push_back(Iteration{kept.size(), result.rmsError, step, seconds});
+
+            const T shift = std::sqrt(step.translation.x * step.translation.x + step.translation.y * step.translation.y);
+            if(std::abs(step.angle) <= settings.tolerance && std::abs(step.factor - 1) <= settings.tolerance
+               && shift <= settings.tolerance * spread) {
+                result.converged = true;
+                break;
+            }
+        }
+        return result;
+    }
+
+//------------------------------------------------------------------------------
+
+private:
+
+    static inline size_t n_required(const Settings &settings) {
+        return settings.metric == POINT_TO_POINT ? 2 : (settings.similarity ? 4 : 3);
+    }
+
+    inline T residual(const Point<T> &p, size_t match, Metric metric) const {
+        const Point<T> &q = (*target)[match];
+        if(metric == POINT_TO_POINT)
+            return p.sqr_distance_to(q);
+        const T distance = (p.x - q.x) * normals[match].x + (p.y - q.y) * normals[match].y;
+        return distance * distance;
+    }
+
+    ///the eigenvector of the smaller eigenvalue of the covariance, the unit x vector if it's undefined
+    Point<T> normal(const std::vector<std::pair<T, size_t>> &neighbours) const {
+        T cx(0), cy(0);
+        for(const auto &nb : neighbours) {
+            cx += (*target)[nb.second].x;
+            cy += (*target)[nb.second].y;
+        }
+        cx /= neighbours.size();
+        cy /= neighbours.size();
+
+        T xx(0), xy(0), yy(0);
+        for(const auto &nb : neighbours) {
+            const T dx = (*target)[nb.second].x - cx, dy = (*target)[nb.second].y - cy;
+            xx += dx * dx;
+            xy += dx * dy;
+            yy += dy * dy;
+        }
+        const T major = T(0.5) * std::atan2(2 * xy, xx - yy);
+        return Point<T>{-std::sin(major), std::cos(major)};
+    }
+
+//------------------------------------------------------------------------------
+
+    ///closed form, the rotation follows from the summed dot and cross products of the centered pairs
+    Transform point_to_point(const std::vector<Point<T>> &moved, const std::vector<size_t> &matches,
+                             const std::vector<Correspondence> &kept, bool similarity, T &spread) const {
+        T px(0), py(0), qx(0), qy(0);
+        for(const auto &c : kept) {
+            px += moved[c.second].x;
+            py += moved[c.second].y;
+            qx += (*target)[matches[c.second]].x;
+            qy += (*target)[matches[c.second]].y;
+        }
+        px /= kept.size(); py /= kept.size(); qx /= kept.size(); qy /= kept.size();
+
+        T dot(0), cross(0), sqrLength(0);
+        for(const auto &c : kept) {
+            const T ax = moved[c.second].x - px, ay = moved[c.second].y - py;
+            const T bx = (*target)[matches[c.second]].x - qx, by = (*target)[matches[c.second]].y - qy;
+            dot += ax * bx + ay * by;
+            cross += ax * by - ay * bx;
+            sqrLength += ax * ax + ay * ay;
+        }
+        spread = std::sqrt(sqrLength / kept.size());
+
+        const T angle = (dot == 0 && cross == 0) ? T(0) : std::atan2(cross, dot);
+        const T factor = similarity && sqrLength > 0 ? std::sqrt(dot * dot + cross * cross) / sqrLength : T(1);
+        const Point<T> center = Transform(angle, factor).apply(Point<T>{px, py});
+        return Transform(angle, factor, Point<T>{qx - center.x, qy - center.y});
+    }
+
+//------------------------------------------------------------------------------
+
+    ///linearized around the centroid of the moved points, parameters {angle, x, y, scale - 1}
+    Transform point_to_line(const std::vector<Point<T>> &moved, const std::vector<size_t> &matches,
+                            const std::vector<Correspondence> &kept, bool similarity, T &spread) const {
+        T cx(0), cy(0);
+        for(const auto &c : kept) {
+            cx += moved[c.second].x;
+            cy += moved[c.second].y;
+        }
+        cx /= kept.size();
+        cy /= kept.size();
+
+        const size_t nParameters = similarity ? 4 : 3;
+        std::array<std::array<T, 4>, 4> normal{};
+        std::array<T, 4> rhs{};
+        T sqrLength(0);
+        for(const auto &c : kept) {
+            const Point<T> &p = moved[c.second];
+            const Point<T> &q = (*target)[matches[c.second]];
+            const Point<T> &nq = normals[matches[c.second]];
+            const T ax = p.x - cx, ay = p.y - cy;
+            const std::array<T, 4> jacobian{{-ay * nq.x + ax * nq.y, nq.x, nq.y, ax * nq.x + ay * nq.y}};
+            const T r = (p.x - q.x) * nq.x + (p.y - q.y) * nq.y;
+            for(size_t i = 0; i < nParameters; ++i) {
+                for(size_t j = 0; j < nParameters; ++j)
+                    normal[i][j] += jacobian[i] * jacobian[j];
+                rhs[i] -= jacobian[i] * r;
+            }
+            sqrLength += ax * ax + ay * ay;
+        }
+        spread = std::sqrt(sqrLength / kept.size());
+
+        const std::array<T, 4> x = solve(normal, rhs, nParameters);
+        const T factor = similarity ? 1 + x[3] : T(1);
+        const Point<T> center = Transform(x[0], factor).apply(Point<T>{cx, cy});
+        return Transform(x[0], factor, Point<T>{cx + x[1] - center.x, cy + x[2] - center.y});
+    }
+
+    ///Gaussian elimination with partial pivoting, directions without constraint (e.g. along a straight target) stay 0
+    static std::array<T, 4> solve(std::array<std::array<T, 4>, 4> a, std::array<T, 4> b, size_t n) {
+        T largest(0);
+        for(size_t i = 0; i < n; ++i)
+            largest = std::max(largest, std::abs(a[i][i]));
+        const T epsilon = largest * std::numeric_limits<T>::epsilon() * 64;
+
+        std::array<size_t, 4> pivots{};
+        std::array<bool, 4> used{};
+        for(size_t col = 0; col < n; ++col) {
+            size_t pivot = n;
+            for(size_t row = 0; row < n; ++row) {
+                if(!used[row] && std::abs(a[row][col]) > epsilon && (pivot == n || std::abs(a[row][col]) > std::abs(a[pivot][col])))
+                    pivot = row;
+            }
+            pivots[col] = pivot;
+            if(pivot == n)
+                continue;
+            used[pivot] = true;
+            for(size_t row = 0; row < n; ++row) {
+                if(row == pivot || a[row][col] == 0)
+                    continue;
+                const T f = a[row][col] / a[pivot][col];
+                for(size_t k = col; k < n; ++k)
+                    a[row][k] -= f * a[pivot][k];
+                b[row] -= f * b[pivot];
+            }
+        }
+
+        std::array<T, 4> x{};
+        for(size_t col = 0; col < n; ++col) {
+            if(pivots[col] != n)
+                x[col] = b[pivots[col]] / a[pivots[col]][col];
+        }
+        return x;
+    }
+};
+
+} //lib_2d
+
+#endif // ITERATIVECLOSESTPOINT_H_INCLUDED
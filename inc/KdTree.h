@@ -29,9 +29,11 @@
 #include <algorithm>
 #include <memory>
 #include <utility>
+#include <stdexcept>
 
 #include "Point.h"
 #include "OrderedPointCloud.h"
+#include "MemoryResource.h"
 
 namespace lib_2d {
 
@@ -44,18 +46,23 @@ private:
 
 //------------------------------------------------------------------------------
 
-    enum Compare {LEFT, RIGHT};
+    static const size_t NONE = static_cast<size_t>(-1);
 
-    std::unique_ptr<KdTree<T> >
-        left,
-        right;
+    ///all nodes are stored within one pool, children are referenced by their index within it
+    struct Node {
+        size_t pId;
+        size_t left, right;
+        size_t dimension;
+    };
 
-    size_t pId;
+    std::vector<Node, ResourceAllocator<Node> > nodes;
 
-    const int dimension;
+    using Candidates = std::vector<std::pair<T, size_t>, ResourceAllocator<std::pair<T, size_t> > >;
 
     std::shared_ptr<OrderedPointCloud<T>> parent;
 
+    std::shared_ptr<PointCloud<T>> pc;
+
 //------------------------------------------------------------------------------
 
 public:
@@ -64,57 +71,35 @@ public:
 
 //------------------------------------------------------------------------------
 
-    KdTree(std::shared_ptr<OrderedPointCloud<T>> tpc, int dim = 0) :
-        dimension(dim % 2),
-        parent(tpc) {
-
-        if(tpc->n_elements() == 1)
-            pId = tpc->first_id();
-
-        else if(tpc->n_elements() > 1) {
-            size_t median = tpc->n_elements() / 2;
-            std::shared_ptr<OrderedPointCloud<T>>
-                tpcL = std::make_shared<OrderedPointCloud<T>>(),
-                tpcR = std::make_shared<OrderedPointCloud<T>>();
-            tpcL->set_parent(tpc->get_parent());
-            tpcR->set_parent(tpc->get_parent());
-
-            tpcL->reserve(median - 1);
-            tpcR->reserve(median - 1);
-
-            median_dimension_sort(tpc, dimension);
+    ///builds the tree in place within a single id buffer, the nodes are allocated from 'resource' (the default resource if none is given)
+    KdTree(std::shared_ptr<OrderedPointCloud<T>> tpc, int dim = 0, MemoryResource *resource = nullptr) :
+        nodes(ResourceAllocator<Node>(resource)),
+        parent(tpc),
+        pc(tpc->get_parent()) {
 
-            for(size_t i = 0; i < tpc->n_elements(); ++i) {
-                if(i < median)
-                    tpcL->push_back_id(tpc->get_id(i));
-                else if(i > median)
-                    tpcR->push_back_id(tpc->get_id(i));
-            }
-
-            pId = tpc->get_id(median);
+        const ResourceAllocator<size_t> allocator(resource);
+        std::vector<size_t, ResourceAllocator<size_t> > ids(allocator);
+        ids.reserve(tpc->n_elements());
+        for(size_t i = 0; i < tpc->n_elements(); ++i)
+            ids.push_back(tpc->get_id(i));
 
-            if(tpcL->n_elements() > 0)  left = std::unique_ptr<KdTree>(new KdTree(tpcL, dimension+1));
-            if(tpcR->n_elements() > 0) right = std::unique_ptr<KdTree>(new KdTree(tpcR, dimension+1));
-        }
+        nodes.reserve(ids.size());
+        build(ids.begin(), ids.end(), dim % 2);
     }
 
 //------------------------------------------------------------------------------
 
     size_t size() const {
-        size_t out(0);
-        if(left)  out += left->size();
-        out +=1;
-        if(right) out += right->size();
-        return out;
+        return nodes.size();
     }
 
 //------------------------------------------------------------------------------
 
     Topology<1> to_topology() const {
         Topology<1> out;
-        if(left) out.push_back(left->to_topology());
-        out.push_back(pId);
-        if(right) out.push_back(right->to_topology());
+        out.reserve_elements(nodes.size());
+        if(!nodes.empty())
+            to_topology(0, out);
         return out;
     }
 
@@ -127,205 +112,230 @@ public:
 //------------------------------------------------------------------------------
 
     size_t nearest(const Point<T> &search) const {
-        if(is_leaf()) return pId; //reached the end, return current value
-        auto val = parent->get_point(pId);
-        auto comp = dimension_compare(search, val , dimension);
-        size_t idBest; //nearest neighbor of search
-        if(comp == LEFT && left)
-            idBest = left->nearest(search);
-        else if(comp == RIGHT && right)
-            idBest = right->nearest(search);
-        else
-            return pId;
-
-        T distanceBest 	= search.distance_to(parent->get_point(idBest));
-        T distanceThis  = search.sqr_distance_to(val);
-
-        if(distanceThis < distanceBest) {
-            distanceBest = distanceThis;
-            idBest = pId; //make this value the best if it is closer than the checked side
-        }
-
-        //check whether other side might have candidates aswell
-        T borderLeft 	= search[dimension] - distanceBest;
-        T borderRight 	= search[dimension] + distanceBest;
-        size_t idOtherBest;
-
-        //check whether distances to other side are smaller than currently best
-        //and recurse into the "wrong" direction, to check for possibly additional candidates
-        if(comp == LEFT && right) {
-            if(borderRight >= val[dimension]) {
-                idOtherBest = right->nearest(search);
-                if(search.sqr_distance_to(parent->get_point(idOtherBest)) < search.sqr_distance_to(parent->get_point(idBest)))
-                    idBest = idOtherBest;
-            }
-        }
-        else if (comp == RIGHT && left) {
-            if(borderLeft <= val[dimension]) {
-                idOtherBest = left->nearest(search);
-                if(search.sqr_distance_to(parent->get_point(idOtherBest)) < search.sqr_distance_to(parent->get_point(idBest)))
-                    idBest = idOtherBest;
-            }
-        }
+        if(nodes.empty())
+            throw std::out_of_range ("KdTree is empty, there is no nearest neighbor");
+        size_t idBest = nodes[0].pId;
+        T distanceBest = search.sqr_distance_to(point(idBest));
+        nearest(0, search, idBest, distanceBest);
+        return idBest;
+    }
 
+    ///starts with the distance to hint (an id within the tree) as bound, so a hint close to the result (e.g. the previous result of a moving query) prunes most of the tree
+    size_t nearest(const Point<T> &search, size_t hint) const {
+        if(nodes.empty())
+            throw std::out_of_range ("KdTree is empty, there is no nearest neighbor");
+        size_t idBest = hint;
+        T distanceBest = search.sqr_distance_to(point(hint));
+        nearest(0, search, idBest, distanceBest);
         return idBest;
     }
 
 //------------------------------------------------------------------------------
 
+    ///the n nearest neighbors of search, sorted by their distance
     Topology<1> k_nearest(const Point<T> &search, size_t n) const {
-        if(n < 1) return Topology<1>(); //no real search if n < 1
-        if(is_leaf()) return Topology<1>(Element{pId}); //no further recursion, return current value
+        if(n < 1 || nodes.empty()) return Topology<1>(); //no real search if n < 1
 
-        auto val = parent->get_point(pId);
+        Candidates candidates; //max heap of the currently best candidates
+        candidates.reserve(n + 1);
+        k_nearest(search, n, candidates);
 
-        Topology<1> res; //nearest neighbors of search
-        if(res.n_elements() < n || search.sqr_distance_to(val) < search.sqr_distance_to(  parent->get_point(res.last()[0])  ))
-            res += Element({pId}); //add current node if there is still room or if it is closer than the currently worst candidate
+        Topology<1> res(candidates.size());
+        for(const auto &c : candidates)
+            res.push_back(Element{c.second});
+        return res;
+    }
 
-        //decide which side to check and recurse into it
-        auto comp = dimension_compare(search, val, dimension);
+    ///allocation free variant for repeated queries, 'result' is reused as heap and afterwards holds {sqrDistance, id} sorted by distance
+    template <typename Container>
+    void k_nearest(const Point<T> &search, size_t n, Container &result) const {
+        k_nearest(search, n, result, [](size_t){ return true; });
+    }
 
-        if(comp == LEFT) {
-            if(left) res += left->k_nearest(search, n);
-        } else if(right) {
-            res += right->k_nearest(search, n);
-        }
+    ///only considers the ids for which accept(id) returns true
+    template <typename Container, typename Accept>
+    void k_nearest(const Point<T> &search, size_t n, Container &result, Accept accept) const {
+        result.clear();
+        if(n < 1 || nodes.empty()) return;
+        k_nearest(0, search, n, result, accept);
+        std::sort_heap(result.begin(), result.end());
+    }
 
-        //only keep the required number of candidates and sort them by distance
-        sort_and_limit(res, parent->get_parent(), search, n);
+//------------------------------------------------------------------------------
 
-        //check whether other side might have candidates aswell
-        T distanceBest 	= search.distance_to(parent->get_point(res.last()[0]));
-        T borderLeft 	= search[dimension] - distanceBest;
-        T borderRight 	= search[dimension] + distanceBest;
+    ///whether any point lies within radius of search, stops at the first one found
+    bool any_within(const Point<T> &search, T radius) const {
+        if(radius < 0.0 || nodes.empty()) return false;
+        return any_within(0, search, radius * radius);
+    }
 
-        //check whether distances to other side are smaller than currently worst candidate
-        //and recurse into the "wrong" direction, to check for possibly additional candidates
-        if(comp == LEFT && right) {
-            if(res.n_elements() < n || borderRight >= val[dimension])
-                res += right->k_nearest(search, n);
-        }
-        else if (comp == RIGHT && left) {
-            if(res.n_elements() < n || borderLeft <= val[dimension])
-                res += left->k_nearest(search, n);
-        }
+//------------------------------------------------------------------------------
 
-        sort_and_limit(res, parent->get_parent(), search, n);
+    Topology<1> in_circle(const Point<T> &search, T radius) const {
+        if(radius <= 0.0 || nodes.empty()) return Topology<1>(); //no real search if radius <= 0
+
+        Topology<1> res; //all points within the circle
+        in_circle(0, search, radius, radius * radius, res);
         return res;
     }
 
 //------------------------------------------------------------------------------
 
-    Topology<1> in_circle(const Point<T> &search, T radius) const {
-        if(radius <= 0.0) return Topology<1>(); //no real search if radius <= 0
+    Topology<1> in_box(const Point<T> &search, T xSize, T ySize) const {
+        if(xSize <= 0.0 || ySize <= 0.0 || nodes.empty()) return Topology<1>(); //no real search if width or height <= 0
+
+        Topology<1> res; //all points within the box
+        in_box(0, search, 0.5 * xSize, 0.5 * ySize, res);
+        return res;
+    }
+
+//------------------------------------------------------------------------------
 
-        auto val = parent->get_point(pId);
+private:
 
-        Topology<1> res; //all points within the sphere
-        if(search.distance_to(val) <= radius)
-            res += Element({pId}); //add current node if it is within the search radius
+    inline const Point<T>& point(size_t pId) const {
+        return (*pc)[pId];
+    }
 
-        if(is_leaf()) return res; //no children, return result
+//------------------------------------------------------------------------------
 
-        //decide which side to check and recurse into it
-        auto comp = dimension_compare(search, val, dimension);
-        if(comp == LEFT) {
-            if(left) res += left->in_circle(search, radius);
-        } else if(right) {
-            res += right->in_circle(search, radius);
-        }
+    template <typename Iterator>
+    size_t build(Iterator first, Iterator last, size_t dimension) {
+        if(first == last)
+            return NONE;
 
-        T borderLeft 	= search[dimension] - radius;
-        T borderRight 	= search[dimension] + radius;
+        Iterator median = first + (last - first) / 2;
+        std::nth_element(first, median, last,
+                         [this, dimension] (size_t lhs, size_t rhs){return point(lhs)[dimension] < point(rhs)[dimension]; });
 
-        //check whether distances to other side are smaller than radius
-        //and recurse into the "wrong" direction, to check for possibly additional candidates
-        if(comp == LEFT && right) {
-            if(borderRight >= val[dimension])
-                res += right->in_circle(search, radius);
-        }
-        else if (comp == RIGHT && left) {
-            if(borderLeft <= val[dimension])
-                res += left->in_circle(search, radius);
-        }
+        size_t index = nodes.size();
+        nodes.push_back(Node{*median, NONE, NONE, dimension});
 
-        return res;
+        size_t left  = build(first, median, (dimension + 1) % 2);
+        size_t right = build(median + 1, last, (dimension + 1) % 2);
+        nodes[index].left  = left;
+        nodes[index].right = right;
+        return index;
     }
 
 //------------------------------------------------------------------------------
 
-    Topology<1> in_box(const Point<T> &search, T xSize, T ySize) const {
-        if(xSize <= 0.0 || ySize <= 0.0) return Topology<1>(); //no real search if width or height <= 0
+    void to_topology(size_t index, Topology<1> &out) const {
+        const Node &node = nodes[index];
+        if(node.left != NONE)  to_topology(node.left, out);
+        out.push_back(Element{node.pId});
+        if(node.right != NONE) to_topology(node.right, out);
+    }
 
-        auto val = parent->get_point(pId);
+//------------------------------------------------------------------------------
 
-        Topology<1> res; //all points within the box
-        if(   dimension_dist(search, val, 0) <= 0.5 * xSize
-           && dimension_dist(search, val, 1) <= 0.5 * ySize)
-            res += Element({pId}); //add current node if it is within the search box
-
-        if(is_leaf()) return res; //no children, return result
-
-        //decide which side to check and recurse into it
-        auto comp = dimension_compare(search, val, dimension);
-        if(comp == LEFT) {
-            if(left) res += left->in_box(search, xSize, ySize);
-        } else if(right) {
-            res += right->in_box(search, xSize, ySize);
+    void nearest(size_t index, const Point<T> &search, size_t &idBest, T &distanceBest) const {
+        const Node &node = nodes[index];
+        const auto &val = point(node.pId);
+
+        T distanceThis = search.sqr_distance_to(val);
+        if(distanceThis < distanceBest) {
+            distanceBest = distanceThis;
+            idBest = node.pId;
         }
 
-        T borderLeft 	= search[dimension] - 0.5 * (dimension == 0 ? xSize : ySize);
-        T borderRight 	= search[dimension] + 0.5 * (dimension == 0 ? xSize : ySize);
+        //recurse into the side of search first, then check whether the other side might have candidates aswell
+        T delta = search[node.dimension] - val[node.dimension];
+        size_t near = delta <= 0 ? node.left  : node.right;
+        size_t far  = delta <= 0 ? node.right : node.left;
 
-        //check whether distances to other side are smaller than radius
-        //and recurse into the "wrong" direction, to check for possibly additional candidates
-        if(comp == LEFT && right) {
-            if(borderRight >= val[dimension])
-                res += right->in_box(search, xSize, ySize);
-        }
-        else if (comp == RIGHT && left) {
-            if(borderLeft <= val[dimension])
-                res += left->in_box(search, xSize, ySize);
+        if(near != NONE)
+            nearest(near, search, idBest, distanceBest);
+        if(far != NONE && delta * delta < distanceBest)
+            nearest(far, search, idBest, distanceBest);
+    }
+
+//------------------------------------------------------------------------------
+
+    template <typename Container, typename Accept>
+    void k_nearest(size_t index, const Point<T> &search, size_t n, Container &candidates, Accept &accept) const {
+        const Node &node = nodes[index];
+        const auto &val = point(node.pId);
+
+        if(accept(node.pId)) {
+            T distanceThis = search.sqr_distance_to(val);
+            if(candidates.size() < n) {
+                candidates.push_back(std::make_pair(distanceThis, node.pId));
+                std::push_heap(candidates.begin(), candidates.end());
+            }
+            else if(distanceThis < candidates.front().first) {
+                std::pop_heap(candidates.begin(), candidates.end());
+                candidates.back() = std::make_pair(distanceThis, node.pId);
+                std::push_heap(candidates.begin(), candidates.end());
+            }
         }
 
-        return res;
+        T delta = search[node.dimension] - val[node.dimension];
+        size_t near = delta <= 0 ? node.left  : node.right;
+        size_t far  = delta <= 0 ? node.right : node.left;
+
+        if(near != NONE)
+            k_nearest(near, search, n, candidates, accept);
+        if(far != NONE && (candidates.size() < n || delta * delta < candidates.front().first))
+            k_nearest(far, search, n, candidates, accept);
     }
 
 //------------------------------------------------------------------------------
 
-private:
+    bool any_within(size_t index, const Point<T> &search, T sqrRadius) const {
+        const Node &node = nodes[index];
+        const auto &val = point(node.pId);
+
+        if(search.sqr_distance_to(val) <= sqrRadius)
+            return true;
+
+        T delta = search[node.dimension] - val[node.dimension];
+        size_t near = delta <= 0 ? node.left  : node.right;
+        size_t far  = delta <= 0 ? node.right : node.left;
 
-    inline bool is_leaf() const {
-        return !left && !right;
+        if(near != NONE && any_within(near, search, sqrRadius))
+            return true;
+        return far != NONE && delta * delta <= sqrRadius && any_within(far, search, sqrRadius);
     }
 
 //------------------------------------------------------------------------------
 
-    static inline void median_dimension_sort(std::shared_ptr<OrderedPointCloud<T>> path, size_t dimension) {
-        std::nth_element(path->begin(), path->begin() + path->n_elements()/2, path->end(),
-                         [&path, dimension] (Element lhs, Element rhs){return path->get_point(lhs[0])[dimension] < path->get_point(rhs[0])[dimension]; });
-    }
+    void in_circle(size_t index, const Point<T> &search, T radius, T sqrRadius, Topology<1> &res) const {
+        const Node &node = nodes[index];
+        const auto &val = point(node.pId);
 
-    static inline T dimension_dist(const Point<T> &lhs, const Point<T> &rhs, size_t dimension) {
-        return std::fabs( lhs[dimension] - rhs[dimension] );
+        if(search.sqr_distance_to(val) <= sqrRadius)
+            res.push_back(Element{node.pId}); //add current node if it is within the search radius
+
+        T delta = search[node.dimension] - val[node.dimension];
+        if(node.left != NONE && delta - radius <= 0)
+            in_circle(node.left, search, radius, sqrRadius, res);
+        if(node.right != NONE && delta + radius >= 0)
+            in_circle(node.right, search, radius, sqrRadius, res);
     }
 
-    static inline Compare dimension_compare(const Point<T> &lhs, const Point<T> &rhs, size_t dimension) {
-        if(lhs[dimension] <= rhs[dimension]) return LEFT;
-        else return RIGHT;
+//------------------------------------------------------------------------------
+
+    void in_box(size_t index, const Point<T> &search, T xHalf, T yHalf, Topology<1> &res) const {
+        const Node &node = nodes[index];
+        const auto &val = point(node.pId);
+
+        if(   dimension_dist(search, val, 0) <= xHalf
+           && dimension_dist(search, val, 1) <= yHalf)
+            res.push_back(Element{node.pId}); //add current node if it is within the search box
+
+        T half  = node.dimension == 0 ? xHalf : yHalf;
+        T delta = search[node.dimension] - val[node.dimension];
+        if(node.left != NONE && delta - half <= 0)
+            in_box(node.left, search, xHalf, yHalf, res);
+        if(node.right != NONE && delta + half >= 0)
+            in_box(node.right, search, xHalf, yHalf, res);
     }
 
 //------------------------------------------------------------------------------
 
-    static inline void sort_and_limit(Topology<1> &target, const std::shared_ptr<PointCloud<T>> pc, const Point<T> &search, size_t maxSize) {
-        if(target.n_elements() > maxSize) {
-            std::partial_sort(target.begin(), target.begin() + maxSize, target.end(),
-                [&search, &pc](const Element &a, const Element &b) {
-                    return search.sqr_distance_to(pc->get_point(a[0])) < search.sqr_distance_to(pc->get_point(b[0]));
-                });
-            target.remove_from(maxSize);
-        }
+    static inline T dimension_dist(const Point<T> &lhs, const Point<T> &rhs, size_t dimension) {
+        return std::fabs( lhs[dimension] - rhs[dimension] );
     }
 };
 
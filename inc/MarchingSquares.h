@@ -0,0 +1,332 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    MarchingSquares.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class MarchingSquares, iso-lines of a scalar field sampled on a regular grid as stitched polylines
+ *          every crossing of an iso-line with a grid edge is identified by the id of that edge, so neighbouring cells agree on it
+ *          bands of cell rows are processed in parallel (all levels within the same pass), each band stitches its segments
+ *          to chains, the chains ending on the seams between bands are stitched afterwards
+ */
+
+#ifndef MARCHINGSQUARES_H_INCLUDED
+#define MARCHINGSQUARES_H_INCLUDED
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+#include "Point.h"
+#include "PointCloud.h"
+#include "parallel.h"
+
+namespace lib_2d {
+
+template <typename T>
+class MarchingSquares {
+
+private:
+
+    ///edge ids of a chain of crossings, closed chains don't repeat their first edge
+    struct Chain {
+        std::vector<size_t> edges;
+        bool closed;
+    };
+
+    using Ends = std::vector<std::pair<size_t, size_t>>; //first and last edge of segments or chains
+
+    enum : size_t {NONE = static_cast<size_t>(-1)};
+
+    std::vector<T> values;
+    size_t nX, nY;
+    Point<T> origin, spacing;
+    size_t nHorizontal; //the ids of horizontal edges come first, those of vertical ones afterwards
+
+//------------------------------------------------------------------------------
+
+public:
+
+    ///values row by row, value (ix, iy) is values[iy * nX + ix], located at origin + (ix * spacing.x, iy * spacing.y)
+    MarchingSquares(std::vector<T> values, size_t nX, size_t nY, const Point<T> &origin = Point<T>{0, 0}, const Point<T> &spacing = Point<T>{1, 1}) :
+        values(std::move(values)),
+        nX(nX),
+        nY(nY),
+        origin(origin),
+        spacing(spacing),
+        nHorizontal(nX > 0 ? (nX - 1) * nY : 0) {
+        if(this->values.size() != nX * nY)
+            throw std::out_of_range ("MarchingSquares requires nX * nY values");
+    }
+
+//------------------------------------------------------------------------------
+
+    size_t n_x() const {
+        return nX;
+    }
+
+    size_t n_y() const {
+        return nY;
+    }
+
+    T value(size_t ix, size_t iy) const {
+        return values[iy * nX + ix];
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the iso-lines of one level, values >= level count as inside and are left of the polylines
+    ///closed polylines end with their first point if closePath is set, open ones start and end on the border of the grid
+    ///the result doesn't depend on nThreads
+    std::vector<PointCloud<T>> contour(T level, bool closePath = true, size_t nThreads = 0) const {
+        return std::move(contours(std::vector<T>(1, level), closePath, nThreads)[0]);
+    }
+
+    ///the iso-lines of all levels within a single pass over the grid
+    std::vector<std::vector<PointCloud<T>>> contours(const std::vector<T> &levels, bool closePath = true, size_t nThreads = 0) const {
+        const size_t
+            nLevels = levels.size(),
+            nCellRows = nY > 1 && nX > 1 ? nY - 1 : 0,
+            nChunks = n_chunks(nCellRows, nThreads, std::max(size_t(1), size_t(1 << 14) / std::max(size_t(1), nX)));
+
+        //per chunk and level: the closed chains and those ending on seams
+        std::vector<std::vector<std::vector<Chain>>> chunkChains(nChunks, std::vector<std::vector<Chain>>(nLevels));
+        parallel_chunks(nCellRows, nChunks, [&](size_t first, size_t last, size_t chunk) {
+            std::vector<Ends> segments(nLevels);
+            for(size_t iy = first; iy < last; ++iy)
+                add_segments(iy, levels, segments);
+            for(size_t l = 0; l < nLevels; ++l)
+                chunkChains[chunk][l] = stitch_segments(segments[l]);
+        });
+
+        std::vector<std::vector<PointCloud<T>>> result(nLevels);
+        parallel_for(nLevels, n_chunks(nLevels, nThreads, 1), [&](size_t l) {
+            std::vector<Chain> chains;
+            for(auto &perLevel : chunkChains) {
+                for(auto &chain : perLevel[l])
+                    chains.push_back(std::move(chain));
+            }
+            result[l] = to_polylines(stitch_chains(chains), levels[l], closePath);
+        });
+        return result;
+    }
+
+//------------------------------------------------------------------------------
+
+private:
+
+    inline size_t horizontal(size_t ix, size_t iy) const {
+        return iy * (nX - 1) + ix;
+    }
+
+    inline size_t vertical(size_t ix, size_t iy) const {
+        return nHorizontal + iy * nX + ix;
+    }
+
+    ///the segments of all cells of a row, corners counter clockwise from (ix, iy), edge k from corner k to k + 1
+    ///a segment starts where edge k leaves the inside and ends where one enters it, saddles are resolved by the mean value
+    void add_segments(size_t iy, const std::vector<T> &levels, std::vector<Ends> &segments) const {
+        const T *below = &values[iy * nX];
+        const T *above = below + nX;
+        for(size_t ix = 0; ix + 1 < nX; ++ix) {
+            const T v[4] = {below[ix], below[ix + 1], above[ix + 1], above[ix]};
+            const T
+                minimum = std::min(std::min(v[0], v[1]), std::min(v[2], v[3])),
+                maximum = std::max(std::max(v[0], v[1]), std::max(v[2], v[3]));
+            const size_t edges[4] = {horizontal(ix, iy), vertical(ix + 1, iy), horizontal(ix, iy + 1), vertical(ix, iy)};
+
+            for(size_t l = 0; l < levels.size(); ++l) {
+                const T level = levels[l];
+                if(!(level > minimum && level <= maximum))
+                    continue; //all corners on the same side
+
+                const bool inside[4] = {v[0] >= level, v[1] >= level, v[2] >= level, v[3] >= level};
+                size_t starts[2], ends[2], nStarts(0), nEnds(0);
+                for(size_t k = 0; k < 4; ++k) {
+                    const bool next = inside[(k + 1) & 3];
+                    if(inside[k] && !next)
+                        starts[nStarts++] = k;
+                    else if(!inside[k] && next)
+                        ends[nEnds++] = k;
+                }
+
+                if(nStarts == 1)
+                    segments[l].push_back(std::make_pair(edges[starts[0]], edges[ends[0]]));
+                else {
+                    //connected through the center: pass around the outside corners, otherwise around the inside ones
+                    const bool center = (v[0] + v[1] + v[2] + v[3]) / 4 >= level;
+                    for(size_t i = 0; i < 2; ++i) {
+                        const size_t k = starts[i];
+                        segments[l].push_back(std::make_pair(edges[k], edges[center ? (k + 1) & 3 : (k + 3) & 3]));
+                    }
+                }
+            }
+        }
+    }
+
+//------------------------------------------------------------------------------
+
+    ///orders items by their ends, every first edge is unique and followed by the item whose first edge is its last one
+    ///returns the sequences of item ids, closed ones marked within 'closed'
+    static std::vector<std::vector<size_t>> stitch(const Ends &ends, std::vector<bool> &closed) {
+        const size_t n = ends.size();
+        std::vector<size_t> order(n);
+        for(size_t i = 0; i < n; ++i)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [&ends](size_t a, size_t b) {
+            return ends[a].first < ends[b].first;
+        });
+
+        std::vector<size_t> next(n, NONE);
+        std::vector<bool> hasPrevious(n, false), visited(n, false);
+        for(size_t i = 0; i < n; ++i) {
+            const auto it = std::lower_bound(order.begin(), order.end(), ends[i].second, [&ends](size_t a, size_t edge) {
+                return ends[a].first < edge;
+            });
+            if(it != order.end() && ends[*it].first == ends[i].second) {
+                next[i] = *it;
+                hasPrevious[*it] = true;
+            }
+        }
+
+        std::vector<std::vector<size_t>> sequences;
+        closed.clear();
+        for(size_t i = 0; i < n; ++i) {
+            if(hasPrevious[i])
+                continue;
+            sequences.emplace_back();
+            for(size_t j = i; j != NONE; j = next[j]) {
+                sequences.back().push_back(j);
+                visited[j] = true;
+            }
+            closed.push_back(false);
+        }
+        for(size_t i = 0; i < n; ++i) {
+            if(visited[i])
+                continue;
+            sequences.emplace_back();
+            for(size_t j = i; !visited[j]; j = next[j]) {
+                sequences.back().push_back(j);
+                visited[j] = true;
+            }
+            closed.push_back(true);
+        }
+        return sequences;
+    }
+
+    static std::vector<Chain> stitch_segments(const Ends &segments) {
+        std::vector<bool> closed;
+        const auto sequences = stitch(segments, closed);
+        std::vector<Chain> chains(sequences.size());
+        for(size_t i = 0; i < sequences.size(); ++i) {
+            auto &edges = chains[i].edges;
+            edges.reserve(sequences[i].size() + 1);
+            edges.push_back(segments[sequences[i].front()].first);
+            for(const auto s : sequences[i])
+                edges.push_back(segments[s].second);
+            if(closed[i])
+                edges.pop_back();
+            chains[i].closed = closed[i];
+        }
+        return chains;
+    }
+
+    ///joins the open chains of all bands at the seams, each junction edge is kept once
+    static std::vector<Chain> stitch_chains(std::vector<Chain> &chains) {
+        std::vector<Chain> result;
+        Ends ends;
+        std::vector<size_t> open;
+        for(size_t i = 0; i < chains.size(); ++i) {
+            if(chains[i].closed)
+                result.push_back(std::move(chains[i]));
+            else {
+                ends.push_back(std::make_pair(chains[i].edges.front(), chains[i].edges.back()));
+                open.push_back(i);
+            }
+        }
+
+        std::vector<bool> closed;
+        const auto sequences = stitch(ends, closed);
+        for(size_t i = 0; i < sequences.size(); ++i) {
+            Chain joined;
+            joined.closed = closed[i];
+            for(const auto s : sequences[i]) {
+                const auto &edges = chains[open[s]].edges;
+                joined.edges.insert(joined.edges.end(), edges.begin() + (joined.edges.empty() ? 0 : 1), edges.end());
+            }
+            if(joined.closed)
+                joined.edges.pop_back();
+            result.push_back(std::move(joined));
+        }
+        return result;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the crossing of the level with an edge, always interpolated from its lower corner
+    Point<T> crossing(size_t edge, T level) const {
+        size_t ix, iy;
+        T a, b;
+        if(edge < nHorizontal) {
+            iy = edge / (nX - 1);
+            ix = edge % (nX - 1);
+            a = value(ix, iy);
+            b = value(ix + 1, iy);
+            const T t = (level - a) / (b - a);
+            return Point<T>{origin.x + (ix + t) * spacing.x, origin.y + iy * spacing.y};
+        }
+        edge -= nHorizontal;
+        iy = edge / nX;
+        ix = edge % nX;
+        a = value(ix, iy);
+        b = value(ix, iy + 1);
+        const T t = (level - a) / (b - a);
+        return Point<T>{origin.x + ix * spacing.x, origin.y + (iy + t) * spacing.y};
+    }
+
+    ///closed chains start at their smallest edge and all are ordered by their first edge, so the result doesn't depend on the bands
+    std::vector<PointCloud<T>> to_polylines(std::vector<Chain> chains, T level, bool closePath) const {
+        for(auto &chain : chains) {
+            if(chain.closed)
+                std::rotate(chain.edges.begin(), std::min_element(chain.edges.begin(), chain.edges.end()), chain.edges.end());
+        }
+        std::sort(chains.begin(), chains.end(), [](const Chain &a, const Chain &b) {
+            return a.edges.front() < b.edges.front();
+        });
+
+        std::vector<PointCloud<T>> result(chains.size());
+        for(size_t i = 0; i < chains.size(); ++i) {
+            auto &polyline = result[i];
+            for(const auto edge : chains[i].edges) {
+                const Point<T> p = crossing(edge, level);
+                if(polyline.empty() || polyline.last() != p) //corners equal to the level are crossed by several edges
+                    polyline.push_back(p);
+            }
+            if(chains[i].closed) {
+                if(polyline.size() > 1 && polyline.last() == polyline[0])
+                    polyline.pop_back();
+                if(closePath)
+                    polyline.push_back(polyline[0]);
+            }
+        }
+        return result;
+    }
+};
+
+} //lib_2d
+
+#endif // MARCHINGSQUARES_H_INCLUDED
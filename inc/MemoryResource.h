@@ -0,0 +1,242 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    MemoryResource.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains MemoryResource, MonotonicResource and ResourceAllocator
+ *          a small C++11 counterpart of std::pmr, used by all containers of this lib
+ *          containers pick up the default resource of the current thread when they are created,
+ *          so a ScopedResource around a request makes all clouds, topologies and trees created within it use an arena
+ */
+
+#ifndef MEMORYRESOURCE_H_INCLUDED
+#define MEMORYRESOURCE_H_INCLUDED
+
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <algorithm>
+
+namespace lib_2d {
+
+class MemoryResource {
+
+public:
+    virtual ~MemoryResource(){}
+
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        return do_allocate(bytes, alignment);
+    }
+
+    void deallocate(void *p, size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        do_deallocate(p, bytes, alignment);
+    }
+
+    bool is_equal(const MemoryResource &other) const {
+        return this == &other || do_is_equal(other);
+    }
+
+protected:
+    virtual void* do_allocate(size_t bytes, size_t alignment) = 0;
+    virtual void do_deallocate(void *p, size_t bytes, size_t alignment) = 0;
+    virtual bool do_is_equal(const MemoryResource &other) const {
+        return this == &other;
+    }
+};
+
+//------------------------------------------------------------------------------
+
+class NewDeleteResource : public MemoryResource {
+
+protected:
+    void* do_allocate(size_t bytes, size_t) override {
+        return ::operator new(bytes);
+    }
+
+    void do_deallocate(void *p, size_t, size_t) override {
+        ::operator delete(p);
+    }
+};
+
+inline MemoryResource* new_delete_resource() {
+    static NewDeleteResource resource;
+    return &resource;
+}
+
+//------------------------------------------------------------------------------
+
+namespace detail {
+    inline MemoryResource*& default_resource() {
+        static thread_local MemoryResource *resource = nullptr;
+        return resource;
+    }
+}
+
+///the resource newly created containers of the calling thread allocate from
+inline MemoryResource* get_default_resource() {
+    MemoryResource *resource = detail::default_resource();
+    return resource ? resource : new_delete_resource();
+}
+
+///sets the default resource of the calling thread and returns the previous one
+inline MemoryResource* set_default_resource(MemoryResource *resource) {
+    MemoryResource *previous = get_default_resource();
+    detail::default_resource() = resource;
+    return previous;
+}
+
+//------------------------------------------------------------------------------
+
+///makes 'resource' the default of the calling thread for the lifetime of this object
+class ScopedResource {
+    MemoryResource *previous;
+public:
+    explicit ScopedResource(MemoryResource *resource) :
+        previous(set_default_resource(resource)) {}
+
+    ~ScopedResource() {
+        set_default_resource(previous);
+    }
+
+    ScopedResource& operator=(const ScopedResource&) = delete;
+    ScopedResource(const ScopedResource&) = delete;
+};
+
+//------------------------------------------------------------------------------
+
+///arena which only ever grows, deallocation is a no-op and everything is freed at once by release() or on destruction
+///not thread safe, use one arena per thread / request
+class MonotonicResource : public MemoryResource {
+
+private:
+    MemoryResource *upstream;
+    std::vector<std::pair<void*, size_t> > blocks;
+    char *current;
+    size_t remaining;
+    size_t nextSize;
+
+public:
+    explicit MonotonicResource(size_t initialSize = 4096, MemoryResource *upstream = new_delete_resource()) :
+        upstream(upstream),
+        current(nullptr),
+        remaining(0),
+        nextSize(initialSize < 64 ? 64 : initialSize) {}
+
+    ~MonotonicResource() {
+        release();
+    }
+
+    MonotonicResource& operator=(const MonotonicResource&) = delete;
+    MonotonicResource(const MonotonicResource&) = delete;
+
+//------------------------------------------------------------------------------
+
+    void release() {
+        for(const auto &block : blocks)
+            upstream->deallocate(block.first, block.second);
+        blocks.clear();
+        current = nullptr;
+        remaining = 0;
+    }
+
+    size_t n_blocks() const {
+        return blocks.size();
+    }
+
+//------------------------------------------------------------------------------
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        size_t padding = current ? (alignment - reinterpret_cast<size_t>(current) % alignment) % alignment : 0;
+        if(!current || padding + bytes > remaining) {
+            size_t size = std::max(nextSize, bytes + alignment);
+            current = static_cast<char*>(upstream->allocate(size));
+            blocks.push_back(std::make_pair(static_cast<void*>(current), size));
+            remaining = size;
+            nextSize = 2 * size;
+            padding = (alignment - reinterpret_cast<size_t>(current) % alignment) % alignment;
+        }
+        void *out = current + padding;
+        current += padding + bytes;
+        remaining -= padding + bytes;
+        return out;
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+};
+
+//------------------------------------------------------------------------------
+
+///std compatible allocator forwarding to a MemoryResource (the default resource of the creating thread if none is given)
+///copies of containers get the default resource, the same way std::pmr::polymorphic_allocator behaves
+template <typename U>
+class ResourceAllocator {
+
+    template <typename V> friend class ResourceAllocator;
+
+private:
+    MemoryResource *resource;
+
+public:
+    using value_type = U;
+
+    ResourceAllocator() :
+        resource(get_default_resource()) {}
+
+    ResourceAllocator(MemoryResource *resource) :
+        resource(resource ? resource : get_default_resource()) {}
+
+    template <typename V>
+    ResourceAllocator(const ResourceAllocator<V> &other) :
+        resource(other.resource) {}
+
+//------------------------------------------------------------------------------
+
+    U* allocate(size_t n) {
+        return static_cast<U*>(resource->allocate(n * sizeof(U), alignof(U)));
+    }
+
+    void deallocate(U *p, size_t n) {
+        resource->deallocate(p, n * sizeof(U), alignof(U));
+    }
+
+//------------------------------------------------------------------------------
+
+    ResourceAllocator select_on_container_copy_construction() const {
+        return ResourceAllocator();
+    }
+
+    MemoryResource* get_resource() const {
+        return resource;
+    }
+
+//------------------------------------------------------------------------------
+
+    template <typename V>
+    bool operator == (const ResourceAllocator<V> &other) const {
+        return resource->is_equal(*other.resource);
+    }
+
+    template <typename V>
+    bool operator != (const ResourceAllocator<V> &other) const {
+        return !(*this == other);
+    }
+};
+
+} //lib_2d
+
+#endif // MEMORYRESOURCE_H_INCLUDED
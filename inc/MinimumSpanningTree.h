@@ -0,0 +1,222 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    MinimumSpanningTree.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class MinimumSpanningTree, the Euclidean minimum spanning tree of a PointCloud
+ *          the tree is a subgraph of the Delaunay triangulation, so Kruskal only has to consider its O(n) edges,
+ *          without the longest edge of each triangle
+ *          the edges are kept sorted by length, single linkage clusters at any distance are the components of its shorter edges
+ */
+
+#ifndef MINIMUMSPANNINGTREE_H_INCLUDED
+#define MINIMUMSPANNINGTREE_H_INCLUDED
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <cmath>
+#include <cstdint>
+
+#include "Point.h"
+#include "PointCloudView.h"
+#include "Topology.h"
+#include "Delaunay.h"
+#include "DisjointSets.h"
+#include "parallel.h"
+
+namespace lib_2d {
+
+template <typename T>
+class MinimumSpanningTree {
+
+using Element = std::array<size_t, 2>;
+using Index = uint32_t;
+
+private:
+
+    struct Candidate {
+        T sqrLength;
+        Index a, b;
+
+        ///ties are broken by the points, so the tree is unique and doesn't depend on the number of threads
+        inline bool operator<(const Candidate &other) const {
+            return sqrLength < other.sqrLength
+                || (sqrLength == other.sqrLength && (a < other.a || (a == other.a && b < other.b)));
+        }
+    };
+
+    ///access to the half edges of the triangulation
+    class Mesh : public Delaunay<T> {
+
+    using Base = Delaunay<T>;
+
+    public:
+        Mesh(const PointCloudView<T> &points, size_t nThreads) :
+            Base(points, nThreads) {}
+
+        ///the edges of the triangulation which may be within the tree, and the duplicates connected to their equal points
+        ///the longest edge of a triangle is the longest one of a cycle, so it can't be within the tree
+        void candidates(const PointCloudView<T> &points, std::vector<Candidate> &result, size_t nThreads) const {
+            const size_t nHalfEdges = 3 * this->nReal;
+            std::vector<char> longest(nHalfEdges, false);
+            parallel_for(this->nReal, n_chunks(this->nReal, nThreads), [&](size_t t) {
+                size_t worst = 3*t;
+                Candidate worstEdge = edge(points, worst);
+                for(size_t he = 3*t + 1; he < 3*t + 3; ++he) {
+                    const Candidate e = edge(points, he);
+                    if(worstEdge < e) {
+                        worst = he;
+                        worstEdge = e;
+                    }
+                }
+                longest[worst] = true;
+            });
+
+            const size_t nChunks = n_chunks(nHalfEdges, nThreads);
+            std::vector<std::vector<Candidate>> chunkCandidates(nChunks);
+            parallel_chunks(nHalfEdges, nChunks, [&](size_t first, size_t last, size_t chunk) {
+                for(size_t he = first; he < last; ++he) {
+                    const size_t twin = this->twins[he];
+                    if(twin > he && !longest[he] && (twin >= nHalfEdges || !longest[twin]))
+                        chunkCandidates[chunk].push_back(edge(points, he));
+                }
+            });
+
+            const Topology<2> &duplicates = this->duplicates();
+            size_t n = duplicates.n_elements();
+            for(const auto &c : chunkCandidates)
+                n += c.size();
+            result.reserve(n);
+            for(const auto &c : chunkCandidates)
+                result.insert(result.end(), c.begin(), c.end());
+            for(size_t i = 0; i < duplicates.n_elements(); ++i)
+                result.push_back(candidate(points, duplicates[i][0], duplicates[i][1]));
+        }
+
+    private:
+        inline Candidate edge(const PointCloudView<T> &points, size_t he) const {
+            return candidate(points, this->ids[this->vertices[he]], this->ids[this->vertices[Base::next(he)]]);
+        }
+    };
+
+    size_t nPoints;
+    Topology<2> tree; //sorted by length
+    std::vector<T> lengths;
+
+//------------------------------------------------------------------------------
+
+public:
+
+    ///the Delaunay triangulation is computed with nThreads, the candidate edges are sorted with as many
+    explicit MinimumSpanningTree(const PointCloudView<T> &points, size_t nThreads = 0) :
+        nPoints(points.size()) {
+
+        std::vector<Candidate> candidates;
+        {
+            const Mesh mesh(points, nThreads);
+            if(mesh.n_triangles() > 0)
+                mesh.candidates(points, candidates, nThreads);
+            else
+                collinear_candidates(points, candidates);
+        }
+        parallel_sort(candidates.begin(), candidates.end(), std::less<Candidate>(), nThreads);
+
+        //Kruskal
+        DisjointSets sets(nPoints);
+        tree.reserve_elements(nPoints > 0 ? nPoints - 1 : 0);
+        lengths.reserve(nPoints > 0 ? nPoints - 1 : 0);
+        for(const auto &c : candidates) {
+            if(sets.n_sets() <= 1)
+                break;
+            if(sets.unite(c.a, c.b)) {
+                tree.push_back(Element{{c.a, c.b}});
+                lengths.push_back(std::sqrt(c.sqrLength));
+            }
+        }
+    }
+
+//------------------------------------------------------------------------------
+
+    size_t n_points() const {
+        return nPoints;
+    }
+
+    ///the n - 1 edges of the tree as indices of the points, sorted by length
+    const Topology<2>& edges() const {
+        return tree;
+    }
+
+    ///the length of each edge
+    const std::vector<T>& edge_lengths() const {
+        return lengths;
+    }
+
+    ///sum of the lengths of all edges
+    T length() const {
+        return std::accumulate(lengths.begin(), lengths.end(), T(0));
+    }
+
+//------------------------------------------------------------------------------
+
+    ///single linkage clustering, points are within the same cluster if they are connected by steps of at most maxDistance
+    ///labels are the index of the cluster of each point, numbered in the order of their first point, returns the number of clusters
+    size_t single_linkage(T maxDistance, std::vector<size_t> &labels) const {
+        DisjointSets sets(nPoints);
+        const size_t nEdges = std::upper_bound(lengths.begin(), lengths.end(), maxDistance) - lengths.begin();
+        for(size_t i = 0; i < nEdges; ++i)
+            sets.unite(tree[i][0], tree[i][1]);
+        return sets.labels(labels);
+    }
+
+    ///the clusters of single linkage clustering with exactly nClusters (or as many points, if there are less)
+    ///the tree is cut at its nClusters - 1 longest edges
+    size_t single_linkage_n(size_t nClusters, std::vector<size_t> &labels) const {
+        DisjointSets sets(nPoints);
+        const size_t nEdges = nClusters < nPoints ? nPoints - std::max(nClusters, size_t(1)) : 0;
+        for(size_t i = 0; i < nEdges && i < tree.n_elements(); ++i)
+            sets.unite(tree[i][0], tree[i][1]);
+        return sets.labels(labels);
+    }
+
+//------------------------------------------------------------------------------
+
+private:
+
+    static inline Candidate candidate(const PointCloudView<T> &points, size_t a, size_t b) {
+        if(a > b)
+            std::swap(a, b);
+        return Candidate{points[a].sqr_distance_to(points[b]), Index(a), Index(b)};
+    }
+
+    ///without a triangulation all points are on a line, the tree connects them in their order along it
+    static void collinear_candidates(const PointCloudView<T> &points, std::vector<Candidate> &candidates) {
+        std::vector<size_t> order(points.size());
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::sort(order.begin(), order.end(), [&points](size_t lhs, size_t rhs) {
+            return points[lhs].x < points[rhs].x || (points[lhs].x == points[rhs].x && points[lhs].y < points[rhs].y);
+        });
+        for(size_t i = 1; i < order.size(); ++i)
+            candidates.push_back(candidate(points, order[i-1], order[i]));
+    }
+};
+
+} //lib_2d
+
+#endif // MINIMUMSPANNINGTREE_H_INCLUDED
@@ -0,0 +1,287 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    OnlineHull.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class OnlineHull, a convex hull over the ids of a PointCloud which is kept up to date while points are added
+ *          the lower and upper chain are stored as ordered maps, so inserting a point is O(log n) amortized
+ *          removing a point which is a vertex of the hull rebuilds the hull from all remaining points
+ */
+
+#ifndef ONLINEHULL_H_INCLUDED
+#define ONLINEHULL_H_INCLUDED
+
+#include <map>
+#include <vector>
+#include <memory>
+#include <iterator>
+#include <stdexcept>
+
+#include "Point.h"
+#include "PointCloud.h"
+#include "OrderedPointCloud.h"
+#include "calc.h"
+
+namespace lib_2d {
+
+template <typename T>
+class OnlineHull {
+
+private:
+
+//------------------------------------------------------------------------------
+
+    ///one monotone chain of the hull, ordered by x
+    ///the upper chain is stored as lower chain of the points mirrored at the x axis (sign = -1)
+    class Chain {
+        std::map<T, size_t> vertices; //x -> id
+        const PointCloud<T> *pc;
+        T sign;
+
+        using Iterator = typename std::map<T, size_t>::iterator;
+
+        inline Point<T> point(size_t id) const {
+            const Point<T> &p = (*pc)[id];
+            return Point<T>{p.x, sign * p.y};
+        }
+
+        static inline T ccw(const Point<T> &a, const Point<T> &b, const Point<T> &c) {
+            return cross(vect(a, b), vect(a, c));
+        }
+
+    public:
+        Chain(const PointCloud<T> *pc, T sign) :
+            pc(pc),
+            sign(sign) {}
+
+        void clear() {
+            vertices.clear();
+        }
+
+        size_t size() const {
+            return vertices.size();
+        }
+
+        size_t front() const {
+            return vertices.begin()->second;
+        }
+
+        size_t back() const {
+            return vertices.rbegin()->second;
+        }
+
+        bool has_vertex(size_t id) const {
+            auto it = vertices.find((*pc)[id].x);
+            return it != vertices.end() && it->second == id;
+        }
+
+        ///adds the point to the chain, returns false if it lies above (or on) the chain
+        bool insert(size_t id) {
+            const Point<T> p = point(id);
+            Iterator it = vertices.lower_bound(p.x);
+
+            if(it != vertices.end() && it->first == p.x) {
+                if(point(it->second).y <= p.y)
+                    return false;
+                it = vertices.erase(it); //p is below the vertex with the same x
+            }
+            else if(it != vertices.end() && it != vertices.begin()) {
+                if(ccw(point(std::prev(it)->second), point(it->second), p) >= 0)
+                    return false; //above the segment of its neighbours
+            }
+
+            it = vertices.insert(it, std::make_pair(p.x, id));
+
+            //remove the neighbours which aren't convex anymore
+            for(Iterator next = std::next(it); next != vertices.end() && std::next(next) != vertices.end(); next = std::next(it)) {
+                if(ccw(p, point(next->second), point(std::next(next)->second)) > 0)
+                    break;
+                vertices.erase(next);
+            }
+            while(it != vertices.begin() && std::prev(it) != vertices.begin()) {
+                Iterator prev = std::prev(it);
+                if(ccw(point(std::prev(prev)->second), point(prev->second), p) > 0)
+                    break;
+                vertices.erase(prev);
+            }
+            return true;
+        }
+
+        ///whether p lies on or above the chain (within its x range)
+        bool below(const Point<T> &original) const {
+            const Point<T> p{original.x, sign * original.y};
+            auto it = vertices.lower_bound(p.x);
+            if(it == vertices.end())
+                return false;
+            if(it->first == p.x)
+                return point(it->second).y <= p.y;
+            if(it == vertices.begin())
+                return false;
+            return ccw(point(std::prev(it)->second), point(it->second), p) >= 0;
+        }
+
+        ///the ids from left to right
+        template <typename F>
+        void for_each(F f) const {
+            for(const auto &v : vertices)
+                f(v.second);
+        }
+
+        template <typename F>
+        void for_each_reversed(F f) const {
+            for(auto it = vertices.rbegin(); it != vertices.rend(); ++it)
+                f(it->second);
+        }
+    };
+
+//------------------------------------------------------------------------------
+
+    std::shared_ptr<PointCloud<T>> pc;
+
+    Chain
+        lower,
+        upper;
+
+    std::vector<char> indexed; //per id of the parent
+
+    size_t nIndexed;
+
+//------------------------------------------------------------------------------
+
+public:
+    OnlineHull& operator=(const OnlineHull&) = delete;
+    OnlineHull(const OnlineHull&) = delete;
+
+//------------------------------------------------------------------------------
+
+    ///if indexExisting is set, all points which already are part of pc are added to the hull
+    OnlineHull(std::shared_ptr<PointCloud<T>> pc, bool indexExisting = true) :
+        pc(pc),
+        lower(pc.get(), 1),
+        upper(pc.get(), -1),
+        nIndexed(0) {
+
+        if(indexExisting) {
+            for(size_t i = 0; i < pc->size(); ++i)
+                insert(i);
+        }
+    }
+
+//------------------------------------------------------------------------------
+
+    ///number of points the hull was built from
+    size_t size() const {
+        return nIndexed;
+    }
+
+    ///number of vertices of the hull
+    size_t n_vertices() const {
+        if(lower.size() == 0)
+            return 0;
+        size_t n = lower.size() + upper.size();
+        if((*pc)[lower.front()] == (*pc)[upper.front()])
+            --n;
+        if(n > 1 && (*pc)[lower.back()] == (*pc)[upper.back()])
+            --n;
+        return n;
+    }
+
+    std::shared_ptr<PointCloud<T>> get_parent() const {
+        return pc;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///appends the point to the parent and adds it to the hull, returns whether the hull changed
+    bool insert(const Point<T> &p) {
+        pc->push_back(p);
+        return insert(pc->size() - 1);
+    }
+
+    ///adds a point of the parent to the hull, O(log n) amortized, returns whether the hull changed
+    bool insert(size_t id) {
+        if(id >= pc->size())
+            throw std::out_of_range ("OnlineHull can't add a point which isn't part of its parent");
+        if(indexed.size() < pc->size())
+            indexed.resize(pc->size(), 0);
+        if(indexed[id])
+            return false;
+
+        indexed[id] = 1;
+        ++nIndexed;
+        bool changedLower = lower.insert(id);
+        bool changedUpper = upper.insert(id);
+        return changedLower || changedUpper;
+    }
+
+    ///removes a point from the hull (it stays part of the parent), returns whether the hull changed
+    ///removing a vertex of the hull rebuilds it from all remaining points
+    bool remove(size_t id) {
+        if(id >= indexed.size() || !indexed[id])
+            return false;
+
+        indexed[id] = 0;
+        --nIndexed;
+        if(!lower.has_vertex(id) && !upper.has_vertex(id))
+            return false;
+
+        lower.clear();
+        upper.clear();
+        for(size_t i = 0; i < indexed.size(); ++i) {
+            if(indexed[i]) {
+                lower.insert(i);
+                upper.insert(i);
+            }
+        }
+        return true;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///whether p lies within the hull (or on its border), O(log n)
+    bool is_inside(const Point<T> &p) const {
+        return lower.below(p) && upper.below(p);
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the current hull as ids into the parent, counter clockwise starting at the smallest point (by x, then y)
+    std::unique_ptr<OrderedPointCloud<T>> hull(bool closePath = true) const {
+        auto out = std::unique_ptr<OrderedPointCloud<T>>(new OrderedPointCloud<T>());
+        out->set_parent(pc);
+        if(lower.size() == 0)
+            return out;
+
+        std::vector<size_t> ids;
+        ids.reserve(n_vertices() + 1);
+        lower.for_each([&ids](size_t id) { ids.push_back(id); });
+        upper.for_each_reversed([&](size_t id) {
+            if(!((*pc)[id] == (*pc)[ids.back()]) && !((*pc)[id] == (*pc)[ids.front()]))
+                ids.push_back(id);
+        });
+
+        for(auto id : ids)
+            out->push_back_id(id);
+        if(closePath)
+            out->push_back_id(ids[0]);
+        return out;
+    }
+};
+
+} //lib_2d
+
+#endif // ONLINEHULL_H_INCLUDED
@@ -55,7 +55,7 @@ public:
     }
 
     OrderedPointCloud(std::shared_ptr<PointCloud<T> > points, Topology<1> top) :
-        topology(top),
+        topology(std::move(top)),
         pc(points) {}
 
 //------------------------------------------------------------------------------
@@ -73,8 +73,10 @@ public:
 
     PointCloud<T> as_pointcloud() const {
         PointCloud<T> result;
+        result.reserve(topology.n_elements());
         for (size_t i = 0; i < topology.n_elements(); ++i)
             result.push_back(get_tpoint(i));
+        return result;
     }
 
 //------------------------------------------------------------------------------
@@ -82,19 +84,19 @@ public:
     ///@todo remove from PC once solely used from here
     OrderedPointCloud& sort_x() {
         std::sort(topology.begin(), topology.end(),
-            [this](Element lhs, Element rhs){return get_point(lhs[0]).x < get_point(rhs[0]).x; });
+            [this](const Element &lhs, const Element &rhs){return get_point(lhs[0]).x < get_point(rhs[0]).x; });
         return *this;
     }
 
     OrderedPointCloud& sort_y() {
         std::sort(topology.begin(), topology.end(),
-            [this](Element lhs, Element rhs){return get_point(lhs[0]).y < get_point(rhs[0]).y; });
+            [this](const Element &lhs, const Element &rhs){return get_point(lhs[0]).y < get_point(rhs[0]).y; });
         return *this;
     }
 
 //------------------------------------------------------------------------------
 
-    inline Point<T> first() const {
+    inline const Point<T>& first() const {
         return get_tpoint(0);
     }
 
@@ -102,7 +104,7 @@ public:
         return topology[0][0];
     }
 
-    inline Point<T> last() const {
+    inline const Point<T>& last() const {
         return get_tpoint(topology.n_elements() - 1);
     }
 
@@ -144,18 +146,18 @@ public:
         return topology[i][0];
     }
 
-    inline Point<T> get_tpoint(size_t tId) const {
+    inline const Point<T>& get_tpoint(size_t tId) const {
         return get_point(topology[tId][0]);
     }
 
-    inline Point<T> get_point(size_t pId) const {
+    inline const Point<T>& get_point(size_t pId) const {
         return (*pc)[pId];
     }
 
 //------------------------------------------------------------------------------
 
     ///@todo add all other analog methods and return this
-    inline void push_back(Point<T> p) {
+    inline void push_back(const Point<T> &p) {
         pc->push_back(p);
         push_back_id(pc->size() - 1);
     }
@@ -186,27 +188,27 @@ public:
 
 //------------------------------------------------------------------------------
 
-    typename std::vector <Element>::iterator begin() {
+    typename Topology<1>::Elements::iterator begin() {
         return topology.begin();
     }
 
-    typename std::vector <Element>::iterator end() {
+    typename Topology<1>::Elements::iterator end() {
         return topology.end();
     }
 
-    typename std::vector <Element>::const_iterator cbegin() const {
+    typename Topology<1>::Elements::const_iterator cbegin() const {
         return topology.cbegin();
     }
 
-    typename std::vector <Element>::const_iterator cend() const {
+    typename Topology<1>::Elements::const_iterator cend() const {
         return topology.cend();
     }
 
-    typename std::vector <Element>::reverse_iterator rbegin() {
+    typename Topology<1>::Elements::reverse_iterator rbegin() {
         return topology.rbegin();
     }
 
-    typename std::vector <Element>::reverse_iterator rend() {
+    typename Topology<1>::Elements::reverse_iterator rend() {
         return topology.rend();
     }
 };
@@ -0,0 +1,284 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    PathDistance.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class PathDistance, similarity measures between paths (Hausdorff, discrete and continuous Fréchet distance)
+ *          all of them accept a bound, as soon as the distance is known to exceed it they return early with a value larger than the bound
+ */
+
+#ifndef PATHDISTANCE_H_INCLUDED
+#define PATHDISTANCE_H_INCLUDED
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+#include "Point.h"
+#include "PointCloudView.h"
+#include "PointCloud.h"
+#include "OrderedPointCloud.h"
+#include "KdTree.h"
+
+namespace lib_2d {
+
+template <typename T>
+class PathDistance {
+
+public:
+
+//------------------------------------------------------------------------------
+
+    ///max over all points of from of the distance to their nearest neighbour within to
+    ///points are visited in a scattered order and skipped if to has any point within the current maximum (Taha and Hanbury)
+    ///returns as soon as the maximum exceeds bound, lowerBound is used as initial maximum
+    static T directed_hausdorff(const PointCloudView<T> &from, const KdTree<T> &to, T bound = std::numeric_limits<T>::max(), T lowerBound = 0) {
+        return directed_hausdorff(from.size(), [&from](size_t i) { return from[i]; }, to, bound, lowerBound);
+    }
+
+    ///symmetric Hausdorff distance between the points of both trees
+    static T hausdorff(const KdTree<T> &a, const KdTree<T> &b, T bound = std::numeric_limits<T>::max()) {
+        const OrderedPointCloud<T> &pa = *a.get_parent();
+        const OrderedPointCloud<T> &pb = *b.get_parent();
+        T distance = directed_hausdorff(pa.n_elements(), [&pa](size_t i) { return pa.get_tpoint(i); }, b, bound, 0);
+        if(distance > bound)
+            return distance;
+        return directed_hausdorff(pb.n_elements(), [&pb](size_t i) { return pb.get_tpoint(i); }, a, bound, distance);
+    }
+
+    ///builds the trees, prefer the overload taking the trees if one path is compared several times
+    static T hausdorff(std::shared_ptr<PointCloud<T>> a, std::shared_ptr<PointCloud<T>> b, T bound = std::numeric_limits<T>::max()) {
+        const KdTree<T>
+            treeA(std::make_shared<OrderedPointCloud<T>>(a)),
+            treeB(std::make_shared<OrderedPointCloud<T>>(b));
+        return hausdorff(treeA, treeB, bound);
+    }
+
+//------------------------------------------------------------------------------
+
+    ///discrete Fréchet distance (Eiter and Mannila) in O(n m) time and O(m) memory
+    ///every coupling passes each row, so the minimum of a row is a lower bound and the computation stops once it exceeds bound
+    static T discrete_frechet(const PointCloudView<T> &a, const PointCloudView<T> &b, T bound = std::numeric_limits<T>::max()) {
+        check_paths(a, b);
+        const size_t
+            n = a.size(),
+            m = b.size();
+
+        std::vector<T>
+            previous(m),
+            current(m);
+
+        for(size_t i = 0; i < n; ++i) {
+            T rowMin = std::numeric_limits<T>::max();
+            for(size_t j = 0; j < m; ++j) {
+                const T d = a[i].distance_to(b[j]);
+                T reachable;
+                if(i == 0 && j == 0)
+                    reachable = d;
+                else if(i == 0)
+                    reachable = std::max(current[j-1], d);
+                else if(j == 0)
+                    reachable = std::max(previous[0], d);
+                else
+                    reachable = std::max(std::min(std::min(previous[j], previous[j-1]), current[j-1]), d);
+                current[j] = reachable;
+                rowMin = std::min(rowMin, reachable);
+            }
+            if(rowMin > bound)
+                return rowMin;
+            std::swap(previous, current);
+        }
+        return previous[m-1];
+    }
+
+//------------------------------------------------------------------------------
+
+    ///decision procedure of the continuous Fréchet distance (Alt and Godau) in O(n m), whether a monotone coupling within maxDistance exists
+    ///the reachable parts of the free space are propagated column by column, it stops as soon as nothing is reachable anymore
+    static bool frechet_within(const PointCloudView<T> &a, const PointCloudView<T> &b, T maxDistance) {
+        check_paths(a, b);
+        const size_t
+            n = a.size(),
+            m = b.size();
+
+        if(a.first().distance_to(b.first()) > maxDistance || a.last().distance_to(b.last()) > maxDistance)
+            return false;
+        if(n == 1)
+            return max_distance_to_vertices(a.first(), b) <= maxDistance;
+        if(m == 1)
+            return max_distance_to_vertices(b.first(), a) <= maxDistance;
+
+        //left edges of the cells within the current column (point a[i] against segment j of b)
+        std::vector<Interval> left(m - 1);
+        bool open = true;
+        for(size_t j = 0; j + 1 < m; ++j) {
+            Interval free = free_interval(a[0], b[j], b[j+1], maxDistance);
+            left[j] = (open && free.start <= 0) ? free : Interval();
+            open = !left[j].empty() && left[j].end >= 1;
+        }
+
+        Interval firstBottom = free_interval(b[0], a[0], a[1], maxDistance);
+        if(firstBottom.start > 0)
+            firstBottom = Interval();
+
+        for(size_t i = 0; i + 1 < n; ++i) {
+            //bottom edge of cell (i, 0), segment i of a against b[0]
+            if(i > 0) {
+                Interval free = free_interval(b[0], a[i], a[i+1], maxDistance);
+                firstBottom = (!firstBottom.empty() && firstBottom.end >= 1 && free.start <= 0) ? free : Interval();
+            }
+            Interval bottom = firstBottom;
+            bool any = !bottom.empty();
+
+            for(size_t j = 0; j + 1 < m; ++j) {
+                const Interval freeRight = free_interval(a[i+1], b[j], b[j+1], maxDistance);
+                const Interval freeTop = free_interval(b[j+1], a[i], a[i+1], maxDistance);
+
+                Interval right, top;
+                if(!bottom.empty())
+                    right = freeRight;
+                else if(!left[j].empty())
+                    right = freeRight.clipped(left[j].start);
+
+                if(!left[j].empty())
+                    top = freeTop;
+                else if(!bottom.empty())
+                    top = freeTop.clipped(bottom.start);
+
+                left[j] = right;
+                bottom = top;
+                any = any || !right.empty() || !top.empty();
+            }
+            if(!any)
+                return false;
+        }
+        return !left[m-2].empty() && left[m-2].end >= 1;
+    }
+
+    ///continuous Fréchet distance, found by bisection of the decision procedure between the distance of the end points and the discrete Fréchet distance
+    ///returns early with a value larger than bound if the distance exceeds it
+    static T frechet(const PointCloudView<T> &a, const PointCloudView<T> &b, T relativeTolerance = 1e-6, T bound = std::numeric_limits<T>::max()) {
+        check_paths(a, b);
+        T lower = std::max(a.first().distance_to(b.first()), a.last().distance_to(b.last()));
+        if(lower > bound)
+            return lower;
+
+        T upper = discrete_frechet(a, b, bound); //the discrete distance is an upper bound of the continuous one
+        if(upper > bound) {
+            if(!frechet_within(a, b, bound))
+                return upper;
+            upper = bound;
+        }
+        while(upper - lower > relativeTolerance * upper) {
+            const T mid = (lower + upper) / 2;
+            if(mid <= lower || mid >= upper)
+                break;
+            if(frechet_within(a, b, mid))
+                upper = mid;
+            else
+                lower = mid;
+        }
+        return upper;
+    }
+
+//------------------------------------------------------------------------------
+
+private:
+
+    ///part [start, end] of a segment which is within a distance, empty if start > end
+    struct Interval {
+        T start = 1, end = 0;
+
+        Interval() {}
+        Interval(T start, T end) :
+            start(start), end(end) {}
+
+        inline bool empty() const {
+            return start > end;
+        }
+
+        inline Interval clipped(T minStart) const {
+            return Interval(std::max(start, minStart), end);
+        }
+    };
+
+    static void check_paths(const PointCloudView<T> &a, const PointCloudView<T> &b) {
+        if(a.empty() || b.empty())
+            throw std::out_of_range ("PathDistance requires non-empty paths");
+    }
+
+    static T max_distance_to_vertices(const Point<T> &p, const PointCloudView<T> &path) {
+        T maxDistance(0);
+        for(const auto &q : path)
+            maxDistance = std::max(maxDistance, p.distance_to(q));
+        return maxDistance;
+    }
+
+    ///parameters t within [0, 1] for which s + t * (e - s) is within distance of p
+    static Interval free_interval(const Point<T> &p, const Point<T> &s, const Point<T> &e, T distance) {
+        const T
+            dx = e.x - s.x,
+            dy = e.y - s.y,
+            fx = s.x - p.x,
+            fy = s.y - p.y,
+            qa = dx * dx + dy * dy,
+            qb = 2 * (dx * fx + dy * fy),
+            qc = fx * fx + fy * fy - distance * distance;
+
+        if(qa == 0)
+            return qc <= 0 ? Interval(0, 1) : Interval();
+
+        const T discriminant = qb * qb - 4 * qa * qc;
+        if(discriminant < 0)
+            return Interval();
+
+        const T root = std::sqrt(discriminant);
+        return Interval(std::max(T(0), (-qb - root) / (2 * qa)), std::min(T(1), (-qb + root) / (2 * qa)));
+    }
+
+    template <typename Get>
+    static T directed_hausdorff(size_t n, Get get, const KdTree<T> &to, T bound, T lowerBound) {
+        if(n == 0)
+            return lowerBound;
+        if(to.size() == 0)
+            throw std::out_of_range ("PathDistance requires non-empty paths");
+
+        const PointCloud<T> &points = *(to.get_parent()->get_parent());
+
+        //consecutive points of paths are close to each other, a stride coprime to n scatters them
+        const size_t prime = 7919;
+        const size_t stride = n % prime == 0 ? 1 : prime;
+
+        T maxDistance = lowerBound;
+        for(size_t k = 0, i = 0; k < n; ++k, i = (i + stride) % n) {
+            const Point<T> p = get(i);
+            if(to.any_within(p, maxDistance))
+                continue;
+            maxDistance = p.distance_to(points[to.nearest(p)]);
+            if(maxDistance > bound)
+                return maxDistance;
+        }
+        return maxDistance;
+    }
+};
+
+} //lib_2d
+
+#endif // PATHDISTANCE_H_INCLUDED
@@ -101,6 +101,14 @@ public:
         return *this;
     }
 
+//------------------------------------------------------------------------------
+
+    Point& scale(T factor, Point center = Point{}) {
+        x = center.x + factor * (x - center.x);
+        y = center.y + factor * (y - center.y);
+        return *this;
+    }
+
 //------------------------------------------------------------------------------
 
     std::string to_string(std::string divider = " ") const {
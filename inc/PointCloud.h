@@ -29,16 +29,22 @@
 #include <fstream>
 #include <algorithm>
 #include <utility>
+#include <functional>
 
 #include "Point.h"
+#include "PointCloudView.h"
+#include "MemoryResource.h"
 
 namespace lib_2d {
 
 template <typename T>
 class PointCloud {
 
+public:
+    using Points = std::vector < Point <T>, ResourceAllocator < Point <T> > >;
+
 protected:
-    std::vector < Point <T> > ps;
+    Points ps;
 
     T ccw(const Point<T> &p1,const Point<T> &p2, const Point<T> &p3) const { ///@todo move somewhere else
         return (p2.x - p1.x)*(p3.y - p1.y) - (p2.y - p1.y)*(p3.x - p1.x);
@@ -51,6 +57,10 @@ public:
         reserve(nPoints);
     }
 
+    ///all points of this PointCloud will be allocated from 'resource' (which has to outlive it)
+    explicit PointCloud(MemoryResource *resource) :
+        ps(ResourceAllocator< Point<T> >(resource)){}
+
     template<class InputIterator>
     PointCloud(InputIterator first, InputIterator last) {
         while(first != last) {
@@ -60,16 +70,36 @@ public:
     }
 
     PointCloud(const std::vector < Point <T> > &points) :
-        ps(points){}
+        ps(points.cbegin(), points.cend()){}
+
+    explicit PointCloud(const PointCloudView<T> &view) :
+        ps(view.cbegin(), view.cend()){}
 
     ~PointCloud(){}
 
+    //the user declared destructor would otherwise suppress moving
+    PointCloud(const PointCloud&) = default;
+    PointCloud(PointCloud&&) = default;
+    PointCloud& operator=(const PointCloud&) = default;
+    PointCloud& operator=(PointCloud&&) = default;
+
 //------------------------------------------------------------------------------
 
-    Point<T> get_point(unsigned int i) const {
+    const Point<T>& get_point(unsigned int i) const {
         return ps[i];
     }
 
+//------------------------------------------------------------------------------
+
+    PointCloudView<T> view() const {
+        return PointCloudView<T>(ps.data(), ps.size());
+    }
+
+    ///zero-copy version of range(indexStart, indexEnd), only valid until this PointCloud reallocates
+    PointCloudView<T> view(size_t indexStart, size_t indexEnd, size_t step = 1) const {
+        return view().slice(indexStart, indexEnd, step);
+    }
+
 //-----remove-------------------------------------------------------------------------
 
     PointCloud& move_by(T x, T y) {
@@ -136,6 +166,14 @@ public:
         return *this;
     }
 
+//------------------------------------------------------------------------------
+
+    PointCloud& scale(T factor, Point<T> center = Point<T>{}) {
+        for(auto &p : ps)
+            p.scale(factor, center);
+        return *this;
+    }
+
 //------------------------------------------------------------------------------
 
     std::string to_string(std::string divider = " ") const {
@@ -188,7 +226,7 @@ public:
 
 //------------------------------------------------------------------------------
 
-    PointCloud& push_back(Point<T> point) {
+    PointCloud& push_back(const Point<T> &point) {
         ps.push_back(point);
         return *this;
     }
@@ -199,12 +237,45 @@ public:
     }
 
     PointCloud& push_back(const PointCloud &other) {
-        ps.reserve( ps.size() + other.size() );
+        grow_for(other.size());
+        if(&other == this) { //appending to itself, the range would be changed while inserting it
+            const size_t n = ps.size();
+            for(size_t i = 0; i < n; ++i)
+                ps.push_back(ps[i]);
+            return *this;
+        }
+        ps.insert( ps.end(), other.cbegin(), other.cend() );
+        return *this;
+    }
+
+    ///takes over the buffer of other if this is empty
+    PointCloud& push_back(PointCloud &&other) {
+        if(&other == this)
+            return push_back(static_cast<const PointCloud&>(other));
+        if(ps.empty())
+            ps = std::move(other.ps);
+        else
+            push_back(other);
+        other.clear();
+        return *this;
+    }
+
+    PointCloud& push_back(const PointCloudView<T> &other) {
+        if(other.empty())
+            return *this;
+        std::less<const Point<T>*> less;
+        if(ps.capacity() < ps.size() + other.size()
+           && !less(&other.first(), ps.data()) && less(&other.first(), ps.data() + ps.size())) { //view into this, reallocating would invalidate it
+            std::vector < Point <T> > tmp(other.cbegin(), other.cend());
+            ps.insert( ps.end(), tmp.cbegin(), tmp.cend() );
+            return *this;
+        }
+        grow_for(other.size());
         ps.insert( ps.end(), other.cbegin(), other.cend() );
         return *this;
     }
 
-    PointCloud& emplace_back(Point<T> point) {
+    PointCloud& emplace_back(const Point<T> &point) {
         ps.emplace_back(point);
         return *this;
     }
@@ -215,9 +286,11 @@ public:
     }
 
     PointCloud& emplace_back(const PointCloud &other) {
-        ps.reserve( ps.size() + other.size() );
-        ps.insert( ps.end(), other.cbegin(), other.cend() );
-        return *this;
+        return push_back(other);
+    }
+
+    PointCloud& emplace_back(PointCloud &&other) {
+        return push_back(std::move(other));
     }
 
 //------------------------------------------------------------------------------
@@ -236,140 +309,53 @@ public:
 //------------------------------------------------------------------------------
 
     T length() const {
-        if(size() < 2)
-            return 0;
-        T l(0);
-
-        for(auto i = ps.cbegin()+1; i != ps.cend(); ++i)
-            l += i->distance_to(*(i-1));
-
-        return l;
+        return view().length();
     }
 
 //------------------------------------------------------------------------------
 
-    Point<T> first() const {
+    const Point<T>& first() const {
         return ps[0];
     }
 
-    Point<T> last() const {
+    const Point<T>& last() const {
         return ps[size()-1];
     }
 
 //------------------------------------------------------------------------------
 
     T get_min_x() const {
-        if(size() == 0)
-            return 0; ///@todo find better error handling
-        T minX(ps[0].x);
-
-        for(auto p :ps) {
-            if(p.x < minX)
-                minX = p.x;
-        }
-        return minX;
+        return view().get_min_x();
     }
 
     T get_max_x() const {
-        if(size() == 0)
-            return 0; ///@todo find better error handling
-        T maxX(ps[0].x);
-
-        for(auto p :ps) {
-            if(p.x > maxX)
-                maxX = p.x;
-        }
-        return maxX;
+        return view().get_max_x();
     }
 
     T get_min_y() const {
-        if(size() == 0)
-            return 0; ///@todo find better error handling
-        T minY(ps[0].y);
-
-        for(auto p :ps) {
-            if(p.y < minY)
-                minY = p.y;
-        }
-        return minY;
+        return view().get_min_y();
     }
 
     T get_max_y() const {
-        if(size() == 0)
-            return 0; ///@todo find better error handling
-        T maxY(ps[0].y);
-
-        for(auto p :ps) {
-            if(p.y > maxY)
-                maxY = p.y;
-        }
-        return maxY;
+        return view().get_max_y();
     }
 
 //------------------------------------------------------------------------------
 
     int get_min_x_index() const {
-        if(size() == 0)
-            return -1;
-
-        unsigned int index(0);
-        T minX(ps[index].x);
-
-        for(unsigned int i = 0; i < size(); ++i) {
-            if(ps[i].x < minX) {
-                minX = ps[i].x;
-                index = i;
-            }
-        }
-        return index;
+        return view().get_min_x_index();
     }
 
     int get_max_x_index() const {
-        if(size() == 0)
-            return -1;
-
-        unsigned int index(0);
-        T maxX(ps[index].x);
-
-        for(unsigned int i = 0; i < size(); ++i) {
-            if(ps[i].x > maxX) {
-                maxX = ps[i].x;
-                index = i;
-            }
-        }
-        return index;
+        return view().get_max_x_index();
     }
 
     int get_min_y_index() const {
-        if(size() == 0)
-            return -1;
-
-        unsigned int index(0);
-        T minY(ps[index].y);
-
-        for(unsigned int i = 0; i < size(); ++i) {
-            if(ps[i].y < minY) {
-                minY = ps[i].y;
-                index = i;
-            }
-        }
-        return index;
+        return view().get_min_y_index();
     }
 
     int get_max_y_index() const {
-        if(size() == 0)
-            return -1;
-
-        unsigned int index(0);
-        T maxY(ps[index].y);
-
-        for(unsigned int i = 0; i < size(); ++i) {
-            if(ps[i].y > maxY) {
-                maxY = ps[i].y;
-                index = i;
-            }
-        }
-        return index;
+        return view().get_max_y_index();
     }
 
 //------------------------------------------------------------------------------
@@ -398,64 +384,52 @@ public:
 //------------------------------------------------------------------------------
 
     //Andrew's monotone chain convex hull algorithm
+    //both chains are built within one buffer, so no duplicates have to be removed afterwards
     PointCloud convex_hull(bool closePath = true) const { ///@todo move to factory and return topological pc
-        int n = size();
+        const size_t n = size();
         PointCloud<T> path = *this;
 
         std::sort(path.begin(), path.end());
 
-        PointCloud<T> lower;
-        for (int i = 0; i < n; ++i) {
-            while (lower.size() >= 2 && ccw(lower[lower.size()-2], lower[lower.size()-1], path[i]) <= 0)
-                lower.pop_back();
-            lower.push_back(path[i]);
+        if(n < 3) {
+            path.ps.erase(std::unique(path.begin(), path.end()), path.end());
         }
-
-        PointCloud<T> upper;
-        for (int i = n-1; i >= 0; i--) {
-            while (upper.size() >= 2 && ccw(upper[upper.size()-2], upper[upper.size()-1], path[i]) <= 0)
-                upper.pop_back();
-            upper.push_back(path[i]);
+        else {
+            Points hull(2 * n, Point<T>{}, path.ps.get_allocator());
+            size_t k(0);
+            for(size_t i = 0; i < n; ++i) { //lower chain
+                while(k >= 2 && ccw(hull[k-2], hull[k-1], path[i]) <= 0)
+                    --k;
+                hull[k++] = path[i];
+            }
+            for(size_t i = n - 1, lower = k + 1; i > 0; --i) { //upper chain
+                while(k >= lower && ccw(hull[k-2], hull[k-1], path[i-1]) <= 0)
+                    --k;
+                hull[k++] = path[i-1];
+            }
+            hull.resize(k - 1); //the last point equals the first one
+            path.ps.swap(hull);
         }
 
-        PointCloud<T> output;
-        output.push_back(lower);
-        output.push_back(upper);
-        output.make_unique();
-
-        if(closePath)
-            output.push_back(output[0]);
-        return output;
+        if(closePath && !path.empty())
+            path.push_back(path[0]);
+        return path;
     }
 
 //------------------------------------------------------------------------------
 
-#ifdef LIB_2D_EXPERIMENTAL
-    bool point_is_inside(const Point<T> &point) {
-        if(size() <= 2)
-            return false;
-
-        auto pointOutside = ps[get_min_y_index()]; //lowest point
-        pointOutside.move_by(1, -1); //move down, certainly outside now
-
-        Path<T> ray = Path<T>();
-        ray += pointOutside;
-        ray += point;
-
-        auto intersections = intersections_with(ray);
-
-        std::cout << pointOutside << std::endl;
-
-        std::cout << intersections << std::endl;
+    int winding_number(const Point<T> &p) const {
+        return view().winding_number(p);
+    }
 
-        unsigned int nIntersections = intersections.size();
+    bool point_is_on_border(const Point<T> &p) const {
+        return view().point_is_on_border(p);
+    }
 
-        if (nIntersections % 2)
-            return true;
-        else
-            return false;
+    bool point_is_inside(const Point<T> &p) const {
+        return view().point_is_inside(p);
     }
-#endif
+
 //------------------------------------------------------------------------------
 
     PointCloud& make_unique() { ///@todo use std::unique
@@ -491,21 +465,23 @@ public:
 
 //------------------------------------------------------------------------------
 
-    bool has_point(const Point<T> &point) {
-        for(const auto &p : ps) {
-            if(p.equal_to(point))
-                return true;
-        }
-        return false;
+    bool has_point(const Point<T> &point) const {
+        return view().has_point(point);
     }
 
 //------------------------------------------------------------------------------
 
-    bool has_point(T x, T y) {
+    bool has_point(T x, T y) const {
         return has_point(Point<T>{x, y});
     }
 
 //------------------------------------------------------------------------------
+    MemoryResource* get_resource() const {
+        return ps.get_allocator().get_resource();
+    }
+
+//------------------------------------------------------------------------------
+
     PointCloud& reserve(size_t i) {
         ps.reserve(i);
         return *this;
@@ -609,124 +585,60 @@ public:
 //------------------------------------------------------------------------------
 
     Point<T> center() const {
-        T
-            sumX(0.0),
-            sumY(0.0);
-
-        for(const auto &i : ps) {
-            sumX += i.x;
-            sumY += i.y;
-        }
-
-        return Point<T>{sumX / size(), sumY / size()};
+        return view().center();
     }
 
 //------------------------------------------------------------------------------
 
     int furthest_apart(const Point<T> &other) const {
-        T maxDistance(0);
-        int furthestIndex(-1);
-        for (unsigned int i = 0; i < size(); ++i) {
-            if(ps[i].sqr_distance_to(other) >= maxDistance) {
-                maxDistance = ps[i].sqr_distance_to(other);
-                furthestIndex = i;
-            }
-        }
-        return furthestIndex;
+        return view().furthest_apart(other);
     }
 
     int furthest_apart(T x, T y) const {
         return furthest_apart(Point<T>{x, y});
     }
 
-    int furthest_apart(const PointCloud &other) const {
-        T maxDistance(0);
-        int furthestIndex(-1);
-
-        for (unsigned int i = 0; i< size(); ++i) {
-            T distance = ps[i].sqr_distance_to( other[other.closest(ps[i])] );
-            if(maxDistance < distance) {
-                maxDistance = distance;
-                furthestIndex = i;
-            }
-        }
-        return furthestIndex;
+    int furthest_apart(const PointCloudView<T> &other) const {
+        return view().furthest_apart(other);
     }
 
 //------------------------------------------------------------------------------
 
     ///@todo remove all nearest methods since these should be performed by the kdtree
     int closest(const Point<T> &other) const {
-        int closestIndex(-1);
-        if(size() == 0)
-            return closestIndex;
-        T minDistance = ps[0].sqr_distance_to(other);
-        for (unsigned int i = 0; i < size(); ++i) {
-            if(ps[i].sqr_distance_to(other) <= minDistance) {
-                minDistance = ps[i].sqr_distance_to(other);
-                closestIndex = i;
-            }
-        }
-        return closestIndex;
+        return view().closest(other);
     }
 
     int closest(T x, T y) const {
         return closest(Point<T>{x, y});
     }
 
-    int closest(const PointCloud &other) const {
-        int closestIndex(-1);
-        if(size() == 0 || other.size() == 0)
-            return closestIndex;
-        T minDistance = ps[0].sqr_distance_to(other[0]);
-        for (unsigned int i = 0; i< size(); ++i) {
-            T distance = ps[i].sqr_distance_to( other[other.closest(ps[i])] );
-            if(minDistance > distance) {
-                minDistance = distance;
-                closestIndex = i;
-            }
-        }
-        return closestIndex;
+    int closest(const PointCloudView<T> &other) const {
+        return view().closest(other);
     }
 
 //------------------------------------------------------------------------------
 
-    bool similar_to(const PointCloud &other, T maxDistance) const {
-        if(size() != other.size())
-            return false;
-        for(unsigned int i = 0; i < size(); ++i) {
-            if(!ps[i].similar_to(other[i], maxDistance))
-                return false;
-        }
-        return true;
+    bool similar_to(const PointCloudView<T> &other, T maxDistance) const {
+        return view().similar_to(other, maxDistance);
     }
 
 //------------------------------------------------------------------------------
 
-    bool equal_to (const PointCloud &other) const {
-        if(size() != other.size())
-            return false;
-        for(unsigned int i = 0; i < size(); ++i) {
-            if(!ps[i].equal_to(other[i]))
-                return false;
-        }
-        return true;
+    bool equal_to (const PointCloudView<T> &other) const {
+        return view().equal_to(other);
     }
 
 //------------------------------------------------------------------------------
 
-    int index_of(const Point<T> &other) {
-        for(auto p = ps.cbegin(); p != ps.cend(); ++p) {
-                if (*p == other)
-                    return (p - ps.cbegin());
-        }
-        return -1;
+    int index_of(const Point<T> &other) const {
+        return view().index_of(other);
     }
 
 //------------------------------------------------------------------------------
 
     //this method should be kept similar to "intersects_with"
-    PointCloud intersections_with(const PointCloud &other) const { ///@todo should be moved to tpc
+    PointCloud intersections_with(const PointCloudView<T> &other) const { ///@todo should be moved to tpc
 
         PointCloud intersections;
 
@@ -736,9 +648,9 @@ public:
         if(!intersects_with(other)) //faster than checking for intersections
             return intersections;
 
-        for(auto i = ps.cbegin(); i != ps.cend()-1; ++i) {
-            for(auto j = other.cbegin(); j != other.cend()-1; ++j)
-                intersections.push_back(calc_intersections(*i, *(i+1), *j, *(j+1)));
+        for(size_t i = 0; i < size()-1; ++i) {
+            for(size_t j = 0; j < other.size()-1; ++j)
+                intersections.push_back(calc_intersections(ps[i], ps[i+1], other[j], other[j+1]));
         }
         return intersections;
     }
@@ -746,24 +658,17 @@ public:
 //------------------------------------------------------------------------------
 
     //this method should be kept similar to "intersections_with"
-    bool intersects_with(const PointCloud &other) const { ///@todo should be moved to tpc
+    bool intersects_with(const PointCloudView<T> &other) const { ///@todo should be moved to tpc
 
         if(size() < 2 || other.size() < 2)
             return false;
 
-        if(size() > 5 && other.size() > 5) { //prevent endless recursion
-            auto boundingBoxThis = bounding_box();
-            auto boundingBoxOther = other.bounding_box();
+        if(!view().bounding_boxes_overlap(other))
+            return false; //only can intersect if boundig boxes intersect
 
-            if(!boundingBoxThis.intersects_with(boundingBoxOther))
-                return false; //only can intersect if boundig boxes intersect
-        }
-
-        for(auto i = ps.cbegin(); i != ps.cend()-1; ++i) {
-            for(auto j = other.cbegin(); j != other.cend()-1; ++j) {
-                PointCloud<T> intersections;
-                intersections.push_back(calc_intersections(*i, *(i+1), *j, *(j+1)));
-                if(intersections.size() > 0)
+        for(size_t i = 0; i < size()-1; ++i) {
+            for(size_t j = 0; j < other.size()-1; ++j) {
+                if(calc_intersections(ps[i], ps[i+1], other[j], other[j+1]).size() > 0)
                     return true;
             }
         }
@@ -794,59 +699,63 @@ public:
         if(indexStart >= size() || indexEnd >= size())
             return *this;
 
-        if(indexStart == 0 && indexEnd == size()-1)
-            return *this;
-
-        PointCloud<T> tmp;
-
-        for(unsigned int i = indexStart; i <= indexEnd; ++i) {
-            tmp += (*this)[i];
-        }
-
-        *this = tmp;
+        ps.erase(ps.begin() + indexEnd + 1, ps.end());
+        ps.erase(ps.begin(), ps.begin() + indexStart);
         return *this;
     }
 
 //------------------------------------------------------------------------------
 
     PointCloud& reduce_points(T epsilon) {
-        *this = douglas_peucker(*this, epsilon);
+        if(size() < 3)
+            return *this;
+        std::vector<bool> keep(size(), false);
+        keep.front() = true;
+        keep.back()  = true;
+        douglas_peucker(view(), 0, size()-1, epsilon, keep);
+
+        size_t nKept(0);
+        for(size_t i = 0; i < size(); ++i) {
+            if(keep[i])
+                ps[nKept++] = ps[i];
+        }
+        ps.erase(ps.begin() + nKept, ps.end());
         return *this;
     }
 
 //------------------------------------------------------------------------------
 
-    typename std::vector <Point<T> >::iterator begin() {
+    typename Points::iterator begin() {
         return ps.begin();
     }
 
-    typename std::vector <Point<T> >::iterator end() {
+    typename Points::iterator end() {
         return ps.end();
     }
 
-    typename std::vector <Point<T> >::const_iterator cbegin() const {
+    typename Points::const_iterator cbegin() const {
         return ps.cbegin();
     }
 
-    typename std::vector <Point<T> >::const_iterator cend() const {
+    typename Points::const_iterator cend() const {
         return ps.cend();
     }
 
-    typename std::vector <Point<T> >::reverse_iterator rbegin() {
+    typename Points::reverse_iterator rbegin() {
         return ps.rbegin();
     }
 
-    typename std::vector <Point<T> >::reverse_iterator rend() {
+    typename Points::reverse_iterator rend() {
         return ps.rend();
     }
 
 //------------------------------------------------------------------------------
 
-    bool operator == (const PointCloud &other) const {
+    bool operator == (const PointCloudView<T> &other) const {
         return equal_to(other);
     }
 
-    bool operator != (const PointCloud &other) const {
+    bool operator != (const PointCloudView<T> &other) const {
         return !equal_to(other);
     }
 
@@ -855,24 +764,56 @@ public:
         return *this;
     }
 
-    PointCloud<T>& operator += (Point<T> other) {
+    PointCloud<T>& operator += (PointCloud<T> &&other) {
+        push_back(std::move(other));
+        return *this;
+    }
+
+    PointCloud<T>& operator += (const Point<T> &other) {
         push_back(other);
         return *this;
     }
 
-    PointCloud<T> operator + (const PointCloud<T> &other) const {
-        auto out = *this;
-        out.push_back(other);
+    //the result is allocated once, temporaries (e.g. within chains a + b + c) are appended to in place
+    PointCloud<T> operator + (const PointCloud<T> &other) const & {
+        PointCloud<T> out;
+        out.reserve(size() + other.size());
+        out.ps.insert(out.ps.end(), ps.cbegin(), ps.cend());
+        out.ps.insert(out.ps.end(), other.cbegin(), other.cend());
         return out;
     }
 
-    PointCloud<T> operator + (Point<T> other) const {
-        auto out = *this;
-        out.push_back(other);
+    PointCloud<T> operator + (const PointCloud<T> &other) && {
+        push_back(other);
+        return std::move(*this);
+    }
+
+    PointCloud<T> operator + (PointCloud<T> &&other) const & {
+        if(&other == this || other.ps.capacity() < size() + other.size())
+            return *this + static_cast<const PointCloud<T>&>(other);
+        other.ps.insert(other.ps.begin(), ps.cbegin(), ps.cend());
+        return std::move(other);
+    }
+
+    PointCloud<T> operator + (PointCloud<T> &&other) && {
+        push_back(std::move(other));
+        return std::move(*this);
+    }
+
+    PointCloud<T> operator + (const Point<T> &other) const & {
+        PointCloud<T> out;
+        out.reserve(size() + 1);
+        out.ps.insert(out.ps.end(), ps.cbegin(), ps.cend());
+        out.ps.push_back(other);
         return out;
     }
 
-    Point<T> operator [] (unsigned int i) const {
+    PointCloud<T> operator + (const Point<T> &other) && {
+        push_back(other);
+        return std::move(*this);
+    }
+
+    const Point<T>& operator [] (unsigned int i) const {
         return ps[i];
     }
 
@@ -881,7 +822,11 @@ public:
     }
 
     operator std::vector < Point <T> > () const {
-        return ps;
+        return std::vector < Point <T> >(ps.cbegin(), ps.cend());
+    }
+
+    operator PointCloudView<T> () const {
+        return view();
     }
 
 //------------------------------------------------------------------------------
@@ -893,6 +838,12 @@ public:
 
 private:
 
+    //reserves geometrically, so repeated appends stay amortized O(1) per point
+    inline void grow_for(size_t n) {
+        if(ps.capacity() < ps.size() + n)
+            ps.reserve(std::max(ps.size() + n, 2 * ps.capacity()));
+    }
+
     static bool compare_x(const Point<T> &lhs, const Point<T> &rhs) {
         return lhs.x < rhs.x;
     }
@@ -902,40 +853,24 @@ private:
     }
 
     //using http://en.wikipedia.org/wiki/Ramer%E2%80%93Douglas%E2%80%93Peucker_algorithm
+    //marks the points within [first, last] which have to be kept, working on a view to avoid any copies
     ///@todo move to tpc or even line topology class (if it is ever added)
-    PointCloud<T> douglas_peucker(PointCloud<T> path, T epsilon) const { ///@todo rename variables to make it more readable
+    static void douglas_peucker(const PointCloudView<T> &path, size_t first, size_t last, T epsilon, std::vector<bool> &keep) {
         T dmax = 0;
-        unsigned int index = 0;
-        unsigned int end = path.size()-1;
+        size_t index = first;
 
-        for(unsigned int i=1; i < end; ++i) {
-            T d = distance_point_line(path[i], path[0], path[end]);
+        for(size_t i = first+1; i < last; ++i) {
+            T d = distance_point_line(path[i], path[first], path[last]);
             if(d > dmax) {
                 index = i;
                 dmax = d;
             }
         }
         if(dmax > epsilon) {
-            auto path1 = path;
-            auto path2 = path;
-
-            path1.range(0,index);
-            path1 = douglas_peucker(path1, epsilon);
-
-            path2.range(index,end);
-            path2 = douglas_peucker(path2, epsilon);
-
-            path1.range(0,path1.size()-2);
-            path = path1 + path2;
-        }
-        else {
-            auto p1 = path[0];
-            auto p2 = path[end];
-            path.clear();
-            path += p1;
-            path += p2;
+            keep[index] = true;
+            douglas_peucker(path, first, index, epsilon, keep);
+            douglas_peucker(path, index, last, epsilon, keep);
         }
-        return path;
     }
 };
 
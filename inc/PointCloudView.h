@@ -0,0 +1,471 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    PointCloudView.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class PointCloudView, a non-owning read-only window onto consecutive (or strided) points
+ *          a view never allocates, it only stays valid as long as the points it was created from are not reallocated
+ */
+
+#ifndef POINTCLOUDVIEW_H_INCLUDED
+#define POINTCLOUDVIEW_H_INCLUDED
+
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <cstddef>
+
+#include "Point.h"
+
+namespace lib_2d {
+
+template <typename T>
+class PointCloudView {
+
+private:
+    const Point<T> *data;
+    size_t n;
+    size_t stride;
+
+public:
+
+//------------------------------------------------------------------------------
+
+    class const_iterator {
+        const Point<T> *data;
+        size_t i;
+        size_t stride;
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = Point<T>;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const Point<T>*;
+        using reference         = const Point<T>&;
+
+        const_iterator(const Point<T> *data = nullptr, size_t i = 0, size_t stride = 1) :
+            data(data),
+            i(i),
+            stride(stride) {}
+
+        const Point<T>& operator * () const {
+            return data[i * stride];
+        }
+
+        const Point<T>* operator -> () const {
+            return data + i * stride;
+        }
+
+        const_iterator& operator ++ () {
+            ++i;
+            return *this;
+        }
+
+        const_iterator operator ++ (int) {
+            auto out = *this;
+            ++i;
+            return out;
+        }
+
+        bool operator == (const const_iterator &other) const {
+            return i == other.i && data == other.data;
+        }
+
+        bool operator != (const const_iterator &other) const {
+            return !(*this == other);
+        }
+    };
+
+//------------------------------------------------------------------------------
+
+    PointCloudView() :
+        data(nullptr),
+        n(0),
+        stride(1) {}
+
+    PointCloudView(const Point<T> *data, size_t n, size_t stride = 1) :
+        data(data),
+        n(n),
+        stride(stride < 1 ? 1 : stride) {}
+
+    PointCloudView(const std::vector < Point <T> > &points) :
+        data(points.data()),
+        n(points.size()),
+        stride(1) {}
+
+//------------------------------------------------------------------------------
+
+    ///creates a sub view of the points [indexStart, indexEnd], every 'step'th point of this view
+    PointCloudView slice(size_t indexStart, size_t indexEnd, size_t step = 1) const {
+        if(step < 1 || indexStart > indexEnd || indexEnd >= n)
+            return PointCloudView();
+        return PointCloudView(data + indexStart * stride, (indexEnd - indexStart) / step + 1, stride * step);
+    }
+
+//------------------------------------------------------------------------------
+
+    inline size_t size() const {
+        return n;
+    }
+
+    inline bool empty() const {
+        return n == 0;
+    }
+
+    inline size_t get_stride() const {
+        return stride;
+    }
+
+//------------------------------------------------------------------------------
+
+    inline const Point<T>& operator [] (size_t i) const {
+        return data[i * stride];
+    }
+
+    inline const Point<T>& get_point(size_t i) const {
+        return data[i * stride];
+    }
+
+    inline const Point<T>& first() const {
+        return data[0];
+    }
+
+    inline const Point<T>& last() const {
+        return data[(n-1) * stride];
+    }
+
+//------------------------------------------------------------------------------
+
+    T length() const {
+        if(n < 2)
+            return 0;
+        T l(0);
+
+        for(size_t i = 1; i < n; ++i)
+            l += (*this)[i].distance_to((*this)[i-1]);
+
+        return l;
+    }
+
+//------------------------------------------------------------------------------
+
+    T get_min_x() const {
+        if(n == 0)
+            return 0; ///@todo find better error handling
+        T minX((*this)[0].x);
+
+        for(size_t i = 1; i < n; ++i) {
+            if((*this)[i].x < minX)
+                minX = (*this)[i].x;
+        }
+        return minX;
+    }
+
+    T get_max_x() const {
+        if(n == 0)
+            return 0; ///@todo find better error handling
+        T maxX((*this)[0].x);
+
+        for(size_t i = 1; i < n; ++i) {
+            if((*this)[i].x > maxX)
+                maxX = (*this)[i].x;
+        }
+        return maxX;
+    }
+
+    T get_min_y() const {
+        if(n == 0)
+            return 0; ///@todo find better error handling
+        T minY((*this)[0].y);
+
+        for(size_t i = 1; i < n; ++i) {
+            if((*this)[i].y < minY)
+                minY = (*this)[i].y;
+        }
+        return minY;
+    }
+
+    T get_max_y() const {
+        if(n == 0)
+            return 0; ///@todo find better error handling
+        T maxY((*this)[0].y);
+
+        for(size_t i = 1; i < n; ++i) {
+            if((*this)[i].y > maxY)
+                maxY = (*this)[i].y;
+        }
+        return maxY;
+    }
+
+//------------------------------------------------------------------------------
+
+    int get_min_x_index() const {
+        if(n == 0)
+            return -1;
+
+        size_t index(0);
+        for(size_t i = 1; i < n; ++i) {
+            if((*this)[i].x < (*this)[index].x)
+                index = i;
+        }
+        return index;
+    }
+
+    int get_max_x_index() const {
+        if(n == 0)
+            return -1;
+
+        size_t index(0);
+        for(size_t i = 1; i < n; ++i) {
+            if((*this)[i].x > (*this)[index].x)
+                index = i;
+        }
+        return index;
+    }
+
+    int get_min_y_index() const {
+        if(n == 0)
+            return -1;
+
+        size_t index(0);
+        for(size_t i = 1; i < n; ++i) {
+            if((*this)[i].y < (*this)[index].y)
+                index = i;
+        }
+        return index;
+    }
+
+    int get_max_y_index() const {
+        if(n == 0)
+            return -1;
+
+        size_t index(0);
+        for(size_t i = 1; i < n; ++i) {
+            if((*this)[i].y > (*this)[index].y)
+                index = i;
+        }
+        return index;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///true if the axis aligned bounding boxes of both views overlap (touching counts as overlapping)
+    bool bounding_boxes_overlap(const PointCloudView &other) const {
+        if(empty() || other.empty())
+            return false;
+        return get_min_x() <= other.get_max_x() && other.get_min_x() <= get_max_x()
+            && get_min_y() <= other.get_max_y() && other.get_min_y() <= get_max_y();
+    }
+
+//------------------------------------------------------------------------------
+
+    Point<T> center() const {
+        T
+            sumX(0.0),
+            sumY(0.0);
+
+        for(size_t i = 0; i < n; ++i) {
+            sumX += (*this)[i].x;
+            sumY += (*this)[i].y;
+        }
+
+        return Point<T>{sumX / n, sumY / n};
+    }
+
+//------------------------------------------------------------------------------
+
+    int furthest_apart(const Point<T> &other) const {
+        T maxDistance(0);
+        int furthestIndex(-1);
+        for(size_t i = 0; i < n; ++i) {
+            T distance = (*this)[i].sqr_distance_to(other);
+            if(distance >= maxDistance) {
+                maxDistance = distance;
+                furthestIndex = i;
+            }
+        }
+        return furthestIndex;
+    }
+
+    int furthest_apart(const PointCloudView &other) const {
+        T maxDistance(0);
+        int furthestIndex(-1);
+
+        for(size_t i = 0; i < n; ++i) {
+            T distance = (*this)[i].sqr_distance_to( other[other.closest((*this)[i])] );
+            if(maxDistance < distance) {
+                maxDistance = distance;
+                furthestIndex = i;
+            }
+        }
+        return furthestIndex;
+    }
+
+//------------------------------------------------------------------------------
+
+    int closest(const Point<T> &other) const {
+        int closestIndex(-1);
+        if(n == 0)
+            return closestIndex;
+        T minDistance = (*this)[0].sqr_distance_to(other);
+        for(size_t i = 0; i < n; ++i) {
+            T distance = (*this)[i].sqr_distance_to(other);
+            if(distance <= minDistance) {
+                minDistance = distance;
+                closestIndex = i;
+            }
+        }
+        return closestIndex;
+    }
+
+    int closest(const PointCloudView &other) const {
+        int closestIndex(-1);
+        if(n == 0 || other.size() == 0)
+            return closestIndex;
+        T minDistance = (*this)[0].sqr_distance_to(other[0]);
+        for(size_t i = 0; i < n; ++i) {
+            T distance = (*this)[i].sqr_distance_to( other[other.closest((*this)[i])] );
+            if(minDistance > distance) {
+                minDistance = distance;
+                closestIndex = i;
+            }
+        }
+        return closestIndex;
+    }
+
+//------------------------------------------------------------------------------
+
+    bool similar_to(const PointCloudView &other, T maxDistance) const {
+        if(n != other.size())
+            return false;
+        for(size_t i = 0; i < n; ++i) {
+            if(!(*this)[i].similar_to(other[i], maxDistance))
+                return false;
+        }
+        return true;
+    }
+
+    bool equal_to(const PointCloudView &other) const {
+        if(n != other.size())
+            return false;
+        for(size_t i = 0; i < n; ++i) {
+            if(!(*this)[i].equal_to(other[i]))
+                return false;
+        }
+        return true;
+    }
+
+//------------------------------------------------------------------------------
+
+    int index_of(const Point<T> &other) const {
+        for(size_t i = 0; i < n; ++i) {
+            if((*this)[i] == other)
+                return i;
+        }
+        return -1;
+    }
+
+    bool has_point(const Point<T> &point) const {
+        return index_of(point) != -1;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///winding number of the (implicitly closed) path around p, 0 outside, +1 inside a counter clockwise and -1 inside a clockwise polygon
+    ///edges include their lower and exclude their upper end, so rays through vertices are counted once
+    int winding_number(const Point<T> &p) const {
+        int winding(0);
+        for(size_t i = 0; i < n; ++i) {
+            const Point<T> &a = (*this)[i];
+            const Point<T> &b = (*this)[i + 1 < n ? i + 1 : 0];
+            const T side = (b.x - a.x) * (p.y - a.y) - (p.x - a.x) * (b.y - a.y);
+            if(a.y <= p.y) {
+                if(b.y > p.y && side > 0)
+                    ++winding;
+            }
+            else if(b.y <= p.y && side < 0)
+                --winding;
+        }
+        return winding;
+    }
+
+    ///whether p lies on one of the edges of the (implicitly closed) path
+    bool point_is_on_border(const Point<T> &p) const {
+        for(size_t i = 0; i < n; ++i) {
+            const Point<T> &a = (*this)[i];
+            const Point<T> &b = (*this)[i + 1 < n ? i + 1 : 0];
+            if(   (b.x - a.x) * (p.y - a.y) == (p.x - a.x) * (b.y - a.y)
+               && std::min(a.x, b.x) <= p.x && p.x <= std::max(a.x, b.x)
+               && std::min(a.y, b.y) <= p.y && p.y <= std::max(a.y, b.y))
+                return true;
+        }
+        return false;
+    }
+
+    ///whether p lies within the polygon described by the (implicitly closed) path, points on the border are inside
+    ///O(n) per query, see PreparedPolygon for many queries against the same polygon
+    bool point_is_inside(const Point<T> &p) const {
+        return winding_number(p) != 0 || point_is_on_border(p);
+    }
+
+//------------------------------------------------------------------------------
+
+    std::string to_string(std::string divider = " ") const {
+        std::string output("");
+
+        for(size_t i = 0; i < n; ++i)
+            output += (*this)[i].to_string(divider) + "\n";
+
+        return output;
+    }
+
+//------------------------------------------------------------------------------
+
+    const_iterator begin() const {
+        return const_iterator(data, 0, stride);
+    }
+
+    const_iterator end() const {
+        return const_iterator(data, n, stride);
+    }
+
+    const_iterator cbegin() const {
+        return begin();
+    }
+
+    const_iterator cend() const {
+        return end();
+    }
+
+//------------------------------------------------------------------------------
+
+    bool operator == (const PointCloudView &other) const {
+        return equal_to(other);
+    }
+
+    bool operator != (const PointCloudView &other) const {
+        return !equal_to(other);
+    }
+
+    friend std::ostream &operator << (std::ostream &os, const PointCloudView &view) {
+        os << view.to_string();
+        return os;
+    }
+};
+
+} //lib_2d
+
+#endif // POINTCLOUDVIEW_H_INCLUDED
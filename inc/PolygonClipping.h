@@ -0,0 +1,552 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    PolygonClipping.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class PolygonClipping, clipping and boolean operations (union, intersection, difference, xor) of polygons
+ *          convex clip windows use Sutherland-Hodgman, arbitrary polygons with holes are overlaid:
+ *          all edges are split at their intersections, classified against the other polygon and linked to the resulting rings
+ *          polygons are sets of rings, outer rings are counter clockwise, holes clockwise (inputs are reoriented by their nesting depth)
+ */
+
+#ifndef POLYGONCLIPPING_H_INCLUDED
+#define POLYGONCLIPPING_H_INCLUDED
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+
+#include "constants.h"
+#include "Point.h"
+#include "PointCloudView.h"
+#include "PointCloud.h"
+#include "RTree.h"
+#include "PreparedPolygon.h"
+#include "parallel.h"
+
+namespace lib_2d {
+
+template <typename T>
+class PolygonClipping {
+
+public:
+    enum Operation {UNION, INTERSECTION, DIFFERENCE, XOR};
+
+private:
+    using Points = std::vector<Point<T>>;
+    using Rings = std::vector<Points>;
+
+    ///a x + b y + c >= 0 for points within
+    struct HalfPlane {
+        T a, b, c;
+
+        inline T operator()(const Point<T> &p) const {
+            return a * p.x + b * p.y + c;
+        }
+    };
+
+    struct Edge {
+        Point<T> a, b;
+    };
+
+public:
+
+//------------------------------------------------------------------------------
+
+    ///Sutherland-Hodgman, clips subject to the convex window (either orientation)
+    ///concave subjects may result in zero width bridges along the border of the window
+    static PointCloud<T> clip_convex(const PointCloudView<T> &subject, const PointCloudView<T> &window, bool closePath = true) {
+        const std::vector<HalfPlane> planes = half_planes(window);
+        Points result, buffer;
+        sutherland_hodgman(subject, planes, result, buffer);
+        return to_pointcloud(result, closePath);
+    }
+
+    ///clips subject to the axis aligned box [minX, maxX] x [minY, maxY]
+    static PointCloud<T> clip_box(const PointCloudView<T> &subject, T minX, T minY, T maxX, T maxY, bool closePath = true) {
+        const std::vector<HalfPlane> planes = box_planes(minX, minY, maxX, maxY);
+        Points result, buffer;
+        sutherland_hodgman(subject, planes, result, buffer);
+        return to_pointcloud(result, closePath);
+    }
+
+    ///clips all subjects to the convex window, split onto several threads, empty results stay within the output
+    static std::vector<PointCloud<T>> clip_convex(const std::vector<PointCloudView<T>> &subjects, const PointCloudView<T> &window, bool closePath = true, size_t nThreads = 0) {
+        const std::vector<HalfPlane> planes = half_planes(window);
+        std::vector<PointCloud<T>> results(subjects.size());
+        parallel_chunks(subjects.size(), n_chunks(subjects.size(), nThreads, 256), [&](size_t first, size_t last, size_t) {
+            Points result, buffer; //reused for all subjects of the chunk
+            for(size_t i = first; i < last; ++i) {
+                sutherland_hodgman(subjects[i], planes, result, buffer);
+                results[i] = to_pointcloud(result, closePath);
+            }
+        });
+        return results;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///boolean operation of two polygons, each given by its rings
+    ///returns the rings of the result, outer rings counter clockwise, holes clockwise
+    static std::vector<PointCloud<T>> compute(const std::vector<PointCloudView<T>> &a, const std::vector<PointCloudView<T>> &b, Operation operation, bool closePath = true) {
+        const Rings
+            ringsA = normalize(a),
+            ringsB = normalize(b);
+
+        std::vector<PointCloud<T>> out;
+        for(const auto &ring : overlay(ringsA, ringsB, prepare(ringsB), operation))
+            out.push_back(to_pointcloud(ring, closePath));
+        return out;
+    }
+
+    static std::vector<PointCloud<T>> compute(const PointCloudView<T> &a, const PointCloudView<T> &b, Operation operation, bool closePath = true) {
+        return compute(std::vector<PointCloudView<T>>(1, a), std::vector<PointCloudView<T>>(1, b), operation, closePath);
+    }
+
+    ///the operation between every single ring polygon of subjects and the polygon b, split onto several threads
+    static std::vector<std::vector<PointCloud<T>>> compute_each(const std::vector<PointCloudView<T>> &subjects, const std::vector<PointCloudView<T>> &b, Operation operation, bool closePath = true, size_t nThreads = 0) {
+        const Rings ringsB = normalize(b);
+        const PreparedPolygon<T> preparedB = prepare(ringsB); //shared by all subjects
+        std::vector<std::vector<PointCloud<T>>> results(subjects.size());
+        parallel_for(subjects.size(), n_chunks(subjects.size(), nThreads, 64), [&](size_t i) {
+            for(const auto &ring : overlay(normalize(std::vector<PointCloudView<T>>(1, subjects[i])), ringsB, preparedB, operation))
+                results[i].push_back(to_pointcloud(ring, closePath));
+        });
+        return results;
+    }
+
+    static std::vector<PointCloud<T>> unite(const PointCloudView<T> &a, const PointCloudView<T> &b) {
+        return compute(a, b, UNION);
+    }
+
+    static std::vector<PointCloud<T>> intersect(const PointCloudView<T> &a, const PointCloudView<T> &b) {
+        return compute(a, b, INTERSECTION);
+    }
+
+    static std::vector<PointCloud<T>> subtract(const PointCloudView<T> &a, const PointCloudView<T> &b) {
+        return compute(a, b, DIFFERENCE);
+    }
+
+    static std::vector<PointCloud<T>> exclusive_or(const PointCloudView<T> &a, const PointCloudView<T> &b) {
+        return compute(a, b, XOR);
+    }
+
+//------------------------------------------------------------------------------
+
+    ///signed area of all rings, positive for counter clockwise outer rings
+    static T area(const std::vector<PointCloud<T>> &rings) {
+        T sum(0);
+        for(const auto &ring : rings)
+            sum += signed_area(ring.view());
+        return sum;
+    }
+
+//------------------------------------------------------------------------------
+
+private:
+
+    static T signed_area(const PointCloudView<T> &ring) {
+        T sum(0);
+        for(size_t i = 0; i < ring.size(); ++i) {
+            const Point<T> &p = ring[i];
+            const Point<T> &q = ring[i + 1 < ring.size() ? i + 1 : 0];
+            sum += p.x * q.y - q.x * p.y;
+        }
+        return sum / 2;
+    }
+
+    static PointCloud<T> to_pointcloud(const Points &ring, bool closePath) {
+        PointCloud<T> out(ring.size() + 1);
+        for(const auto &p : ring)
+            out.push_back(p);
+        if(closePath && !ring.empty())
+            out.push_back(ring.front());
+        return out;
+    }
+
+    static inline T cross3(const Point<T> &o, const Point<T> &a, const Point<T> &b) {
+        return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+    }
+
+//------------------------------------------------------------------------------
+
+    static std::vector<HalfPlane> half_planes(const PointCloudView<T> &window) {
+        Points ps(window.begin(), window.end());
+        while(ps.size() > 1 && ps.back() == ps.front())
+            ps.pop_back();
+        if(signed_area(PointCloudView<T>(ps)) < 0)
+            std::reverse(ps.begin(), ps.end());
+
+        std::vector<HalfPlane> planes;
+        for(size_t i = 0; i < ps.size(); ++i) {
+            const Point<T> &c = ps[i];
+            const Point<T> &d = ps[(i + 1) % ps.size()];
+            if(c == d)
+                continue;
+            planes.push_back(HalfPlane{-(d.y - c.y), d.x - c.x, (d.y - c.y) * c.x - (d.x - c.x) * c.y});
+        }
+        return planes;
+    }
+
+    static std::vector<HalfPlane> box_planes(T minX, T minY, T maxX, T maxY) {
+        return std::vector<HalfPlane>{
+            HalfPlane{ 1,  0, -minX},
+            HalfPlane{-1,  0,  maxX},
+            HalfPlane{ 0,  1, -minY},
+            HalfPlane{ 0, -1,  maxY}};
+    }
+
+    ///the subject is clipped by one half plane after another, result and buffer are swapped between the passes
+    static void sutherland_hodgman(const PointCloudView<T> &subject, const std::vector<HalfPlane> &planes, Points &result, Points &buffer) {
+        result.assign(subject.begin(), subject.end());
+        while(result.size() > 1 && result.back() == result.front())
+            result.pop_back();
+
+        for(const auto &plane : planes) {
+            if(result.empty())
+                break;
+            buffer.clear();
+            Point<T> previous = result.back();
+            T previousValue = plane(previous);
+            for(const auto &current : result) {
+                const T value = plane(current);
+                if((value >= 0) != (previousValue >= 0)) {
+                    const T t = previousValue / (previousValue - value);
+                    buffer.push_back(Point<T>{previous.x + t * (current.x - previous.x), previous.y + t * (current.y - previous.y)});
+                }
+                if(value >= 0)
+                    buffer.push_back(current);
+                previous = current;
+                previousValue = value;
+            }
+            std::swap(result, buffer);
+        }
+        if(result.size() < 3)
+            result.clear();
+    }
+
+//------------------------------------------------------------------------------
+
+    ///copies the rings without duplicate points, outer rings (even nesting depth) counter clockwise, holes clockwise
+    static Rings normalize(const std::vector<PointCloudView<T>> &rings) {
+        Rings out;
+        for(const auto &ring : rings) {
+            Points ps;
+            for(const auto &p : ring) {
+                if(ps.empty() || !(ps.back() == p))
+                    ps.push_back(p);
+            }
+            while(ps.size() > 1 && ps.back() == ps.front())
+                ps.pop_back();
+            if(ps.size() >= 3)
+                out.push_back(ps);
+        }
+
+        for(size_t i = 0; i < out.size(); ++i) {
+            size_t depth(0);
+            for(size_t j = 0; j < out.size(); ++j) {
+                if(i != j && PointCloudView<T>(out[j]).winding_number(out[i][0]) != 0)
+                    ++depth;
+            }
+            const bool counterClockwise = signed_area(PointCloudView<T>(out[i])) > 0;
+            if(counterClockwise != (depth % 2 == 0))
+                std::reverse(out[i].begin(), out[i].end());
+        }
+        return out;
+    }
+
+    static void edges_of(const Rings &rings, std::vector<Edge> &edges) {
+        for(const auto &ring : rings) {
+            for(size_t i = 0; i < ring.size(); ++i)
+                edges.push_back(Edge{ring[i], ring[(i + 1) % ring.size()]});
+        }
+    }
+
+    ///adds the points where the edges touch or cross to the split points of both, points on an edge are taken exactly
+    static void intersect_edges(const Edge &e, const Edge &f, Points &splitsE, Points &splitsF) {
+        const T
+            d1 = cross3(e.a, e.b, f.a),
+            d2 = cross3(e.a, e.b, f.b),
+            d3 = cross3(f.a, f.b, e.a),
+            d4 = cross3(f.a, f.b, e.b);
+
+        auto within = [](const Point<T> &p, const Point<T> &q, const Point<T> &r) { //r within the box of p and q
+            return std::min(p.x, q.x) <= r.x && r.x <= std::max(p.x, q.x) && std::min(p.y, q.y) <= r.y && r.y <= std::max(p.y, q.y);
+        };
+
+        if(((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) && ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0))) {
+            const T t = d3 / (d3 - d4);
+            const Point<T> x{e.a.x + t * (e.b.x - e.a.x), e.a.y + t * (e.b.y - e.a.y)};
+            splitsE.push_back(x);
+            splitsF.push_back(x);
+            return;
+        }
+        if(d1 == 0 && within(e.a, e.b, f.a)) splitsE.push_back(f.a);
+        if(d2 == 0 && within(e.a, e.b, f.b)) splitsE.push_back(f.b);
+        if(d3 == 0 && within(f.a, f.b, e.a)) splitsF.push_back(e.a);
+        if(d4 == 0 && within(f.a, f.b, e.b)) splitsF.push_back(e.b);
+    }
+
+    ///splits all edges of both polygons at their intersections, small inputs are checked pairwise, larger ones joined within RTrees
+    static void split_edges(const Rings &ringsA, const Rings &ringsB, std::vector<Edge> &edgesA, std::vector<Edge> &edgesB) {
+        std::vector<Edge> a, b;
+        edges_of(ringsA, a);
+        edges_of(ringsB, b);
+        std::vector<Points>
+            splitsA(a.size()),
+            splitsB(b.size());
+
+        if(a.size() * b.size() <= 4096) {
+            for(size_t i = 0; i < a.size(); ++i) {
+                for(size_t j = 0; j < b.size(); ++j) {
+                    if(   std::max(a[i].a.x, a[i].b.x) < std::min(b[j].a.x, b[j].b.x)
+                       || std::min(a[i].a.x, a[i].b.x) > std::max(b[j].a.x, b[j].b.x)
+                       || std::max(a[i].a.y, a[i].b.y) < std::min(b[j].a.y, b[j].b.y)
+                       || std::min(a[i].a.y, a[i].b.y) > std::max(b[j].a.y, b[j].b.y))
+                        continue;
+                    intersect_edges(a[i], b[j], splitsA[i], splitsB[j]);
+                }
+            }
+        }
+        else {
+            const std::vector<PointCloud<T>>
+                closedA = closed(ringsA),
+                closedB = closed(ringsB);
+            const std::vector<size_t>
+                offsetsA = offsets(ringsA),
+                offsetsB = offsets(ringsB);
+            const RTree<T>
+                treeA(views(closedA)),
+                treeB(views(closedB));
+            for(const auto &pair : treeA.join(treeB)) {
+                const size_t
+                    i = offsetsA[pair[0]] + pair[1],
+                    j = offsetsB[pair[2]] + pair[3];
+                intersect_edges(a[i], b[j], splitsA[i], splitsB[j]);
+            }
+        }
+
+        split(a, splitsA, edgesA);
+        split(b, splitsB, edgesB);
+    }
+
+    static std::vector<PointCloud<T>> closed(const Rings &rings) {
+        std::vector<PointCloud<T>> out;
+        for(const auto &ring : rings)
+            out.push_back(to_pointcloud(ring, true));
+        return out;
+    }
+
+    static std::vector<PointCloudView<T>> views(const std::vector<PointCloud<T>> &clouds) {
+        std::vector<PointCloudView<T>> out;
+        for(const auto &cloud : clouds)
+            out.push_back(cloud.view());
+        return out;
+    }
+
+    static std::vector<size_t> offsets(const Rings &rings) {
+        std::vector<size_t> out;
+        size_t offset(0);
+        for(const auto &ring : rings) {
+            out.push_back(offset);
+            offset += ring.size();
+        }
+        return out;
+    }
+
+    static void split(const std::vector<Edge> &edges, std::vector<Points> &splits, std::vector<Edge> &out) {
+        for(size_t i = 0; i < edges.size(); ++i) {
+            const Edge &e = edges[i];
+            Points &ps = splits[i];
+            const Point<T> direction{e.b.x - e.a.x, e.b.y - e.a.y};
+            std::sort(ps.begin(), ps.end(), [&](const Point<T> &lhs, const Point<T> &rhs) {
+                return (lhs.x - e.a.x) * direction.x + (lhs.y - e.a.y) * direction.y
+                     < (rhs.x - e.a.x) * direction.x + (rhs.y - e.a.y) * direction.y;
+            });
+            Point<T> previous = e.a;
+            for(const auto &p : ps) {
+                if(p == previous || p == e.b)
+                    continue;
+                out.push_back(Edge{previous, p});
+                previous = p;
+            }
+            out.push_back(Edge{previous, e.b});
+        }
+    }
+
+//------------------------------------------------------------------------------
+
+    ///an undirected edge (smaller point first), direction is the sum of +1 for each edge from lower to higher and -1 for the opposite direction
+    struct Shared {
+        Point<T> lower, higher;
+        int direction;
+
+        inline bool operator < (const Shared &other) const {
+            return lower < other.lower || (lower == other.lower && higher < other.higher);
+        }
+    };
+
+    using Directions = std::vector<Shared>;
+
+    static Directions directions(const std::vector<Edge> &edges) {
+        Directions out;
+        out.reserve(edges.size());
+        for(const auto &e : edges)
+            out.push_back(e.a < e.b ? Shared{e.a, e.b, 1} : Shared{e.b, e.a, -1});
+        std::sort(out.begin(), out.end());
+
+        size_t n(0);
+        for(size_t i = 0; i < out.size(); ++i) {
+            if(n > 0 && out[n-1].lower == out[i].lower && out[n-1].higher == out[i].higher)
+                out[n-1].direction += out[i].direction;
+            else
+                out[n++] = out[i];
+        }
+        out.resize(n);
+        return out;
+    }
+
+    ///adds the edges of one polygon which are part of the result, 'first' is set for the first operand
+    static void select(const std::vector<Edge> &edges, const Directions &otherDirections, const PreparedPolygon<T> &other, bool first, Operation operation, std::vector<Edge> &out) {
+        for(const auto &e : edges) {
+            const bool forward = e.a < e.b;
+            const Shared key = forward ? Shared{e.a, e.b, 0} : Shared{e.b, e.a, 0};
+            auto shared = std::lower_bound(otherDirections.begin(), otherDirections.end(), key);
+            if(shared != otherDirections.end() && !(key < *shared) && shared->direction != 0) {
+                const bool sameDirection = (shared->direction > 0) == forward;
+                const bool keep = first && (sameDirection ? (operation == UNION || operation == INTERSECTION) : operation == DIFFERENCE);
+                if(keep)
+                    out.push_back(e);
+                continue;
+            }
+
+            const Point<T> middle{(e.a.x + e.b.x) / 2, (e.a.y + e.b.y) / 2};
+            const bool inside = other.locate(middle) != PreparedPolygon<T>::OUTSIDE;
+            bool keep(false), reversed(false);
+            switch(operation) {
+                case UNION:        keep = !inside; break;
+                case INTERSECTION: keep = inside;  break;
+                case DIFFERENCE:   keep = first ? !inside : inside; reversed = !first; break;
+                case XOR:          keep = true; reversed = inside; break;
+            }
+            if(keep)
+                out.push_back(reversed ? Edge{e.b, e.a} : e);
+        }
+    }
+
+    ///links the edges to rings, at vertices with several outgoing edges the one turning left the most is taken (smallest faces)
+    static Rings link(std::vector<Edge> &edges) {
+        std::sort(edges.begin(), edges.end(), [](const Edge &lhs, const Edge &rhs) {
+            return lhs.a < rhs.a;
+        });
+        std::vector<bool> used(edges.size(), false);
+
+        Rings rings;
+        Points ring;
+        for(size_t start = 0; start < edges.size(); ++start) {
+            if(used[start])
+                continue;
+            used[start] = true;
+            ring.assign(1, edges[start].a);
+            size_t current = start;
+            bool closedRing(false);
+            while(true) {
+                const Point<T> &v = edges[current].b;
+                if(v == edges[start].a) {
+                    closedRing = true;
+                    break;
+                }
+                ring.push_back(v);
+
+                const Point<T> back{edges[current].a.x - v.x, edges[current].a.y - v.y};
+                auto range = std::equal_range(edges.begin(), edges.end(), Edge{v, v}, [](const Edge &lhs, const Edge &rhs) {
+                    return lhs.a < rhs.a;
+                });
+                size_t next = edges.size();
+                T bestAngle(0);
+                for(auto it = range.first; it != range.second; ++it) {
+                    const size_t candidate = it - edges.begin();
+                    if(used[candidate])
+                        continue;
+                    const Point<T> direction{it->b.x - v.x, it->b.y - v.y};
+                    T ccw = std::atan2(back.x * direction.y - back.y * direction.x, back.x * direction.x + back.y * direction.y);
+                    if(ccw < 0)
+                        ccw += LIB_2D_2PI;
+                    const T clockwise = ccw == 0 ? LIB_2D_2PI : LIB_2D_2PI - ccw;
+                    if(next == edges.size() || clockwise < bestAngle) {
+                        next = candidate;
+                        bestAngle = clockwise;
+                    }
+                }
+                if(next == edges.size())
+                    break;
+                used[next] = true;
+                current = next;
+            }
+            if(closedRing) {
+                remove_colinear(ring);
+                if(ring.size() >= 3)
+                    rings.push_back(ring);
+            }
+        }
+        return rings;
+    }
+
+    ///removes points within straight parts, which were created by splitting edges
+    static void remove_colinear(Points &ring) {
+        bool removed = true;
+        while(removed && ring.size() >= 3) {
+            removed = false;
+            Points out;
+            for(size_t i = 0; i < ring.size(); ++i) {
+                const Point<T> &previous = out.empty() ? ring.back() : out.back();
+                const Point<T> &next = ring[(i + 1) % ring.size()];
+                const T turn = cross3(previous, ring[i], next);
+                const T along = (ring[i].x - previous.x) * (next.x - ring[i].x) + (ring[i].y - previous.y) * (next.y - ring[i].y);
+                if(turn == 0 && along > 0) {
+                    removed = true;
+                    continue;
+                }
+                out.push_back(ring[i]);
+            }
+            ring.swap(out);
+        }
+    }
+
+    static Rings overlay(const Rings &ringsA, const Rings &ringsB, const PreparedPolygon<T> &preparedB, Operation operation) {
+        std::vector<Edge> edgesA, edgesB;
+        split_edges(ringsA, ringsB, edgesA, edgesB);
+
+        const std::vector<PointCloud<T>> closedA = closed(ringsA);
+        const PreparedPolygon<T> preparedA(views(closedA), 1);
+
+        std::vector<Edge> selected;
+        select(edgesA, directions(edgesB), preparedB, true, operation, selected);
+        select(edgesB, directions(edgesA), preparedA, false, operation, selected);
+        return link(selected);
+    }
+
+    static PreparedPolygon<T> prepare(const Rings &rings) {
+        return PreparedPolygon<T>(views(closed(rings)), 1);
+    }
+};
+
+} //lib_2d
+
+#endif // POLYGONCLIPPING_H_INCLUDED
@@ -0,0 +1,602 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    PolygonTriangulation.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class PolygonTriangulation, splits polygons with holes into triangles by ear clipping (as earcut)
+ *          holes are bridged to the outer ring, candidate points of the ear tests are found along a z-order curve
+ *          inputs which aren't simple are cured locally or split along a valid diagonal, so most of them still result in triangles
+ *          an instance keeps its buffers, so triangulating many small polygons with the same instance doesn't allocate
+ */
+
+#ifndef POLYGONTRIANGULATION_H_INCLUDED
+#define POLYGONTRIANGULATION_H_INCLUDED
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+#include <cmath>
+
+#include "Point.h"
+#include "PointCloudView.h"
+#include "Topology.h"
+#include "parallel.h"
+
+namespace lib_2d {
+
+template <typename T>
+class PolygonTriangulation {
+
+using Element = std::array<size_t, 3>;
+using Index = uint32_t;
+
+private:
+    enum : Index {NONE = std::numeric_limits<Index>::max()};
+
+    ///vertex within the circular lists of the rings, also linked in z-order
+    struct Node {
+        T x, y;
+        size_t i; //index within the concatenated rings
+        uint32_t z;
+        Index prev, next, prevZ, nextZ;
+        bool steiner; //single point holes are kept, even if collinear
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Index> buffer;
+
+    T minX = 0, minY = 0, invSize = 0; //z-order of the bounding box, invSize is 0 for small polygons which are tested without it
+
+    Topology<3> *result = nullptr; //of the current call
+
+//------------------------------------------------------------------------------
+
+public:
+
+    ///the triangles (counter clockwise) of the polygon, indexed as within it, the polygon may be closed (first == last)
+    Topology<3> triangulate(const PointCloudView<T> &polygon) {
+        return triangulate(std::vector<PointCloudView<T>>(1, polygon));
+    }
+
+    ///the first ring is the outer one, all others are holes within it, their orientation doesn't matter
+    ///the triangles are indexed as within the concatenation of all rings
+    Topology<3> triangulate(const std::vector<PointCloudView<T>> &rings) {
+        Topology<3> res;
+        triangulate(rings, res);
+        return res;
+    }
+
+    ///appends the triangles to res, their indices are increased by offset
+    void triangulate(const std::vector<PointCloudView<T>> &rings, Topology<3> &res, size_t offset = 0) {
+        nodes.clear();
+        result = &res;
+        if(rings.empty())
+            return;
+
+        size_t nPoints(0);
+        for(const auto &ring : rings)
+            nPoints += ring.size();
+        nodes.reserve(nPoints + 4 * rings.size());
+        res.reserve_elements(res.n_elements() + nPoints + 2 * rings.size());
+
+        Index outer = linked_list(rings[0], offset, true);
+        if(outer == NONE || nodes[outer].next == nodes[outer].prev)
+            return;
+        if(rings.size() > 1)
+            outer = eliminate_holes(rings, offset, outer);
+
+        invSize = 0;
+        if(nPoints > 80) {
+            minX = nodes[0].x; minY = nodes[0].y;
+            T maxX(minX), maxY(minY);
+            for(const auto &node : nodes) {
+                minX = std::min(minX, node.x); maxX = std::max(maxX, node.x);
+                minY = std::min(minY, node.y); maxY = std::max(maxY, node.y);
+            }
+            const T size = std::max(maxX - minX, maxY - minY);
+            invSize = size != 0 ? T(32767) / size : T(0);
+        }
+
+        earcut(outer, 0);
+    }
+
+//------------------------------------------------------------------------------
+
+    ///triangulates every polygon (without holes), split onto several threads, each one reusing its buffers
+    static std::vector<Topology<3>> triangulate_each(const std::vector<PointCloudView<T>> &polygons, size_t nThreads = 0) {
+        std::vector<Topology<3>> results(polygons.size());
+        parallel_chunks(polygons.size(), n_chunks(polygons.size(), nThreads, 256), [&](size_t first, size_t last, size_t) {
+            PolygonTriangulation triangulation;
+            std::vector<PointCloudView<T>> rings(1, PointCloudView<T>());
+            for(size_t i = first; i < last; ++i) {
+                rings[0] = polygons[i];
+                triangulation.triangulate(rings, results[i]);
+            }
+        });
+        return results;
+    }
+
+//------------------------------------------------------------------------------
+
+private:
+
+    ///positive if p q r turn clockwise, zero if collinear
+    static inline T area(const Node &p, const Node &q, const Node &r) {
+        return (q.y - p.y) * (r.x - q.x) - (q.x - p.x) * (r.y - q.y);
+    }
+
+    inline T area(Index p, Index q, Index r) const {
+        return area(nodes[p], nodes[q], nodes[r]);
+    }
+
+    inline bool equals(Index a, Index b) const {
+        return nodes[a].x == nodes[b].x && nodes[a].y == nodes[b].y;
+    }
+
+    static inline bool point_in_triangle(T ax, T ay, T bx, T by, T cx, T cy, T px, T py) {
+        return (cx - px) * (ay - py) >= (ax - px) * (cy - py)
+            && (ax - px) * (by - py) >= (bx - px) * (ay - py)
+            && (bx - px) * (cy - py) >= (cx - px) * (by - py);
+    }
+
+    ///position along a z-order curve through a 2^15 x 2^15 grid over the bounding box
+    inline uint32_t z_order(T x, T y) const {
+        return interleave(uint32_t((x - minX) * invSize)) | (interleave(uint32_t((y - minY) * invSize)) << 1);
+    }
+
+    static inline uint32_t interleave(uint32_t x) {
+        x = (x | (x << 8)) & 0x00FF00FF;
+        x = (x | (x << 4)) & 0x0F0F0F0F;
+        x = (x | (x << 2)) & 0x33333333;
+        x = (x | (x << 1)) & 0x55555555;
+        return x;
+    }
+
+    inline void emit(Index a, Index b, Index c) {
+        result->push_back(Element{nodes[a].i, nodes[b].i, nodes[c].i});
+    }
+
+//------------------------------------------------------------------------------
+
+    Index insert_node(size_t i, const Point<T> &p, Index last) {
+        const Index n = Index(nodes.size());
+        nodes.push_back(Node{p.x, p.y, i, 0, n, n, NONE, NONE, false});
+        if(last != NONE) {
+            nodes[n].next = nodes[last].next;
+            nodes[n].prev = last;
+            nodes[nodes[last].next].prev = n;
+            nodes[last].next = n;
+        }
+        return n;
+    }
+
+    void remove_node(Index p) {
+        Node &node = nodes[p];
+        nodes[node.next].prev = node.prev;
+        nodes[node.prev].next = node.next;
+        if(node.prevZ != NONE)
+            nodes[node.prevZ].nextZ = node.nextZ;
+        if(node.nextZ != NONE)
+            nodes[node.nextZ].prevZ = node.prevZ;
+    }
+
+    ///circular list of the ring, counter clockwise for the outer ring and clockwise for holes
+    Index linked_list(const PointCloudView<T> &ring, size_t offset, bool counterClockwise) {
+        const size_t n = ring.size();
+        if(n == 0)
+            return NONE;
+        T signedArea(0);
+        for(size_t i = 0, j = n - 1; i < n; j = i++)
+            signedArea += (ring[j].x - ring[i].x) * (ring[i].y + ring[j].y);
+
+        Index last(NONE);
+        if(counterClockwise == (signedArea > 0)) {
+            for(size_t i = 0; i < n; ++i)
+                last = insert_node(offset + i, ring[i], last);
+        }
+        else {
+            for(size_t i = n; i > 0; --i)
+                last = insert_node(offset + i - 1, ring[i-1], last);
+        }
+
+        if(equals(last, nodes[last].next)) {
+            const Index next = nodes[last].next;
+            remove_node(last);
+            last = next;
+        }
+        return last;
+    }
+
+    ///removes duplicate and collinear points
+    Index filter_points(Index start, Index end = NONE) {
+        if(start == NONE)
+            return start;
+        if(end == NONE)
+            end = start;
+
+        Index p = start;
+        bool again;
+        do {
+            again = false;
+            if(!nodes[p].steiner && (equals(p, nodes[p].next) || area(nodes[p].prev, p, nodes[p].next) == 0)) {
+                remove_node(p);
+                p = end = nodes[p].prev;
+                if(p == nodes[p].next)
+                    break;
+                again = true;
+            }
+            else
+                p = nodes[p].next;
+        } while(again || p != end);
+        return end;
+    }
+
+//------------------------------------------------------------------------------
+
+    void earcut(Index ear, int pass) {
+        if(ear == NONE)
+            return;
+        if(pass == 0 && invSize != 0)
+            index_curve(ear);
+
+        Index stop = ear;
+        while(nodes[ear].prev != nodes[ear].next) {
+            const Index
+                prev = nodes[ear].prev,
+                next = nodes[ear].next;
+
+            if(invSize != 0 ? is_ear_hashed(ear) : is_ear(ear)) {
+                emit(prev, ear, next);
+                remove_node(ear);
+                ear = stop = nodes[next].next; //skipping the next vertex leads to less sliver triangles
+                continue;
+            }
+
+            ear = next;
+            if(ear == stop) {
+                //no ears found, the polygon isn't simple
+                if(pass == 0)
+                    earcut(filter_points(ear), 1);
+                else if(pass == 1)
+                    earcut(cure_local_intersections(filter_points(ear)), 2);
+                else
+                    split_earcut(ear);
+                break;
+            }
+        }
+    }
+
+    ///no other point (being reflex) lies within the convex corner
+    bool is_ear(Index ear) const {
+        const Node
+            &a = nodes[nodes[ear].prev],
+            &b = nodes[ear],
+            &c = nodes[nodes[ear].next];
+        if(area(a, b, c) >= 0)
+            return false;
+
+        const T
+            x0 = std::min(a.x, std::min(b.x, c.x)), y0 = std::min(a.y, std::min(b.y, c.y)),
+            x1 = std::max(a.x, std::max(b.x, c.x)), y1 = std::max(a.y, std::max(b.y, c.y));
+
+        for(Index p = c.next; p != b.prev; p = nodes[p].next) {
+            const Node &node = nodes[p];
+            if(node.x >= x0 && node.x <= x1 && node.y >= y0 && node.y <= y1
+               && point_in_triangle(a.x, a.y, b.x, b.y, c.x, c.y, node.x, node.y)
+               && area(nodes[node.prev], node, nodes[node.next]) >= 0)
+                return false;
+        }
+        return true;
+    }
+
+    ///as is_ear, but only the points whose z-order is within the one of the bounding box of the corner are tested
+    bool is_ear_hashed(Index ear) const {
+        const Index
+            ia = nodes[ear].prev,
+            ic = nodes[ear].next;
+        const Node
+            &a = nodes[ia],
+            &b = nodes[ear],
+            &c = nodes[ic];
+        if(area(a, b, c) >= 0)
+            return false;
+
+        const T
+            x0 = std::min(a.x, std::min(b.x, c.x)), y0 = std::min(a.y, std::min(b.y, c.y)),
+            x1 = std::max(a.x, std::max(b.x, c.x)), y1 = std::max(a.y, std::max(b.y, c.y));
+        const uint32_t
+            minZ = z_order(x0, y0),
+            maxZ = z_order(x1, y1);
+
+        auto blocks = [&](Index p) {
+            const Node &node = nodes[p];
+            return node.x >= x0 && node.x <= x1 && node.y >= y0 && node.y <= y1 && p != ia && p != ic
+                && point_in_triangle(a.x, a.y, b.x, b.y, c.x, c.y, node.x, node.y)
+                && area(nodes[node.prev], node, nodes[node.next]) >= 0;
+        };
+
+        //search in both directions along the curve
+        Index p = b.prevZ, n = b.nextZ;
+        while(p != NONE && nodes[p].z >= minZ && n != NONE && nodes[n].z <= maxZ) {
+            if(blocks(p))
+                return false;
+            p = nodes[p].prevZ;
+            if(blocks(n))
+                return false;
+            n = nodes[n].nextZ;
+        }
+        for(; p != NONE && nodes[p].z >= minZ; p = nodes[p].prevZ) {
+            if(blocks(p))
+                return false;
+        }
+        for(; n != NONE && nodes[n].z <= maxZ; n = nodes[n].nextZ) {
+            if(blocks(n))
+                return false;
+        }
+        return true;
+    }
+
+    ///links the points of the ring in z-order
+    void index_curve(Index start) {
+        buffer.clear();
+        Index p = start;
+        do {
+            nodes[p].z = z_order(nodes[p].x, nodes[p].y);
+            buffer.push_back(p);
+            p = nodes[p].next;
+        } while(p != start);
+
+        std::sort(buffer.begin(), buffer.end(), [this](Index lhs, Index rhs) {
+            return nodes[lhs].z < nodes[rhs].z;
+        });
+        for(size_t k = 0; k < buffer.size(); ++k) {
+            nodes[buffer[k]].prevZ = k > 0 ? buffer[k-1] : Index(NONE);
+            nodes[buffer[k]].nextZ = k + 1 < buffer.size() ? buffer[k+1] : Index(NONE);
+        }
+    }
+
+    ///removes self intersections where two consecutive edges cross, by cutting off their triangle
+    Index cure_local_intersections(Index start) {
+        Index p = start;
+        do {
+            const Index
+                a = nodes[p].prev,
+                b = nodes[nodes[p].next].next;
+            if(!equals(a, b) && intersects(a, p, nodes[p].next, b) && locally_inside(a, b) && locally_inside(b, a)) {
+                emit(a, p, b);
+                remove_node(p);
+                remove_node(nodes[p].next);
+                p = start = b;
+            }
+            p = nodes[p].next;
+        } while(p != start);
+        return filter_points(p);
+    }
+
+    ///splits the polygon along a valid diagonal and triangulates both halves
+    void split_earcut(Index start) {
+        Index a = start;
+        do {
+            for(Index b = nodes[nodes[a].next].next; b != nodes[a].prev; b = nodes[b].next) {
+                if(nodes[a].i != nodes[b].i && is_valid_diagonal(a, b)) {
+                    Index c = split_polygon(a, b);
+                    a = filter_points(a, nodes[a].next);
+                    c = filter_points(c, nodes[c].next);
+                    earcut(a, 0);
+                    earcut(c, 0);
+                    return;
+                }
+            }
+            a = nodes[a].next;
+        } while(a != start);
+    }
+
+//------------------------------------------------------------------------------
+
+    ///connects all holes to the outer ring, from left to right
+    Index eliminate_holes(const std::vector<PointCloudView<T>> &rings, size_t offset, Index outer) {
+        std::vector<Index> leftmost;
+        offset += rings[0].size();
+        for(size_t k = 1; k < rings.size(); ++k) {
+            const Index list = linked_list(rings[k], offset, false);
+            offset += rings[k].size();
+            if(list == NONE)
+                continue;
+            if(list == nodes[list].next)
+                nodes[list].steiner = true;
+            leftmost.push_back(get_leftmost(list));
+        }
+        std::sort(leftmost.begin(), leftmost.end(), [this](Index lhs, Index rhs) {
+            return nodes[lhs].x < nodes[rhs].x;
+        });
+        for(auto hole : leftmost)
+            outer = eliminate_hole(hole, outer);
+        return outer;
+    }
+
+    Index eliminate_hole(Index hole, Index outer) {
+        const Index bridge = find_hole_bridge(hole, outer);
+        if(bridge == NONE)
+            return outer;
+        const Index bridgeReverse = split_polygon(bridge, hole);
+        filter_points(bridgeReverse, nodes[bridgeReverse].next);
+        return filter_points(bridge, nodes[bridge].next);
+    }
+
+    ///David Eberly's algorithm, a point of the outer ring visible from the leftmost point of the hole
+    Index find_hole_bridge(Index hole, Index outer) const {
+        const T hx = nodes[hole].x, hy = nodes[hole].y;
+        T qx = -std::numeric_limits<T>::max();
+        Index m(NONE);
+
+        //the segment left of the hole which intersects the ray towards -x closest to it
+        Index p = outer;
+        do {
+            const Node &node = nodes[p], &next = nodes[node.next];
+            if(hy <= node.y && hy >= next.y && next.y != node.y) {
+                const T x = node.x + (hy - node.y) * (next.x - node.x) / (next.y - node.y);
+                if(x <= hx && x > qx) {
+                    qx = x;
+                    m = node.x < next.x ? p : node.next;
+                    if(x == hx)
+                        return m; //the hole touches the segment
+                }
+            }
+            p = node.next;
+        } while(p != outer);
+        if(m == NONE)
+            return NONE;
+
+        //points within the triangle of the hole point, the intersection and the end point of the segment may block it
+        //the one with the smallest angle to the ray is visible instead
+        const Index stop = m;
+        const T mx = nodes[m].x, my = nodes[m].y;
+        T tanMin = std::numeric_limits<T>::max();
+        p = m;
+        do {
+            const Node &node = nodes[p];
+            if(hx >= node.x && node.x >= mx && hx != node.x
+               && point_in_triangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, node.x, node.y)) {
+                const T tan = std::fabs(hy - node.y) / (hx - node.x);
+                if(locally_inside(p, hole)
+                   && (tan < tanMin || (tan == tanMin && (node.x > nodes[m].x || (node.x == nodes[m].x && sector_contains_sector(m, p)))))) {
+                    m = p;
+                    tanMin = tan;
+                }
+            }
+            p = node.next;
+        } while(p != stop);
+        return m;
+    }
+
+    bool sector_contains_sector(Index m, Index p) const {
+        return area(nodes[m].prev, m, nodes[p].prev) < 0 && area(nodes[p].next, m, nodes[m].next) < 0;
+    }
+
+    Index get_leftmost(Index start) const {
+        Index p = start, leftmost = start;
+        do {
+            if(nodes[p].x < nodes[leftmost].x || (nodes[p].x == nodes[leftmost].x && nodes[p].y < nodes[leftmost].y))
+                leftmost = p;
+            p = nodes[p].next;
+        } while(p != start);
+        return leftmost;
+    }
+
+//------------------------------------------------------------------------------
+
+    bool is_valid_diagonal(Index a, Index b) const {
+        const Node &na = nodes[a], &nb = nodes[b];
+        return nodes[na.next].i != nb.i && nodes[na.prev].i != nb.i && !intersects_polygon(a, b)
+            && ((locally_inside(a, b) && locally_inside(b, a) && middle_inside(a, b)
+                 && (area(na.prev, a, nb.prev) != 0 || area(a, nb.prev, b) != 0)) //no opposite facing sectors
+                || (equals(a, b) && area(na.prev, a, na.next) > 0 && area(nb.prev, b, nb.next) > 0)); //zero length
+    }
+
+    static inline int sign(T value) {
+        return (value > 0) - (value < 0);
+    }
+
+    ///whether q lies within the bounding box of p and r (all collinear)
+    static inline bool on_segment(const Node &p, const Node &q, const Node &r) {
+        return q.x <= std::max(p.x, r.x) && q.x >= std::min(p.x, r.x) && q.y <= std::max(p.y, r.y) && q.y >= std::min(p.y, r.y);
+    }
+
+    bool intersects(Index p1, Index q1, Index p2, Index q2) const {
+        const Node &a = nodes[p1], &b = nodes[q1], &c = nodes[p2], &d = nodes[q2];
+        const int
+            o1 = sign(area(a, b, c)),
+            o2 = sign(area(a, b, d)),
+            o3 = sign(area(c, d, a)),
+            o4 = sign(area(c, d, b));
+        return (o1 != o2 && o3 != o4)
+            || (o1 == 0 && on_segment(a, c, b))
+            || (o2 == 0 && on_segment(a, d, b))
+            || (o3 == 0 && on_segment(c, a, d))
+            || (o4 == 0 && on_segment(c, b, d));
+    }
+
+    bool intersects_polygon(Index a, Index b) const {
+        Index p = a;
+        do {
+            const Index next = nodes[p].next;
+            if(nodes[p].i != nodes[a].i && nodes[next].i != nodes[a].i && nodes[p].i != nodes[b].i && nodes[next].i != nodes[b].i
+               && intersects(p, next, a, b))
+                return true;
+            p = next;
+        } while(p != a);
+        return false;
+    }
+
+    ///whether the diagonal a b starts into the interior at a
+    bool locally_inside(Index a, Index b) const {
+        const Node &na = nodes[a];
+        return area(na.prev, a, na.next) < 0
+            ? area(a, b, na.next) >= 0 && area(a, na.prev, b) >= 0
+            : area(a, b, na.prev) < 0 || area(a, na.next, b) < 0;
+    }
+
+    bool middle_inside(Index a, Index b) const {
+        const T
+            px = (nodes[a].x + nodes[b].x) / 2,
+            py = (nodes[a].y + nodes[b].y) / 2;
+        bool inside = false;
+        Index p = a;
+        do {
+            const Node &node = nodes[p], &next = nodes[node.next];
+            if(((node.y > py) != (next.y > py)) && next.y != node.y && (px < (next.x - node.x) * (py - node.y) / (next.y - node.y) + node.x))
+                inside = !inside;
+            p = node.next;
+        } while(p != a);
+        return inside;
+    }
+
+    ///links a and b with a bridge, splitting the ring into two (or merging a hole into it), returns the copy of b
+    Index split_polygon(Index a, Index b) {
+        const Index
+            a2 = Index(nodes.size()),
+            b2 = a2 + 1;
+        nodes.push_back(nodes[a]);
+        nodes.push_back(nodes[b]);
+        const Index
+            an = nodes[a].next,
+            bp = nodes[b].prev;
+        for(Index copy : {a2, b2}) {
+            nodes[copy].prevZ = nodes[copy].nextZ = NONE;
+            nodes[copy].steiner = false;
+        }
+
+        nodes[a].next = b;
+        nodes[b].prev = a;
+
+        nodes[a2].next = an;
+        nodes[an].prev = a2;
+
+        nodes[b2].next = a2;
+        nodes[a2].prev = b2;
+
+        nodes[bp].next = b2;
+        nodes[b2].prev = bp;
+        return b2;
+    }
+};
+
+} //lib_2d
+
+#endif // POLYGONTRIANGULATION_H_INCLUDED
@@ -0,0 +1,271 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    PreparedPolygon.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class PreparedPolygon, a slab index over the edges of a polygon for point in polygon queries in O(log n)
+ *          the polygon is split into horizontal slabs at the y values of its vertices, the edges within a slab are sorted by x
+ *          and store the sum of the winding of all edges right of them
+ */
+
+#ifndef PREPAREDPOLYGON_H_INCLUDED
+#define PREPAREDPOLYGON_H_INCLUDED
+
+#include <vector>
+#include <array>
+#include <algorithm>
+
+#include "Point.h"
+#include "PointCloudView.h"
+#include "Topology.h"
+#include "parallel.h"
+
+namespace lib_2d {
+
+template <typename T>
+class PreparedPolygon {
+
+using Element = std::array<size_t, 1>;
+
+public:
+    enum Location {OUTSIDE, INSIDE, ON_BORDER};
+
+private:
+
+//------------------------------------------------------------------------------
+
+    ///an edge within a slab, a is its lower end
+    struct Entry {
+        Point<T> a, b;
+        int winding; //+1 for upwards edges, -1 for downwards edges
+    };
+
+    struct Horizontal {
+        T y, minX, maxX;
+    };
+
+    std::vector<T> ys; //sorted, unique y values of all vertices, slab i is [ys[i], ys[i+1])
+
+    std::vector<size_t> slabStart; //entries of slab i are [slabStart[i], slabStart[i+1])
+
+    std::vector<Entry> entries;
+
+    std::vector<int> rightWinding; //sum of the winding of the entry and all entries right of it within its slab
+
+    std::vector<Horizontal> horizontals; //sorted by y, then minX
+
+//------------------------------------------------------------------------------
+
+public:
+
+    ///the polygon is implicitly closed, it may not intersect itself
+    explicit PreparedPolygon(const PointCloudView<T> &polygon, size_t nThreads = 0) :
+        PreparedPolygon(std::vector<PointCloudView<T>>(1, polygon), nThreads) {}
+
+    ///several rings whose windings are summed up, holes have to be oriented opposite to their outer ring
+    explicit PreparedPolygon(const std::vector<PointCloudView<T>> &rings, size_t nThreads = 0) {
+        std::vector<Entry> edges;
+        for(const auto &ring : rings) {
+            size_t n = ring.size();
+            if(n > 1 && ring.first() == ring.last())
+                --n;
+            for(size_t i = 0; i < n; ++i) {
+                const Point<T> &a = ring[i];
+                const Point<T> &b = ring[(i + 1) % n];
+                ys.push_back(a.y);
+                if(a.y == b.y) {
+                    if(a.x != b.x)
+                        horizontals.push_back(Horizontal{a.y, std::min(a.x, b.x), std::max(a.x, b.x)});
+                }
+                else if(a.y < b.y)
+                    edges.push_back(Entry{a, b, 1});
+                else
+                    edges.push_back(Entry{b, a, -1});
+            }
+        }
+
+        std::sort(ys.begin(), ys.end());
+        ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+        std::sort(horizontals.begin(), horizontals.end(), [](const Horizontal &lhs, const Horizontal &rhs) {
+            return lhs.y < rhs.y || (lhs.y == rhs.y && lhs.minX < rhs.minX);
+        });
+
+        const size_t nSlabs = ys.size() > 0 ? ys.size() - 1 : 0;
+        slabStart.assign(nSlabs + 1, 0);
+        std::vector<std::array<size_t, 2>> spans(edges.size()); //first and last slab of each edge
+        for(size_t i = 0; i < edges.size(); ++i) {
+            spans[i][0] = slab_of(edges[i].a.y);
+            spans[i][1] = slab_of(edges[i].b.y);
+            for(size_t s = spans[i][0]; s < spans[i][1]; ++s)
+                ++slabStart[s + 1];
+        }
+        for(size_t s = 0; s < nSlabs; ++s)
+            slabStart[s + 1] += slabStart[s];
+
+        entries.resize(slabStart[nSlabs]);
+        std::vector<size_t> fill(slabStart.begin(), slabStart.end() - 1);
+        for(size_t i = 0; i < edges.size(); ++i) {
+            for(size_t s = spans[i][0]; s < spans[i][1]; ++s)
+                entries[fill[s]++] = edges[i];
+        }
+
+        //the edges don't cross within a slab, so their order at its middle is their order within the whole slab
+        rightWinding.resize(entries.size());
+        parallel_for(nSlabs, n_chunks(entries.size(), nThreads), [this](size_t s) {
+            const T middle = (ys[s] + ys[s + 1]) / 2;
+            std::sort(entries.begin() + slabStart[s], entries.begin() + slabStart[s + 1], [middle](const Entry &lhs, const Entry &rhs) {
+                return x_at(lhs, middle) < x_at(rhs, middle);
+            });
+            int sum(0);
+            for(size_t i = slabStart[s + 1]; i > slabStart[s]; --i) {
+                sum += entries[i - 1].winding;
+                rightWinding[i - 1] = sum;
+            }
+        });
+    }
+
+//------------------------------------------------------------------------------
+
+    ///number of slabs and the total number of edges stored within them
+    size_t n_slabs() const {
+        return slabStart.size() - 1;
+    }
+
+    size_t n_entries() const {
+        return entries.size();
+    }
+
+//------------------------------------------------------------------------------
+
+    ///winding number of the polygon around p, O(log n)
+    int winding_number(const Point<T> &p) const {
+        if(ys.size() < 2 || p.y < ys.front() || p.y >= ys.back())
+            return 0;
+        const size_t s = slab_of(p.y);
+        const size_t k = first_right_of(s, p);
+        return k < slabStart[s + 1] ? rightWinding[k] : 0;
+    }
+
+    Location locate(const Point<T> &p) const {
+        if(ys.empty() || p.y < ys.front() || p.y > ys.back())
+            return OUTSIDE;
+
+        const size_t lower = std::lower_bound(ys.begin(), ys.end(), p.y) - ys.begin();
+        const bool onVertexLevel = ys[lower] == p.y;
+
+        int winding(0);
+        if(p.y < ys.back()) {
+            const size_t s = onVertexLevel ? lower : lower - 1;
+            const size_t k = first_right_of(s, p);
+            if(k < slabStart[s + 1]) {
+                if(side(entries[k], p) == 0)
+                    return ON_BORDER;
+                winding = rightWinding[k];
+            }
+        }
+
+        if(onVertexLevel) {
+            //edges ending at this height
+            if(lower > 0) {
+                const size_t k = first_right_of(lower - 1, p);
+                if(k < slabStart[lower] && side(entries[k], p) == 0)
+                    return ON_BORDER;
+            }
+            //horizontal edges at this height
+            auto it = std::upper_bound(horizontals.begin(), horizontals.end(), p, [](const Point<T> &q, const Horizontal &h) {
+                return q.y < h.y || (q.y == h.y && q.x < h.minX);
+            });
+            while(it != horizontals.begin()) {
+                --it;
+                if(it->y != p.y)
+                    break;
+                if(it->maxX >= p.x)
+                    return ON_BORDER;
+            }
+        }
+
+        return winding != 0 ? INSIDE : OUTSIDE;
+    }
+
+    ///whether p lies within the polygon or on its border
+    bool contains(const Point<T> &p) const {
+        return locate(p) != OUTSIDE;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///classifies all points, split onto several threads
+    void locate(const PointCloudView<T> &points, std::vector<Location> &result, size_t nThreads = 0) const {
+        result.resize(points.size());
+        parallel_for(points.size(), n_chunks(points.size(), nThreads), [&](size_t i) {
+            result[i] = locate(points[i]);
+        });
+    }
+
+    ///ids of all points within the polygon (and on its border if includeBorder is set), split onto several threads
+    Topology<1> inside(const PointCloudView<T> &points, bool includeBorder = true, size_t nThreads = 0) const {
+        const size_t nChunks = n_chunks(points.size(), nThreads);
+        std::vector<std::vector<size_t>> chunkIds(nChunks);
+        parallel_chunks(points.size(), nChunks, [&](size_t first, size_t last, size_t chunk) {
+            for(size_t i = first; i < last; ++i) {
+                const Location location = locate(points[i]);
+                if(location == INSIDE || (includeBorder && location == ON_BORDER))
+                    chunkIds[chunk].push_back(i);
+            }
+        });
+
+        size_t n(0);
+        for(const auto &ids : chunkIds)
+            n += ids.size();
+        Topology<1> res;
+        res.reserve_elements(n);
+        for(const auto &ids : chunkIds) {
+            for(auto id : ids)
+                res.push_back(Element{id});
+        }
+        return res;
+    }
+
+//------------------------------------------------------------------------------
+
+private:
+
+    static inline T x_at(const Entry &e, T y) {
+        return e.a.x + (e.b.x - e.a.x) * (y - e.a.y) / (e.b.y - e.a.y);
+    }
+
+    ///positive if p is left of the edge, 0 if it is on its line
+    static inline T side(const Entry &e, const Point<T> &p) {
+        return (e.b.x - e.a.x) * (p.y - e.a.y) - (p.x - e.a.x) * (e.b.y - e.a.y);
+    }
+
+    ///the slab [ys[i], ys[i+1]) containing y
+    inline size_t slab_of(T y) const {
+        return std::upper_bound(ys.begin(), ys.end(), y) - ys.begin() - 1;
+    }
+
+    ///the first entry of the slab which p is left of or on
+    inline size_t first_right_of(size_t s, const Point<T> &p) const {
+        return std::partition_point(entries.begin() + slabStart[s], entries.begin() + slabStart[s + 1], [&p](const Entry &e) {
+            return side(e, p) < 0;
+        }) - entries.begin();
+    }
+};
+
+} //lib_2d
+
+#endif // PREPAREDPOLYGON_H_INCLUDED
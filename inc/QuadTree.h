@@ -0,0 +1,661 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    QuadTree.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class QuadTree, a bucket PR-quadtree over the ids of an OrderedPointCloud
+ *          leafs are split once they hold more than bucketSize ids and merged again once their parent holds no more than that
+ *          every node knows the number and centroid of the points below it, which can be used as level of detail
+ */
+
+#ifndef QUADTREE_H_INCLUDED
+#define QUADTREE_H_INCLUDED
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <cmath>
+#include <stdexcept>
+
+#include "Point.h"
+#include "PointCloud.h"
+#include "OrderedPointCloud.h"
+#include "MemoryResource.h"
+
+namespace lib_2d {
+
+template <typename T>
+class QuadTree {
+
+using Element = std::array<size_t, 1>;
+
+public:
+
+    ///aggregated information about all points within a square region
+    struct Region {
+        Point<T> center;
+        T size;
+        size_t count;
+        Point<T> centroid;
+    };
+
+private:
+
+//------------------------------------------------------------------------------
+
+    static const size_t NONE = static_cast<size_t>(-1);
+
+    static const size_t MAX_DEPTH = 32; //leafs at (or below) this depth are never split, their buckets are chained instead
+
+    ///all nodes are stored within one pool, the four children of a node are always stored next to each other
+    ///children are ordered by quadrant: bit 0 set -> east, bit 1 set -> north
+    struct Node {
+        T cx, cy, half;
+        size_t firstChild; //NONE for leafs
+        size_t block;      //first bucket of a leaf, NONE if the leaf is empty
+        size_t count;      //number of points within this node and all its children
+        T sumX, sumY;
+    };
+
+    template <typename U>
+    using Buffer = std::vector<U, ResourceAllocator<U> >;
+
+    using Candidates = Buffer<std::pair<T, size_t> >;
+
+    std::shared_ptr<OrderedPointCloud<T>> parent;
+
+    std::shared_ptr<PointCloud<T>> pc;
+
+    size_t bucketSize;
+
+    Buffer<Node> nodes;
+
+    Buffer<size_t>
+        freeGroups,  //first index of unused groups of four nodes
+        blockIds,    //buckets of bucketSize ids each
+        blockNext,   //next bucket of a chain, NONE at its end
+        freeBlocks,
+        scratch;
+
+//------------------------------------------------------------------------------
+
+public:
+    QuadTree& operator=(const QuadTree&) = delete;
+    QuadTree(const QuadTree&) = delete;
+
+//------------------------------------------------------------------------------
+
+    ///nodes and buckets are allocated from 'resource' (the default resource if none is given)
+    QuadTree(std::shared_ptr<OrderedPointCloud<T>> tpc, size_t bucketSize = 8, MemoryResource *resource = nullptr) :
+        parent(tpc),
+        pc(tpc->get_parent()),
+        bucketSize(bucketSize < 1 ? 1 : bucketSize),
+        nodes(ResourceAllocator<Node>(resource)),
+        freeGroups(ResourceAllocator<size_t>(resource)),
+        blockIds(ResourceAllocator<size_t>(resource)),
+        blockNext(ResourceAllocator<size_t>(resource)),
+        freeBlocks(ResourceAllocator<size_t>(resource)),
+        scratch(ResourceAllocator<size_t>(resource)) {
+
+        const size_t n = tpc->n_elements();
+        T minX(0), maxX(0), minY(0), maxY(0);
+        if(n > 0) {
+            minX = maxX = tpc->get_tpoint(0).x;
+            minY = maxY = tpc->get_tpoint(0).y;
+        }
+        for(size_t i = 1; i < n; ++i) {
+            const auto &p = tpc->get_tpoint(i);
+            minX = std::min(minX, p.x);
+            maxX = std::max(maxX, p.x);
+            minY = std::min(minY, p.y);
+            maxY = std::max(maxY, p.y);
+        }
+
+        T half = 0.5 * std::max(maxX - minX, maxY - minY);
+        half = half > 0 ? half * T(1.001) : T(1);
+        nodes.push_back(Node{T(0.5) * (minX + maxX), T(0.5) * (minY + maxY), half, NONE, NONE, 0, 0, 0});
+
+        nodes.reserve(1 + 4 * (n / this->bucketSize + 1));
+        for(size_t i = 0; i < n; ++i)
+            insert(tpc->get_id(i));
+    }
+
+//------------------------------------------------------------------------------
+
+    size_t size() const {
+        return nodes[0].count;
+    }
+
+    std::shared_ptr<OrderedPointCloud<T>> get_parent() const {
+        return parent;
+    }
+
+    ///number of nodes currently in use
+    size_t n_nodes() const {
+        return nodes.size() - 4 * freeGroups.size();
+    }
+
+//------------------------------------------------------------------------------
+
+    ///adds a new point to the parent and indexes it, returns its id
+    size_t insert(const Point<T> &p) {
+        check_finite(p); //before the parent is changed
+        parent->push_back(p);
+        size_t pId = pc->size() - 1;
+        insert(pId);
+        return pId;
+    }
+
+    ///indexes a point which is already part of the parent (it must not be indexed yet)
+    void insert(size_t pId) {
+        if(pId >= pc->size())
+            throw std::out_of_range ("QuadTree can't index a point which isn't part of its parent");
+        const auto &p = (*pc)[pId];
+        check_finite(p); //infinite coordinates would let the root grow forever
+        while(!contains(nodes[0], p))
+            grow_towards(p);
+
+        size_t index = 0;
+        for(size_t depth = 0; ; ++depth) {
+            if(nodes[index].firstChild == NONE) {
+                if(nodes[index].count < bucketSize || depth >= MAX_DEPTH) { //growing the root moves leafs below MAX_DEPTH
+                    leaf_append(index, pId);
+                    return;
+                }
+                split(index);
+            }
+            add_to(nodes[index], p);
+            index = nodes[index].firstChild + quadrant(nodes[index], p);
+        }
+    }
+
+    ///removes a point from the index (it stays part of the parent), returns false if it wasn't indexed
+    ///the position of the point mustn't have changed since it was inserted, use move() to change it
+    bool remove(size_t pId) {
+        if(pId >= pc->size())
+            return false;
+        const auto &p = (*pc)[pId];
+        if(!contains(nodes[0], p))
+            return false;
+
+        scratch.clear(); //path from the root to the leaf
+        size_t index = 0;
+        while(nodes[index].firstChild != NONE) {
+            scratch.push_back(index);
+            index = nodes[index].firstChild + quadrant(nodes[index], p);
+        }
+        if(!leaf_remove(index, pId))
+            return false;
+
+        size_t collapse = NONE;
+        for(auto i : scratch) {
+            remove_from(nodes[i], p);
+            if(collapse == NONE && nodes[i].count <= bucketSize)
+                collapse = i;
+        }
+        if(collapse != NONE)
+            merge(collapse);
+        return true;
+    }
+
+    ///moves a point of the parent to a new position and updates the index
+    void move(size_t pId, const Point<T> &p) {
+        bool indexed = remove(pId);
+        (*pc)[pId] = p;
+        if(indexed)
+            insert(pId);
+    }
+
+//------------------------------------------------------------------------------
+
+    size_t nearest(const Point<T> &search) const {
+        if(size() == 0)
+            throw std::out_of_range ("QuadTree is empty, there is no nearest neighbor");
+        auto res = k_nearest(search, 1);
+        return res[0][0];
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the n nearest neighbors of search, sorted by their distance
+    Topology<1> k_nearest(const Point<T> &search, size_t n) const {
+        if(n < 1 || size() == 0) return Topology<1>();
+
+        Candidates candidates(ResourceAllocator<std::pair<T, size_t> >(nodes.get_allocator()));
+        candidates.reserve(n + 1);
+        k_nearest(0, search, n, candidates);
+
+        std::sort_heap(candidates.begin(), candidates.end());
+        Topology<1> res(candidates.size());
+        for(const auto &c : candidates)
+            res.push_back(Element{c.second});
+        return res;
+    }
+
+//------------------------------------------------------------------------------
+
+    Topology<1> in_circle(const Point<T> &search, T radius) const {
+        Topology<1> res; //all points within the circle
+        if(radius <= 0.0) return res; //no real search if radius <= 0
+        in_circle(0, search, radius * radius, res);
+        return res;
+    }
+
+//------------------------------------------------------------------------------
+
+    Topology<1> in_box(const Point<T> &search, T xSize, T ySize) const {
+        Topology<1> res; //all points within the box
+        if(xSize <= 0.0 || ySize <= 0.0) return res; //no real search if width or height <= 0
+        in_box(0, search, 0.5 * xSize, 0.5 * ySize, res);
+        return res;
+    }
+
+    ///the number of points within the box, whole nodes within the box are counted by their aggregate
+    size_t count_in_box(const Point<T> &search, T xSize, T ySize) const {
+        if(xSize <= 0.0 || ySize <= 0.0) return 0;
+        return count_in_box(0, search, 0.5 * xSize, 0.5 * ySize);
+    }
+
+//------------------------------------------------------------------------------
+
+    ///number and centroid of the points within the whole tree
+    Region region() const {
+        return region_of(nodes[0]);
+    }
+
+    ///all non-empty regions at the given depth (or leafs above it), e.g. to render clustered data with a level of detail
+    std::vector<Region> regions(size_t depth) const {
+        std::vector<Region> out;
+        regions(0, depth, out);
+        return out;
+    }
+
+    ///the centroids of all non-empty regions at the given depth
+    PointCloud<T> level_of_detail(size_t depth) const {
+        auto all = regions(depth);
+        PointCloud<T> out(all.size());
+        for(const auto &r : all)
+            out.push_back(r.centroid);
+        return out;
+    }
+
+//------------------------------------------------------------------------------
+
+private:
+
+    static void check_finite(const Point<T> &p) {
+        if(!std::isfinite(p.x) || !std::isfinite(p.y))
+            throw std::invalid_argument ("QuadTree can't index non-finite coordinates");
+    }
+
+    static inline bool contains(const Node &node, const Point<T> &p) {
+        return p.x >= node.cx - node.half && p.x <= node.cx + node.half
+            && p.y >= node.cy - node.half && p.y <= node.cy + node.half;
+    }
+
+    static inline size_t quadrant(const Node &node, const Point<T> &p) {
+        return (p.x >= node.cx ? 1 : 0) + (p.y >= node.cy ? 2 : 0);
+    }
+
+    static inline void add_to(Node &node, const Point<T> &p) {
+        ++node.count;
+        node.sumX += p.x;
+        node.sumY += p.y;
+    }
+
+    static inline void remove_from(Node &node, const Point<T> &p) {
+        if(--node.count == 0)
+            node.sumX = node.sumY = 0;
+        else {
+            node.sumX -= p.x;
+            node.sumY -= p.y;
+        }
+    }
+
+    static inline T sqr_distance_to_box(const Node &node, const Point<T> &p) {
+        T dx = std::max(std::fabs(p.x - node.cx) - node.half, T(0));
+        T dy = std::max(std::fabs(p.y - node.cy) - node.half, T(0));
+        return dx * dx + dy * dy;
+    }
+
+    ///like sqr_distance_to_box, but reduced by a few ulps of the coordinates involved, so rounding can't prune points on a circle
+    ///(sqr_distance_to may round to double precision, so its epsilon is added)
+    static inline T sqr_distance_to_box_lower(const Node &node, const Point<T> &p) {
+        const T epsilon = std::numeric_limits<T>::epsilon() + T(std::numeric_limits<double>::epsilon());
+        T dx = std::fabs(p.x - node.cx) - node.half;
+        T dy = std::fabs(p.y - node.cy) - node.half;
+        dx = std::max(dx - 4 * epsilon * (std::fabs(p.x) + std::fabs(node.cx) + node.half), T(0));
+        dy = std::max(dy - 4 * epsilon * (std::fabs(p.y) + std::fabs(node.cy) + node.half), T(0));
+        return (dx * dx + dy * dy) * (1 - 4 * epsilon);
+    }
+
+    static Region region_of(const Node &node) {
+        Point<T> centroid{0, 0};
+        if(node.count > 0)
+            centroid = Point<T>{node.sumX / node.count, node.sumY / node.count};
+        return Region{Point<T>{node.cx, node.cy}, 2 * node.half, node.count, centroid};
+    }
+
+//------------------------------------------------------------------------------
+
+    size_t alloc_group(const Node parentNode) { //a copy, since the pool might grow
+        size_t first;
+        if(!freeGroups.empty()) {
+            first = freeGroups.back();
+            freeGroups.pop_back();
+        }
+        else {
+            first = nodes.size();
+            nodes.resize(nodes.size() + 4);
+        }
+        const T half = 0.5 * parentNode.half;
+        for(size_t q = 0; q < 4; ++q) {
+            T cx = parentNode.cx + ((q & 1) ? half : -half);
+            T cy = parentNode.cy + ((q & 2) ? half : -half);
+            nodes[first + q] = Node{cx, cy, half, NONE, NONE, 0, 0, 0};
+        }
+        return first;
+    }
+
+    size_t alloc_block() {
+        if(!freeBlocks.empty()) {
+            size_t block = freeBlocks.back();
+            freeBlocks.pop_back();
+            blockNext[block] = NONE;
+            return block;
+        }
+        blockNext.push_back(NONE);
+        blockIds.resize(blockIds.size() + bucketSize);
+        return blockNext.size() - 1;
+    }
+
+    void free_blocks(size_t block) {
+        while(block != NONE) {
+            freeBlocks.push_back(block);
+            block = blockNext[block];
+        }
+    }
+
+//------------------------------------------------------------------------------
+
+    void leaf_append(size_t index, size_t pId) {
+        Node &node = nodes[index];
+        size_t slot = node.count;
+        if(node.block == NONE)
+            node.block = alloc_block();
+        size_t block = node.block;
+        for(; slot >= bucketSize; slot -= bucketSize) {
+            if(blockNext[block] == NONE) {
+                size_t next = alloc_block();
+                blockNext[block] = next;
+            }
+            block = blockNext[block];
+        }
+        blockIds[block * bucketSize + slot] = pId;
+        add_to(node, (*pc)[pId]);
+    }
+
+    bool leaf_remove(size_t index, size_t pId) {
+        Node &node = nodes[index];
+        size_t
+            found = NONE,
+            last = NONE,
+            lastBlock = node.block,
+            beforeLast = NONE;
+
+        size_t block = node.block;
+        for(size_t i = 0; i < node.count; ++i) {
+            if(i > 0 && i % bucketSize == 0) {
+                beforeLast = block;
+                block = blockNext[block];
+            }
+            size_t at = block * bucketSize + i % bucketSize;
+            if(blockIds[at] == pId)
+                found = at;
+            last = at;
+            lastBlock = block;
+        }
+        if(found == NONE)
+            return false;
+
+        blockIds[found] = blockIds[last];
+        remove_from(node, (*pc)[pId]);
+        if(node.count % bucketSize == 0) { //the last bucket became empty
+            free_blocks(lastBlock);
+            if(beforeLast == NONE)
+                node.block = NONE;
+            else
+                blockNext[beforeLast] = NONE;
+        }
+        return true;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///turns the leaf into an inner node and distributes its ids onto four new children
+    void split(size_t index) {
+        scratch.clear();
+        gather(index, scratch);
+        free_blocks(nodes[index].block);
+
+        size_t first = alloc_group(nodes[index]);
+        Node &node = nodes[index];
+        node.block = NONE;
+        node.firstChild = first;
+        for(auto pId : scratch)
+            leaf_append(first + quadrant(node, (*pc)[pId]), pId);
+    }
+
+    ///turns the inner node back into a leaf holding all ids of its children
+    void merge(size_t index) {
+        scratch.clear();
+        gather(index, scratch);
+        release_children(index);
+
+        Node &node = nodes[index];
+        node.firstChild = NONE;
+        node.block = NONE;
+        node.count = 0;
+        node.sumX = node.sumY = 0;
+        for(auto pId : scratch)
+            leaf_append(index, pId);
+    }
+
+    void release_children(size_t index) {
+        const Node &node = nodes[index];
+        if(node.firstChild == NONE) {
+            free_blocks(node.block);
+            return;
+        }
+        for(size_t q = 0; q < 4; ++q)
+            release_children(node.firstChild + q);
+        freeGroups.push_back(node.firstChild);
+    }
+
+    template <typename Container>
+    void gather(size_t index, Container &out) const {
+        const Node &node = nodes[index];
+        if(node.firstChild != NONE) {
+            for(size_t q = 0; q < 4; ++q)
+                gather(node.firstChild + q, out);
+            return;
+        }
+        size_t block = node.block;
+        for(size_t i = 0; i < node.count; ++i) {
+            if(i > 0 && i % bucketSize == 0)
+                block = blockNext[block];
+            out.push_back(blockIds[block * bucketSize + i % bucketSize]);
+        }
+    }
+
+    ///doubles the size of the root, making the current root a child of it, so the root grows towards p
+    void grow_towards(const Point<T> &p) {
+        Node old = nodes[0];
+        size_t q = (p.x < old.cx ? 1 : 0) + (p.y < old.cy ? 2 : 0); //quadrant of the old root within the new one
+
+        Node root = old;
+        root.cx = old.cx + ((q & 1) ? -old.half : old.half);
+        root.cy = old.cy + ((q & 2) ? -old.half : old.half);
+        root.half = 2 * old.half;
+        root.block = NONE;
+
+        size_t first = alloc_group(root);
+        nodes[first + q] = old;
+        root.firstChild = first;
+        nodes[0] = root;
+    }
+
+//------------------------------------------------------------------------------
+
+    template <typename F>
+    void for_each_in_leaf(const Node &node, F &f) const {
+        size_t block = node.block;
+        for(size_t i = 0; i < node.count; ++i) {
+            if(i > 0 && i % bucketSize == 0)
+                block = blockNext[block];
+            f(blockIds[block * bucketSize + i % bucketSize]);
+        }
+    }
+
+//------------------------------------------------------------------------------
+
+    void k_nearest(size_t index, const Point<T> &search, size_t n, Candidates &candidates) const {
+        const Node &node = nodes[index];
+        if(node.count == 0)
+            return;
+
+        if(node.firstChild == NONE) {
+            auto consider = [&](size_t pId) {
+                T distance = search.sqr_distance_to((*pc)[pId]);
+                if(candidates.size() < n) {
+                    candidates.push_back(std::make_pair(distance, pId));
+                    std::push_heap(candidates.begin(), candidates.end());
+                }
+                else if(distance < candidates.front().first) {
+                    std::pop_heap(candidates.begin(), candidates.end());
+                    candidates.back() = std::make_pair(distance, pId);
+                    std::push_heap(candidates.begin(), candidates.end());
+                }
+            };
+            for_each_in_leaf(node, consider);
+            return;
+        }
+
+        //visit the children closest to search first
+        std::pair<T, size_t> children[4];
+        for(size_t q = 0; q < 4; ++q)
+            children[q] = std::make_pair(sqr_distance_to_box(nodes[node.firstChild + q], search), node.firstChild + q);
+        std::sort(children, children + 4);
+
+        for(const auto &child : children) {
+            if(candidates.size() == n && child.first >= candidates.front().first)
+                break;
+            k_nearest(child.second, search, n, candidates);
+        }
+    }
+
+//------------------------------------------------------------------------------
+
+    void in_circle(size_t index, const Point<T> &search, T sqrRadius, Topology<1> &res) const {
+        const Node &node = nodes[index];
+        if(node.count == 0 || sqr_distance_to_box_lower(node, search) > sqrRadius)
+            return;
+
+        if(node.firstChild == NONE) {
+            auto add = [&](size_t pId) {
+                if(search.sqr_distance_to((*pc)[pId]) <= sqrRadius)
+                    res.push_back(Element{pId});
+            };
+            for_each_in_leaf(node, add);
+            return;
+        }
+        for(size_t q = 0; q < 4; ++q)
+            in_circle(node.firstChild + q, search, sqrRadius, res);
+    }
+
+//------------------------------------------------------------------------------
+
+    static inline bool overlaps(const Node &node, const Point<T> &search, T xHalf, T yHalf) {
+        return std::fabs(node.cx - search.x) <= node.half + xHalf
+            && std::fabs(node.cy - search.y) <= node.half + yHalf;
+    }
+
+    static inline bool within_box(const Point<T> &p, const Point<T> &search, T xHalf, T yHalf) {
+        return std::fabs(p.x - search.x) <= xHalf && std::fabs(p.y - search.y) <= yHalf;
+    }
+
+    void in_box(size_t index, const Point<T> &search, T xHalf, T yHalf, Topology<1> &res) const {
+        const Node &node = nodes[index];
+        if(node.count == 0 || !overlaps(node, search, xHalf, yHalf))
+            return;
+
+        if(node.firstChild == NONE) {
+            auto add = [&](size_t pId) {
+                if(within_box((*pc)[pId], search, xHalf, yHalf))
+                    res.push_back(Element{pId});
+            };
+            for_each_in_leaf(node, add);
+            return;
+        }
+        for(size_t q = 0; q < 4; ++q)
+            in_box(node.firstChild + q, search, xHalf, yHalf, res);
+    }
+
+    size_t count_in_box(size_t index, const Point<T> &search, T xHalf, T yHalf) const {
+        const Node &node = nodes[index];
+        if(node.count == 0 || !overlaps(node, search, xHalf, yHalf))
+            return 0;
+        if(std::fabs(node.cx - search.x) + node.half <= xHalf && std::fabs(node.cy - search.y) + node.half <= yHalf)
+            return node.count; //completely within the box
+
+        size_t count(0);
+        if(node.firstChild == NONE) {
+            auto add = [&](size_t pId) {
+                if(within_box((*pc)[pId], search, xHalf, yHalf))
+                    ++count;
+            };
+            for_each_in_leaf(node, add);
+            return count;
+        }
+        for(size_t q = 0; q < 4; ++q)
+            count += count_in_box(node.firstChild + q, search, xHalf, yHalf);
+        return count;
+    }
+
+//------------------------------------------------------------------------------
+
+    void regions(size_t index, size_t depth, std::vector<Region> &out) const {
+        const Node &node = nodes[index];
+        if(node.count == 0)
+            return;
+        if(depth == 0 || node.firstChild == NONE) {
+            out.push_back(region_of(node));
+            return;
+        }
+        for(size_t q = 0; q < 4; ++q)
+            regions(node.firstChild + q, depth - 1, out);
+    }
+};
+
+template <typename T>
+const size_t QuadTree<T>::NONE;
+
+} //lib_2d
+
+#endif //QUADTREE_H_INCLUDED
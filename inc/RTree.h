@@ -0,0 +1,530 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    RTree.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class RTree, a packed R-tree over the segments of one or more paths
+ *          the tree is bulk loaded with sort-tile-recursive (STR) and can't be changed afterwards
+ *          segments are referenced as {path, segment}, where segment i connects the points i and i+1 of the path
+ *          the endpoints are stored within the tree, so it can be serialized and reloaded without the paths
+ */
+
+#ifndef RTREE_H_INCLUDED
+#define RTREE_H_INCLUDED
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <cmath>
+#include <limits>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "Point.h"
+#include "PointCloudView.h"
+#include "PointCloud.h"
+#include "Topology.h"
+#include "MemoryResource.h"
+#include "calc.h"
+
+namespace lib_2d {
+
+template <typename T>
+class RTree {
+
+using Element = std::array<size_t, 2>;
+
+private:
+
+//------------------------------------------------------------------------------
+
+    struct Segment {
+        size_t path, seg;
+        Point<T> a, b;
+    };
+
+    ///all nodes are stored within one pool, level by level, the root is the last node
+    ///the children of a node are consecutive, either within 'segments' (leafs) or within 'nodes'
+    struct Node {
+        T minX, minY, maxX, maxY;
+        size_t first, count;
+        bool leaf;
+    };
+
+    template <typename U>
+    using Buffer = std::vector<U, ResourceAllocator<U> >;
+
+    size_t nodeCapacity;
+
+    Buffer<Segment> segments;
+
+    Buffer<Node> nodes;
+
+//------------------------------------------------------------------------------
+
+public:
+    explicit RTree(size_t nodeCapacity = 16, MemoryResource *resource = nullptr) :
+        nodeCapacity(nodeCapacity < 2 ? 2 : nodeCapacity),
+        segments(ResourceAllocator<Segment>(resource)),
+        nodes(ResourceAllocator<Node>(resource)) {}
+
+    explicit RTree(const PointCloudView<T> &path, size_t nodeCapacity = 16, MemoryResource *resource = nullptr) :
+        RTree(nodeCapacity, resource) {
+
+        add_segments(0, path);
+        build();
+    }
+
+    explicit RTree(const std::vector< PointCloudView<T> > &paths, size_t nodeCapacity = 16, MemoryResource *resource = nullptr) :
+        RTree(nodeCapacity, resource) {
+
+        size_t n(0);
+        for(const auto &path : paths)
+            n += path.size() > 1 ? path.size() - 1 : 0;
+        segments.reserve(n);
+
+        for(size_t i = 0; i < paths.size(); ++i)
+            add_segments(i, paths[i]);
+        build();
+    }
+
+//------------------------------------------------------------------------------
+
+    ///number of indexed segments
+    size_t size() const {
+        return segments.size();
+    }
+
+    bool empty() const {
+        return segments.empty();
+    }
+
+    size_t n_nodes() const {
+        return nodes.size();
+    }
+
+    size_t get_node_capacity() const {
+        return nodeCapacity;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///all segments which intersect the box, as {path, segment}
+    Topology<2> in_box(const Point<T> &search, T xSize, T ySize) const {
+        Topology<2> res;
+        if(xSize <= 0.0 || ySize <= 0.0 || empty()) return res; //no real search if width or height <= 0
+
+        const T
+            minX = search.x - 0.5 * xSize,
+            maxX = search.x + 0.5 * xSize,
+            minY = search.y - 0.5 * ySize,
+            maxY = search.y + 0.5 * ySize;
+
+        for_each_overlapping(nodes.size() - 1, minX, minY, maxX, maxY, [&](const Segment &s) {
+            if(segment_in_box(s.a, s.b, minX, minY, maxX, maxY))
+                res.push_back(Element{s.path, s.seg});
+        });
+        return res;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the segment closest to search, as {path, segment}
+    Element nearest(const Point<T> &search) const {
+        if(empty())
+            throw std::out_of_range ("RTree is empty, there is no nearest segment");
+
+        //best first search, always expanding the node with the smallest distance to search
+        using Entry = std::pair<T, size_t>;
+        Buffer<Entry> queue(ResourceAllocator<Entry>(nodes.get_allocator()));
+        std::greater<Entry> closer;
+
+        Element best{{0, 0}};
+        T distanceBest = std::numeric_limits<T>::max();
+
+        queue.push_back(Entry(sqr_distance_to_box(nodes.back(), search), nodes.size() - 1));
+        while(!queue.empty()) {
+            std::pop_heap(queue.begin(), queue.end(), closer);
+            Entry current = queue.back();
+            queue.pop_back();
+            if(current.first >= distanceBest)
+                break;
+
+            const Node &node = nodes[current.second];
+            for(size_t i = node.first; i < node.first + node.count; ++i) {
+                if(node.leaf) {
+                    const Segment &s = segments[i];
+                    T distance = sqr_distance_point_segment(search, s.a, s.b);
+                    if(distance < distanceBest) {
+                        distanceBest = distance;
+                        best = Element{{s.path, s.seg}};
+                    }
+                }
+                else {
+                    T distance = sqr_distance_to_box(nodes[i], search);
+                    if(distance < distanceBest) {
+                        queue.push_back(Entry(distance, i));
+                        std::push_heap(queue.begin(), queue.end(), closer);
+                    }
+                }
+            }
+        }
+        return best;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///all pairs of segments of both trees with overlapping bounding boxes, as {path, segment, otherPath, otherSegment}
+    ///if onlyIntersecting is set, the candidates are filtered to the pairs which really intersect
+    Topology<4> join(const RTree &other, bool onlyIntersecting = false) const {
+        Topology<4> res;
+        if(empty() || other.empty())
+            return res;
+        join(nodes.size() - 1, other, other.nodes.size() - 1, onlyIntersecting, res);
+        return res;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the intersections between the path and all indexed segments
+    //this method should be kept similar to "intersects_with"
+    PointCloud<T> intersections_with(const PointCloudView<T> &path) const {
+        PointCloud<T> intersections;
+        if(empty())
+            return intersections;
+
+        for(size_t i = 0; i + 1 < path.size(); ++i) {
+            const auto &p1 = path[i];
+            const auto &p2 = path[i+1];
+            for_each_overlapping(nodes.size() - 1,
+                std::min(p1.x, p2.x), std::min(p1.y, p2.y), std::max(p1.x, p2.x), std::max(p1.y, p2.y),
+                [&](const Segment &s) {
+                    Point<T> intersection;
+                    if(segment_intersection(p1, p2, s.a, s.b, intersection))
+                        intersections.push_back(intersection);
+                });
+        }
+        return intersections;
+    }
+
+    //this method should be kept similar to "intersections_with"
+    bool intersects_with(const PointCloudView<T> &path) const {
+        if(empty())
+            return false;
+
+        for(size_t i = 0; i + 1 < path.size(); ++i) {
+            if(intersects_segment(nodes.size() - 1, path[i], path[i+1]))
+                return true;
+        }
+        return false;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///serializes the whole tree, segments and nodes, so loading it doesn't have to rebuild it
+    std::string to_string() const {
+        std::stringstream ss;
+        ss.precision(std::numeric_limits<T>::max_digits10);
+        ss << "rtree " << nodeCapacity << " " << segments.size() << " " << nodes.size() << "\n";
+        for(const auto &s : segments)
+            ss << s.path << " " << s.seg << " " << s.a.x << " " << s.a.y << " " << s.b.x << " " << s.b.y << "\n";
+        for(const auto &n : nodes)
+            ss << n.first << " " << n.count << " " << n.leaf << " " << n.minX << " " << n.minY << " " << n.maxX << " " << n.maxY << "\n";
+        return ss.str();
+    }
+
+//------------------------------------------------------------------------------
+
+    bool to_file(const std::string &path) const {
+        std::ofstream out(path.c_str());
+        if(!out.good())
+            return false;
+        out << to_string();
+        out.close();
+        return true;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///loads a tree created by to_string(), the tree stays unchanged if the input is invalid
+    bool from_string(const std::string &input) {
+        std::stringstream ss(input);
+        std::string header("");
+        size_t capacity(0), nSegments(0), nNodes(0);
+        if(!(ss >> header >> capacity >> nSegments >> nNodes) || header != "rtree" || capacity < 2)
+            return false;
+
+        Buffer<Segment> newSegments(segments.get_allocator());
+        Buffer<Node> newNodes(nodes.get_allocator());
+        newSegments.reserve(nSegments);
+        newNodes.reserve(nNodes);
+
+        for(size_t i = 0; i < nSegments; ++i) {
+            Segment s;
+            if(!(ss >> s.path >> s.seg >> s.a.x >> s.a.y >> s.b.x >> s.b.y))
+                return false;
+            newSegments.push_back(s);
+        }
+        for(size_t i = 0; i < nNodes; ++i) {
+            Node n;
+            if(!(ss >> n.first >> n.count >> n.leaf >> n.minX >> n.minY >> n.maxX >> n.maxY))
+                return false;
+            size_t nChildren = n.leaf ? nSegments : i; //children are always stored before their parent
+            if(n.count == 0 || n.first + n.count > nChildren)
+                return false;
+            newNodes.push_back(n);
+        }
+        if((nSegments == 0) != (nNodes == 0))
+            return false;
+
+        nodeCapacity = capacity;
+        segments.swap(newSegments);
+        nodes.swap(newNodes);
+        return true;
+    }
+
+//------------------------------------------------------------------------------
+
+    bool from_file(const std::string &path) {
+        std::ifstream in(path.c_str());
+        if(!in.good())
+            return false;
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        in.close();
+        return from_string(buffer.str());
+    }
+
+//------------------------------------------------------------------------------
+
+    ///sort-tile-recursive: sorts by x, cuts into vertical slices of whole nodes and sorts each slice by y
+    ///the packing of the tree, also used by ReverseKNearest for its trees of circles
+    template <typename Iterator, typename Center>
+    static void str_sort(Iterator first, Iterator last, size_t capacity, Center center) {
+        typedef typename std::iterator_traits<Iterator>::value_type Value;
+        const size_t
+            n = last - first,
+            nNodes = (n + capacity - 1) / capacity,
+            nSlices = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(nNodes)))),
+            sliceSize = nSlices * capacity;
+
+        std::sort(first, last, [&](const Value &lhs, const Value &rhs) {
+            return center(lhs).x < center(rhs).x;
+        });
+        for(size_t i = 0; i < n; i += sliceSize) {
+            std::sort(first + i, first + std::min(n, i + sliceSize), [&](const Value &lhs, const Value &rhs) {
+                return center(lhs).y < center(rhs).y;
+            });
+        }
+    }
+
+//------------------------------------------------------------------------------
+
+private:
+
+    void add_segments(size_t pathId, const PointCloudView<T> &path) {
+        for(size_t i = 0; i + 1 < path.size(); ++i)
+            segments.push_back(Segment{pathId, i, path[i], path[i+1]});
+    }
+
+//------------------------------------------------------------------------------
+
+    void build() {
+        nodes.clear();
+        if(segments.empty())
+            return;
+
+        str_sort(segments.begin(), segments.end(), nodeCapacity, [](const Segment &s) {
+            return Point<T>{T(0.5) * (s.a.x + s.b.x), T(0.5) * (s.a.y + s.b.y)};
+        });
+
+        const size_t nLeafs = (segments.size() + nodeCapacity - 1) / nodeCapacity;
+        nodes.reserve(nLeafs + nLeafs / (nodeCapacity - 1) + 32);
+
+        for(size_t i = 0; i < segments.size(); i += nodeCapacity) {
+            Node leaf = empty_node(i, std::min(nodeCapacity, segments.size() - i), true);
+            for(size_t j = i; j < leaf.first + leaf.count; ++j) {
+                extend(leaf, segments[j].a);
+                extend(leaf, segments[j].b);
+            }
+            nodes.push_back(leaf);
+        }
+
+        //pack each level into the next one, until there's only the root left
+        size_t levelStart = 0;
+        while(nodes.size() - levelStart > 1) {
+            const size_t levelEnd = nodes.size();
+            str_sort(nodes.begin() + levelStart, nodes.begin() + levelEnd, nodeCapacity, [](const Node &n) {
+                return Point<T>{T(0.5) * (n.minX + n.maxX), T(0.5) * (n.minY + n.maxY)};
+            });
+
+            for(size_t i = levelStart; i < levelEnd; i += nodeCapacity) {
+                Node inner = empty_node(i, std::min(nodeCapacity, levelEnd - i), false);
+                for(size_t j = i; j < inner.first + inner.count; ++j) {
+                    inner.minX = std::min(inner.minX, nodes[j].minX);
+                    inner.minY = std::min(inner.minY, nodes[j].minY);
+                    inner.maxX = std::max(inner.maxX, nodes[j].maxX);
+                    inner.maxY = std::max(inner.maxY, nodes[j].maxY);
+                }
+                nodes.push_back(inner);
+            }
+            levelStart = levelEnd;
+        }
+    }
+
+    static Node empty_node(size_t first, size_t count, bool leaf) {
+        return Node{
+            std::numeric_limits<T>::max(), std::numeric_limits<T>::max(),
+            std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest(),
+            first, count, leaf};
+    }
+
+    static inline void extend(Node &node, const Point<T> &p) {
+        node.minX = std::min(node.minX, p.x);
+        node.minY = std::min(node.minY, p.y);
+        node.maxX = std::max(node.maxX, p.x);
+        node.maxY = std::max(node.maxY, p.y);
+    }
+
+//------------------------------------------------------------------------------
+
+    static inline bool overlaps(const Node &node, T minX, T minY, T maxX, T maxY) {
+        return node.minX <= maxX && minX <= node.maxX && node.minY <= maxY && minY <= node.maxY;
+    }
+
+    static inline bool overlaps(const Node &lhs, const Node &rhs) {
+        return overlaps(lhs, rhs.minX, rhs.minY, rhs.maxX, rhs.maxY);
+    }
+
+    static inline bool overlaps(const Segment &lhs, const Segment &rhs) {
+        return std::min(lhs.a.x, lhs.b.x) <= std::max(rhs.a.x, rhs.b.x) && std::min(rhs.a.x, rhs.b.x) <= std::max(lhs.a.x, lhs.b.x)
+            && std::min(lhs.a.y, lhs.b.y) <= std::max(rhs.a.y, rhs.b.y) && std::min(rhs.a.y, rhs.b.y) <= std::max(lhs.a.y, lhs.b.y);
+    }
+
+    static inline T sqr_distance_to_box(const Node &node, const Point<T> &p) {
+        T dx = std::max(std::max(node.minX - p.x, p.x - node.maxX), T(0));
+        T dy = std::max(std::max(node.minY - p.y, p.y - node.maxY), T(0));
+        return dx * dx + dy * dy;
+    }
+
+    ///Liang-Barsky clipping of the segment [a, b] against the box
+    static bool segment_in_box(const Point<T> &a, const Point<T> &b, T minX, T minY, T maxX, T maxY) {
+        const T
+            dx = b.x - a.x,
+            dy = b.y - a.y,
+            p[4] = {-dx, dx, -dy, dy},
+            q[4] = {a.x - minX, maxX - a.x, a.y - minY, maxY - a.y};
+
+        T
+            tMin(0),
+            tMax(1);
+
+        for(size_t i = 0; i < 4; ++i) {
+            if(p[i] == 0) {
+                if(q[i] < 0)
+                    return false; //parallel and outside
+                continue;
+            }
+            T t = q[i] / p[i];
+            if(p[i] < 0) {
+                if(t > tMax) return false;
+                if(t > tMin) tMin = t;
+            }
+            else {
+                if(t < tMin) return false;
+                if(t < tMax) tMax = t;
+            }
+        }
+        return true;
+    }
+
+//------------------------------------------------------------------------------
+
+    template <typename F>
+    void for_each_overlapping(size_t index, T minX, T minY, T maxX, T maxY, F f) const {
+        const Node &node = nodes[index];
+        if(!overlaps(node, minX, minY, maxX, maxY))
+            return;
+
+        for(size_t i = node.first; i < node.first + node.count; ++i) {
+            if(!node.leaf)
+                for_each_overlapping(i, minX, minY, maxX, maxY, f);
+            else {
+                const Segment &s = segments[i];
+                if(   std::min(s.a.x, s.b.x) <= maxX && minX <= std::max(s.a.x, s.b.x)
+                   && std::min(s.a.y, s.b.y) <= maxY && minY <= std::max(s.a.y, s.b.y))
+                    f(s);
+            }
+        }
+    }
+
+    bool intersects_segment(size_t index, const Point<T> &p1, const Point<T> &p2) const {
+        const Node &node = nodes[index];
+        if(!overlaps(node, std::min(p1.x, p2.x), std::min(p1.y, p2.y), std::max(p1.x, p2.x), std::max(p1.y, p2.y)))
+            return false;
+
+        for(size_t i = node.first; i < node.first + node.count; ++i) {
+            if(node.leaf ? segments_intersect(p1, p2, segments[i].a, segments[i].b) : intersects_segment(i, p1, p2))
+                return true;
+        }
+        return false;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///synchronous traversal of both trees, descending into the larger node first
+    void join(size_t index, const RTree &other, size_t otherIndex, bool onlyIntersecting, Topology<4> &res) const {
+        const Node &node = nodes[index];
+        const Node &otherNode = other.nodes[otherIndex];
+        if(!overlaps(node, otherNode))
+            return;
+
+        if(node.leaf && otherNode.leaf) {
+            for(size_t i = node.first; i < node.first + node.count; ++i) {
+                const Segment &s = segments[i];
+                for(size_t j = otherNode.first; j < otherNode.first + otherNode.count; ++j) {
+                    const Segment &o = other.segments[j];
+                    if(!overlaps(s, o))
+                        continue;
+                    if(onlyIntersecting && !segments_intersect(s.a, s.b, o.a, o.b))
+                        continue;
+                    res.push_back(std::array<size_t, 4>{{s.path, s.seg, o.path, o.seg}});
+                }
+            }
+            return;
+        }
+
+        const bool descendThis = !node.leaf && (otherNode.leaf
+            || (node.maxX - node.minX) * (node.maxY - node.minY) >= (otherNode.maxX - otherNode.minX) * (otherNode.maxY - otherNode.minY));
+
+        if(descendThis) {
+            for(size_t i = node.first; i < node.first + node.count; ++i)
+                join(i, other, otherIndex, onlyIntersecting, res);
+        }
+        else {
+            for(size_t j = otherNode.first; j < otherNode.first + otherNode.count; ++j)
+                join(index, other, j, onlyIntersecting, res);
+        }
+    }
+};
+
+} //lib_2d
+
+#endif //RTREE_H_INCLUDED
@@ -0,0 +1,654 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    Ransac.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class Ransac, robust fitting of lines, circles and ellipses to noisy PointClouds
+ *          the points are stored normalized as separate x and y arrays, inliers are counted without branches in blocks
+ *          and a hypothesis is dropped as soon as it can't beat the best one anymore or fails the T(d,d) pre test
+ *          every hypothesis draws its sample from its own generator, so the result doesn't depend on the number of threads
+ *          given a quality per point, samples are drawn from a growing set of the best points (PROSAC)
+ */
+
+#ifndef RANSAC_H_INCLUDED
+#define RANSAC_H_INCLUDED
+
+#include <vector>
+#include <array>
+#include <utility>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cmath>
+#include <cstdint>
+
+#include "constants.h"
+#include "Point.h"
+#include "PointCloudView.h"
+#include "Topology.h"
+#include "LineSegment.h"
+#include "Arc.h"
+#include "Ellipse.h"
+#include "parallel.h"
+
+namespace lib_2d {
+
+template <typename T>
+class Ransac {
+
+using Element = std::array<size_t, 1>;
+
+public:
+
+    struct Settings {
+        T threshold = 1; //maximum distance of an inlier to the model
+        T confidence = T(0.99); //probability of having drawn at least one sample of inliers only, before stopping early
+        size_t maxIterations = 10000;
+        size_t preTest = 1; //d of the T(d,d) test, number of random points which have to be inliers before counting all of them
+        uint64_t seed = 1337;
+        size_t nThreads = 0;
+    };
+
+    struct LineFit {
+        bool found = false;
+        Point<T> start, end; //the extent of the inliers along the line
+        Topology<1> inliers;
+        size_t nHypotheses = 0;
+
+        LineSegment<T> segment() const {
+            return LineSegment<T>(start, end);
+        }
+    };
+
+    struct CircleFit {
+        bool found = false;
+        Point<T> center;
+        T radius = 0;
+        T radiansStart = 0, radiansEnd = 0; //the extent of the inliers, the largest gap between them is left out
+        Topology<1> inliers;
+        size_t nHypotheses = 0;
+
+        Arc<T> arc(unsigned int nPoints) const {
+            return Arc<T>(2 * radius, nPoints, false, radiansStart, radiansEnd, center);
+        }
+
+        Arc<T> circle(unsigned int nPoints) const {
+            return Arc<T>(2 * radius, nPoints, true, 0, LIB_2D_2PI, center);
+        }
+    };
+
+    struct EllipseFit {
+        bool found = false;
+        Point<T> center;
+        T a = 0, b = 0, angle = 0; //a is the semi axis in direction of angle
+        Topology<1> inliers;
+        size_t nHypotheses = 0;
+
+        Ellipse<T> ellipse(unsigned int nPoints, bool closePath = true) const {
+            return Ellipse<T>(a, b, nPoints, closePath, center, angle);
+        }
+    };
+
+private:
+
+    ///n x + c <= threshold
+    struct LineModel {
+        T nx, ny, c;
+
+        inline bool inlier(T x, T y, T sqrThreshold) const {
+            const T d = nx * x + ny * y - c;
+            return d * d <= sqrThreshold;
+        }
+    };
+
+    struct CircleModel {
+        T cx, cy, r;
+
+        inline bool inlier(T x, T y, T threshold) const {
+            const T dx = x - cx, dy = y - cy;
+            const T d = dx * dx + dy * dy;
+            const T inner = std::max(r - threshold, T(0));
+            const T outer = r + threshold;
+            return (d >= inner * inner) & (d <= outer * outer);
+        }
+    };
+
+    ///a x^2 + b xy + c y^2 + d x + e y + f = 0 with the Sampson distance as first order approximation of the distance
+    struct ConicModel {
+        T a, b, c, d, e, f;
+
+        inline bool inlier(T x, T y, T sqrThreshold) const {
+            const T value = a * x * x + b * x * y + c * y * y + d * x + e * y + f;
+            const T gx = 2 * a * x + b * y + d;
+            const T gy = b * x + 2 * c * y + e;
+            return value * value <= sqrThreshold * (gx * gx + gy * gy);
+        }
+    };
+
+    ///splitmix64, cheap enough to be seeded for every single hypothesis
+    struct Random {
+        uint64_t state;
+
+        explicit Random(uint64_t seed) : state(seed) {}
+
+        inline uint64_t next() {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        inline size_t below(size_t n) {
+            return size_t(next() % n);
+        }
+    };
+
+    using Sample = std::array<size_t, 5>;
+
+    enum : size_t {BLOCK = 1024, BATCH = 256, NONE = static_cast<size_t>(-1)};
+
+    std::vector<T> xs, ys; //normalized, in order of decreasing quality
+    std::vector<size_t> ids;
+    Point<T> origin;
+    T scale;
+    bool ranked;
+
+//------------------------------------------------------------------------------
+
+public:
+
+    ///samples are drawn uniformly
+    explicit Ransac(const PointCloudView<T> &points) :
+        ranked(false) {
+        std::vector<size_t> order(points.size());
+        std::iota(order.begin(), order.end(), size_t(0));
+        init(points, order);
+    }
+
+    ///samples are drawn from the points with the highest quality first
+    Ransac(const PointCloudView<T> &points, const std::vector<T> &quality) :
+        ranked(true) {
+        std::vector<size_t> order(points.size());
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::stable_sort(order.begin(), order.end(), [&quality](size_t lhs, size_t rhs) {
+            return quality[lhs] > quality[rhs];
+        });
+        init(points, order);
+    }
+
+//------------------------------------------------------------------------------
+
+    size_t size() const {
+        return xs.size();
+    }
+
+//------------------------------------------------------------------------------
+
+    LineFit line(const Settings &settings = Settings()) const {
+        LineFit result;
+        LineModel model;
+        std::vector<size_t> inliers;
+        const T threshold = settings.threshold / scale;
+        result.found = search(2, settings, threshold * threshold, model, inliers, result.nHypotheses,
+            [this](const Sample &s, LineModel &m) { return line_through(s[0], s[1], m); },
+            [this](const std::vector<size_t> &in, LineModel &m) { return fit_line(in, m); });
+        if(!result.found)
+            return result;
+
+        T lowest(std::numeric_limits<T>::max()), highest(std::numeric_limits<T>::lowest());
+        for(const auto i : inliers) {
+            const T along = -model.ny * xs[i] + model.nx * ys[i];
+            lowest = std::min(lowest, along);
+            highest = std::max(highest, along);
+        }
+        result.start = denormalize(model.nx * model.c - model.ny * lowest, model.ny * model.c + model.nx * lowest);
+        result.end = denormalize(model.nx * model.c - model.ny * highest, model.ny * model.c + model.nx * highest);
+        result.inliers = to_topology(inliers);
+        return result;
+    }
+
+//------------------------------------------------------------------------------
+
+    CircleFit circle(const Settings &settings = Settings()) const {
+        CircleFit result;
+        CircleModel model;
+        std::vector<size_t> inliers;
+        result.found = search(3, settings, settings.threshold / scale, model, inliers, result.nHypotheses,
+            [this](const Sample &s, CircleModel &m) { return circle_through(s[0], s[1], s[2], m); },
+            [this](const std::vector<size_t> &in, CircleModel &m) { return fit_circle(in, m); });
+        if(!result.found)
+            return result;
+
+        result.center = denormalize(model.cx, model.cy);
+        result.radius = model.r * scale;
+
+        std::vector<T> angles;
+        angles.reserve(inliers.size());
+        for(const auto i : inliers)
+            angles.push_back(std::atan2(ys[i] - model.cy, xs[i] - model.cx));
+        std::sort(angles.begin(), angles.end());
+        T gap = angles.front() + T(LIB_2D_2PI) - angles.back();
+        size_t after = 0;
+        for(size_t i = 1; i < angles.size(); ++i) {
+            if(angles[i] - angles[i-1] > gap) {
+                gap = angles[i] - angles[i-1];
+                after = i;
+            }
+        }
+        result.radiansStart = angles[after];
+        result.radiansEnd = angles[after] + T(LIB_2D_2PI) - gap;
+        result.inliers = to_topology(inliers);
+        return result;
+    }
+
+//------------------------------------------------------------------------------
+
+    EllipseFit ellipse(const Settings &settings = Settings()) const {
+        EllipseFit result;
+        ConicModel model;
+        std::vector<size_t> inliers;
+        const T threshold = settings.threshold / scale;
+        result.found = search(5, settings, threshold * threshold, model, inliers, result.nHypotheses,
+            [this](const Sample &s, ConicModel &m) { return fit_conic(s.data(), 5, m); },
+            [this](const std::vector<size_t> &in, ConicModel &m) { return fit_conic(in.data(), in.size(), m); });
+        if(!result.found)
+            return result;
+
+        T cx(0), cy(0), a(0), b(0), angle(0);
+        ellipse_parameters(model, cx, cy, a, b, angle);
+        result.center = denormalize(cx, cy);
+        result.a = a * scale;
+        result.b = b * scale;
+        result.angle = angle;
+        result.inliers = to_topology(inliers);
+        return result;
+    }
+
+//------------------------------------------------------------------------------
+
+private:
+
+    void init(const PointCloudView<T> &points, const std::vector<size_t> &order) {
+        const size_t n = points.size();
+        T cx(0), cy(0);
+        for(size_t i = 0; i < n; ++i) {
+            cx += points[i].x;
+            cy += points[i].y;
+        }
+        origin = n > 0 ? Point<T>{cx / n, cy / n} : Point<T>{0, 0};
+
+        T sqrSpread(0);
+        for(size_t i = 0; i < n; ++i)
+            sqrSpread += points[i].sqr_distance_to(origin);
+        scale = n > 0 && sqrSpread > 0 ? std::sqrt(sqrSpread / n) : T(1);
+
+        xs.resize(n);
+        ys.resize(n);
+        ids = order;
+        for(size_t i = 0; i < n; ++i) {
+            xs[i] = (points[order[i]].x - origin.x) / scale;
+            ys[i] = (points[order[i]].y - origin.y) / scale;
+        }
+    }
+
+    inline Point<T> denormalize(T x, T y) const {
+        return Point<T>{origin.x + x * scale, origin.y + y * scale};
+    }
+
+    Topology<1> to_topology(std::vector<size_t> &inliers) const {
+        for(auto &i : inliers)
+            i = ids[i];
+        std::sort(inliers.begin(), inliers.end());
+        Topology<1> result;
+        result.reserve_elements(inliers.size());
+        for(const auto i : inliers)
+            result.push_back(Element{i});
+        return result;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the number of inliers, stops early once it can't reach atLeast anymore
+    template <typename Model>
+    size_t count(const Model &model, T threshold, size_t atLeast) const {
+        const size_t n = xs.size();
+        size_t result(0);
+        for(size_t first = 0; first < n; first += BLOCK) {
+            const size_t last = std::min(n, first + size_t(BLOCK));
+            size_t inBlock(0);
+            for(size_t i = first; i < last; ++i)
+                inBlock += model.inlier(xs[i], ys[i], threshold);
+            result += inBlock;
+            if(result + (n - last) < atLeast)
+                return result;
+        }
+        return result;
+    }
+
+    template <typename Model>
+    void collect(const Model &model, T threshold, std::vector<size_t> &inliers) const {
+        inliers.clear();
+        for(size_t i = 0; i < xs.size(); ++i) {
+            if(model.inlier(xs[i], ys[i], threshold))
+                inliers.push_back(i);
+        }
+    }
+
+    ///the hypothesis at which the sampled prefix grows beyond each size, starting at m (PROSAC with maxIterations as T_N)
+    std::vector<size_t> prosac_schedule(size_t m, size_t maxIterations) const {
+        std::vector<size_t> schedule;
+        if(!ranked)
+            return schedule;
+        const size_t n = xs.size();
+        double tn = double(maxIterations);
+        for(size_t i = 0; i < m; ++i)
+            tn *= double(m - i) / double(n - i);
+        double tnPrime = 1;
+        for(size_t size = m; size < n && tnPrime <= double(maxIterations); ++size) {
+            schedule.push_back(size_t(tnPrime));
+            const double next = tn * double(size + 1) / double(size + 1 - m);
+            tnPrime += std::ceil(next - tn);
+            tn = next;
+        }
+        return schedule;
+    }
+
+    ///m distinct indices, the last one of the current prefix and the others within it for PROSAC
+    void draw(size_t m, size_t hypothesis, const std::vector<size_t> &schedule, Random &random, Sample &sample) const {
+        size_t n = xs.size();
+        size_t i(0);
+        if(ranked) {
+            const size_t prefix = m + (std::upper_bound(schedule.begin(), schedule.end(), hypothesis) - schedule.begin());
+            if(prefix < n) {
+                n = prefix;
+                sample[i++] = n - 1;
+                --n;
+            }
+        }
+        while(i < m) {
+            const size_t candidate = random.below(n);
+            if(std::find(sample.begin(), sample.begin() + i, candidate) == sample.begin() + i)
+                sample[i++] = candidate;
+        }
+    }
+
+    ///number of hypotheses to draw at least one sample of inliers only with the requested confidence
+    size_t n_required(size_t m, size_t nInliers, const Settings &settings) const {
+        if(nInliers == 0)
+            return settings.maxIterations;
+        const double ratio = double(nInliers) / double(xs.size());
+        const double good = std::pow(ratio, double(m + settings.preTest)); //the pre test also has to be passed
+        if(good >= 1)
+            return 1;
+        const double required = std::log(1 - double(settings.confidence)) / std::log(1 - good);
+        return required < double(settings.maxIterations) ? size_t(std::ceil(required)) : settings.maxIterations;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///hypotheses are evaluated in batches in parallel, the best one is refit to its inliers, then again as long as that gains inliers
+    ///ties are resolved by the lower hypothesis index, so the result is the same for any number of threads
+    template <typename Model, typename Minimal, typename Refit>
+    bool search(size_t m, const Settings &settings, T threshold, Model &best, std::vector<size_t> &inliers, size_t &nHypotheses,
+                Minimal minimal, Refit refit) const {
+        const size_t n = xs.size();
+        nHypotheses = 0;
+        if(n < m)
+            return false;
+
+        const std::vector<size_t> schedule = prosac_schedule(m, settings.maxIterations);
+        size_t bestCount(0);
+        size_t required = settings.maxIterations;
+
+        struct Candidate {
+            size_t count;
+            size_t hypothesis;
+            Model model;
+        };
+
+        while(nHypotheses < required) {
+            const size_t first = nHypotheses;
+            const size_t last = std::min(required, first + size_t(BATCH));
+            const size_t nChunks = n_chunks((last - first) * n, settings.nThreads, 1 << 16);
+            std::vector<Candidate> candidates(nChunks, Candidate{0, NONE, Model()});
+
+            parallel_chunks(last - first, nChunks, [&](size_t from, size_t to, size_t chunk) {
+                Candidate &local = candidates[chunk];
+                Sample sample;
+                Model model;
+                for(size_t hypothesis = first + from; hypothesis < first + to; ++hypothesis) {
+                    Random random(settings.seed ^ (0xD1B54A32D192ED03ULL * (hypothesis + 1)));
+                    draw(m, hypothesis, schedule, random, sample);
+                    if(!minimal(sample, model))
+                        continue;
+
+                    bool passed = true;
+                    for(size_t i = 0; i < settings.preTest && passed; ++i) {
+                        const size_t j = random.below(n);
+                        passed = model.inlier(xs[j], ys[j], threshold);
+                    }
+                    if(!passed)
+                        continue;
+
+                    const size_t c = count(model, threshold, std::max(bestCount, local.count));
+                    if(c > local.count && c >= m) {
+                        local.count = c;
+                        local.hypothesis = hypothesis;
+                        local.model = model;
+                    }
+                }
+            });
+
+            for(const auto &c : candidates) {
+                if(c.hypothesis != NONE && c.count > bestCount) {
+                    bestCount = c.count;
+                    best = c.model;
+                }
+            }
+            nHypotheses = last;
+            required = std::max(nHypotheses, std::min(required, n_required(m, bestCount, settings)));
+        }
+        if(bestCount == 0)
+            return false;
+
+        collect(best, threshold, inliers);
+        std::vector<size_t> refinedInliers;
+        for(size_t i = 0; i < 5; ++i) {
+            Model refined;
+            if(!refit(inliers, refined))
+                break;
+            collect(refined, threshold, refinedInliers);
+            if(refinedInliers.size() < m || (i > 0 && refinedInliers.size() < inliers.size()))
+                break;
+            const bool grown = refinedInliers.size() > inliers.size();
+            best = refined;
+            std::swap(inliers, refinedInliers);
+            if(!grown)
+                break;
+        }
+        return true;
+    }
+
+//------------------------------------------------------------------------------
+
+    bool line_through(size_t i, size_t j, LineModel &model) const {
+        const T dx = xs[j] - xs[i], dy = ys[j] - ys[i];
+        const T length = std::sqrt(dx * dx + dy * dy);
+        if(!(length > 0))
+            return false;
+        model.nx = -dy / length;
+        model.ny = dx / length;
+        model.c = model.nx * xs[i] + model.ny * ys[i];
+        return true;
+    }
+
+    ///total least squares, the normal is the direction of least variance
+    bool fit_line(const std::vector<size_t> &in, LineModel &model) const {
+        if(in.size() < 2)
+            return false;
+        T cx(0), cy(0);
+        for(const auto i : in) {
+            cx += xs[i];
+            cy += ys[i];
+        }
+        cx /= in.size();
+        cy /= in.size();
+        T xx(0), xy(0), yy(0);
+        for(const auto i : in) {
+            const T dx = xs[i] - cx, dy = ys[i] - cy;
+            xx += dx * dx;
+            xy += dx * dy;
+            yy += dy * dy;
+        }
+        const T major = T(0.5) * std::atan2(2 * xy, xx - yy);
+        model.nx = -std::sin(major);
+        model.ny = std::cos(major);
+        model.c = model.nx * cx + model.ny * cy;
+        return true;
+    }
+
+//------------------------------------------------------------------------------
+
+    bool circle_through(size_t i, size_t j, size_t k, CircleModel &model) const {
+        const T bx = xs[j] - xs[i], by = ys[j] - ys[i];
+        const T cx = xs[k] - xs[i], cy = ys[k] - ys[i];
+        const T d = 2 * (bx * cy - by * cx);
+        if(std::abs(d) <= std::numeric_limits<T>::epsilon())
+            return false;
+        const T sqrB = bx * bx + by * by, sqrC = cx * cx + cy * cy;
+        const T ux = (cy * sqrB - by * sqrC) / d;
+        const T uy = (bx * sqrC - cx * sqrB) / d;
+        model.cx = xs[i] + ux;
+        model.cy = ys[i] + uy;
+        model.r = std::sqrt(ux * ux + uy * uy);
+        return true;
+    }
+
+    ///algebraic least squares of x^2 + y^2 + d x + e y + f = 0
+    bool fit_circle(const std::vector<size_t> &in, CircleModel &model) const {
+        std::array<std::array<T, 5>, 5> normal{};
+        std::array<T, 5> rhs{};
+        for(const auto i : in) {
+            const T x = xs[i], y = ys[i];
+            const std::array<T, 3> row{{x, y, 1}};
+            const T value = -(x * x + y * y);
+            for(size_t r = 0; r < 3; ++r) {
+                for(size_t c = 0; c < 3; ++c)
+                    normal[r][c] += row[r] * row[c];
+                rhs[r] += row[r] * value;
+            }
+        }
+        std::array<T, 5> p;
+        if(!solve(normal, rhs, 3, p))
+            return false;
+        model.cx = -p[0] / 2;
+        model.cy = -p[1] / 2;
+        const T sqrRadius = model.cx * model.cx + model.cy * model.cy - p[2];
+        if(!(sqrRadius > 0))
+            return false;
+        model.r = std::sqrt(sqrRadius);
+        return true;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///through 5 points or least squares for more, with a + c = 1, which excludes no ellipse, only valid if the conic is an ellipse
+    bool fit_conic(const size_t *in, size_t n, ConicModel &model) const {
+        std::array<std::array<T, 5>, 5> system{};
+        std::array<T, 5> rhs{};
+        for(size_t k = 0; k < n; ++k) {
+            const T x = xs[in[k]], y = ys[in[k]];
+            const std::array<T, 5> row{{x * x - y * y, x * y, x, y, 1}};
+            const T value = -y * y;
+            if(n == 5) {
+                system[k] = row;
+                rhs[k] = value;
+                continue;
+            }
+            for(size_t r = 0; r < 5; ++r) {
+                for(size_t c = 0; c < 5; ++c)
+                    system[r][c] += row[r] * row[c];
+                rhs[r] += row[r] * value;
+            }
+        }
+        std::array<T, 5> p;
+        if(!solve(system, rhs, 5, p))
+            return false;
+        model = ConicModel{p[0], p[1], 1 - p[0], p[2], p[3], p[4]};
+
+        T cx(0), cy(0), a(0), b(0), angle(0);
+        return ellipse_parameters(model, cx, cy, a, b, angle);
+    }
+
+    static bool ellipse_parameters(const ConicModel &m, T &cx, T &cy, T &a, T &b, T &angle) {
+        const T det = 4 * m.a * m.c - m.b * m.b;
+        if(!(det > 0))
+            return false;
+        cx = (m.b * m.e - 2 * m.c * m.d) / det;
+        cy = (m.b * m.d - 2 * m.a * m.e) / det;
+        const T f0 = m.f + (m.d * cx + m.e * cy) / 2;
+
+        angle = T(0.5) * std::atan2(m.b, m.a - m.c);
+        const T cs = std::cos(angle), sn = std::sin(angle);
+        const T along = m.a * cs * cs + m.b * cs * sn + m.c * sn * sn;
+        const T across = m.a * sn * sn - m.b * cs * sn + m.c * cs * cs;
+        if(!(-f0 / along > 0) || !(-f0 / across > 0))
+            return false;
+        a = std::sqrt(-f0 / along);
+        b = std::sqrt(-f0 / across);
+        return true;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///Gaussian elimination with partial pivoting of the leading n x n system
+    static bool solve(std::array<std::array<T, 5>, 5> a, std::array<T, 5> b, size_t n, std::array<T, 5> &x) {
+        T largest(0);
+        for(size_t i = 0; i < n; ++i)
+            largest = std::max(largest, std::abs(a[i][i]));
+        const T epsilon = largest * std::numeric_limits<T>::epsilon() * 16;
+
+        for(size_t col = 0; col < n; ++col) {
+            size_t pivot = col;
+            for(size_t row = col + 1; row < n; ++row) {
+                if(std::abs(a[row][col]) > std::abs(a[pivot][col]))
+                    pivot = row;
+            }
+            if(!(std::abs(a[pivot][col]) > epsilon))
+                return false;
+            std::swap(a[col], a[pivot]);
+            std::swap(b[col], b[pivot]);
+            for(size_t row = col + 1; row < n; ++row) {
+                const T f = a[row][col] / a[col][col];
+                for(size_t k = col; k < n; ++k)
+                    a[row][k] -= f * a[col][k];
+                b[row] -= f * b[col];
+            }
+        }
+        for(size_t col = n; col-- > 0;) {
+            T value = b[col];
+            for(size_t k = col + 1; k < n; ++k)
+                value -= a[col][k] * x[k];
+            x[col] = value / a[col][col];
+        }
+        return true;
+    }
+};
+
+} //lib_2d
+
+#endif // RANSAC_H_INCLUDED
@@ -0,0 +1,456 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    ReverseKNearest.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class ReverseKNearest, reverse k nearest neighbour queries (which points have q among their k nearest)
+ *          every client stores the distances to its k nearest sites, the circle of its k-th distance contains exactly the
+ *          positions which would be among its k nearest, so a query is a point containment test within a packed R-tree of circles
+ *          sites are the clients themselves (monochromatic) or a second PointCloud (bichromatic)
+ *          inserted points are scanned linearly until there are MIN_PENDING of them, then they are packed into a new tree
+ *          which absorbs all smaller trees (logarithmic method), since ids are appended every tree covers a range of them
+ */
+
+#ifndef REVERSEKNEAREST_H_INCLUDED
+#define REVERSEKNEAREST_H_INCLUDED
+
+#include <vector>
+#include <array>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <cmath>
+
+#include "Point.h"
+#include "PointCloud.h"
+#include "PointCloudView.h"
+#include "OrderedPointCloud.h"
+#include "Topology.h"
+#include "KdTree.h"
+#include "RTree.h"
+#include "parallel.h"
+
+namespace lib_2d {
+
+template <typename T>
+class ReverseKNearest {
+
+using Element = std::array<size_t, 1>;
+
+private:
+
+    ///the circle of a client, sqrRadius shrinks when sites are inserted
+    struct Entry {
+        size_t id;
+        T x, y, sqrRadius;
+    };
+
+    ///packed by RTree::str_sort, level by level with the root as last node, children are consecutive
+    ///the boxes are those of the circles when packing, they stay valid since radii only shrink
+    struct Node {
+        T minX, minY, maxX, maxY;
+        size_t first, count;
+        bool leaf;
+    };
+
+    struct CircleTree {
+        std::vector<Entry> entries;
+        std::vector<Node> nodes;
+    };
+
+    using Candidates = std::vector<std::pair<T, size_t>>;
+
+    enum : size_t {NODE_CAPACITY = 16, MIN_PENDING = 256, NONE = static_cast<size_t>(-1)};
+
+    size_t k;
+    bool bichromatic;
+    std::shared_ptr<PointCloud<T>> clients, sites; //the same for monochromatic queries
+
+    std::vector<T> sqrDistances; //to the k nearest sites of each client, ascending, infinite if there are less sites
+
+    std::vector<std::unique_ptr<KdTree<T>>> siteTrees; //decreasing in size
+    std::vector<size_t> siteStarts; //the first site of each tree
+    size_t nTreeSites; //later sites are scanned linearly
+
+    std::vector<CircleTree> circleTrees; //decreasing in size
+    std::vector<size_t> clientStarts; //the first client of each tree
+    size_t nTreeClients; //later clients are scanned linearly
+    std::vector<size_t> slots; //the entry of each packed client within its tree
+
+//------------------------------------------------------------------------------
+
+public:
+    ReverseKNearest& operator=(const ReverseKNearest&) = delete;
+    ReverseKNearest(const ReverseKNearest&) = delete;
+
+//------------------------------------------------------------------------------
+
+    ///monochromatic, a point is never among its own nearest neighbours
+    ReverseKNearest(const PointCloudView<T> &points, size_t k, size_t nThreads = 0) :
+        k(k),
+        bichromatic(false),
+        clients(std::make_shared<PointCloud<T>>(points)),
+        sites(clients) {
+        init(nThreads);
+    }
+
+    ///bichromatic, the k nearest of each client are searched among the sites
+    ReverseKNearest(const PointCloudView<T> &clientPoints, const PointCloudView<T> &sitePoints, size_t k, size_t nThreads = 0) :
+        k(k),
+        bichromatic(true),
+        clients(std::make_shared<PointCloud<T>>(clientPoints)),
+        sites(std::make_shared<PointCloud<T>>(sitePoints)) {
+        init(nThreads);
+    }
+
+//------------------------------------------------------------------------------
+
+    size_t get_k() const {
+        return k;
+    }
+
+    size_t n_clients() const {
+        return clients->size();
+    }
+
+    size_t n_sites() const {
+        return sites->size();
+    }
+
+    ///distance of a client to its k-th nearest site, infinite if there are less than k
+    T radius(size_t client) const {
+        return std::sqrt(sqrDistances[client * k + k - 1]);
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the clients which would have a site at q among their k nearest (ties included), ascending
+    Topology<1> query(const Point<T> &q) const {
+        std::vector<size_t> found;
+        for_each_containing(q, [&found](size_t client) {
+            found.push_back(client);
+        });
+        return to_topology(found);
+    }
+
+    ///the clients which have the site among their k nearest
+    Topology<1> query_site(size_t site) const {
+        std::vector<size_t> found;
+        const bool self = !bichromatic;
+        for_each_containing((*sites)[site], [&](size_t client) {
+            if(!self || client != site)
+                found.push_back(client);
+        });
+        return to_topology(found);
+    }
+
+    ///query for all probes, as compressed rows: the clients for probe i are result[offsets[i]] to result[offsets[i+1] - 1]
+    void query(const PointCloudView<T> &probes, std::vector<size_t> &offsets, std::vector<size_t> &result, size_t nThreads = 0) const {
+        const size_t n = probes.size();
+        const size_t nChunks = n_chunks(n, nThreads, 1 << 10);
+        std::vector<std::vector<size_t>> chunkResults(nChunks);
+        offsets.assign(n + 1, 0);
+
+        parallel_chunks(n, nChunks, [&](size_t first, size_t last, size_t chunk) {
+            std::vector<size_t> &found = chunkResults[chunk];
+            for(size_t i = first; i < last; ++i) {
+                const size_t start = found.size();
+                for_each_containing(probes[i], [&found](size_t client) {
+                    found.push_back(client);
+                });
+                std::sort(found.begin() + start, found.end());
+                offsets[i + 1] = found.size() - start;
+            }
+        });
+
+        for(size_t i = 1; i <= n; ++i)
+            offsets[i] += offsets[i - 1];
+        result.clear();
+        result.reserve(offsets.back());
+        for(const auto &found : chunkResults)
+            result.insert(result.end(), found.begin(), found.end());
+    }
+
+//------------------------------------------------------------------------------
+
+    ///monochromatic insertion, returns the id of the new point
+    size_t insert(const Point<T> &p) {
+        if(bichromatic)
+            throw std::out_of_range ("ReverseKNearest::insert is only available for monochromatic queries");
+        const size_t id = clients->size();
+        clients->push_back(p);
+        add_client(id);
+        shrink_containing(id);
+        update();
+        return id;
+    }
+
+    ///bichromatic insertion of a site, returns its id
+    size_t insert_site(const Point<T> &p) {
+        if(!bichromatic)
+            throw std::out_of_range ("ReverseKNearest::insert_site is only available for bichromatic queries");
+        const size_t id = sites->size();
+        sites->push_back(p);
+        shrink_containing(id);
+        update();
+        return id;
+    }
+
+    ///bichromatic insertion of a client, returns its id
+    size_t insert_client(const Point<T> &p) {
+        if(!bichromatic)
+            throw std::out_of_range ("ReverseKNearest::insert_client is only available for bichromatic queries");
+        const size_t id = clients->size();
+        clients->push_back(p);
+        add_client(id);
+        update();
+        return id;
+    }
+
+//------------------------------------------------------------------------------
+
+private:
+
+    void init(size_t nThreads) {
+        if(k < 1)
+            throw std::out_of_range ("ReverseKNearest requires k > 0");
+
+        nTreeSites = nTreeClients = 0;
+        pack_sites();
+        const size_t n = clients->size();
+        sqrDistances.resize(n * k);
+        parallel_chunks(n, n_chunks(n, nThreads, 1 << 10), [&](size_t first, size_t last, size_t) {
+            Candidates candidates;
+            candidates.reserve(k + 1);
+            for(size_t i = first; i < last; ++i)
+                nearest_sites(i, candidates);
+        });
+        pack_clients();
+    }
+
+    void update() {
+        if(sites->size() - nTreeSites >= MIN_PENDING)
+            pack_sites();
+        if(clients->size() - nTreeClients >= MIN_PENDING)
+            pack_clients();
+    }
+
+    ///the pending sites and all trees which aren't larger form a new tree
+    void pack_sites() {
+        const size_t n = sites->size();
+        size_t first = nTreeSites;
+        while(!siteStarts.empty() && nTreeSites - siteStarts.back() <= n - first) {
+            first = siteStarts.back();
+            nTreeSites = first;
+            siteStarts.pop_back();
+            siteTrees.pop_back();
+        }
+        if(first == n)
+            return;
+
+        Topology<1> ids;
+        ids.reserve_elements(n - first);
+        for(size_t i = first; i < n; ++i)
+            ids.push_back(Element{i});
+        siteTrees.emplace_back(new KdTree<T>(std::make_shared<OrderedPointCloud<T>>(sites, std::move(ids))));
+        siteStarts.push_back(first);
+        nTreeSites = n;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the k nearest sites of a client, from the KdTrees and the pending sites
+    void nearest_sites(size_t client, Candidates &candidates) {
+        const Point<T> &p = (*clients)[client];
+        T *row = &sqrDistances[client * k];
+        std::fill(row, row + k, std::numeric_limits<T>::infinity());
+
+        const size_t self = bichromatic ? NONE : client;
+        for(const auto &tree : siteTrees) {
+            tree->k_nearest(p, k, candidates, [self](size_t id) { return id != self; });
+            for(const auto &c : candidates)
+                add_distance(row, c.first);
+        }
+        for(size_t site = nTreeSites; site < sites->size(); ++site) {
+            if(site != self)
+                add_distance(row, p.sqr_distance_to((*sites)[site]));
+        }
+    }
+
+    ///inserts into the sorted row, dropping its largest distance
+    inline void add_distance(T *row, T sqrDistance) const {
+        if(!(sqrDistance < row[k - 1]))
+            return;
+        size_t i = k - 1;
+        while(i > 0 && row[i - 1] > sqrDistance) {
+            row[i] = row[i - 1];
+            --i;
+        }
+        row[i] = sqrDistance;
+    }
+
+    ///the new site is among the k nearest of all clients containing it
+    void shrink_containing(size_t site) {
+        const Point<T> q = (*sites)[site];
+        std::vector<size_t> found;
+        for_each_containing(q, [&found](size_t client) {
+            found.push_back(client);
+        });
+        for(const auto client : found) {
+            if(!bichromatic && client == site)
+                continue;
+            T *row = &sqrDistances[client * k];
+            add_distance(row, q.sqr_distance_to((*clients)[client]));
+            if(client < nTreeClients) {
+                const size_t tree = std::upper_bound(clientStarts.begin(), clientStarts.end(), client) - clientStarts.begin() - 1;
+                circleTrees[tree].entries[slots[client]].sqrRadius = row[k - 1];
+            }
+        }
+    }
+
+    void add_client(size_t client) {
+        sqrDistances.resize(clients->size() * k);
+        Candidates candidates;
+        candidates.reserve(k + 1);
+        nearest_sites(client, candidates);
+    }
+
+//------------------------------------------------------------------------------
+
+    template <typename F>
+    void for_each_containing(const Point<T> &q, F f) const {
+        for(const auto &tree : circleTrees)
+            for_each_containing(tree, tree.nodes.size() - 1, q, f);
+        for(size_t client = nTreeClients; client < clients->size(); ++client) {
+            if(q.sqr_distance_to((*clients)[client]) <= sqrDistances[client * k + k - 1])
+                f(client);
+        }
+    }
+
+    template <typename F>
+    void for_each_containing(const CircleTree &tree, size_t index, const Point<T> &q, F &f) const {
+        const auto &entries = tree.entries;
+        const auto &nodes = tree.nodes;
+        const Node &node = nodes[index];
+        for(size_t i = node.first; i < node.first + node.count; ++i) {
+            if(node.leaf) {
+                //same distance function as for the k nearest, so ties at the k-th distance stay inside
+                const Entry &e = entries[i];
+                if(q.sqr_distance_to(Point<T>{e.x, e.y}) <= e.sqrRadius)
+                    f(e.id);
+            }
+            else if(nodes[i].minX <= q.x && q.x <= nodes[i].maxX && nodes[i].minY <= q.y && q.y <= nodes[i].maxY)
+                for_each_containing(tree, i, q, f);
+        }
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the pending clients and all trees which aren't larger form a new tree
+    void pack_clients() {
+        const size_t nClients = clients->size();
+        size_t first = nTreeClients;
+        while(!clientStarts.empty() && nTreeClients - clientStarts.back() <= nClients - first) {
+            first = clientStarts.back();
+            nTreeClients = first;
+            clientStarts.pop_back();
+            circleTrees.pop_back();
+        }
+        if(first == nClients)
+            return;
+
+        circleTrees.emplace_back();
+        auto &entries = circleTrees.back().entries;
+        auto &nodes = circleTrees.back().nodes;
+        const size_t n = nClients - first;
+        entries.reserve(n);
+        for(size_t i = first; i < nClients; ++i)
+            entries.push_back(Entry{i, (*clients)[i].x, (*clients)[i].y, sqrDistances[i * k + k - 1]});
+        RTree<T>::str_sort(entries.begin(), entries.end(), NODE_CAPACITY, [](const Entry &e) {
+            return Point<T>{e.x, e.y};
+        });
+        slots.resize(nClients);
+        for(size_t i = 0; i < n; ++i)
+            slots[entries[i].id] = i;
+        clientStarts.push_back(first);
+        nTreeClients = nClients;
+
+        const size_t nLeafs = (n + NODE_CAPACITY - 1) / NODE_CAPACITY;
+        nodes.reserve(nLeafs + nLeafs / (NODE_CAPACITY - 1) + 32);
+        for(size_t i = 0; i < n; i += NODE_CAPACITY) {
+            Node leaf = empty_node(i, std::min(size_t(NODE_CAPACITY), n - i), true);
+            for(size_t j = i; j < leaf.first + leaf.count; ++j) {
+                //widened by a few ulps, so rounding of sqrt and of the bounds can't exclude ties at the k-th distance
+                //(sqr_distance_to may round to double precision, so its epsilon is added)
+                const Entry &e = entries[j];
+                const T
+                    epsilon = std::numeric_limits<T>::epsilon() + T(std::numeric_limits<double>::epsilon()),
+                    r = std::sqrt(e.sqrRadius),
+                    rx = r + 4 * epsilon * (std::abs(e.x) + r),
+                    ry = r + 4 * epsilon * (std::abs(e.y) + r);
+                leaf.minX = std::min(leaf.minX, e.x - rx);
+                leaf.minY = std::min(leaf.minY, e.y - ry);
+                leaf.maxX = std::max(leaf.maxX, e.x + rx);
+                leaf.maxY = std::max(leaf.maxY, e.y + ry);
+            }
+            nodes.push_back(leaf);
+        }
+
+        //pack each level into the next one, until there's only the root left
+        size_t levelStart = 0;
+        while(nodes.size() - levelStart > 1) {
+            const size_t levelEnd = nodes.size();
+            RTree<T>::str_sort(nodes.begin() + levelStart, nodes.begin() + levelEnd, NODE_CAPACITY, [](const Node &node) {
+                return Point<T>{T(0.5) * (node.minX + node.maxX), T(0.5) * (node.minY + node.maxY)};
+            });
+
+            for(size_t i = levelStart; i < levelEnd; i += NODE_CAPACITY) {
+                Node inner = empty_node(i, std::min(size_t(NODE_CAPACITY), levelEnd - i), false);
+                for(size_t j = i; j < inner.first + inner.count; ++j) {
+                    inner.minX = std::min(inner.minX, nodes[j].minX);
+                    inner.minY = std::min(inner.minY, nodes[j].minY);
+                    inner.maxX = std::max(inner.maxX, nodes[j].maxX);
+                    inner.maxY = std::max(inner.maxY, nodes[j].maxY);
+                }
+                nodes.push_back(inner);
+            }
+            levelStart = levelEnd;
+        }
+    }
+
+    static Node empty_node(size_t first, size_t count, bool leaf) {
+        return Node{
+            std::numeric_limits<T>::infinity(), std::numeric_limits<T>::infinity(),
+            -std::numeric_limits<T>::infinity(), -std::numeric_limits<T>::infinity(),
+            first, count, leaf};
+    }
+
+    static Topology<1> to_topology(std::vector<size_t> &found) {
+        std::sort(found.begin(), found.end());
+        Topology<1> result;
+        result.reserve_elements(found.size());
+        for(const auto id : found)
+            result.push_back(Element{id});
+        return result;
+    }
+};
+
+} //lib_2d
+
+#endif // REVERSEKNEAREST_H_INCLUDED
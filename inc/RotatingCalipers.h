@@ -0,0 +1,277 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    RotatingCalipers.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class RotatingCalipers, measurements of convex polygons (diameter, width, enclosing rectangles)
+ *          all methods expect a convex hull (as returned by convex_hull(), closed or open) and run in O(h)
+ */
+
+#ifndef ROTATINGCALIPERS_H_INCLUDED
+#define ROTATINGCALIPERS_H_INCLUDED
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "calc.h"
+#include "Point.h"
+#include "PointCloudView.h"
+#include "PointCloud.h"
+#include "LineSegment.h"
+#include "Rectangle.h"
+
+namespace lib_2d {
+
+template <typename T>
+class RotatingCalipers {
+    using Points = std::vector<Point<T>>;
+
+public:
+
+//------------------------------------------------------------------------------
+
+    ///the two points of the hull which are furthest apart
+    static LineSegment<T> diameter(const PointCloudView<T> &hull) {
+        const Points ps = prepare(hull);
+        const size_t n = ps.size();
+
+        size_t
+            bestA(0),
+            bestB(0);
+        T maxDistance(0);
+        size_t j = 1 % n;
+        for(size_t i = 0; i < n; ++i) {
+            const size_t next = (i + 1) % n;
+            while(area2(ps[i], ps[next], ps[(j + 1) % n]) > area2(ps[i], ps[next], ps[j]))
+                j = (j + 1) % n;
+
+            for(size_t a : {i, next}) {
+                T distance = ps[a].sqr_distance_to(ps[j]);
+                if(distance > maxDistance) {
+                    maxDistance = distance;
+                    bestA = a;
+                    bestB = j;
+                }
+            }
+        }
+        return LineSegment<T>(ps[bestA], ps[bestB]);
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the minimum distance of two parallel lines enclosing the hull
+    static T width(const PointCloudView<T> &hull) {
+        const Points ps = prepare(hull);
+        const size_t n = ps.size();
+        if(n < 3)
+            return 0;
+
+        T minWidth(-1);
+        size_t j = 1;
+        for(size_t i = 0; i < n; ++i) {
+            const size_t next = (i + 1) % n;
+            const T edgeLength = ps[i].distance_to(ps[next]);
+            if(edgeLength == 0)
+                continue;
+            while(area2(ps[i], ps[next], ps[(j + 1) % n]) > area2(ps[i], ps[next], ps[j]))
+                j = (j + 1) % n;
+
+            T w = area2(ps[i], ps[next], ps[j]) / edgeLength;
+            if(minWidth < 0 || w < minWidth)
+                minWidth = w;
+        }
+        return minWidth < 0 ? 0 : minWidth;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the enclosing rectangle with the smallest area, one of its sides is collinear with an edge of the hull
+    static Rectangle<T> min_area_rectangle(const PointCloudView<T> &hull, bool closePath = true) {
+        return min_rectangle(hull, closePath, false);
+    }
+
+    ///the enclosing rectangle with the smallest perimeter, one of its sides is collinear with an edge of the hull
+    static Rectangle<T> min_perimeter_rectangle(const PointCloudView<T> &hull, bool closePath = true) {
+        return min_rectangle(hull, closePath, true);
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the point of hullA and the point of hullB which are furthest apart
+    ///these are the vertex of the minkowski difference hullA - hullB furthest from the origin, found by merging the edges of both hulls
+    static LineSegment<T> max_distance(const PointCloudView<T> &hullA, const PointCloudView<T> &hullB) {
+        Points a = prepare(hullA);
+        Points b = prepare(hullB);
+        for(auto &p : b)
+            p = Point<T>{-p.x, -p.y};
+
+        rotate_to_lowest(a);
+        rotate_to_lowest(b);
+        const size_t
+            n = a.size(),
+            m = b.size();
+
+        size_t
+            bestA(0),
+            bestB(0),
+            i(0),
+            j(0);
+        T maxDistance(-1);
+        while(true) {
+            const Point<T> &pa = a[i % n];
+            const Point<T> &pb = b[j % m];
+            T distance = sqr(pa.x + pb.x) + sqr(pa.y + pb.y);
+            if(distance > maxDistance) {
+                maxDistance = distance;
+                bestA = i % n;
+                bestB = j % m;
+            }
+            if(i >= n && j >= m)
+                break;
+
+            if(i == n)
+                ++j;
+            else if(j == m)
+                ++i;
+            else {
+                T c = cross(vect(a[i], a[(i + 1) % n]), vect(b[j], b[(j + 1) % m]));
+                if(c >= 0)
+                    ++i;
+                if(c <= 0)
+                    ++j;
+            }
+        }
+        return LineSegment<T>(a[bestA], Point<T>{-b[bestB].x, -b[bestB].y});
+    }
+
+//------------------------------------------------------------------------------
+
+private:
+
+    static inline T area2(const Point<T> &a, const Point<T> &b, const Point<T> &c) {
+        return cross(vect(a, b), vect(a, c));
+    }
+
+    static inline T sqr(T x) {
+        return x * x;
+    }
+
+    ///copy of the hull without closing point and consecutive duplicates, in counter clockwise order
+    static Points prepare(const PointCloudView<T> &hull) {
+        if(hull.empty())
+            throw std::out_of_range ("RotatingCalipers require a non-empty hull");
+
+        Points ps;
+        ps.reserve(hull.size());
+        for(const auto &p : hull) {
+            if(ps.empty() || !(ps.back() == p))
+                ps.push_back(p);
+        }
+        while(ps.size() > 1 && ps.back() == ps.front())
+            ps.pop_back();
+
+        T area(0);
+        for(size_t i = 0; i < ps.size(); ++i)
+            area += cross(ps[i], ps[(i + 1) % ps.size()]);
+        if(area < 0)
+            std::reverse(ps.begin(), ps.end());
+        return ps;
+    }
+
+    ///rotates the polygon so it starts with its lowest (then leftmost) point
+    static void rotate_to_lowest(Points &ps) {
+        size_t lowest = 0;
+        for(size_t i = 1; i < ps.size(); ++i) {
+            if(ps[i].y < ps[lowest].y || (ps[i].y == ps[lowest].y && ps[i].x < ps[lowest].x))
+                lowest = i;
+        }
+        std::rotate(ps.begin(), ps.begin() + lowest, ps.end());
+    }
+
+    ///for every edge the calipers right, top and left of it are advanced monotonically
+    static Rectangle<T> min_rectangle(const PointCloudView<T> &hull, bool closePath, bool byPerimeter) {
+        const Points ps = prepare(hull);
+        const size_t n = ps.size();
+        if(n == 1)
+            return Rectangle<T>(0, 0, closePath, ps[0]);
+
+        T
+            bestCost(-1),
+            bestWidth(0),
+            bestHeight(0),
+            bestAngle(0);
+        Point<T> bestCenter{};
+
+        size_t
+            right(0),
+            top(0),
+            left(0);
+        bool initialized(false);
+
+        for(size_t i = 0; i < n; ++i) {
+            const size_t next = (i + 1) % n;
+            const T edgeLength = ps[i].distance_to(ps[next]);
+            if(edgeLength == 0)
+                continue;
+            const Point<T> u{(ps[next].x - ps[i].x) / edgeLength, (ps[next].y - ps[i].y) / edgeLength};
+            const Point<T> normal{-u.y, u.x};
+
+            if(!initialized)
+                right = next;
+            while(dot(u, ps[(right + 1) % n]) > dot(u, ps[right]))
+                right = (right + 1) % n;
+            if(!initialized)
+                top = right;
+            while(dot(normal, ps[(top + 1) % n]) > dot(normal, ps[top]))
+                top = (top + 1) % n;
+            if(!initialized)
+                left = top;
+            initialized = true;
+            while(dot(u, ps[(left + 1) % n]) < dot(u, ps[left]))
+                left = (left + 1) % n;
+
+            const T
+                minU = dot(u, vect(ps[i], ps[left])),
+                maxU = dot(u, vect(ps[i], ps[right])),
+                width = maxU - minU,
+                height = dot(normal, vect(ps[i], ps[top])),
+                cost = byPerimeter ? width + height : width * height;
+
+            if(bestCost < 0 || cost < bestCost) {
+                bestCost = cost;
+                bestWidth = width;
+                bestHeight = height;
+                bestAngle = std::atan2(u.y, u.x);
+                const T
+                    alongU = minU + width / 2,
+                    alongNormal = height / 2;
+                bestCenter = Point<T>{ps[i].x + u.x * alongU + normal.x * alongNormal,
+                                      ps[i].y + u.y * alongU + normal.y * alongNormal};
+            }
+        }
+        if(!initialized)
+            return Rectangle<T>(0, 0, closePath, ps[0]);
+
+        return Rectangle<T>(bestWidth, bestHeight, closePath, bestCenter, bestAngle);
+    }
+};
+
+} //lib_2d
+
+#endif // ROTATINGCALIPERS_H_INCLUDED
@@ -0,0 +1,210 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    SortedGrid.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class SortedGrid, points sorted by the cell of a uniform grid they are in, so each cell is a range of them
+ *          a Cursor visiting the cells in ascending order finds the cells within reach by only moving forward within each column
+ *          used by Dbscan and DistanceJoin
+ */
+
+#ifndef SORTEDGRID_H_INCLUDED
+#define SORTEDGRID_H_INCLUDED
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <limits>
+#include <functional>
+#include <cmath>
+#include <cstdint>
+
+#include "Point.h"
+#include "PointCloudView.h"
+#include "parallel.h"
+
+namespace lib_2d {
+
+template <typename T>
+class SortedGrid {
+
+public:
+    using Key = uint64_t;
+    using Range = std::pair<size_t, size_t>;
+    using Order = std::vector<std::pair<Key, size_t>>;
+
+    T
+        minX,
+        minY,
+        cellSize;
+
+    int64_t
+        reach, //number of cells in each direction which may contain points within the radius
+        nColumns,
+        nRows; //including a margin of reach + 1 empty cells around the points
+
+    std::vector<T> xs, ys; //sorted by cell
+    std::vector<size_t> ids;
+    std::vector<Key> keys; //of each non-empty cell
+    std::vector<size_t> starts; //of each cell, followed by the number of points
+
+//------------------------------------------------------------------------------
+
+    ///cells of (at least) size, points within radius are at most reach cells apart
+    SortedGrid(const PointCloudView<T> &points, T radius, T size, size_t nThreads) :
+        minX(0),
+        minY(0),
+        cellSize(size),
+        reach(int64_t(std::ceil(radius / size))) {
+
+        const size_t n = points.size();
+        T maxX(0), maxY(0);
+        if(n > 0) {
+            minX = maxX = points[0].x;
+            minY = maxY = points[0].y;
+        }
+        for(size_t i = 1; i < n; ++i) {
+            minX = std::min(minX, points[i].x);
+            maxX = std::max(maxX, points[i].x);
+            minY = std::min(minY, points[i].y);
+            maxY = std::max(maxY, points[i].y);
+        }
+
+        //cells a few ulps (relative to the largest cell index) wider than requested, so rounding within cell() can't place
+        //points within the radius more than reach cells apart, cell() subtracts in T and divides in double
+        const T extent = std::max(maxX - minX, maxY - minY);
+        const T epsilon = std::numeric_limits<T>::epsilon() + T(std::numeric_limits<double>::epsilon());
+        cellSize = size * (1 + 4 * epsilon * (extent / size + 2));
+
+        //huge extents require larger cells, so the keys stay within 32 bit per axis
+        const T maxCells = T(1 << 30);
+        if(extent / cellSize >= maxCells) {
+            cellSize = extent / maxCells;
+            reach = int64_t(std::ceil(radius / cellSize)) + 1;
+        }
+        nColumns = int64_t((maxX - minX) / cellSize) + 1 + 2 * (reach + 1);
+        nRows = int64_t((maxY - minY) / cellSize) + 1 + 2 * (reach + 1);
+
+        Order order;
+        sorted(points, order, nThreads);
+        xs.resize(n);
+        ys.resize(n);
+        ids.resize(n);
+        for(size_t i = 0; i < n; ++i) {
+            const size_t id = order[i].second;
+            xs[i] = points[id].x;
+            ys[i] = points[id].y;
+            ids[i] = id;
+            if(i == 0 || order[i].first != order[i-1].first) {
+                keys.push_back(order[i].first);
+                starts.push_back(i);
+            }
+        }
+        starts.push_back(n);
+    }
+
+//------------------------------------------------------------------------------
+
+    static inline Key key(int64_t x, int64_t y) {
+        return (Key(x) << 32) | Key(y);
+    }
+
+    ///the cell of a position, clamped to the margin, so positions far outside still find no neighbours
+    inline Key key(const Point<T> &p) const {
+        return key(cell(p.x, minX, nColumns), cell(p.y, minY, nRows));
+    }
+
+    inline T sqr_distance(T x, T y, size_t j) const {
+        const T dx = x - xs[j], dy = y - ys[j];
+        return dx * dx + dy * dy;
+    }
+
+    ///{key, index} of all points, sorted by their cells
+    void sorted(const PointCloudView<T> &points, Order &order, size_t nThreads) const {
+        const size_t n = points.size();
+        order.resize(n);
+        parallel_for(n, n_chunks(n, nThreads), [&](size_t i) {
+            order[i] = std::make_pair(key(points[i]), i);
+        });
+        parallel_sort(order.begin(), order.end(), std::less<std::pair<Key, size_t>>(), nThreads);
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the cells within reach of a cell, as ranges of consecutive cells (one per column)
+    ///cells have to be visited in ascending order, then the bounds of the ranges only move forward until the column changes
+    class Cursor {
+        const SortedGrid &grid;
+        int64_t column;
+        std::vector<size_t> firsts, lasts;
+        std::vector<Range> ranges;
+
+    public:
+        explicit Cursor(const SortedGrid &g) :
+            grid(g),
+            column(-1),
+            firsts(2 * g.reach + 1),
+            lasts(2 * g.reach + 1) {}
+
+        const std::vector<Range>& of(Key cell) {
+            const int64_t x = int64_t(cell >> 32);
+            const int64_t y = int64_t(cell & 0xFFFFFFFF);
+            const int64_t yMin = std::max(y - grid.reach, int64_t(0));
+            const int64_t yMax = y + grid.reach;
+            const size_t nCells = grid.keys.size();
+            if(x != column) {
+                column = x;
+                for(int64_t dx = -grid.reach; dx <= grid.reach; ++dx) {
+                    if(x + dx < 0)
+                        continue;
+                    const size_t i = dx + grid.reach;
+                    firsts[i] = std::lower_bound(grid.keys.begin(), grid.keys.end(), key(x + dx, yMin)) - grid.keys.begin();
+                    lasts[i] = firsts[i];
+                }
+            }
+
+            ranges.clear();
+            for(int64_t dx = -grid.reach; dx <= grid.reach; ++dx) {
+                if(x + dx < 0)
+                    continue;
+                const size_t i = dx + grid.reach;
+                const Key lowest = key(x + dx, yMin), highest = key(x + dx, yMax);
+                while(firsts[i] < nCells && grid.keys[firsts[i]] < lowest)
+                    ++firsts[i];
+                lasts[i] = std::max(lasts[i], firsts[i]);
+                while(lasts[i] < nCells && grid.keys[lasts[i]] <= highest)
+                    ++lasts[i];
+                if(firsts[i] != lasts[i])
+                    ranges.push_back(Range(firsts[i], lasts[i]));
+            }
+            return ranges;
+        }
+    };
+
+//------------------------------------------------------------------------------
+
+private:
+
+    inline int64_t cell(T value, T minValue, int64_t nCells) const {
+        const double c = std::floor(double(value - minValue) / double(cellSize)) + double(reach + 1);
+        return int64_t(std::min(std::max(c, 0.0), double(nCells - 1)));
+    }
+};
+
+} //lib_2d
+
+#endif // SORTEDGRID_H_INCLUDED
@@ -0,0 +1,485 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    SpatialGrid.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class SpatialGrid, a uniform grid index as an alternative to the KdTree for uniformly dense data
+ *          the ids are bucketed per cell with a counting sort (compressed rows), making the build O(n)
+ *          single points can be inserted, removed and moved in O(1)
+ */
+
+#ifndef SPATIALGRID_H_INCLUDED
+#define SPATIALGRID_H_INCLUDED
+
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <limits>
+#include <cmath>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "Point.h"
+#include "OrderedPointCloud.h"
+#include "MemoryResource.h"
+
+namespace lib_2d {
+
+template <typename T>
+class SpatialGrid {
+
+using Element = std::array<size_t, 1>;
+
+private:
+
+//------------------------------------------------------------------------------
+
+    static const size_t NONE = static_cast<size_t>(-1);
+
+    enum Storage {IN_ROWS, IN_OVERFLOW, IN_OUTSIDE};
+
+    struct Location {
+        size_t cell;
+        size_t slot;
+        Storage storage;
+    };
+
+    template <typename U>
+    using Buffer = std::vector<U, ResourceAllocator<U> >;
+
+    using Candidates = Buffer<std::pair<T, size_t> >;
+
+    std::shared_ptr<OrderedPointCloud<T>> parent;
+
+    std::shared_ptr<PointCloud<T>> pc;
+
+    T
+        minX,
+        minY,
+        cellSize,
+        invCellSize;
+
+    size_t
+        nX,
+        nY,
+        nIndexed;
+
+    Buffer<size_t>
+        cellStart,  //nCells + 1 offsets into cellIds, the capacity of each cell within the rows
+        cellCount,  //number of used slots per cell
+        cellIds,
+        outside;    //points which were inserted outside of the gridded area
+
+    Buffer<char> hasOverflow;
+
+    std::unordered_map<size_t, std::vector<size_t> > overflow; //points inserted into cells which were already full, buckets are kept for reuse once empty
+
+    Buffer<Location> locations; //per point id of the parent
+
+//------------------------------------------------------------------------------
+
+public:
+    SpatialGrid& operator=(const SpatialGrid&) = delete;
+    SpatialGrid(const SpatialGrid&) = delete;
+
+//------------------------------------------------------------------------------
+
+    ///if cellSize <= 0 it's chosen from the bounding box and the density of the points, to get about pointsPerCell points per cell
+    SpatialGrid(std::shared_ptr<OrderedPointCloud<T>> tpc, T cellSize = 0, size_t pointsPerCell = 2, MemoryResource *resource = nullptr) :
+        parent(tpc),
+        pc(tpc->get_parent()),
+        minX(0),
+        minY(0),
+        cellSize(1),
+        invCellSize(1),
+        nX(1),
+        nY(1),
+        nIndexed(0),
+        cellStart(ResourceAllocator<size_t>(resource)),
+        cellCount(ResourceAllocator<size_t>(resource)),
+        cellIds(ResourceAllocator<size_t>(resource)),
+        outside(ResourceAllocator<size_t>(resource)),
+        hasOverflow(ResourceAllocator<char>(resource)),
+        locations(ResourceAllocator<Location>(resource)) {
+
+        const size_t n = tpc->n_elements();
+        T maxX(0), maxY(0);
+        if(n > 0) {
+            minX = maxX = tpc->get_tpoint(0).x;
+            minY = maxY = tpc->get_tpoint(0).y;
+        }
+        for(size_t i = 1; i < n; ++i) {
+            const auto &p = tpc->get_tpoint(i);
+            minX = std::min(minX, p.x);
+            maxX = std::max(maxX, p.x);
+            minY = std::min(minY, p.y);
+            maxY = std::max(maxY, p.y);
+        }
+
+        if(cellSize <= 0)
+            cellSize = choose_cell_size(maxX - minX, maxY - minY, n, pointsPerCell);
+        this->cellSize = cellSize;
+        invCellSize = 1 / cellSize;
+        nX = static_cast<size_t>((maxX - minX) * invCellSize) + 1;
+        nY = static_cast<size_t>((maxY - minY) * invCellSize) + 1;
+
+        //counting sort of all ids into their cells
+        const size_t nCells = nX * nY;
+        cellStart.assign(nCells + 1, 0);
+        cellCount.assign(nCells, 0);
+        hasOverflow.assign(nCells, 0);
+        locations.assign(pc->size(), Location{NONE, NONE, IN_ROWS});
+
+        const ResourceAllocator<size_t> allocator(resource);
+        Buffer<size_t> cells(allocator);
+        cells.reserve(n);
+        for(size_t i = 0; i < n; ++i) {
+            size_t cell = cell_of(tpc->get_tpoint(i));
+            cells.push_back(cell);
+            if(cell != NONE)
+                ++cellStart[cell + 1];
+        }
+        for(size_t c = 0; c < nCells; ++c)
+            cellStart[c + 1] += cellStart[c];
+
+        cellIds.assign(cellStart[nCells], NONE);
+        for(size_t i = 0; i < n; ++i) {
+            size_t pId = tpc->get_id(i);
+            if(cells[i] == NONE) { //rounding placed it just outside
+                add_outside(pId);
+                continue;
+            }
+            size_t slot = cellStart[cells[i]] + cellCount[cells[i]]++;
+            cellIds[slot] = pId;
+            locations[pId] = Location{cells[i], slot, IN_ROWS};
+            ++nIndexed;
+        }
+    }
+
+//------------------------------------------------------------------------------
+
+    size_t size() const {
+        return nIndexed;
+    }
+
+    std::shared_ptr<OrderedPointCloud<T>> get_parent() const {
+        return parent;
+    }
+
+    T get_cell_size() const {
+        return cellSize;
+    }
+
+    size_t n_cells() const {
+        return nX * nY;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///adds a new point to the parent and indexes it, returns its id
+    size_t insert(const Point<T> &p) {
+        parent->push_back(p);
+        size_t pId = pc->size() - 1;
+        insert(pId);
+        return pId;
+    }
+
+    ///indexes a point which is already part of the parent, O(1)
+    void insert(size_t pId) {
+        if(pId >= pc->size())
+            throw std::out_of_range ("SpatialGrid can't index a point which isn't part of its parent");
+        if(pId >= locations.size())
+            locations.resize(pc->size(), Location{NONE, NONE, IN_ROWS});
+        if(locations[pId].cell != NONE || locations[pId].storage == IN_OUTSIDE)
+            return; //already indexed
+
+        size_t cell = cell_of((*pc)[pId]);
+        if(cell == NONE)
+            add_outside(pId);
+        else if(cellCount[cell] < cellStart[cell + 1] - cellStart[cell]) {
+            size_t slot = cellStart[cell] + cellCount[cell]++;
+            cellIds[slot] = pId;
+            locations[pId] = Location{cell, slot, IN_ROWS};
+            ++nIndexed;
+        }
+        else {
+            auto &bucket = overflow[cell];
+            bucket.push_back(pId);
+            hasOverflow[cell] = 1;
+            locations[pId] = Location{cell, bucket.size() - 1, IN_OVERFLOW};
+            ++nIndexed;
+        }
+    }
+
+    ///removes a point from the index (it stays part of the parent), O(1)
+    void remove(size_t pId) {
+        if(pId >= locations.size())
+            return;
+        Location loc = locations[pId];
+
+        if(loc.storage == IN_OUTSIDE) {
+            if(loc.slot == NONE)
+                return;
+            swap_remove(outside, loc.slot);
+        }
+        else if(loc.cell == NONE)
+            return; //not indexed
+        else if(loc.storage == IN_OVERFLOW) {
+            auto &bucket = overflow[loc.cell];
+            swap_remove(bucket, loc.slot);
+            if(bucket.empty())
+                hasOverflow[loc.cell] = 0;
+        }
+        else {
+            size_t last = cellStart[loc.cell] + --cellCount[loc.cell];
+            if(last != loc.slot) {
+                cellIds[loc.slot] = cellIds[last];
+                locations[cellIds[loc.slot]].slot = loc.slot;
+            }
+            if(hasOverflow[loc.cell]) { //refill the rows from the overflow
+                auto &bucket = overflow[loc.cell];
+                size_t moved = bucket.back();
+                bucket.pop_back();
+                cellIds[last] = moved;
+                locations[moved] = Location{loc.cell, last, IN_ROWS};
+                ++cellCount[loc.cell];
+                if(bucket.empty())
+                    hasOverflow[loc.cell] = 0;
+            }
+        }
+        locations[pId] = Location{NONE, NONE, IN_ROWS};
+        --nIndexed;
+    }
+
+    ///moves a point of the parent to a new position and updates the index, O(1)
+    void move(size_t pId, const Point<T> &p) {
+        remove(pId);
+        (*pc)[pId] = p;
+        insert(pId);
+    }
+
+//------------------------------------------------------------------------------
+
+    size_t nearest(const Point<T> &search) const {
+        if(nIndexed == 0)
+            throw std::out_of_range ("SpatialGrid is empty, there is no nearest neighbor");
+        auto res = k_nearest(search, 1);
+        return res[0][0];
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the n nearest neighbors of search, sorted by their distance
+    Topology<1> k_nearest(const Point<T> &search, size_t n) const {
+        if(n < 1 || nIndexed == 0) return Topology<1>();
+
+        Candidates candidates; //max heap of the currently best candidates
+        candidates.reserve(n + 1);
+        auto consider = [&](size_t pId) {
+            T distance = search.sqr_distance_to((*pc)[pId]);
+            if(candidates.size() < n) {
+                candidates.push_back(std::make_pair(distance, pId));
+                std::push_heap(candidates.begin(), candidates.end());
+            }
+            else if(distance < candidates.front().first) {
+                std::pop_heap(candidates.begin(), candidates.end());
+                candidates.back() = std::make_pair(distance, pId);
+                std::push_heap(candidates.begin(), candidates.end());
+            }
+        };
+
+        for(auto pId : outside)
+            consider(pId);
+
+        //search ring after ring around the cell of search, until no closer point can be found anymore
+        const size_t cx = clamped_index(search.x, minX, nX);
+        const size_t cy = clamped_index(search.y, minY, nY);
+        for(size_t r = 0; ; ++r) {
+            for_each_in_ring(cx, cy, r, consider);
+            T bound = ring_bound(search, cx, cy, r);
+            if(bound == std::numeric_limits<T>::max())
+                break;
+            if(candidates.size() == n && bound * bound > candidates.front().first)
+                break;
+        }
+
+        std::sort_heap(candidates.begin(), candidates.end());
+        Topology<1> res(candidates.size());
+        for(const auto &c : candidates)
+            res.push_back(Element{c.second});
+        return res;
+    }
+
+//------------------------------------------------------------------------------
+
+    Topology<1> in_circle(const Point<T> &search, T radius) const {
+        if(radius <= 0.0) return Topology<1>(); //no real search if radius <= 0
+
+        Topology<1> res;
+        const T sqrRadius = radius * radius;
+        for_each_in_range(search.x - radius, search.x + radius, search.y - radius, search.y + radius, [&](size_t pId) {
+            if(search.sqr_distance_to((*pc)[pId]) <= sqrRadius)
+                res.push_back(Element{pId});
+        });
+        return res;
+    }
+
+//------------------------------------------------------------------------------
+
+    Topology<1> in_box(const Point<T> &search, T xSize, T ySize) const {
+        if(xSize <= 0.0 || ySize <= 0.0) return Topology<1>(); //no real search if width or height <= 0
+
+        Topology<1> res;
+        const T
+            xHalf = 0.5 * xSize,
+            yHalf = 0.5 * ySize;
+        for_each_in_range(search.x - xHalf, search.x + xHalf, search.y - yHalf, search.y + yHalf, [&](size_t pId) {
+            const auto &p = (*pc)[pId];
+            if(std::fabs(p.x - search.x) <= xHalf && std::fabs(p.y - search.y) <= yHalf)
+                res.push_back(Element{pId});
+        });
+        return res;
+    }
+
+//------------------------------------------------------------------------------
+
+private:
+
+    static T choose_cell_size(T width, T height, size_t n, size_t pointsPerCell) {
+        const T extent = std::max(width, height);
+        if(n < 2 || extent <= 0)
+            return 1;
+        const T area = width * height;
+        T size = area > 0
+            ? std::sqrt(area * pointsPerCell / n)
+            : extent * pointsPerCell / n; //all points on a line
+        //never create more than about four cells per point
+        const T minSize = std::max(std::sqrt(area / (4 * n)), extent / (4 * n));
+        return std::max(size, minSize);
+    }
+
+//------------------------------------------------------------------------------
+
+    inline size_t cell_of(const Point<T> &p) const {
+        T fx = (p.x - minX) * invCellSize;
+        T fy = (p.y - minY) * invCellSize;
+        if(!(fx >= 0 && fy >= 0))
+            return NONE;
+        size_t ix = static_cast<size_t>(fx);
+        size_t iy = static_cast<size_t>(fy);
+        if(ix >= nX || iy >= nY)
+            return NONE;
+        return iy * nX + ix;
+    }
+
+    inline size_t clamped_index(T value, T min, size_t n) const {
+        T f = (value - min) * invCellSize;
+        if(!(f > 0))
+            return 0;
+        if(f >= n)
+            return n - 1;
+        return static_cast<size_t>(f);
+    }
+
+//------------------------------------------------------------------------------
+
+    void add_outside(size_t pId) {
+        outside.push_back(pId);
+        locations[pId] = Location{NONE, outside.size() - 1, IN_OUTSIDE};
+        ++nIndexed;
+    }
+
+    template <typename Container>
+    void swap_remove(Container &ids, size_t slot) {
+        if(slot != ids.size() - 1) {
+            ids[slot] = ids.back();
+            locations[ids[slot]].slot = slot;
+        }
+        ids.pop_back();
+    }
+
+//------------------------------------------------------------------------------
+
+    template <typename F>
+    inline void for_each_in_cell(size_t cell, F &f) const {
+        for(size_t i = cellStart[cell], end = cellStart[cell] + cellCount[cell]; i < end; ++i)
+            f(cellIds[i]);
+        if(hasOverflow[cell]) {
+            for(auto pId : overflow.find(cell)->second)
+                f(pId);
+        }
+    }
+
+    ///all cells with a chebyshev distance of r to the cell (cx, cy)
+    template <typename F>
+    void for_each_in_ring(size_t cx, size_t cy, size_t r, F &f) const {
+        const long
+            x0 = (long)cx - (long)r,
+            x1 = (long)cx + (long)r,
+            y0 = (long)cy - (long)r,
+            y1 = (long)cy + (long)r;
+
+        for(long y = std::max(y0, 0L); y <= std::min(y1, (long)nY - 1); ++y) {
+            if(y == y0 || y == y1) {
+                for(long x = std::max(x0, 0L); x <= std::min(x1, (long)nX - 1); ++x)
+                    for_each_in_cell(y * nX + x, f);
+            }
+            else {
+                if(x0 >= 0)        for_each_in_cell(y * nX + x0, f);
+                if(x1 < (long)nX)   for_each_in_cell(y * nX + x1, f);
+            }
+        }
+    }
+
+    ///lower bound of the distance between search and any cell outside of ring r, max() if there are no such cells
+    T ring_bound(const Point<T> &search, size_t cx, size_t cy, size_t r) const {
+        T bound = std::numeric_limits<T>::max();
+        if(cx >= r + 1)   bound = std::min(bound, search.x - (minX + (cx - r) * cellSize));
+        if(cx + r + 1 < nX) bound = std::min(bound, minX + (cx + r + 1) * cellSize - search.x);
+        if(cy >= r + 1)   bound = std::min(bound, search.y - (minY + (cy - r) * cellSize));
+        if(cy + r + 1 < nY) bound = std::min(bound, minY + (cy + r + 1) * cellSize - search.y);
+        return std::max(bound, T(0));
+    }
+
+    template <typename F>
+    void for_each_in_range(T xMin, T xMax, T yMin, T yMax, F f) const {
+        for(auto pId : outside)
+            f(pId);
+        if(nIndexed == outside.size())
+            return;
+        if(xMax < minX || yMax < minY || xMin > minX + nX * cellSize || yMin > minY + nY * cellSize)
+            return;
+
+        const size_t
+            ix0 = clamped_index(xMin, minX, nX),
+            ix1 = clamped_index(xMax, minX, nX),
+            iy0 = clamped_index(yMin, minY, nY),
+            iy1 = clamped_index(yMax, minY, nY);
+
+        for(size_t y = iy0; y <= iy1; ++y)
+            for(size_t x = ix0; x <= ix1; ++x)
+                for_each_in_cell(y * nX + x, f);
+    }
+};
+
+template <typename T>
+const size_t SpatialGrid<T>::NONE;
+
+} //lib_2d
+
+#endif //SPATIALGRID_H_INCLUDED
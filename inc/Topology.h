@@ -31,6 +31,7 @@
 #include <array>
 
 #include "Point.h"
+#include "MemoryResource.h"
 
 namespace lib_2d {
 
@@ -39,11 +40,18 @@ class Topology {
 
     using Element = std::array<size_t, ELEMENTSIZE>;
 
+public:
+    using Elements = std::vector < Element, ResourceAllocator<Element> >;
+
 protected:
-    std::vector < Element > elements;
+    Elements elements;
 public:
     Topology(){}
 
+    ///all elements of this Topology will be allocated from 'resource' (which has to outlive it)
+    explicit Topology(MemoryResource *resource) :
+        elements(ResourceAllocator<Element>(resource)){}
+
     Topology(Element e) {
         elements.push_back(e);
     }
@@ -62,6 +70,12 @@ public:
 
     ~Topology(){}
 
+    //the user declared destructor would otherwise suppress moving
+    Topology(const Topology&) = default;
+    Topology(Topology&&) = default;
+    Topology& operator=(const Topology&) = default;
+    Topology& operator=(Topology&&) = default;
+
 //------------------------------------------------------------------------------
 
     Topology& push_back(const Element &e) {
@@ -70,8 +84,27 @@ public:
     }
 
     Topology& push_back(const Topology &other) {
-        for(auto e = other.cbegin(); e != other.cend(); ++e)
-            elements.push_back(*e);
+        if(elements.capacity() < elements.size() + other.n_elements()) //reserve geometrically to stay amortized
+            elements.reserve(std::max(elements.size() + other.n_elements(), 2 * elements.capacity()));
+        if(&other == this) { //appending to itself, the range would be changed while inserting it
+            const size_t n = elements.size();
+            for(size_t i = 0; i < n; ++i)
+                elements.push_back(elements[i]);
+            return *this;
+        }
+        elements.insert(elements.end(), other.cbegin(), other.cend());
+        return *this;
+    }
+
+    ///takes over the buffer of other if this is empty
+    Topology& push_back(Topology &&other) {
+        if(&other == this)
+            return push_back(static_cast<const Topology&>(other));
+        if(elements.empty())
+            elements = std::move(other.elements);
+        else
+            push_back(other);
+        other.clear();
         return *this;
     }
 
@@ -81,9 +114,11 @@ public:
     }
 
     Topology& emplace_back(const Topology &other) {
-        for(auto e : other)
-            elements.emplace_back(e);
-        return *this;
+        return push_back(other);
+    }
+
+    Topology& emplace_back(Topology &&other) {
+        return push_back(std::move(other));
     }
 
 //------------------------------------------------------------------------------
@@ -101,11 +136,11 @@ public:
 
 //------------------------------------------------------------------------------
 
-    Element first() const {
+    const Element& first() const {
         return elements[0];
     }
 
-    Element last() const {
+    const Element& last() const {
         return elements[elements.size() - 1];
     }
 
@@ -121,6 +156,12 @@ public:
         elements.reserve(i);
     }
 
+//------------------------------------------------------------------------------
+
+    MemoryResource* get_resource() const {
+        return elements.get_allocator().get_resource();
+    }
+
 //------------------------------------------------------------------------------
 
     Topology& clear() {
@@ -166,33 +207,33 @@ public:
 
 //------------------------------------------------------------------------------
 
-    typename std::vector <Element>::iterator begin() {
+    typename Elements::iterator begin() {
         return elements.begin();
     }
 
-    typename std::vector <Element>::iterator end() {
+    typename Elements::iterator end() {
         return elements.end();
     }
 
-    typename std::vector <Element>::const_iterator cbegin() const {
+    typename Elements::const_iterator cbegin() const {
         return elements.cbegin();
     }
 
-    typename std::vector <Element>::const_iterator cend() const {
+    typename Elements::const_iterator cend() const {
         return elements.cend();
     }
 
-    typename std::vector <Element>::reverse_iterator rbegin() {
+    typename Elements::reverse_iterator rbegin() {
         return elements.rbegin();
     }
 
-    typename std::vector <Element>::reverse_iterator rend() {
+    typename Elements::reverse_iterator rend() {
         return elements.rend();
     }
 
 //------------------------------------------------------------------------------
 
-    Element operator [] (unsigned int i) const {
+    const Element& operator [] (unsigned int i) const {
         return elements[i];
     }
 
@@ -205,7 +246,12 @@ public:
         return *this;
     }
 
-    Topology& operator += (Element other) {
+    Topology& operator += (Topology &&other) {
+        push_back(std::move(other));
+        return *this;
+    }
+
+    Topology& operator += (const Element &other) {
         push_back(other);
         return *this;
     }
@@ -0,0 +1,531 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    Voronoi.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains the class Voronoi, the Voronoi diagram as dual of the Delaunay triangulation
+ *          its vertices are the circumcenters of the triangles, the cell of a site is found by rotating around it within the mesh
+ *          nearest site queries walk to the triangle of the query and descend greedily along the Delaunay edges
+ *          natural neighbour (Sibson) weights are the areas the cell of the query would steal from its neighbours
+ */
+
+#ifndef VORONOI_H_INCLUDED
+#define VORONOI_H_INCLUDED
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "Point.h"
+#include "PointCloudView.h"
+#include "PointCloud.h"
+#include "Rectangle.h"
+#include "Topology.h"
+#include "Delaunay.h"
+#include "PolygonClipping.h"
+#include "parallel.h"
+
+namespace lib_2d {
+
+template <typename T>
+class Voronoi : public Delaunay<T> {
+
+using Base = Delaunay<T>;
+using Index = typename Base::Index;
+using Real = typename Base::Real;
+using Weights = std::vector<std::pair<size_t, T>>;
+
+private:
+    enum : Index {NONE = Base::GHOST};
+
+    std::vector<Index> outgoing; //a half edge starting at each point, NONE for duplicates
+    std::vector<Index> siteOf; //the point representing each point of the source, duplicates share the one which was kept
+
+    std::vector<Index> grid; //a triangle per bucket, start of the walks towards points far away from the hint
+    size_t gridWidth = 0, gridHeight = 0;
+    Real gridMinX = 0, gridMinY = 0, gridScaleX = 0, gridScaleY = 0;
+
+//------------------------------------------------------------------------------
+
+public:
+
+    ///triangulates all points, nThreads is forwarded to the Delaunay triangulation
+    explicit Voronoi(const PointCloudView<T> &source, size_t nThreads = 0) :
+        Base(source, nThreads) {
+
+        outgoing.assign(this->points.size(), NONE);
+        for(size_t he = 0; he < this->vertices.size(); ++he) {
+            if(this->vertices[he] != NONE)
+                outgoing[this->vertices[he]] = Index(he);
+        }
+
+        siteOf.assign(source.size(), NONE);
+        for(size_t v = 0; v < outgoing.size(); ++v) {
+            if(outgoing[v] != NONE)
+                siteOf[this->ids[v]] = Index(v);
+        }
+        const Topology<2> &duplicates = this->duplicates();
+        for(size_t i = 0; i < duplicates.n_elements(); ++i)
+            siteOf[duplicates[i][0]] = siteOf[duplicates[i][1]];
+        if(this->nReal > 0)
+            build_grid();
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the vertices of the diagram, the circumcenters of the triangles, in the order of triangles()
+    PointCloud<T> voronoi_vertices() const {
+        PointCloud<T> res(this->nReal);
+        for(size_t t = 0; t < this->nReal; ++t)
+            res.push_back(center(t));
+        return res;
+    }
+
+    ///whether the cell of the point is unbounded, since it is on the convex hull
+    bool unbounded(size_t id) const {
+        const Index v = site(id);
+        if(v == NONE)
+            return true;
+        const size_t start = outgoing[v];
+        size_t he = start;
+        do {
+            if(this->is_ghost(he / 3))
+                return true;
+            he = this->twins[Base::prev(he)];
+        } while(he != start);
+        return false;
+    }
+
+    ///the cell of a point as indices of voronoi_vertices(), counter clockwise
+    ///the cells of hull points are unbounded, their list starts and ends with the vertices of the two infinite edges
+    Topology<1> cell(size_t id) const {
+        Topology<1> res;
+        const Index v = site(id);
+        if(v == NONE)
+            return res;
+
+        const size_t start = first_around(v);
+        size_t he = start;
+        do {
+            if(!this->is_ghost(he / 3))
+                res.push_back(std::array<size_t, 1>{{he / 3}});
+            he = this->twins[Base::prev(he)];
+        } while(he != start);
+        return res;
+    }
+
+    ///the cell of a point as polygon clipped by bounds, counter clockwise
+    ///unbounded cells are closed far outside of the bounds before clipping, empty for collinear sources
+    PointCloud<T> cell(size_t id, const Rectangle<T> &bounds, bool closePath = true) const {
+        std::vector<Point<T>> corners;
+        return cell(id, bounds, closePath, corners);
+    }
+
+    ///the cells of all points of the source, split onto several threads
+    std::vector<PointCloud<T>> cells(const Rectangle<T> &bounds, bool closePath = true, size_t nThreads = 0) const {
+        std::vector<PointCloud<T>> res(siteOf.size());
+        parallel_chunks(res.size(), n_chunks(res.size(), nThreads, 1 << 10), [&](size_t first, size_t last, size_t) {
+            std::vector<Point<T>> corners;
+            for(size_t i = first; i < last; ++i)
+                res[i] = cell(i, bounds, closePath, corners);
+        });
+        return res;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///index of the point within the source whose cell contains p (the nearest one)
+    size_t nearest(const Point<T> &p) const {
+        size_t hint(0);
+        return nearest(p, hint);
+    }
+
+    ///the walk towards p starts at the triangle of hint (or a bucket of a coarse grid, if that is closer) and hint is set to the triangle of p
+    ///passing the hint of the previous query makes subsequent queries of nearby points O(1)
+    size_t nearest(const Point<T> &p, size_t &hint) const {
+        if(this->nReal == 0)
+            return nearest_linear(p);
+        hint = walk(p, hint);
+        return this->ids[descend(p, hint)];
+    }
+
+    ///nearest points of all queries, split onto several threads, each one reusing the triangle of its previous query
+    void nearest(const PointCloudView<T> &queries, std::vector<size_t> &result, size_t nThreads = 0) const {
+        result.resize(queries.size());
+        parallel_chunks(queries.size(), n_chunks(queries.size(), nThreads), [&](size_t first, size_t last, size_t) {
+            size_t hint(0);
+            for(size_t i = first; i < last; ++i)
+                result[i] = nearest(queries[i], hint);
+        });
+    }
+
+//------------------------------------------------------------------------------
+
+    ///natural neighbour (Sibson) weights of p as pairs of source index and weight, summing up to 1
+    ///outside of the convex hull the nearest point gets the full weight, on the hull p is interpolated linearly along its edge
+    void natural_neighbours(const Point<T> &p, Weights &weights) const {
+        size_t hint(0);
+        std::vector<size_t> cavity;
+        natural_neighbours(p, weights, hint, cavity);
+    }
+
+    void natural_neighbours(const Point<T> &p, Weights &weights, size_t &hint) const {
+        std::vector<size_t> cavity;
+        natural_neighbours(p, weights, hint, cavity);
+    }
+
+    ///natural neighbour interpolation of values given per point of the source
+    T interpolate(const Point<T> &p, const std::vector<T> &values) const {
+        check_values(values);
+        size_t hint(0);
+        Weights weights;
+        std::vector<size_t> cavity;
+        natural_neighbours(p, weights, hint, cavity);
+        return weighted_sum(weights, values);
+    }
+
+    ///interpolates at all queries, split onto several threads, each one reusing the triangle of its previous query
+    void interpolate(const PointCloudView<T> &queries, const std::vector<T> &values, std::vector<T> &result, size_t nThreads = 0) const {
+        check_values(values);
+        result.resize(queries.size());
+        parallel_chunks(queries.size(), n_chunks(queries.size(), nThreads, 1 << 12), [&](size_t first, size_t last, size_t) {
+            size_t hint(0);
+            Weights weights;
+            std::vector<size_t> cavity;
+            for(size_t i = first; i < last; ++i) {
+                natural_neighbours(queries[i], weights, hint, cavity);
+                result[i] = weighted_sum(weights, values);
+            }
+        });
+    }
+
+//------------------------------------------------------------------------------
+
+private:
+
+    inline Index site(size_t id) const {
+        if(id >= siteOf.size())
+            throw std::out_of_range ("Voronoi site index out of range");
+        return siteOf[id];
+    }
+
+    ///buckets of about two points each, a bucket without points uses the triangle of the previous one
+    void build_grid() {
+        const size_t m = this->points.size();
+        T minX(this->points[0].x), maxX(minX), minY(this->points[0].y), maxY(minY);
+        for(const auto &p : this->points) {
+            minX = std::min(minX, p.x); maxX = std::max(maxX, p.x);
+            minY = std::min(minY, p.y); maxY = std::max(maxY, p.y);
+        }
+        const Real
+            width = std::max(Real(maxX) - minX, std::numeric_limits<Real>::min()),
+            height = std::max(Real(maxY) - minY, std::numeric_limits<Real>::min()),
+            bucket = std::sqrt(2 * width * height / Real(m));
+        gridWidth = size_t(std::min(Real(1 << 14), std::max(Real(1), width / bucket)));
+        gridHeight = size_t(std::min(Real(1 << 14), std::max(Real(1), height / bucket)));
+        gridMinX = minX;
+        gridMinY = minY;
+        gridScaleX = gridWidth / width;
+        gridScaleY = gridHeight / height;
+
+        grid.assign(gridWidth * gridHeight, NONE);
+        for(size_t v = 0; v < m; ++v) {
+            if(outgoing[v] != NONE)
+                grid[bucket_of(this->points[v])] = Index(outgoing[v] / 3);
+        }
+        Index previous = Index(0);
+        for(auto &t : grid) {
+            if(t == NONE)
+                t = previous;
+            previous = t;
+        }
+    }
+
+    inline size_t bucket_of(const Point<T> &p) const {
+        const Real
+            x = std::min(std::max((Real(p.x) - gridMinX) * gridScaleX, Real(0)), Real(gridWidth - 1)),
+            y = std::min(std::max((Real(p.y) - gridMinY) * gridScaleY, Real(0)), Real(gridHeight - 1));
+        return size_t(y) * gridWidth + size_t(x);
+    }
+
+    ///locates p, starting at hint or the triangle of its bucket, whichever is closer
+    inline size_t walk(const Point<T> &p, size_t hint) const {
+        size_t t = grid[bucket_of(p)];
+        if(hint < this->vertices.size() / 3) {
+            const Point<T>
+                &fromHint = this->points[this->vertices[3*hint]],
+                &fromGrid = this->points[this->vertices[3*t]];
+            if(sqr_distance(fromHint, p) < sqr_distance(fromGrid, p))
+                t = hint;
+        }
+        return this->locate(p, t);
+    }
+
+    inline Point<T> center(size_t t) const {
+        return Base::circumcenter(this->points[this->vertices[3*t]], this->points[this->vertices[3*t+1]], this->points[this->vertices[3*t+2]]);
+    }
+
+    static inline Real sqr_distance(const Point<T> &a, const Point<T> &b) {
+        const Real
+            dx = Real(a.x) - b.x,
+            dy = Real(a.y) - b.y;
+        return dx * dx + dy * dy;
+    }
+
+    ///twice the signed area of the triangle p a b
+    static inline Real cross(const Point<T> &p, const Point<T> &a, const Point<T> &b) {
+        return (Real(a.x) - p.x) * (Real(b.y) - p.y) - (Real(a.y) - p.y) * (Real(b.x) - p.x);
+    }
+
+    void check_values(const std::vector<T> &values) const {
+        if(values.size() != siteOf.size())
+            throw std::out_of_range ("Voronoi requires one value per point of the source");
+    }
+
+    static T weighted_sum(const Weights &weights, const std::vector<T> &values) {
+        Real sum(0);
+        for(const auto &w : weights)
+            sum += Real(w.second) * values[w.first];
+        return T(sum);
+    }
+
+    size_t nearest_linear(const Point<T> &p) const {
+        size_t best(0);
+        for(size_t v = 1; v < this->points.size(); ++v) {
+            if(sqr_distance(this->points[v], p) < sqr_distance(this->points[best], p))
+                best = v;
+        }
+        return this->points.empty() ? 0 : this->ids[best];
+    }
+
+    ///starting at the nearest point of triangle t, moves to closer Delaunay neighbours until there are none
+    ///a point without a closer neighbour is the nearest one
+    Index descend(const Point<T> &p, size_t t) const {
+        Index best(NONE);
+        Real bestDistance(0);
+        for(size_t k = 0; k < 3; ++k) {
+            const Index w = this->vertices[3*t+k];
+            if(w == NONE)
+                continue;
+            const Real d = sqr_distance(this->points[w], p);
+            if(best == NONE || d < bestDistance) {
+                best = w;
+                bestDistance = d;
+            }
+        }
+
+        for(bool improved = true; improved;) {
+            improved = false;
+            const size_t start = outgoing[best];
+            size_t he = start;
+            do {
+                const Index w = this->vertices[Base::next(he)];
+                if(w != NONE) {
+                    const Real d = sqr_distance(this->points[w], p);
+                    if(d < bestDistance) {
+                        best = w;
+                        bestDistance = d;
+                        improved = true;
+                        break;
+                    }
+                }
+                he = this->twins[Base::prev(he)];
+            } while(he != start);
+        }
+        return best;
+    }
+
+    ///a half edge starting at v, for hull points the first one after their ghost triangles
+    size_t first_around(Index v) const {
+        const size_t start = outgoing[v];
+        size_t he = start;
+        do {
+            const size_t following = this->twins[Base::prev(he)];
+            if(this->is_ghost(he / 3) && !this->is_ghost(following / 3))
+                return following;
+            he = following;
+        } while(he != start);
+        return start;
+    }
+
+    PointCloud<T> cell(size_t id, const Rectangle<T> &bounds, bool closePath, std::vector<Point<T>> &corners) const {
+        const Index v = site(id);
+        if(v == NONE)
+            return PointCloud<T>();
+
+        //the circumcenters around the site, ghosts use the one of their real neighbour where their infinite edge starts
+        const PointCloudView<T> window = bounds.view();
+        const Point<T> &middle = window.first();
+        Real reach = std::sqrt(sqr_distance(this->points[v], middle));
+        for(const auto &q : window)
+            reach = std::max(reach, std::sqrt(sqr_distance(q, middle)));
+        corners.clear();
+        const size_t start = first_around(v);
+        size_t he = start;
+        do {
+            const size_t t = he / 3;
+            corners.push_back(center(this->is_ghost(t) ? this->twins[3*t] / 3 : t));
+            reach = std::max(reach, std::sqrt(sqr_distance(corners.back(), middle)));
+            he = this->twins[Base::prev(he)];
+        } while(he != start);
+
+        //the infinite edges are cut far outside of the bounds, the two ghosts of a hull point follow each other
+        //and the far points of their edges are connected through a third one in between
+        const Real far = 4 * reach;
+        PointCloud<T> polygon(corners.size() + 1);
+        Real previousX(0), previousY(0);
+        bool previousGhost = false;
+        he = start;
+        for(const auto &corner : corners) {
+            const size_t t = he / 3;
+            he = this->twins[Base::prev(he)];
+            if(!this->is_ghost(t)) {
+                polygon.push_back(corner);
+                previousGhost = false;
+                continue;
+            }
+            const Point<T>
+                &a = this->points[this->vertices[3*t]],
+                &b = this->points[this->vertices[3*t+1]];
+            const Real length = std::sqrt(sqr_distance(a, b));
+            const Real nx = -(Real(b.y) - a.y) / length, ny = (Real(b.x) - a.x) / length; //outwards, left of the hull edge
+            if(previousGhost) {
+                Real mx = nx + previousX, my = ny + previousY;
+                const Real mLength = std::sqrt(mx * mx + my * my);
+                mx = mLength > 0 ? mx / mLength : -ny;
+                my = mLength > 0 ? my / mLength : nx;
+                polygon.push_back(Point<T>{T(this->points[v].x + 2 * far * mx), T(this->points[v].y + 2 * far * my)});
+            }
+            polygon.push_back(Point<T>{T(corner.x + far * nx), T(corner.y + far * ny)});
+            previousX = nx;
+            previousY = ny;
+            previousGhost = true;
+        }
+        return PolygonClipping<T>::clip_convex(polygon.view(), window, closePath);
+    }
+
+    void natural_neighbours(const Point<T> &p, Weights &weights, size_t &hint, std::vector<size_t> &cavity) const {
+        weights.clear();
+        if(this->nReal == 0) {
+            if(!this->points.empty())
+                weights.emplace_back(nearest_linear(p), T(1));
+            return;
+        }
+
+        const size_t t = walk(p, hint);
+        hint = t;
+        if(this->is_ghost(t)) {
+            weights.emplace_back(this->ids[descend(p, t)], T(1));
+            return;
+        }
+
+        for(size_t k = 0; k < 3; ++k) {
+            const Index a = this->vertices[3*t+k];
+            if(this->points[a] == p) {
+                weights.emplace_back(this->ids[a], T(1));
+                return;
+            }
+        }
+        for(size_t k = 0; k < 3; ++k) {
+            const size_t he = 3*t+k;
+            const Point<T>
+                &a = this->points[this->vertices[he]],
+                &b = this->points[this->vertices[Base::next(he)]];
+            if(this->is_ghost(this->twins[he] / 3) && Base::orient(a, b, p) == 0) {
+                const Real s = ((Real(p.x) - a.x) * (Real(b.x) - a.x) + (Real(p.y) - a.y) * (Real(b.y) - a.y)) / sqr_distance(a, b);
+                weights.emplace_back(this->ids[this->vertices[he]], T(1 - s));
+                weights.emplace_back(this->ids[this->vertices[Base::next(he)]], T(s));
+                return;
+            }
+        }
+
+        //the triangles whose circumcircle contains p, they would be removed by inserting it
+        cavity.assign(1, t);
+        for(size_t i = 0; i < cavity.size(); ++i) {
+            for(size_t k = 0; k < 3; ++k) {
+                const size_t other = this->twins[3*cavity[i]+k] / 3;
+                if(this->is_ghost(other) || within(cavity, other))
+                    continue;
+                if(Base::in_circle(this->points[this->vertices[3*other]], this->points[this->vertices[3*other+1]], this->points[this->vertices[3*other+2]], p) > 0)
+                    cavity.push_back(other);
+            }
+        }
+
+        //each point v of the cavity border loses the part of its cell between the new circumcenters of its two border edges
+        //and the old circumcenters of the cavity triangles around it
+        Real total(0);
+        for(size_t i = 0; i < cavity.size(); ++i) {
+            for(size_t k = 0; k < 3; ++k) {
+                const size_t border = 3*cavity[i]+k;
+                if(within(cavity, this->twins[border] / 3))
+                    continue;
+                const Index
+                    v = this->vertices[border],
+                    w = this->vertices[Base::next(border)];
+                const Point<T> first = Base::circumcenter(this->points[v], this->points[w], p);
+                Point<T> previous = first;
+                Real area(0);
+                size_t he = border;
+                while(true) {
+                    const Point<T> corner = center(he / 3);
+                    area += cross(p, previous, corner);
+                    previous = corner;
+                    const size_t incoming = Base::prev(he);
+                    if(!within(cavity, this->twins[incoming] / 3)) {
+                        const Point<T> last = Base::circumcenter(this->points[this->vertices[incoming]], this->points[v], p);
+                        area += cross(p, previous, last);
+                        area += cross(p, last, first);
+                        break;
+                    }
+                    he = this->twins[incoming];
+                }
+                area = std::fabs(area) / 2;
+                weights.emplace_back(this->ids[v], T(area));
+                total += area;
+            }
+        }
+
+        if(total > 0 && total < std::numeric_limits<Real>::infinity()) {
+            for(auto &w : weights)
+                w.second = T(w.second / total);
+            return;
+        }
+
+        //degenerate cavities fall back to barycentric weights
+        weights.clear();
+        const Point<T>
+            &a = this->points[this->vertices[3*t]],
+            &b = this->points[this->vertices[3*t+1]],
+            &c = this->points[this->vertices[3*t+2]];
+        const Real area = Base::orient(a, b, c);
+        weights.emplace_back(this->ids[this->vertices[3*t]], T(Base::orient(b, c, p) / area));
+        weights.emplace_back(this->ids[this->vertices[3*t+1]], T(Base::orient(c, a, p) / area));
+        weights.emplace_back(this->ids[this->vertices[3*t+2]], T(Base::orient(a, b, p) / area));
+    }
+
+    static inline bool within(const std::vector<size_t> &cavity, size_t t) {
+        return std::find(cavity.begin(), cavity.end(), t) != cavity.end();
+    }
+};
+
+} //lib_2d
+
+#endif // VORONOI_H_INCLUDED
@@ -23,6 +23,9 @@
 #ifndef CALC_H_INCLUDED
 #define CALC_H_INCLUDED
 
+#include <algorithm>
+#include <initializer_list>
+
 #include "Point.h"
 #include "PointCloud.h"
 
@@ -215,6 +218,98 @@ namespace lib_2d {
 
         return intersections;
     }
+
+//------------------------------------------------------------------------------
+
+    ///1 if r is left of the line p -> q, -1 if right of it, 0 if all three are colinear
+    ///unlike turn() this works on the unnormalized vectors, so it is exact for exactly representable products
+    template <typename T>
+    inline int orientation(const Point<T> &p, const Point<T> &q, const Point<T> &r) {
+        const auto res = cross(vect(p, q), vect(p, r));
+
+        if(res > 0) return  1;
+        if(res < 0) return -1;
+        else        return 0;
+    }
+
+    ///whether r lies within the bounding box of the segment [p, q] (and thus on it, if it is colinear)
+    template <typename T>
+    inline bool on_segment(const Point<T> &p, const Point<T> &q, const Point<T> &r) {
+        return std::min(p.x, q.x) <= r.x && r.x <= std::max(p.x, q.x)
+            && std::min(p.y, q.y) <= r.y && r.y <= std::max(p.y, q.y);
+    }
+
+//------------------------------------------------------------------------------
+
+    ///whether the segments [p1, p2] and [q1, q2] intersect, touching and colinear overlaps count as intersecting
+    template <typename T>
+    bool segments_intersect(const Point<T> &p1, const Point<T> &p2, const Point<T> &q1, const Point<T> &q2) {
+        const int
+            o1 = orientation(p1, p2, q1),
+            o2 = orientation(p1, p2, q2),
+            o3 = orientation(q1, q2, p1),
+            o4 = orientation(q1, q2, p2);
+
+        if(o1 != o2 && o3 != o4)
+            return true;
+
+        return (o1 == 0 && on_segment(p1, p2, q1))
+            || (o2 == 0 && on_segment(p1, p2, q2))
+            || (o3 == 0 && on_segment(q1, q2, p1))
+            || (o4 == 0 && on_segment(q1, q2, p2));
+    }
+
+    ///calculates the intersection of the segments [p1, p2] and [q1, q2] via their parametric form p1 + t * (p2 - p1)
+    ///the range checks of t are done without divisions, so there are no problems with vertical or horizontal segments
+    ///for colinear overlapping segments one of the endpoints within the overlap is returned
+    template <typename T>
+    bool segment_intersection(const Point<T> &p1, const Point<T> &p2, const Point<T> &q1, const Point<T> &q2, Point<T> &intersection) {
+        const Point<T>
+            r = vect(p1, p2),
+            s = vect(q1, q2),
+            pq = vect(p1, q1);
+
+        T
+            denominator = cross(r, s),
+            tNumerator = cross(pq, s),
+            uNumerator = cross(pq, r);
+
+        if(denominator == 0) {
+            if(uNumerator != 0)
+                return false; //parallel
+            for(const auto &candidate : {q1, q2, p1, p2}) {
+                if(on_segment(p1, p2, candidate) && on_segment(q1, q2, candidate)) {
+                    intersection = candidate;
+                    return true;
+                }
+            }
+            return false; //colinear without overlap
+        }
+
+        if(denominator < 0) {
+            denominator = -denominator;
+            tNumerator = -tNumerator;
+            uNumerator = -uNumerator;
+        }
+        if(tNumerator < 0 || tNumerator > denominator || uNumerator < 0 || uNumerator > denominator)
+            return false;
+
+        const T t = tNumerator / denominator;
+        intersection = Point<T>{p1.x + t * r.x, p1.y + t * r.y};
+        return true;
+    }
+
+//------------------------------------------------------------------------------
+
+    ///the squared distance between p and the closest point of the segment [a, b]
+    template <typename T>
+    inline T sqr_distance_point_segment(const Point<T> &p, const Point<T> &a, const Point<T> &b) {
+        const Point<T> ab = vect(a, b);
+        const T length = dot(ab, ab);
+        T t = length > 0 ? dot(vect(a, p), ab) / length : 0;
+        t = std::max(T(0), std::min(T(1), t));
+        return p.sqr_distance_to(Point<T>{a.x + t * ab.x, a.y + t * ab.y});
+    }
 } //lib_2d
 
 #endif // CALC_H_INCLUDED
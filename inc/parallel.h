@@ -0,0 +1,128 @@
+/*
+    Copyright (c) 2015 Martin Buck
+    Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"),
+    to deal in the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+    and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+    The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+    DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+    OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/**
+ * \file    parallel.h
+ * \author  Martin Buck
+ * \date    November 2015
+ * \version 1.0
+ * \brief   contains small helpers to split work onto several threads
+ *          requires linking with -pthread
+ */
+
+#ifndef PARALLEL_H_INCLUDED
+#define PARALLEL_H_INCLUDED
+
+#include <vector>
+#include <thread>
+#include <exception>
+#include <algorithm>
+#include <cstddef>
+
+namespace lib_2d {
+
+//------------------------------------------------------------------------------
+
+    ///the number of threads to use if none is given, at least 1
+    inline size_t n_threads() {
+        size_t n = std::thread::hardware_concurrency();
+        return n > 0 ? n : 1;
+    }
+
+    ///the number of chunks to split n items into, so each chunk has at least minChunkSize items
+    inline size_t n_chunks(size_t n, size_t nThreads = 0, size_t minChunkSize = 1 << 14) {
+        if(nThreads == 0)
+            nThreads = n_threads();
+        size_t nChunks = minChunkSize > 0 ? n / minChunkSize : n;
+        return std::max(size_t(1), std::min(nThreads, nChunks));
+    }
+
+//------------------------------------------------------------------------------
+
+    ///splits [0, n) into nChunks consecutive ranges and calls f(first, last, chunk) for each of them on its own thread
+    ///the last chunk is processed by the calling thread, the first exception thrown by any chunk is rethrown after all of them finished
+    template <typename F>
+    void parallel_chunks(size_t n, size_t nChunks, F f) {
+        if(nChunks < 2 || n < 2) {
+            f(size_t(0), n, size_t(0));
+            return;
+        }
+        nChunks = std::min(nChunks, n);
+
+        std::vector<std::exception_ptr> errors(nChunks);
+        auto run = [&](size_t chunk) {
+            try {
+                f(chunk * n / nChunks, (chunk + 1) * n / nChunks, chunk);
+            }
+            catch(...) {
+                errors[chunk] = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(nChunks - 1);
+        for(size_t chunk = 0; chunk + 1 < nChunks; ++chunk)
+            threads.emplace_back(run, chunk);
+        run(nChunks - 1);
+
+        for(auto &thread : threads)
+            thread.join();
+        for(const auto &error : errors) {
+            if(error)
+                std::rethrow_exception(error);
+        }
+    }
+
+//------------------------------------------------------------------------------
+
+    ///calls f(i) for all i within [0, n), split onto nChunks threads
+    template <typename F>
+    void parallel_for(size_t n, size_t nChunks, F f) {
+        parallel_chunks(n, nChunks, [&f](size_t first, size_t last, size_t) {
+            for(size_t i = first; i < last; ++i)
+                f(i);
+        });
+    }
+
+//------------------------------------------------------------------------------
+
+    ///sorts [first, last), chunks of at least minChunkSize items are sorted on their own threads and merged pairwise
+    template <typename Iterator, typename Compare>
+    void parallel_sort(Iterator first, Iterator last, Compare compare, size_t nThreads = 0, size_t minChunkSize = 1 << 16) {
+        const size_t n = last - first;
+        const size_t nChunks = n_chunks(n, nThreads, minChunkSize);
+        if(nChunks < 2) {
+            std::sort(first, last, compare);
+            return;
+        }
+
+        auto bound = [n, nChunks](size_t chunk) {
+            return std::min(chunk, nChunks) * n / nChunks;
+        };
+        parallel_chunks(n, nChunks, [&](size_t from, size_t to, size_t) {
+            std::sort(first + from, first + to, compare);
+        });
+        for(size_t width = 1; width < nChunks; width *= 2) {
+            const size_t nMerges = (nChunks + 2 * width - 1) / (2 * width);
+            parallel_for(nMerges, nMerges, [&](size_t i) {
+                const size_t chunk = 2 * width * i;
+                if(chunk + width < nChunks)
+                    std::inplace_merge(first + bound(chunk), first + bound(chunk + width), first + bound(chunk + 2 * width), compare);
+            });
+        }
+    }
+
+} //lib_2d
+
+#endif // PARALLEL_H_INCLUDED
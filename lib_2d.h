@@ -23,13 +23,17 @@
 #ifndef LIB_2D_H_INCLUDED
 #define LIB_2D_H_INCLUDED
 
-//#define LIB_2D_EXPERIMENTAL
-
+#include "inc/MemoryResource.h"
 #include "inc/Point.h"
 #include "inc/Topology.h"
+#include "inc/PointCloudView.h"
 #include "inc/PointCloud.h"
 #include "inc/OrderedPointCloud.h"
 #include "inc/KdTree.h"
+#include "inc/SpatialGrid.h"
+#include "inc/QuadTree.h"
+#include "inc/RTree.h"
+#include "inc/OnlineHull.h"
 #include "inc/LineSegment.h"
 #include "inc/Rectangle.h"
 #include "inc/Arc.h"
@@ -39,5 +43,21 @@
 #include "inc/InterpolationLinear.h"
 #include "inc/InterpolationCosine.h"
 #include "inc/Factory2D.h"
+#include "inc/RotatingCalipers.h"
+#include "inc/EnclosingCircle.h"
+#include "inc/PathDistance.h"
+#include "inc/PreparedPolygon.h"
+#include "inc/PolygonClipping.h"
+#include "inc/Delaunay.h"
+#include "inc/Voronoi.h"
+#include "inc/PolygonTriangulation.h"
+#include "inc/DisjointSets.h"
+#include "inc/MinimumSpanningTree.h"
+#include "inc/Dbscan.h"
+#include "inc/IterativeClosestPoint.h"
+#include "inc/Ransac.h"
+#include "inc/DistanceJoin.h"
+#include "inc/ReverseKNearest.h"
+#include "inc/MarchingSquares.h"
 
 #endif // LIB_2D_H_INCLUDED
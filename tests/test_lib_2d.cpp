@@ -22,6 +22,7 @@
 
 #include <iostream>
 #include <stdexcept>
+#include <random>
 
 #include "../lib_2d.h"
 
@@ -250,6 +251,53 @@ TEST_CASE("testing PointCloud") {
         REQUIRE(tmp.size() == 16);
     }
 
+    SECTION("testing appending of temporaries") {
+        auto tmp = path;
+        auto data = &tmp[0];
+
+        PointCloud<T> target;
+        target.push_back(std::move(tmp));
+        REQUIRE(target.size() == 3);
+        REQUIRE(&target[0] == data); //buffer was taken over
+        REQUIRE(tmp.size() == 0);
+
+        auto chained = path + path + path + Point<T>{7, 7};
+        REQUIRE(chained.size() == 10);
+        REQUIRE(chained.last() == ( Point<T>{7, 7} ));
+
+        PointCloud<T> other(path);
+        other.reserve(6);
+        data = &other[0];
+        auto prepended = path + std::move(other);
+        REQUIRE(prepended.size() == 6);
+        REQUIRE(&prepended[0] == data); //buffer of the temporary was reused
+        REQUIRE(prepended == path + path);
+
+        Topology<1> top, top2;
+        top.push_back(std::array<size_t, 1>{1});
+        top2.push_back(std::array<size_t, 1>{2});
+        top2 += std::move(top);
+        REQUIRE(top2.n_elements() == 2);
+        REQUIRE(top2.last()[0] == 1);
+
+        //appending to itself copies instead of emptying
+        PointCloud<T> self(path);
+        self.push_back(std::move(self));
+        REQUIRE(self == path + path);
+        self.push_back(self);
+        REQUIRE(self.size() == 4 * path.size());
+        self.reserve(16 * path.size());
+        PointCloud<T> doubled = self + std::move(self);
+        REQUIRE(doubled.size() == 8 * path.size());
+        REQUIRE(self.size() == 4 * path.size());
+        REQUIRE(doubled == self + self);
+
+        top2.push_back(std::move(top2));
+        REQUIRE(top2.n_elements() == 4);
+        REQUIRE(top2[2][0] == 2);
+        REQUIRE(top2.last()[0] == 1);
+    }
+
     SECTION("testing retrieval of first and last element") {
         REQUIRE(path.last() == path[path.size()-1]);
         REQUIRE(path.first() == path[0]);
@@ -565,7 +613,6 @@ TEST_CASE("testing PointCloud") {
 
         REQUIRE(convexHull.size() == 5);
     }
-#ifdef LIB_2D_EXPERIMENTAL
     SECTION("testing inside tests") {
         PointCloud<T> tmp = PointCloud<T> ();
         tmp.push_back(0,0);
@@ -581,9 +628,15 @@ TEST_CASE("testing PointCloud") {
 
         REQUIRE(convexHull.point_is_inside(Point<T>{1,1}));
         REQUIRE(convexHull.point_is_inside(Point<T>{2,1}));
-
+        REQUIRE(convexHull.point_is_inside(Point<T>{3,0})); //on the border
+        REQUIRE(convexHull.point_is_inside(Point<T>{-6,0})); //vertex
+        REQUIRE_FALSE(convexHull.point_is_inside(Point<T>{4,0}));
+        REQUIRE_FALSE(convexHull.point_is_inside(Point<T>{-7,0})); //ray through a vertex
+        REQUIRE(convexHull.winding_number(Point<T>{1,1}) == 1);
+        REQUIRE(convexHull.winding_number(Point<T>{4,0}) == 0);
+        REQUIRE(convexHull.point_is_on_border(Point<T>{3,1}));
+        REQUIRE_FALSE(convexHull.point_is_on_border(Point<T>{1,1}));
     }
-#endif
     SECTION("testing method chaining") {
         auto tmp = path;
         auto tmp2 = path;
@@ -599,6 +652,66 @@ TEST_CASE("testing PointCloud") {
     }
 }
 
+TEST_CASE("testing PointCloudView") {
+    PointCloud<T> path = PointCloud<T>();
+    for(unsigned int i = 0; i < 10; ++i)
+        path.push_back(i, 2*i);
+
+    auto view = path.view();
+
+    SECTION("testing access without copies") {
+        REQUIRE(view.size() == path.size());
+        REQUIRE(&view[3] == &path[3]);
+        REQUIRE(view.first() == path.first());
+        REQUIRE(view.last() == path.last());
+        REQUIRE(view.length() == path.length());
+    }
+
+    SECTION("testing slicing") {
+        auto slice = path.view(2, 5);
+        REQUIRE(slice.size() == 4);
+        REQUIRE(slice.first() == path[2]);
+        REQUIRE(slice.last() == path[5]);
+
+        auto tmp = path;
+        tmp.range(2, 5);
+        REQUIRE(tmp == slice);
+        REQUIRE(PointCloud<T>(slice) == tmp);
+
+        auto strided = path.view(1, 9, 2);
+        REQUIRE(strided.size() == 5);
+        REQUIRE(strided.get_stride() == 2);
+        REQUIRE(strided[4] == path[9]);
+        REQUIRE(strided.slice(1, 2).first() == path[3]);
+
+        unsigned int n(0);
+        for(const auto &p : strided) {
+            REQUIRE(p == path[1 + 2*n]);
+            ++n;
+        }
+        REQUIRE(n == 5);
+    }
+
+    SECTION("testing algorithms accepting views") {
+        REQUIRE(path.closest(path.view(8, 9)) == 8);
+        REQUIRE(path.furthest_apart(path.view(8, 9)) == 0);
+        REQUIRE(path.similar_to(view, MAX_DELTA));
+
+        PointCloud<T> cross = PointCloud<T>();
+        cross.push_back(0, 10);
+        cross.push_back(10, 0);
+        REQUIRE(cross.intersects_with(path.view(0, 9)));
+        REQUIRE(!cross.intersects_with(path.view(5, 9)));
+    }
+
+    SECTION("testing appending views") {
+        auto tmp = path;
+        tmp.push_back(tmp.view(0, 2));
+        REQUIRE(tmp.size() == 13);
+        REQUIRE(tmp.last() == path[2]);
+    }
+}
+
 TEST_CASE("testing LineSegment") {
     lib_2d::LineSegment<T> line = lib_2d::LineSegment<T>(Point<T>{0,0}, Point<T>{1,1});
 
@@ -825,4 +938,2342 @@ TEST_CASE("testing Kdtree") {
 
     auto find2 = tree2.nearest(search);
     REQUIRE(nearestInPath == topInv->get_tpoint(find2));
+
+    SECTION("comparing with brute force search") {
+        Point<T> center{3.0, -2.0};
+        T radius(4.0);
+
+        auto inCircle = tree2.in_circle(center, radius);
+        size_t nInCircle(0);
+        for(const auto &p : *inv)
+            if(p.distance_to(center) <= radius) ++nInCircle;
+        REQUIRE(inCircle.n_elements() == nInCircle);
+
+        auto inBox = tree2.in_box(center, 6.0, 3.0);
+        size_t nInBox(0);
+        for(const auto &p : *inv)
+            if(fabs(p.x - center.x) <= 3.0 && fabs(p.y - center.y) <= 1.5) ++nInBox;
+        REQUIRE(inBox.n_elements() == nInBox);
+
+        auto kNearest = tree2.k_nearest(center, 5);
+        REQUIRE(kNearest.n_elements() == 5);
+        REQUIRE(inv->get_point(kNearest[0][0]) == inv->get_point(inv->closest(center)));
+        for(size_t i = 1; i < kNearest.n_elements(); ++i)
+            REQUIRE(center.sqr_distance_to(inv->get_point(kNearest[i-1][0])) <= center.sqr_distance_to(inv->get_point(kNearest[i][0])));
+
+        std::vector<std::pair<T, size_t> > buffer;
+        tree2.k_nearest(center, 5, buffer);
+        REQUIRE(buffer.size() == 5);
+        for(size_t i = 0; i < buffer.size(); ++i)
+            REQUIRE(buffer[i].second == kNearest[i][0]);
+
+        tree2.k_nearest(center, 5, buffer, [&](size_t id) { return id != kNearest[0][0]; });
+        REQUIRE(buffer.size() == 5);
+        REQUIRE(buffer[0].second == kNearest[1][0]);
+    }
+}
+
+TEST_CASE("testing parallel convex hull") {
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<T> dist(-100.0, 100.0);
+    auto pc = std::make_shared<PointCloud<T>>(100000);
+    for(size_t i = 0; i < 100000; ++i)
+        pc->push_back(dist(gen), dist(gen));
+    pc->push_back(-200, -200); //duplicates and colinear points on the hull
+    pc->push_back(-200, -200);
+    pc->push_back(-200, 0);
+    pc->push_back(-200, 200);
+
+    auto expected = pc->convex_hull();
+
+    for(size_t nThreads : {1, 4}) {
+        auto hull = Factory2D<T>::convex_hull(pc, true, nThreads);
+        REQUIRE(hull->as_pointcloud() == expected);
+    }
+
+    auto open = Factory2D<T>::convex_hull(pc, false);
+    REQUIRE(open->n_elements() == expected.size() - 1);
+    REQUIRE(open->get_parent() == pc);
+
+    auto small = std::make_shared<PointCloud<T>>();
+    REQUIRE(Factory2D<T>::convex_hull(small)->n_elements() == 0);
+    small->push_back(1, 1);
+    small->push_back(1, 1);
+    REQUIRE(Factory2D<T>::convex_hull(small, false)->n_elements() == 1);
+}
+
+TEST_CASE("testing concave hull") {
+    //U shaped grid of points, the opening can only be found by a concave hull
+    auto pc = std::make_shared<PointCloud<T>>();
+    for(int x = 0; x <= 20; ++x) {
+        for(int y = 0; y <= 20; ++y) {
+            if(x > 5 && x < 15 && y > 5)
+                continue;
+            pc->push_back(x, y);
+        }
+    }
+
+    auto hull = Factory2D<T>::concave_hull(pc, 5);
+    auto convex = pc->convex_hull();
+
+    REQUIRE(hull->n_elements() > convex.size());
+    REQUIRE(hull->first() == hull->last());
+    REQUIRE(hull->first() == Point<T>({0, 0}));
+
+    auto path = hull->as_pointcloud();
+    REQUIRE(path.has_point(Point<T>{10, 5}));  //bottom of the opening
+    REQUIRE(path.has_point(Point<T>{20, 20}));
+    REQUIRE(path.has_point(Point<T>{0, 20}));
+
+    size_t nSelfIntersections(0);
+    for(size_t i = 0; i + 1 < path.size(); ++i) {
+        for(size_t j = i + 2; j + 1 < path.size(); ++j) {
+            if(i == 0 && j + 2 == path.size())
+                continue; //first and last edge share the start
+            if(segments_intersect(path[i], path[i+1], path[j], path[j+1]))
+                ++nSelfIntersections;
+        }
+    }
+    REQUIRE(nSelfIntersections == 0);
+
+    auto open = Factory2D<T>::concave_hull(pc, 5, -1, false);
+    REQUIRE(open->n_elements() == hull->n_elements() - 1);
+
+    //reaching maxIter ends the search with the shortened path instead of retrying every k
+    std::mt19937 gen(17);
+    std::uniform_real_distribution<T> dist(-100.0, 100.0);
+    auto large = std::make_shared<PointCloud<T>>();
+    for(size_t i = 0; i < 8000; ++i)
+        large->push_back(dist(gen), dist(gen));
+    auto limited = Factory2D<T>::concave_hull(large, 5, 10);
+    REQUIRE(limited->n_elements() == 9);
+    REQUIRE(limited->first() != limited->last());
+
+    //duplicates are ignored, collinear points result in the convex hull
+    auto unique = std::make_shared<PointCloud<T>>();
+    for(size_t i = 0; i < 1000; ++i)
+        unique->push_back(dist(gen), dist(gen));
+    auto duplicated = std::make_shared<PointCloud<T>>(*unique + *unique);
+    auto expected = Factory2D<T>::concave_hull(unique, 5);
+    auto deduplicated = Factory2D<T>::concave_hull(duplicated, 5);
+    REQUIRE(expected->n_elements() > Factory2D<T>::convex_hull(unique)->n_elements());
+    REQUIRE(deduplicated->first() == deduplicated->last());
+    REQUIRE(deduplicated->as_pointcloud() == expected->as_pointcloud());
+
+    auto line = std::make_shared<PointCloud<T>>();
+    for(size_t i = 0; i < 2000; ++i)
+        line->push_back(T(i % 1000), T(2 * (i % 1000)));
+    auto collinear = Factory2D<T>::concave_hull(line, 5);
+    REQUIRE(collinear->as_pointcloud() == Factory2D<T>::convex_hull(line)->as_pointcloud());
+}
+
+TEST_CASE("testing OnlineHull") {
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<T> dist(-50.0, 50.0);
+    auto pc = std::make_shared<PointCloud<T>>();
+    for(size_t i = 0; i < 100; ++i)
+        pc->push_back(dist(gen), dist(gen));
+
+    OnlineHull<T> online(pc);
+    REQUIRE(online.size() == 100);
+    REQUIRE(online.hull()->as_pointcloud() == pc->convex_hull());
+
+    SECTION("streaming inserts") {
+        for(size_t i = 0; i < 2000; ++i) {
+            online.insert(Point<T>{dist(gen) * (1 + T(i) / 500), dist(gen)});
+            if(i % 250 == 0)
+                REQUIRE(online.hull()->as_pointcloud() == pc->convex_hull());
+        }
+        REQUIRE(online.size() == pc->size());
+        REQUIRE(online.hull()->as_pointcloud() == pc->convex_hull());
+        REQUIRE(online.hull(false)->n_elements() == online.n_vertices());
+        REQUIRE_FALSE(online.insert(Point<T>{0, 0}));
+        REQUIRE(online.is_inside(Point<T>{0, 0}));
+        REQUIRE_FALSE(online.is_inside(Point<T>{1000, 0}));
+    }
+
+    SECTION("duplicates and colinear points") {
+        REQUIRE(online.insert(Point<T>{-100, -100}));
+        REQUIRE(online.insert(Point<T>{100, -100}));
+        REQUIRE_FALSE(online.insert(Point<T>{0, -100}));
+        REQUIRE_FALSE(online.insert(Point<T>{100, -100}));
+        REQUIRE(online.hull()->as_pointcloud() == pc->convex_hull());
+        REQUIRE(online.is_inside(Point<T>{0, -100}));
+        REQUIRE_FALSE(online.is_inside(Point<T>{0, -101}));
+    }
+
+    SECTION("removal") {
+        std::vector<bool> removed(pc->size(), false);
+        for(size_t round = 0; round < 50; ++round) {
+            auto hull = online.hull(false);
+            size_t id = hull->get_id(round % hull->n_elements());
+            REQUIRE(online.remove(id));
+            REQUIRE_FALSE(online.remove(id));
+            removed[id] = true;
+
+            PointCloud<T> remaining;
+            for(size_t i = 0; i < pc->size(); ++i) {
+                if(!removed[i])
+                    remaining.push_back((*pc)[i]);
+            }
+            REQUIRE(online.hull()->as_pointcloud() == remaining.convex_hull());
+        }
+        REQUIRE(online.size() == 50);
+
+        auto hull = online.hull(false);
+        std::vector<bool> onHull(pc->size(), false);
+        for(size_t i = 0; i < hull->n_elements(); ++i)
+            onHull[hull->get_id(i)] = true;
+        size_t interior = 0;
+        while(removed[interior] || onHull[interior])
+            ++interior;
+        REQUIRE_FALSE(online.remove(interior));
+        REQUIRE(online.size() == 49);
+    }
+
+    SECTION("degenerated") {
+        auto empty = std::make_shared<PointCloud<T>>();
+        OnlineHull<T> small(empty);
+        REQUIRE(small.hull()->n_elements() == 0);
+        REQUIRE_FALSE(small.is_inside(Point<T>{0, 0}));
+        small.insert(Point<T>{1, 1});
+        REQUIRE(small.n_vertices() == 1);
+        small.insert(Point<T>{1, 3});
+        REQUIRE(small.n_vertices() == 2);
+        REQUIRE(small.is_inside(Point<T>{1, 2}));
+        REQUIRE_THROWS(small.insert(size_t(5)));
+    }
+}
+
+TEST_CASE("testing RotatingCalipers") {
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<T> dist(-10.0, 10.0);
+    PointCloud<T> cloud, other;
+    for(size_t i = 0; i < 500; ++i) {
+        cloud.push_back(dist(gen) * 2, dist(gen));
+        other.push_back(dist(gen) + 40, dist(gen) * 3 + 5);
+    }
+    auto hull = cloud.convex_hull();
+    auto otherHull = other.convex_hull(false);
+    const T eps = 1e-3;
+
+    SECTION("diameter") {
+        T expected(0);
+        for(const auto &p : hull)
+            for(const auto &q : hull)
+                expected = std::max(expected, p.distance_to(q));
+        auto d = RotatingCalipers<T>::diameter(hull);
+        REQUIRE(std::fabs(d.length() - expected) < eps);
+        REQUIRE(cloud.has_point(d.first()));
+        REQUIRE(cloud.has_point(d.last()));
+    }
+
+    SECTION("width") {
+        T expected(-1);
+        for(size_t i = 0; i + 1 < hull.size(); ++i) {
+            T w(0);
+            for(const auto &p : hull)
+                w = std::max(w, std::fabs(cross(vect(hull[i], hull[i+1]), vect(hull[i], p))) / hull[i].distance_to(hull[i+1]));
+            if(expected < 0 || w < expected)
+                expected = w;
+        }
+        REQUIRE(std::fabs(RotatingCalipers<T>::width(hull) - expected) < eps);
+        REQUIRE(std::fabs(RotatingCalipers<T>::width(Rectangle<T>(4, 2)) - 2) < eps);
+    }
+
+    SECTION("enclosing rectangles") {
+        T expectedArea(-1), expectedPerimeter(-1);
+        for(size_t i = 0; i + 1 < hull.size(); ++i) {
+            Point<T> u = vect(hull[i], hull[i+1]);
+            T len = std::sqrt(dot(u, u));
+            u = Point<T>{u.x / len, u.y / len};
+            Point<T> normal{-u.y, u.x};
+            T minU(0), maxU(0), maxN(0);
+            for(const auto &p : hull) {
+                minU = std::min(minU, dot(u, vect(hull[i], p)));
+                maxU = std::max(maxU, dot(u, vect(hull[i], p)));
+                maxN = std::max(maxN, dot(normal, vect(hull[i], p)));
+            }
+            T area = (maxU - minU) * maxN, perimeter = 2 * (maxU - minU + maxN);
+            if(expectedArea < 0 || area < expectedArea) expectedArea = area;
+            if(expectedPerimeter < 0 || perimeter < expectedPerimeter) expectedPerimeter = perimeter;
+        }
+
+        auto rect = RotatingCalipers<T>::min_area_rectangle(hull);
+        REQUIRE(rect.size() == 5);
+        REQUIRE(std::fabs(rect.get_width() * rect.get_height() - expectedArea) < eps * expectedArea);
+        for(const auto &p : cloud) {
+            for(size_t i = 0; i + 1 < rect.size(); ++i)
+                REQUIRE(cross(vect(rect[i], rect[i+1]), vect(rect[i], p)) > -eps * rect.get_width() * rect.get_height());
+        }
+
+        auto perimeterRect = RotatingCalipers<T>::min_perimeter_rectangle(hull, false);
+        REQUIRE(perimeterRect.size() == 4);
+        REQUIRE(std::fabs(2 * (perimeterRect.get_width() + perimeterRect.get_height()) - expectedPerimeter) < eps * expectedPerimeter);
+
+        auto rotated = Rectangle<T>(6, 2, true, Point<T>({3, 4}), 0.5);
+        auto fitted = RotatingCalipers<T>::min_area_rectangle(rotated);
+        REQUIRE(std::fabs(fitted.get_width() * fitted.get_height() - 12) < eps);
+    }
+
+    SECTION("max distance of two hulls") {
+        T expected(0);
+        for(const auto &p : hull)
+            for(const auto &q : otherHull)
+                expected = std::max(expected, p.distance_to(q));
+        auto d = RotatingCalipers<T>::max_distance(hull, otherHull);
+        REQUIRE(std::fabs(d.length() - expected) < eps);
+        REQUIRE(hull.has_point(d.first()));
+        REQUIRE(otherHull.has_point(d.last()));
+        REQUIRE(std::fabs(RotatingCalipers<T>::max_distance(hull, hull).length() - RotatingCalipers<T>::diameter(hull).length()) < eps);
+    }
+
+    SECTION("degenerated hulls") {
+        PointCloud<T> single, segment;
+        single.push_back(1, 2);
+        segment.push_back(0, 0);
+        segment.push_back(3, 4);
+        REQUIRE(RotatingCalipers<T>::diameter(single).length() == 0);
+        REQUIRE(std::fabs(RotatingCalipers<T>::diameter(segment).length() - 5) < eps);
+        REQUIRE(RotatingCalipers<T>::width(segment) == 0);
+        REQUIRE(std::fabs(RotatingCalipers<T>::min_area_rectangle(segment).get_width() - 5) < eps);
+        REQUIRE(std::fabs(RotatingCalipers<T>::max_distance(single, segment).length() - single[0].distance_to(segment[1])) < eps);
+        REQUIRE_THROWS(RotatingCalipers<T>::diameter(PointCloud<T>()));
+    }
+}
+
+TEST_CASE("testing EnclosingCircle") {
+    std::mt19937 gen(11);
+    std::normal_distribution<T> dist(0.0, 10.0);
+    PointCloud<T> cloud;
+    for(size_t i = 0; i < 2000; ++i)
+        cloud.push_back(dist(gen) + 5, dist(gen) * 0.5 - 3);
+    const T eps = 1e-3;
+
+    EnclosingCircle<T> circle(cloud);
+    for(const auto &p : cloud)
+        REQUIRE(circle.center().distance_to(p) <= circle.get_radius() * (1 + eps));
+
+    //brute force over all circles defined by two or three points of the hull
+    auto hull = cloud.convex_hull(false);
+    T expected(-1);
+    auto consider = [&](const EnclosingCircle<T> &candidate) {
+        for(const auto &p : hull) {
+            if(candidate.center().distance_to(p) > candidate.get_radius() * (1 + eps))
+                return;
+        }
+        if(expected < 0 || candidate.get_radius() < expected)
+            expected = candidate.get_radius();
+    };
+    for(size_t i = 0; i < hull.size(); ++i) {
+        for(size_t j = i + 1; j < hull.size(); ++j) {
+            consider(EnclosingCircle<T>(LineSegment<T>(hull[i], hull[j])));
+            for(size_t k = j + 1; k < hull.size(); ++k) {
+                PointCloud<T> triangle;
+                triangle.push_back(hull[i]);
+                triangle.push_back(hull[j]);
+                triangle.push_back(hull[k]);
+                consider(EnclosingCircle<T>(triangle));
+            }
+        }
+    }
+    REQUIRE(std::fabs(circle.get_radius() - expected) < eps * expected);
+
+    EnclosingCircle<T> filtered(cloud, true);
+    REQUIRE(std::fabs(filtered.get_radius() - circle.get_radius()) < eps * expected);
+    REQUIRE(filtered.center().distance_to(circle.center()) < eps * expected);
+
+    SECTION("to_arc") {
+        auto arc = circle.to_arc(100);
+        REQUIRE(arc.size() == 100);
+        REQUIRE(std::fabs(arc.get_diameter() - circle.get_diameter()) < eps);
+        REQUIRE(arc.center().distance_to(circle.center()) < eps);
+    }
+
+    SECTION("streaming") {
+        EnclosingCircle<T> streamed;
+        REQUIRE(streamed.empty());
+        REQUIRE_FALSE(streamed.contains(Point<T>({0, 0})));
+        for(size_t i = 0; i < cloud.size(); i += 100)
+            streamed.extend(cloud.view(i, std::min(i + 99, cloud.size() - 1)));
+        for(const auto &p : cloud)
+            REQUIRE(streamed.contains(p));
+        REQUIRE(streamed.get_radius() >= circle.get_radius() * (1 - eps));
+        REQUIRE(streamed.get_radius() <= circle.get_radius() * 1.5);
+    }
+
+    SECTION("degenerated") {
+        PointCloud<T> single, colinear;
+        single.push_back(1, 2);
+        for(int i = 0; i < 10; ++i)
+            colinear.push_back(i, 2 * i);
+        REQUIRE(EnclosingCircle<T>(single).get_radius() == 0);
+        REQUIRE(EnclosingCircle<T>(single).center() == single[0]);
+        REQUIRE(std::fabs(EnclosingCircle<T>(colinear).get_diameter() - colinear[0].distance_to(colinear[9])) < eps);
+        REQUIRE(EnclosingCircle<T>(PointCloud<T>()).empty());
+    }
+}
+
+TEST_CASE("testing closest pair") {
+    std::mt19937 gen(5);
+    std::uniform_real_distribution<T> dist(-1000.0, 1000.0);
+
+    SECTION("within one cloud") {
+        auto pc = std::make_shared<PointCloud<T>>();
+        for(size_t i = 0; i < 70000; ++i)
+            pc->push_back(dist(gen), dist(gen));
+
+        KdTree<T> tree(std::make_shared<OrderedPointCloud<T>>(pc));
+        T expected = std::numeric_limits<T>::max();
+        for(size_t i = 0; i < pc->size(); ++i) {
+            auto nearest = tree.k_nearest((*pc)[i], 2);
+            expected = std::min(expected, (*pc)[i].sqr_distance_to((*pc)[nearest[1][0]]));
+        }
+
+        for(size_t nThreads : {1, 4}) {
+            auto ids = Factory2D<T>::closest_pair(*pc, nThreads);
+            REQUIRE(ids[0] < ids[1]);
+            REQUIRE((*pc)[ids[0]].sqr_distance_to((*pc)[ids[1]]) == expected);
+        }
+
+        //the closest pair crossing the border of two slabs
+        pc->push_back(0.0, 0.0);
+        pc->push_back(0.0, 0.0);
+        auto ids = Factory2D<T>::closest_pair(*pc, 4);
+        REQUIRE(ids[0] == pc->size() - 2);
+        REQUIRE(ids[1] == pc->size() - 1);
+    }
+
+    SECTION("small clouds") {
+        PointCloud<T> pc;
+        pc.push_back(0, 0);
+        REQUIRE_THROWS(Factory2D<T>::closest_pair(pc));
+        pc.push_back(5, 5);
+        pc.push_back(1, 0);
+        pc.push_back(3, 3);
+        auto ids = Factory2D<T>::closest_pair(pc);
+        REQUIRE(ids[0] == 0);
+        REQUIRE(ids[1] == 2);
+    }
+
+    SECTION("between two clouds") {
+        auto a = std::make_shared<PointCloud<T>>();
+        auto b = std::make_shared<PointCloud<T>>();
+        for(size_t i = 0; i < 3000; ++i)
+            a->push_back(dist(gen), dist(gen));
+        for(size_t i = 0; i < 300; ++i)
+            b->push_back(dist(gen) + 1900, dist(gen));
+
+        T expected = std::numeric_limits<T>::max();
+        for(const auto &p : *a)
+            for(const auto &q : *b)
+                expected = std::min(expected, p.sqr_distance_to(q));
+
+        for(size_t nThreads : {1, 4}) {
+            auto ids = Factory2D<T>::closest_pair(a, b, nThreads);
+            REQUIRE((*a)[ids[0]].sqr_distance_to((*b)[ids[1]]) == expected);
+            auto swapped = Factory2D<T>::closest_pair(b, a, nThreads);
+            REQUIRE((*b)[swapped[0]].sqr_distance_to((*a)[swapped[1]]) == expected);
+        }
+
+        KdTree<T> tree(std::make_shared<OrderedPointCloud<T>>(b));
+        auto ids = Factory2D<T>::closest_pair(*a, tree);
+        REQUIRE((*a)[ids[0]].sqr_distance_to((*b)[ids[1]]) == expected);
+        REQUIRE_THROWS(Factory2D<T>::closest_pair(PointCloud<T>(), tree));
+    }
+}
+
+TEST_CASE("testing PathDistance") {
+    std::mt19937 gen(17);
+    std::normal_distribution<T> noise(0.0, 0.3);
+    auto a = std::make_shared<PointCloud<T>>();
+    auto b = std::make_shared<PointCloud<T>>();
+    for(size_t i = 0; i < 400; ++i) {
+        T t = T(i) / 20;
+        a->push_back(t, std::sin(t) + noise(gen));
+        b->push_back(t + noise(gen), std::sin(t) + 0.5 + noise(gen));
+    }
+    const T eps = 1e-3;
+
+    SECTION("hausdorff") {
+        T expectedAB(0), expectedBA(0);
+        for(const auto &p : *a)
+            expectedAB = std::max(expectedAB, (*b)[b->closest(p)].distance_to(p));
+        for(const auto &p : *b)
+            expectedBA = std::max(expectedBA, (*a)[a->closest(p)].distance_to(p));
+
+        KdTree<T>
+            treeA(std::make_shared<OrderedPointCloud<T>>(a)),
+            treeB(std::make_shared<OrderedPointCloud<T>>(b));
+        REQUIRE(std::fabs(PathDistance<T>::directed_hausdorff(*a, treeB) - expectedAB) < eps);
+        REQUIRE(std::fabs(PathDistance<T>::directed_hausdorff(*b, treeA) - expectedBA) < eps);
+        REQUIRE(std::fabs(PathDistance<T>::hausdorff(treeA, treeB) - std::max(expectedAB, expectedBA)) < eps);
+        REQUIRE(std::fabs(PathDistance<T>::hausdorff(a, b) - std::max(expectedAB, expectedBA)) < eps);
+
+        //early exit only guarantees a value above the bound
+        T bound = std::max(expectedAB, expectedBA) / 2;
+        REQUIRE(PathDistance<T>::hausdorff(treeA, treeB, bound) > bound);
+        REQUIRE(PathDistance<T>::hausdorff(treeA, treeA) == 0);
+
+        REQUIRE(treeA.any_within((*a)[5], 0));
+        REQUIRE_FALSE(treeA.any_within(Point<T>({1000, 1000}), 10));
+    }
+
+    SECTION("discrete frechet") {
+        //plain dynamic programming over the full table
+        const size_t n = a->size(), m = b->size();
+        std::vector<std::vector<T>> table(n, std::vector<T>(m));
+        for(size_t i = 0; i < n; ++i) {
+            for(size_t j = 0; j < m; ++j) {
+                T d = (*a)[i].distance_to((*b)[j]);
+                if(i == 0 && j == 0) table[i][j] = d;
+                else if(i == 0) table[i][j] = std::max(table[i][j-1], d);
+                else if(j == 0) table[i][j] = std::max(table[i-1][j], d);
+                else table[i][j] = std::max(std::min(std::min(table[i-1][j], table[i-1][j-1]), table[i][j-1]), d);
+            }
+        }
+        T expected = table[n-1][m-1];
+        REQUIRE(std::fabs(PathDistance<T>::discrete_frechet(*a, *b) - expected) < eps);
+        REQUIRE(PathDistance<T>::discrete_frechet(*a, *b, expected / 2) > expected / 2);
+        REQUIRE(PathDistance<T>::discrete_frechet(*a, *a) == 0);
+    }
+
+    SECTION("continuous frechet") {
+        PointCloud<T> line, bump;
+        line.push_back(0, 0);
+        line.push_back(10, 0);
+        bump.push_back(0, 1);
+        bump.push_back(5, 3);
+        bump.push_back(10, 1);
+        REQUIRE(std::fabs(PathDistance<T>::discrete_frechet(line, bump) - std::sqrt(T(34))) < eps);
+        REQUIRE(std::fabs(PathDistance<T>::frechet(line, bump) - 3) < eps);
+        REQUIRE(PathDistance<T>::frechet_within(line, bump, 3.01));
+        REQUIRE_FALSE(PathDistance<T>::frechet_within(line, bump, 2.99));
+
+        //going back and forth along the line requires a larger distance than visiting the same points in order
+        PointCloud<T> backwards;
+        backwards.push_back(0, 0);
+        backwards.push_back(8, 0);
+        backwards.push_back(2, 0);
+        backwards.push_back(10, 0);
+        REQUIRE(std::fabs(PathDistance<T>::frechet(line, backwards) - 3) < eps);
+        REQUIRE(PathDistance<T>::hausdorff(std::make_shared<PointCloud<T>>(line), std::make_shared<PointCloud<T>>(backwards)) < 8.01);
+
+        T discrete = PathDistance<T>::discrete_frechet(*a, *b);
+        T continuous = PathDistance<T>::frechet(*a, *b);
+        REQUIRE(continuous <= discrete + eps);
+        REQUIRE(PathDistance<T>::frechet_within(*a, *b, continuous * (1 + eps)));
+        REQUIRE_FALSE(PathDistance<T>::frechet_within(*a, *b, continuous * (1 - eps)));
+        REQUIRE(PathDistance<T>::frechet(*a, *b, 1e-6, continuous / 2) > continuous / 2);
+
+        PointCloud<T> single;
+        single.push_back(5, 0);
+        REQUIRE(std::fabs(PathDistance<T>::frechet(single, line) - 5) < eps);
+        REQUIRE_THROWS(PathDistance<T>::frechet(PointCloud<T>(), line));
+    }
+}
+
+TEST_CASE("testing PreparedPolygon") {
+    //comb with horizontal and vertical edges, vertices on a grid so queries hit vertices and edges exactly
+    PointCloud<T> comb;
+    comb.push_back(0, 0);
+    comb.push_back(10, 0);
+    comb.push_back(10, 8);
+    for(int x = 9; x >= 1; x -= 2) {
+        comb.push_back(x, 8);
+        comb.push_back(x, 3);
+        comb.push_back(x - 1, 3);
+        comb.push_back(x - 1, 8);
+    }
+    comb.push_back(0, 8);
+
+    PointCloud<T> hole; //clockwise
+    hole.push_back(2, 1);
+    hole.push_back(2, 2);
+    hole.push_back(7, 2);
+    hole.push_back(7, 1);
+
+    auto check = [](const PreparedPolygon<T> &prepared, const std::vector<PointCloudView<T>> &rings, const Point<T> &p) {
+        int winding(0);
+        bool border(false);
+        for(const auto &ring : rings) {
+            winding += ring.winding_number(p);
+            border = border || ring.point_is_on_border(p);
+        }
+        auto expected = border ? PreparedPolygon<T>::ON_BORDER : (winding != 0 ? PreparedPolygon<T>::INSIDE : PreparedPolygon<T>::OUTSIDE);
+        REQUIRE(prepared.locate(p) == expected);
+        REQUIRE(prepared.winding_number(p) == (border ? prepared.winding_number(p) : winding));
+    };
+
+    SECTION("single ring") {
+        PreparedPolygon<T> prepared(comb);
+        REQUIRE(prepared.n_slabs() == 2);
+        for(int x = -2; x <= 12; ++x) {
+            for(int y = -2; y <= 10; ++y) {
+                check(prepared, {comb.view()}, Point<T>({T(x), T(y)}));
+                check(prepared, {comb.view()}, Point<T>({x + T(0.5), y + T(0.5)}));
+            }
+        }
+        REQUIRE(prepared.locate(Point<T>({1.5, 5})) == PreparedPolygon<T>::INSIDE);
+        REQUIRE(prepared.locate(Point<T>({0.5, 5})) == PreparedPolygon<T>::OUTSIDE);
+        REQUIRE(prepared.locate(Point<T>({1, 5})) == PreparedPolygon<T>::ON_BORDER);
+        REQUIRE(prepared.locate(Point<T>({5, 0})) == PreparedPolygon<T>::ON_BORDER);
+        REQUIRE(prepared.contains(Point<T>({10, 8})));
+    }
+
+    SECTION("with hole") {
+        std::vector<PointCloudView<T>> rings = {comb.view(), hole.view()};
+        PreparedPolygon<T> prepared(rings);
+        for(int x = -2; x <= 12; ++x) {
+            for(int y = -2; y <= 10; ++y) {
+                check(prepared, rings, Point<T>({T(x), T(y)}));
+                check(prepared, rings, Point<T>({x + T(0.5), y + T(0.5)}));
+            }
+        }
+        REQUIRE(prepared.locate(Point<T>({4.5, 1.5})) == PreparedPolygon<T>::OUTSIDE);
+    }
+
+    SECTION("batch queries") {
+        std::mt19937 gen(23);
+        std::uniform_real_distribution<T> dist(-20.0, 20.0);
+        Arc<T> circle(30, 200, true);
+        PreparedPolygon<T> prepared(circle);
+        PointCloud<T> queries;
+        for(size_t i = 0; i < 100000; ++i)
+            queries.push_back(dist(gen), dist(gen));
+
+        for(size_t nThreads : {1, 4}) {
+            std::vector<PreparedPolygon<T>::Location> locations;
+            prepared.locate(queries, locations, nThreads);
+            REQUIRE(locations.size() == queries.size());
+            auto inside = prepared.inside(queries, true, nThreads);
+            size_t nInside(0);
+            for(size_t i = 0; i < queries.size(); ++i) {
+                const bool expected = circle.point_is_inside(queries[i]);
+                REQUIRE((locations[i] != PreparedPolygon<T>::OUTSIDE) == expected);
+                if(expected) {
+                    REQUIRE(inside[nInside][0] == i);
+                    ++nInside;
+                }
+            }
+            REQUIRE(inside.n_elements() == nInside);
+        }
+    }
+
+    SECTION("empty") {
+        PreparedPolygon<T> prepared((PointCloud<T>()));
+        REQUIRE(prepared.locate(Point<T>({0, 0})) == PreparedPolygon<T>::OUTSIDE);
+        REQUIRE(prepared.winding_number(Point<T>({0, 0})) == 0);
+    }
+}
+
+TEST_CASE("testing PolygonClipping") {
+    using Clip = PolygonClipping<T>;
+    auto square = [](T minX, T minY, T size) {
+        return Rectangle<T>(size, size, true, Point<T>({minX + size / 2, minY + size / 2}));
+    };
+
+    SECTION("convex clipping") {
+        Rectangle<T> subject = square(0, 0, 4);
+        PointCloud<T> clipped = Clip::clip_box(subject, 2, 1, 10, 3);
+        REQUIRE(clipped.size() == 5);
+        REQUIRE(clipped.first() == clipped.last());
+        REQUIRE(Clip::area({clipped}) == Approx(4));
+
+        //the window may be given in either orientation
+        Rectangle<T> window = square(2, 1, 8);
+        PointCloud<T> reversed(window.begin(), window.end());
+        std::reverse(reversed.begin(), reversed.end());
+        REQUIRE(Clip::area({Clip::clip_convex(subject, window)}) == Approx(6));
+        REQUIRE(Clip::area({Clip::clip_convex(subject, reversed, false)}) == Approx(6));
+
+        //a triangle window and a subject completely outside of it
+        PointCloud<T> triangle;
+        triangle.push_back(0, 0);
+        triangle.push_back(4, 0);
+        triangle.push_back(0, 4);
+        REQUIRE(Clip::area({Clip::clip_convex(subject, triangle)}) == Approx(8));
+        REQUIRE(Clip::clip_box(subject, 10, 10, 20, 20).empty());
+
+        //batch results equal the single ones
+        std::vector<Rectangle<T>> subjects;
+        for(size_t i = 0; i < 1000; ++i)
+            subjects.push_back(square(T(i % 40) / 4 - 2, T(i / 40) / 4 - 2, 1.5));
+        std::vector<PointCloudView<T>> views;
+        for(const auto &s : subjects)
+            views.push_back(s.view());
+        for(size_t nThreads : {1, 4}) {
+            auto results = Clip::clip_convex(views, window, true, nThreads);
+            REQUIRE(results.size() == subjects.size());
+            for(size_t i = 0; i < subjects.size(); ++i)
+                REQUIRE(results[i].view() == Clip::clip_convex(subjects[i], window).view());
+        }
+    }
+
+    SECTION("boolean operations of squares") {
+        Rectangle<T>
+            a = square(0, 0, 2),
+            b = square(1, 1, 2);
+
+        auto unite = Clip::unite(a, b);
+        REQUIRE(unite.size() == 1);
+        REQUIRE(unite[0].size() == 9);
+        REQUIRE(Clip::area(unite) == Approx(7));
+
+        auto intersection = Clip::intersect(a, b);
+        REQUIRE(intersection.size() == 1);
+        REQUIRE(intersection[0].size() == 5);
+        REQUIRE(Clip::area(intersection) == Approx(1));
+
+        REQUIRE(Clip::area(Clip::subtract(a, b)) == Approx(3));
+        REQUIRE(Clip::area(Clip::subtract(b, a)) == Approx(3));
+
+        auto exclusive = Clip::exclusive_or(a, b);
+        REQUIRE(exclusive.size() == 2);
+        REQUIRE(Clip::area(exclusive) == Approx(6));
+
+        //disjoint
+        Rectangle<T> far = square(5, 5, 1);
+        REQUIRE(Clip::unite(a, far).size() == 2);
+        REQUIRE(Clip::intersect(a, far).empty());
+        REQUIRE(Clip::area(Clip::subtract(a, far)) == Approx(4));
+
+        //contained, the difference is a ring with a hole
+        Rectangle<T> inner = square(0.5, 0.5, 1);
+        REQUIRE(Clip::area(Clip::unite(a, inner)) == Approx(4));
+        REQUIRE(Clip::area(Clip::intersect(a, inner)) == Approx(1));
+        auto holed = Clip::subtract(a, inner);
+        REQUIRE(holed.size() == 2);
+        REQUIRE(Clip::area(holed) == Approx(3));
+        REQUIRE(Clip::subtract(inner, a).empty());
+    }
+
+    SECTION("shared edges") {
+        Rectangle<T>
+            a = square(0, 0, 1),
+            b = square(1, 0, 1),
+            c = square(0, 0, 1);
+
+        auto unite = Clip::unite(a, b);
+        REQUIRE(unite.size() == 1);
+        REQUIRE(unite[0].size() == 5); //collinear points are removed
+        REQUIRE(Clip::area(unite) == Approx(2));
+        REQUIRE(Clip::intersect(a, b).empty());
+        REQUIRE(Clip::area(Clip::subtract(a, b)) == Approx(1));
+
+        REQUIRE(Clip::area(Clip::unite(a, c)) == Approx(1));
+        REQUIRE(Clip::area(Clip::intersect(a, c)) == Approx(1));
+        REQUIRE(Clip::subtract(a, c).empty());
+        REQUIRE(Clip::exclusive_or(a, c).empty());
+
+        //touching at a corner only
+        Rectangle<T> d = square(1, 1, 1);
+        auto corner = Clip::unite(a, d);
+        REQUIRE(corner.size() == 2);
+        REQUIRE(Clip::area(corner) == Approx(2));
+    }
+
+    SECTION("polygons with holes") {
+        //a frame, both rings given counter clockwise, the hole is reoriented
+        std::vector<PointCloudView<T>> frame;
+        Rectangle<T>
+            outer = square(0, 0, 4),
+            hole = square(1, 1, 2);
+        frame.push_back(outer);
+        frame.push_back(hole);
+
+        Rectangle<T> bar = square(-1, 1.5, 6);
+        PointCloud<T> barCut = Clip::clip_box(bar, -1, 1.5, 5, 2.5);
+        std::vector<PointCloudView<T>> bars(1, barCut);
+
+        REQUIRE(Clip::area(Clip::compute(frame, frame, Clip::UNION)) == Approx(12));
+        REQUIRE(Clip::area(Clip::compute(frame, bars, Clip::INTERSECTION)) == Approx(2));
+        REQUIRE(Clip::area(Clip::compute(frame, bars, Clip::UNION)) == Approx(16));
+        REQUIRE(Clip::area(Clip::compute(frame, bars, Clip::DIFFERENCE)) == Approx(10));
+        REQUIRE(Clip::area(Clip::compute(bars, frame, Clip::DIFFERENCE)) == Approx(4));
+        REQUIRE(Clip::area(Clip::compute(frame, bars, Clip::XOR)) == Approx(14));
+
+        //the hole is filled completely
+        std::vector<PointCloudView<T>> filling(1, hole);
+        auto filled = Clip::compute(frame, filling, Clip::UNION);
+        REQUIRE(filled.size() == 1);
+        REQUIRE(Clip::area(filled) == Approx(16));
+    }
+
+    SECTION("compare with convex clipping") {
+        Arc<T> circle(10, 64, true);
+        Rectangle<T> window = square(-2, -7, 6);
+        const T expected = Clip::area({Clip::clip_convex(circle, window)});
+        REQUIRE(Clip::area(Clip::intersect(circle, window)) == Approx(expected));
+        const T united = Clip::area(Clip::unite(circle, window));
+        REQUIRE(united == Approx(Clip::area({PointCloud<T>(circle)}) + 36 - expected));
+
+        //many edges, the candidate pairs are found with RTrees
+        Arc<T>
+            large(10, 2000, true),
+            shifted(10, 2000, true, 0, LIB_2D_2PI, Point<T>({3, 1}));
+        const T areaLarge = Clip::area({PointCloud<T>(large)});
+        const T common = Clip::area(Clip::intersect(large, shifted));
+        REQUIRE(common > 0);
+        REQUIRE(Clip::area(Clip::unite(large, shifted)) == Approx(2 * areaLarge - common));
+        REQUIRE(Clip::area(Clip::subtract(large, shifted)) == Approx(areaLarge - common));
+
+        std::vector<PointCloudView<T>> subjects(100, circle);
+        auto each = Clip::compute_each(subjects, {window}, Clip::INTERSECTION, true, 4);
+        REQUIRE(each.size() == 100);
+        REQUIRE(Clip::area(each[99]) == Approx(expected));
+    }
+}
+
+TEST_CASE("testing Delaunay") {
+    auto canonical = [](const Topology<3> &triangles) {
+        std::vector<std::array<size_t, 3>> res;
+        for(size_t i = 0; i < triangles.n_elements(); ++i) {
+            std::array<size_t, 3> e = triangles[i];
+            std::rotate(e.begin(), std::min_element(e.begin(), e.end()), e.end());
+            res.push_back(e);
+        }
+        std::sort(res.begin(), res.end());
+        return res;
+    };
+
+    SECTION("degenerate inputs") {
+        REQUIRE(Delaunay<T>(PointCloud<T>()).n_triangles() == 0);
+        PointCloud<T> line;
+        for(size_t i = 0; i < 100; ++i)
+            line.push_back(i, 2 * i);
+        REQUIRE(Delaunay<T>(line).n_triangles() == 0);
+        REQUIRE(Delaunay<T>(line).triangles().empty());
+
+        Rectangle<T> square(2, 2, false);
+        Delaunay<T> two(square);
+        REQUIRE(two.n_triangles() == 2);
+        REQUIRE(two.triangles().n_elements() == 2);
+
+        //cocircular points and duplicates
+        Arc<T> circle(10, 100, false);
+        REQUIRE(Delaunay<T>(circle).n_triangles() == 98);
+        PointCloud<T> grid;
+        for(size_t k = 0; k < 3; ++k) {
+            for(size_t i = 0; i < 10; ++i) {
+                for(size_t j = 0; j < 10; ++j)
+                    grid.push_back(i, j);
+            }
+        }
+        Delaunay<T> triangulated(grid);
+        REQUIRE(triangulated.n_triangles() == 2 * 9 * 9);
+        REQUIRE(triangulated.n_duplicates() == 200);
+        const Topology<2> duplicates = triangulated.duplicates();
+        REQUIRE(duplicates.n_elements() == 200);
+        for(size_t i = 0; i < duplicates.n_elements(); ++i) {
+            REQUIRE(grid[duplicates[i][0]] == grid[duplicates[i][1]]);
+            REQUIRE(duplicates[i][1] < 100); //the first of equal points is kept
+        }
+        auto triangles = triangulated.triangles();
+        T area(0);
+        for(size_t i = 0; i < triangles.n_elements(); ++i) {
+            const Point<T> &a = grid[triangles[i][0]], &b = grid[triangles[i][1]], &c = grid[triangles[i][2]];
+            area += ((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x)) / 2;
+        }
+        REQUIRE(area == Approx(81));
+    }
+
+    SECTION("duplicates of inexact coordinates") {
+        //0.1 isn't representable, so many of these points are nearly (but not exactly) cocircular
+        std::mt19937 gen(675);
+        std::uniform_int_distribution<int> cell(0, 19);
+        PointCloud<T> points;
+        for(size_t i = 0; i < 290; ++i)
+            points.push_back(T(cell(gen)) * T(0.1), T(cell(gen)) * T(0.1));
+        std::vector<bool> distinct(points.size(), true);
+        size_t nDistinct(0);
+        for(size_t i = 0; i < points.size(); ++i) {
+            for(size_t j = 0; j < i && distinct[i]; ++j)
+                distinct[i] = points[i] != points[j];
+            if(distinct[i])
+                ++nDistinct;
+        }
+
+        Delaunay<T> triangulated(points);
+        REQUIRE(triangulated.n_duplicates() == points.size() - nDistinct);
+        const Topology<2> &duplicates = triangulated.duplicates();
+        REQUIRE(duplicates.n_elements() == points.size() - nDistinct);
+        for(size_t i = 0; i < duplicates.n_elements(); ++i) {
+            REQUIRE_FALSE(distinct[duplicates[i][0]]);
+            REQUIRE(distinct[duplicates[i][1]]);
+            REQUIRE(points[duplicates[i][0]] == points[duplicates[i][1]]);
+        }
+
+        auto triangles = triangulated.triangles();
+        std::vector<bool> used(points.size(), false);
+        T area(0);
+        for(size_t i = 0; i < triangles.n_elements(); ++i) {
+            for(size_t k = 0; k < 3; ++k)
+                used[triangles[i][k]] = true;
+            const Point<T> &a = points[triangles[i][0]], &b = points[triangles[i][1]], &c = points[triangles[i][2]];
+            const T doubleArea = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+            REQUIRE(doubleArea > 0);
+            area += doubleArea / 2;
+        }
+        REQUIRE(std::count(used.begin(), used.end(), true) == static_cast<std::ptrdiff_t>(nDistinct));
+        REQUIRE(area == Approx(PolygonClipping<T>::area({points.convex_hull(false)})));
+        REQUIRE(MinimumSpanningTree<T>(points).edges().n_elements() == points.size() - 1);
+        REQUIRE(Voronoi<T>(points).cell(duplicates[0][0]).n_elements() == Voronoi<T>(points).cell(duplicates[0][1]).n_elements());
+    }
+
+    SECTION("empty circumcircles") {
+        std::mt19937 gen(7);
+        std::uniform_real_distribution<T> dist(-50.0, 50.0);
+        PointCloud<T> points;
+        for(size_t i = 0; i < 300; ++i)
+            points.push_back(dist(gen), dist(gen));
+
+        Delaunay<T> triangulated(points);
+        auto triangles = triangulated.triangles();
+        PointCloud<T> hull = points.convex_hull(false);
+        REQUIRE(triangles.n_elements() == 2 * points.size() - 2 - hull.size());
+        REQUIRE(triangulated.edges().n_elements() == 3 * points.size() - 3 - hull.size());
+        REQUIRE(triangulated.duplicates().empty());
+
+        T area(0);
+        for(size_t i = 0; i < triangles.n_elements(); ++i) {
+            const Point<T> &a = points[triangles[i][0]], &b = points[triangles[i][1]], &c = points[triangles[i][2]];
+            const T doubleArea = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+            REQUIRE(doubleArea > 0);
+            area += doubleArea / 2;
+
+            const T
+                bx = b.x - a.x, by = b.y - a.y,
+                cx = c.x - a.x, cy = c.y - a.y,
+                d = 2 * (bx * cy - by * cx);
+            const Point<T> center({a.x + (cy * (bx * bx + by * by) - by * (cx * cx + cy * cy)) / d,
+                                   a.y + (bx * (cx * cx + cy * cy) - cx * (bx * bx + by * by)) / d});
+            const T radius = center.distance_to(a);
+            for(size_t k = 0; k < points.size(); ++k)
+                REQUIRE(center.distance_to(points[k]) > radius * (1 - 1e-3));
+        }
+        REQUIRE(area == Approx(PolygonClipping<T>::area({hull})));
+    }
+
+    SECTION("strips") {
+        std::mt19937 gen(11);
+        std::uniform_real_distribution<T> dist(-100.0, 100.0);
+        PointCloud<T> points;
+        for(size_t i = 0; i < 150000; ++i)
+            points.push_back(dist(gen), dist(gen));
+        for(size_t i = 0; i < 150; ++i) {
+            for(size_t j = 0; j < 150; ++j)
+                points.push_back(i, j); //cocircular
+        }
+        const size_t n = points.size();
+        for(size_t i = 0; i < 30000; i += 3)
+            points.push_back(points[n - 1 - i]); //duplicates of the lattice and random points, later ones first
+
+        Delaunay<T>
+            serial(points, 1),
+            strips(points, 4);
+        REQUIRE(serial.n_triangles() == strips.n_triangles());
+        REQUIRE(serial.n_duplicates() == 10000);
+        REQUIRE(strips.n_duplicates() == 10000);
+        REQUIRE(canonical(serial.triangles()) == canonical(strips.triangles()));
+        const Topology<2> duplicates = strips.duplicates();
+        REQUIRE(duplicates.n_elements() == 10000);
+        for(size_t i = 0; i < duplicates.n_elements(); ++i) {
+            REQUIRE(duplicates[i][0] >= n);
+            REQUIRE(points[duplicates[i][1]] == points[duplicates[i][0]]);
+            REQUIRE(duplicates[i][1] < n); //the same point is kept as in serial
+        }
+    }
+}
+
+TEST_CASE("testing Voronoi") {
+    std::mt19937 gen(13);
+    std::uniform_real_distribution<T> dist(-50.0, 50.0);
+    PointCloud<T> points;
+    for(size_t i = 0; i < 500; ++i)
+        points.push_back(dist(gen), dist(gen));
+    points.push_back(points[3]);
+    Voronoi<T> voronoi(points);
+
+    SECTION("cells") {
+        REQUIRE(voronoi.voronoi_vertices().size() == voronoi.n_triangles());
+        REQUIRE(voronoi.cell(3).n_elements() == voronoi.cell(500).n_elements());
+        REQUIRE_THROWS(voronoi.cell(501));
+
+        //the clipped cells of all sites tile the bounds
+        Rectangle<T> bounds(150, 120, true, Point<T>{10, -5}, 0.3);
+        auto cells = voronoi.cells(bounds);
+        REQUIRE(cells.size() == points.size());
+        T area(0);
+        for(size_t i = 0; i < 500; ++i) {
+            if(!cells[i].empty())
+                area += PolygonClipping<T>::area({cells[i]});
+        }
+        REQUIRE(area == Approx(150 * 120));
+        REQUIRE(cells[500].size() == cells[3].size());
+
+        PointCloud<T> hull = points.convex_hull(false);
+        for(const auto &p : hull)
+            REQUIRE(voronoi.unbounded(voronoi.nearest(p)));
+        //the vertices of a cell are the points furthest away from all sites and equidistant to its own
+        auto vertices = voronoi.voronoi_vertices();
+        for(size_t i = 0; i < 50; ++i) {
+            auto cell = voronoi.cell(i);
+            for(size_t j = 0; j < cell.n_elements(); ++j) {
+                const Point<T> &corner = vertices[cell[j][0]];
+                const T radius = corner.distance_to(points[i]);
+                for(size_t k = 0; k < points.size(); ++k)
+                    REQUIRE(corner.distance_to(points[k]) > radius * (1 - 1e-3));
+            }
+        }
+    }
+
+    SECTION("nearest") {
+        PointCloud<T> queries;
+        for(size_t i = 0; i < 2000; ++i)
+            queries.push_back(1.5 * dist(gen), 1.5 * dist(gen));
+        std::vector<size_t> result;
+        voronoi.nearest(queries, result, 4);
+        REQUIRE(result.size() == queries.size());
+        size_t hint(0);
+        for(size_t i = 0; i < queries.size(); ++i) {
+            T best = std::numeric_limits<T>::max();
+            for(const auto &p : points)
+                best = std::min(best, p.sqr_distance_to(queries[i]));
+            REQUIRE(points[result[i]].sqr_distance_to(queries[i]) == best);
+            REQUIRE(voronoi.nearest(queries[i], hint) == result[i]);
+        }
+
+        PointCloud<T> line;
+        for(size_t i = 0; i < 10; ++i)
+            line.push_back(i, 2 * i);
+        Voronoi<T> collinear(line);
+        REQUIRE(collinear.nearest(Point<T>{3.1, 6.5}) == 3);
+        REQUIRE(collinear.cell(3).empty());
+    }
+
+    SECTION("natural neighbours") {
+        //linear functions are reproduced within the hull
+        std::vector<T> values;
+        for(const auto &p : points)
+            values.push_back(2 * p.x - 3 * p.y + 1);
+        PointCloud<T> queries;
+        for(size_t i = 0; i < 1000; ++i)
+            queries.push_back(0.6 * dist(gen), 0.6 * dist(gen));
+        std::vector<T> result;
+        voronoi.interpolate(queries, values, result, 4);
+        std::vector<std::pair<size_t, T>> weights;
+        for(size_t i = 0; i < queries.size(); ++i) {
+            const Point<T> &q = queries[i];
+            const T expected = 2 * q.x - 3 * q.y + 1;
+            REQUIRE(result[i] == Approx(expected).epsilon(1e-3));
+            REQUIRE(voronoi.interpolate(q, values) == Approx(expected).epsilon(1e-3));
+
+            voronoi.natural_neighbours(q, weights);
+            T sum(0), x(0), y(0);
+            for(const auto &w : weights) {
+                REQUIRE(w.second >= 0);
+                sum += w.second;
+                x += w.second * points[w.first].x;
+                y += w.second * points[w.first].y;
+            }
+            REQUIRE(sum == Approx(1));
+            REQUIRE(x == Approx(q.x).epsilon(1e-3));
+            REQUIRE(y == Approx(q.y).epsilon(1e-3));
+        }
+
+        voronoi.natural_neighbours(points[7], weights);
+        REQUIRE(weights.size() == 1);
+        REQUIRE(weights[0].first == 7);
+        voronoi.natural_neighbours(Point<T>{1000, 1000}, weights);
+        REQUIRE(weights.size() == 1);
+        REQUIRE(weights[0].first == voronoi.nearest(Point<T>{1000, 1000}));
+        REQUIRE_THROWS(voronoi.interpolate(Point<T>{0, 0}, std::vector<T>(3)));
+    }
+}
+
+TEST_CASE("testing PolygonTriangulation") {
+    //sum of the signed areas of the triangles, counts the clockwise ones
+    auto area_of = [](const std::vector<Point<T>> &points, const Topology<3> &triangles, size_t &nClockwise) {
+        T area(0);
+        nClockwise = 0;
+        for(size_t i = 0; i < triangles.n_elements(); ++i) {
+            const Point<T> &a = points[triangles[i][0]], &b = points[triangles[i][1]], &c = points[triangles[i][2]];
+            const T doubleArea = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+            if(doubleArea < 0)
+                ++nClockwise;
+            area += doubleArea / 2;
+        }
+        return area;
+    };
+
+    PolygonTriangulation<T> triangulation;
+    size_t nClockwise(0);
+
+    SECTION("degenerate inputs") {
+        REQUIRE(triangulation.triangulate(PointCloud<T>()).empty());
+        REQUIRE(triangulation.triangulate(LineSegment<T>(Point<T>{0, 0}, Point<T>{1, 1})).empty());
+        REQUIRE(triangulation.triangulate(std::vector<PointCloudView<T>>()).empty());
+    }
+
+    SECTION("simple polygons") {
+        Rectangle<T> rectangle(4, 2, true);
+        Topology<3> triangles = triangulation.triangulate(rectangle);
+        REQUIRE(triangles.n_elements() == 2);
+        std::vector<Point<T>> points(rectangle.begin(), rectangle.end());
+        REQUIRE(area_of(points, triangles, nClockwise) == Approx(8));
+        REQUIRE(nClockwise == 0);
+
+        //clockwise input results in counter clockwise triangles
+        PointCloud<T> reversed(points.rbegin(), points.rend());
+        triangles = triangulation.triangulate(reversed);
+        points.assign(reversed.begin(), reversed.end());
+        REQUIRE(area_of(points, triangles, nClockwise) == Approx(8));
+        REQUIRE(nClockwise == 0);
+
+        Ellipse<T> ellipse(10, 6, 1000, false);
+        triangles = triangulation.triangulate(ellipse);
+        REQUIRE(triangles.n_elements() == 998);
+        points.assign(ellipse.begin(), ellipse.end());
+        REQUIRE(area_of(points, triangles, nClockwise) == Approx(PolygonClipping<T>::area({ellipse})));
+        REQUIRE(nClockwise == 0);
+
+        //concave star with random spikes
+        std::mt19937 gen(17);
+        std::uniform_real_distribution<T> dist(20.0, 100.0);
+        PointCloud<T> star;
+        for(size_t i = 0; i < 2000; ++i) {
+            const T angle = LIB_2D_2PI * i / 2000, radius = dist(gen);
+            star.push_back(radius * cos(angle), radius * sin(angle));
+        }
+        triangles = triangulation.triangulate(star);
+        REQUIRE(triangles.n_elements() == 1998);
+        points.assign(star.begin(), star.end());
+        REQUIRE(area_of(points, triangles, nClockwise) == Approx(PolygonClipping<T>::area({star})));
+        REQUIRE(nClockwise == 0);
+    }
+
+    SECTION("holes") {
+        Rectangle<T> outer(100, 100, false);
+        std::vector<Rectangle<T>> holes;
+        holes.push_back(Rectangle<T>(5, 5, false, Point<T>{-20, 10}));
+        holes.push_back(Rectangle<T>(5, 5, false, Point<T>{20, -10}, 0.5));
+        holes.push_back(Rectangle<T>(5, 5, false, Point<T>{0, 30}));
+
+        std::vector<PointCloudView<T>> rings(1, outer.view());
+        std::vector<Point<T>> points(outer.begin(), outer.end());
+        for(auto &hole : holes) {
+            rings.push_back(hole.view());
+            points.insert(points.end(), hole.begin(), hole.end());
+        }
+        const Topology<3> triangles = triangulation.triangulate(rings);
+        REQUIRE(triangles.n_elements() == 4 + 12 + 2 * 3 - 2);
+        REQUIRE(area_of(points, triangles, nClockwise) == Approx(100 * 100 - 3 * 25));
+        REQUIRE(nClockwise == 0);
+
+        //the instance reuses its buffers
+        REQUIRE(triangulation.triangulate(rings).n_elements() == triangles.n_elements());
+        Topology<3> appended;
+        triangulation.triangulate(rings, appended, 10);
+        triangulation.triangulate(rings, appended, 10);
+        REQUIRE(appended.n_elements() == 2 * triangles.n_elements());
+        REQUIRE(appended[0][0] == triangles[0][0] + 10);
+    }
+
+    SECTION("batches") {
+        std::vector<Rectangle<T>> rectangles;
+        for(size_t i = 0; i < 1000; ++i)
+            rectangles.push_back(Rectangle<T>(1, 2, i % 2 == 0, Point<T>{T(i), 0}, 0.1 * i));
+        std::vector<PointCloudView<T>> polygons;
+        for(const auto &rectangle : rectangles)
+            polygons.push_back(rectangle.view());
+
+        const std::vector<Topology<3>> results = PolygonTriangulation<T>::triangulate_each(polygons, 4);
+        REQUIRE(results.size() == polygons.size());
+        for(size_t i = 0; i < polygons.size(); ++i) {
+            REQUIRE(results[i].n_elements() == 2);
+            std::vector<Point<T>> points(polygons[i].begin(), polygons[i].end());
+            REQUIRE(area_of(points, results[i], nClockwise) == Approx(2).epsilon(1e-3));
+            REQUIRE(nClockwise == 0);
+        }
+    }
+}
+
+TEST_CASE("testing DisjointSets") {
+    DisjointSets sets(10);
+    REQUIRE(sets.size() == 10);
+    REQUIRE(sets.n_sets() == 10);
+    REQUIRE(sets.unite(0, 1));
+    REQUIRE(sets.unite(2, 3));
+    REQUIRE(sets.unite(1, 3));
+    REQUIRE_FALSE(sets.unite(0, 2));
+    REQUIRE(sets.same(0, 3));
+    REQUIRE_FALSE(sets.same(0, 4));
+    REQUIRE(sets.set_size(2) == 4);
+    REQUIRE(sets.n_sets() == 7);
+
+    std::vector<size_t> labels;
+    REQUIRE(sets.labels(labels) == 7);
+    REQUIRE(labels == std::vector<size_t>({0, 0, 0, 0, 1, 2, 3, 4, 5, 6}));
+}
+
+TEST_CASE("testing MinimumSpanningTree") {
+    std::mt19937 gen(19);
+    std::uniform_real_distribution<T> dist(-100.0, 100.0);
+
+    SECTION("against Prim") {
+        PointCloud<T> points;
+        for(size_t i = 0; i < 500; ++i)
+            points.push_back(dist(gen), dist(gen));
+        for(size_t i = 0; i < 10; ++i)
+            points.push_back(points[3 * i]);
+
+        //O(n^2) Prim on the complete graph
+        const size_t n = points.size();
+        std::vector<T> distances(n, std::numeric_limits<T>::max());
+        std::vector<bool> within(n, false);
+        distances[0] = 0;
+        T expected(0);
+        for(size_t k = 0; k < n; ++k) {
+            size_t best = n;
+            for(size_t i = 0; i < n; ++i) {
+                if(!within[i] && (best == n || distances[i] < distances[best]))
+                    best = i;
+            }
+            within[best] = true;
+            expected += distances[best];
+            for(size_t i = 0; i < n; ++i)
+                distances[i] = std::min(distances[i], points[best].distance_to(points[i]));
+        }
+
+        MinimumSpanningTree<T> tree(points);
+        REQUIRE(tree.n_points() == n);
+        REQUIRE(tree.edges().n_elements() == n - 1);
+        REQUIRE(tree.length() == Approx(expected));
+        REQUIRE(std::is_sorted(tree.edge_lengths().begin(), tree.edge_lengths().end()));
+
+        std::vector<size_t> labels;
+        REQUIRE(tree.single_linkage(0, labels) == 500);
+        REQUIRE(labels[500] == labels[0]);
+        REQUIRE(tree.single_linkage(1000, labels) == 1);
+        REQUIRE(tree.single_linkage_n(7, labels) == 7);
+        REQUIRE(tree.single_linkage_n(1000, labels) == n);
+    }
+
+    SECTION("degenerate inputs") {
+        REQUIRE(MinimumSpanningTree<T>(PointCloud<T>()).edges().empty());
+        PointCloud<T> line;
+        for(size_t i = 0; i < 10; ++i)
+            line.push_back(9 - i, 2 * (9 - i));
+        line.push_back(line[4]);
+        MinimumSpanningTree<T> tree(line);
+        REQUIRE(tree.edges().n_elements() == 10);
+        REQUIRE(tree.length() == Approx(9 * std::sqrt(T(5))));
+    }
+
+    SECTION("single linkage") {
+        //two blobs of points far apart from each other
+        PointCloud<T> points;
+        std::uniform_real_distribution<T> small(0.0, 1.0);
+        for(size_t i = 0; i < 400; ++i) {
+            const T offset = i % 2 == 0 ? 0 : 50;
+            points.push_back(small(gen) + offset, small(gen));
+        }
+        MinimumSpanningTree<T> tree(points);
+        std::vector<size_t> labels;
+        REQUIRE(tree.single_linkage(10, labels) == 2);
+        for(size_t i = 0; i < points.size(); ++i)
+            REQUIRE(labels[i] == i % 2);
+        REQUIRE(tree.single_linkage_n(2, labels) == 2);
+        REQUIRE(labels[398] == 0);
+        REQUIRE(labels[399] == 1);
+    }
+
+    SECTION("threads") {
+        PointCloud<T> points;
+        for(size_t i = 0; i < 150000; ++i)
+            points.push_back(dist(gen), dist(gen));
+        for(size_t i = 0; i < 100; ++i) {
+            for(size_t j = 0; j < 100; ++j)
+                points.push_back(i, j); //equally long edges
+        }
+        MinimumSpanningTree<T>
+            serial(points, 1),
+            threaded(points, 4);
+        REQUIRE(serial.edges().n_elements() == points.size() - 1);
+        REQUIRE(threaded.edges().n_elements() == points.size() - 1);
+        bool same = true;
+        for(size_t i = 0; i < serial.edges().n_elements(); ++i)
+            same = same && serial.edges()[i] == threaded.edges()[i];
+        REQUIRE(same);
+    }
+}
+
+TEST_CASE("testing Dbscan") {
+    std::mt19937 gen(23);
+    std::uniform_real_distribution<T> dist(-100.0, 100.0);
+
+    SECTION("against brute force") {
+        auto points = std::make_shared<PointCloud<T>>();
+        for(size_t i = 0; i < 1500; ++i)
+            points->push_back(std::floor(dist(gen)) / 4, dist(gen) / 4);
+        const size_t n = points->size();
+        const T radius = 1.5;
+        const size_t minPoints = 4;
+
+        std::vector<bool> core(n, false);
+        for(size_t i = 0; i < n; ++i) {
+            size_t count(0);
+            for(size_t j = 0; j < n; ++j) {
+                if((*points)[i].sqr_distance_to((*points)[j]) <= radius * radius)
+                    ++count;
+            }
+            core[i] = count >= minPoints;
+        }
+        DisjointSets sets(n);
+        for(size_t i = 0; i < n; ++i) {
+            for(size_t j = i + 1; j < n; ++j) {
+                if(core[i] && core[j] && (*points)[i].sqr_distance_to((*points)[j]) <= radius * radius)
+                    sets.unite(i, j);
+            }
+        }
+
+        for(size_t nThreads = 1; nThreads < 5; nThreads += 3) {
+            Dbscan<T> dbscan(points, radius, minPoints, nThreads);
+            REQUIRE(dbscan.n_points() == n);
+            const std::vector<size_t> &labels = dbscan.labels();
+            for(size_t i = 0; i < n; ++i) {
+                REQUIRE(dbscan.is_core(i) == core[i]);
+                for(size_t j = i + 1; j < n; ++j) {
+                    if(core[i] && core[j])
+                        REQUIRE(sets.same(i, j) == (labels[i] == labels[j]));
+                }
+                if(core[i])
+                    continue;
+                size_t nearest = Dbscan<T>::NOISE;
+                for(size_t j = 0; j < n; ++j) {
+                    if(core[j] && (*points)[i].sqr_distance_to((*points)[j]) <= radius * radius
+                       && (nearest == Dbscan<T>::NOISE || (*points)[i].sqr_distance_to((*points)[j]) < (*points)[i].sqr_distance_to((*points)[nearest])))
+                        nearest = j;
+                }
+                REQUIRE(labels[i] == (nearest == Dbscan<T>::NOISE ? size_t(Dbscan<T>::NOISE) : labels[nearest]));
+            }
+        }
+    }
+
+    SECTION("clusters") {
+        //two dense blobs, a sparse line of noise between them
+        auto points = std::make_shared<PointCloud<T>>();
+        std::uniform_real_distribution<T> small(0.0, 1.0);
+        for(size_t i = 0; i < 400; ++i) {
+            const T offset = i % 2 == 0 ? 0 : 50;
+            points->push_back(small(gen) + offset, small(gen));
+        }
+        for(size_t i = 0; i < 10; ++i)
+            points->push_back(5 + 4 * i, 0);
+
+        Dbscan<T> dbscan(points, 0.3, 5);
+        REQUIRE(dbscan.n_clusters() == 2);
+        for(size_t i = 0; i < 400; ++i)
+            REQUIRE(dbscan.labels()[i] == i % 2);
+        for(size_t i = 400; i < points->size(); ++i)
+            REQUIRE(dbscan.labels()[i] == size_t(Dbscan<T>::NOISE));
+
+        const auto clusters = dbscan.clusters();
+        REQUIRE(clusters.size() == 2);
+        REQUIRE(clusters[0]->topology.n_elements() == 200);
+        REQUIRE(clusters[1]->topology.n_elements() == 200);
+        REQUIRE(clusters[1]->get_id(0) == 1);
+        REQUIRE(clusters[1]->first().x >= 50);
+        REQUIRE(dbscan.cluster(1)->topology.n_elements() == 200);
+        REQUIRE(dbscan.noise()->topology.n_elements() == 10);
+        REQUIRE_THROWS(dbscan.cluster(2));
+    }
+
+    SECTION("points exactly radius apart") {
+        //a lattice spaced by the radius, far from the origin, so cell() rounds
+        auto points = std::make_shared<PointCloud<T>>();
+        const T radius = T(0.3);
+        for(int i = 0; i < 40; ++i) {
+            for(int j = 0; j < 5; ++j)
+                points->push_back(T(1000) + T(i) * radius, T(-500) + T(3 * j) * radius);
+        }
+        const size_t n = points->size();
+        auto within = [&](size_t i, size_t j) {
+            const T dx = (*points)[i].x - (*points)[j].x, dy = (*points)[i].y - (*points)[j].y;
+            return dx * dx + dy * dy <= radius * radius;
+        };
+        DisjointSets sets(n);
+        std::vector<bool> core(n, false);
+        for(size_t i = 0; i < n; ++i) {
+            size_t count(0);
+            for(size_t j = 0; j < n; ++j)
+                count += within(i, j);
+            core[i] = count >= 3;
+        }
+        for(size_t i = 0; i < n; ++i) {
+            for(size_t j = i + 1; j < n; ++j) {
+                if(core[i] && core[j] && within(i, j))
+                    sets.unite(i, j);
+            }
+        }
+
+        Dbscan<T> dbscan(points, radius, 3);
+        for(size_t i = 0; i < n; ++i) {
+            REQUIRE(dbscan.is_core(i) == core[i]);
+            for(size_t j = i + 1; j < n; ++j) {
+                if(core[i] && core[j])
+                    REQUIRE(sets.same(i, j) == (dbscan.labels()[i] == dbscan.labels()[j]));
+            }
+        }
+    }
+
+    SECTION("degenerate inputs") {
+        auto points = std::make_shared<PointCloud<T>>();
+        REQUIRE(Dbscan<T>(points, 1, 3).n_clusters() == 0);
+        REQUIRE_THROWS(Dbscan<T>(points, 0, 3));
+
+        for(size_t i = 0; i < 5; ++i)
+            points->push_back(1, 1);
+        REQUIRE(Dbscan<T>(points, 1, 5).n_clusters() == 1);
+        REQUIRE(Dbscan<T>(points, 1, 6).n_clusters() == 0);
+
+        //huge extents require cells larger than the radius
+        points->push_back(1e12, -1e12);
+        points->push_back(1e12, -1e12);
+        Dbscan<T> dbscan(points, 1, 2);
+        REQUIRE(dbscan.n_clusters() == 2);
+        REQUIRE(dbscan.labels()[6] == 1);
+    }
+}
+
+TEST_CASE("testing IterativeClosestPoint") {
+    using Icp = IterativeClosestPoint<T>;
+    std::mt19937 gen(29);
+    std::uniform_real_distribution<T> dist(-100.0, 100.0);
+
+    //a sine wave and a circle, so there is no symmetry
+    auto target = std::make_shared<PointCloud<T>>();
+    for(size_t i = 0; i < 2000; ++i)
+        target->push_back(T(0.01) * i, 3 * std::sin(T(0.01) * i));
+    for(size_t i = 0; i < 1000; ++i)
+        target->push_back(10 + 3 * std::cos(T(0.00628) * i), 2 + 3 * std::sin(T(0.00628) * i));
+    Icp icp(target);
+    REQUIRE(icp.n_target() == 3000);
+    REQUIRE(icp.target_normals()[100].x == Approx(-3 * std::cos(T(1)) / std::sqrt(1 + 9 * std::cos(T(1)) * std::cos(T(1)))).epsilon(0.01)); //slope of the sine wave is 3 cos(x)
+
+    SECTION("transforms") {
+        const Icp::Transform a(T(0.3), T(2), Point<T>{1, -2});
+        const Icp::Transform b(T(-0.1), T(0.5), Point<T>{3, 4});
+        const Point<T> p{T(1.5), T(-0.5)};
+        const Point<T> twice = b.apply(a.apply(p));
+        REQUIRE(a.then(b).apply(p).x == Approx(twice.x));
+        REQUIRE(a.then(b).apply(p).y == Approx(twice.y));
+        REQUIRE(a.then(a.inverse()).apply(p).x == Approx(p.x));
+        REQUIRE(a.then(a.inverse()).apply(p).y == Approx(p.y));
+
+        PointCloud<T> pc;
+        pc.push_back(p);
+        a.apply(pc);
+        REQUIRE(pc[0].x == Approx(a.apply(p).x));
+        REQUIRE(pc[0].y == Approx(a.apply(p).y));
+    }
+
+    SECTION("rigid and similarity") {
+        for(size_t similarity = 0; similarity < 2; ++similarity) {
+            const Icp::Transform truth(T(0.05), similarity ? T(1.1) : T(1), Point<T>{T(0.2), T(0.1)});
+            const Icp::Transform inverse = truth.inverse();
+            PointCloud<T> source;
+            for(size_t i = 0; i < target->size(); i += 2)
+                source.push_back(inverse.apply((*target)[i]));
+
+            for(size_t metric = 0; metric < 2; ++metric) {
+                Icp::Settings settings;
+                settings.metric = metric == 0 ? Icp::POINT_TO_POINT : Icp::POINT_TO_LINE;
+                settings.similarity = similarity == 1;
+                settings.maxIterations = 200;
+                settings.tolerance = T(1e-5);
+                const Icp::Result result = icp.align(source.view(), Icp::Transform(), settings);
+                REQUIRE(result.converged);
+                REQUIRE(!result.log.empty());
+                REQUIRE(result.log.front().nCorrespondences == source.size());
+                REQUIRE(result.rmsError < T(1e-3));
+                REQUIRE(result.transform.angle == Approx(truth.angle).epsilon(1e-3));
+                REQUIRE(result.transform.factor == Approx(truth.factor).epsilon(1e-3));
+
+                PointCloud<T> aligned(source);
+                result.transform.apply(aligned);
+                for(size_t i = 0; i < aligned.size(); ++i)
+                    REQUIRE(aligned[i].distance_to((*target)[2 * i]) < T(1e-2));
+            }
+        }
+    }
+
+    SECTION("outliers") {
+        const Icp::Transform truth(T(-0.08), T(1), Point<T>{T(-0.3), T(0.25)});
+        const Icp::Transform inverse = truth.inverse();
+        PointCloud<T> source;
+        for(size_t i = 0; i < target->size(); i += 3)
+            source.push_back(inverse.apply((*target)[i]));
+        for(size_t i = 0; i < 100; ++i)
+            source.push_back(dist(gen), dist(gen));
+
+        Icp::Settings settings;
+        settings.trimRatio = T(0.85);
+        settings.maxIterations = 200;
+        settings.tolerance = T(1e-5);
+        settings.nThreads = 3;
+        const Icp::Result trimmed = icp.align(source.view(), Icp::Transform(), settings);
+        REQUIRE(trimmed.transform.angle == Approx(truth.angle).epsilon(1e-3));
+        REQUIRE(trimmed.transform.translation.x == Approx(truth.translation.x).epsilon(1e-2));
+        REQUIRE(trimmed.log.front().nCorrespondences == size_t(std::ceil(T(0.85) * source.size())));
+
+        settings.trimRatio = 1;
+        settings.maxDistance = 1;
+        const Icp::Result limited = icp.align(source.view(), Icp::Transform(), settings);
+        REQUIRE(limited.transform.angle == Approx(truth.angle).epsilon(1e-3));
+        REQUIRE(limited.log.back().nCorrespondences >= 1000);
+        REQUIRE(limited.log.back().nCorrespondences < 1010);
+    }
+
+    SECTION("degenerate inputs") {
+        REQUIRE(icp.align(PointCloud<T>().view()).log.empty());
+        PointCloud<T> single;
+        single.push_back(1, 1);
+        REQUIRE(!icp.align(single.view()).converged);
+    }
+}
+
+TEST_CASE("testing Ransac") {
+    std::mt19937 gen(31);
+    std::normal_distribution<T> noise(0.0, 0.02);
+    std::uniform_real_distribution<T> dist(-50.0, 50.0);
+
+    //2000 points of a shape followed by 3000 outliers
+    auto with_outliers = [&](PointCloud<T> points) {
+        for(size_t i = 0; i < 3000; ++i)
+            points.push_back(dist(gen), dist(gen));
+        return points;
+    };
+    auto inliers_found = [](const Topology<1> &inliers) {
+        size_t n(0);
+        for(size_t i = 0; i < inliers.n_elements(); ++i) {
+            if(inliers[i][0] < 2000)
+                ++n;
+        }
+        return n;
+    };
+
+    Ransac<T>::Settings settings;
+    settings.threshold = T(0.1);
+
+    SECTION("line") {
+        PointCloud<T> points;
+        for(size_t i = 0; i < 2000; ++i) {
+            const T t = T(0.01) * i - 10;
+            points.push_back(3 + T(0.8) * t + noise(gen), -2 + T(0.6) * t + noise(gen));
+        }
+        points = with_outliers(points);
+
+        const Ransac<T> ransac(points.view());
+        REQUIRE(ransac.size() == 5000);
+        const Ransac<T>::LineFit fit = ransac.line(settings);
+        REQUIRE(fit.found);
+        REQUIRE(inliers_found(fit.inliers) > 1950);
+        REQUIRE(fit.inliers.n_elements() < 2100);
+
+        const LineSegment<T> segment = fit.segment();
+        REQUIRE(segment.size() == 2);
+        const T length = segment[0].distance_to(segment[1]);
+        REQUIRE(length > 19);
+        REQUIRE(std::abs((segment[1].x - segment[0].x) / length) == Approx(0.8).epsilon(1e-2));
+        REQUIRE(std::abs((segment[1].y - segment[0].y) / length) == Approx(0.6).epsilon(1e-2));
+
+        //the same result for any number of threads
+        settings.nThreads = 1;
+        const Ransac<T>::LineFit serial = ransac.line(settings);
+        settings.nThreads = 4;
+        const Ransac<T>::LineFit threaded = ransac.line(settings);
+        REQUIRE(serial.inliers.n_elements() == threaded.inliers.n_elements());
+        for(size_t i = 0; i < serial.inliers.n_elements(); ++i)
+            REQUIRE(serial.inliers[i][0] == threaded.inliers[i][0]);
+        REQUIRE(serial.nHypotheses == threaded.nHypotheses);
+    }
+
+    SECTION("circle") {
+        PointCloud<T> points;
+        for(size_t i = 0; i < 2000; ++i) {
+            const T radians = T(0.002) * i - 2;
+            points.push_back(20 + 7 * std::cos(radians) + noise(gen), 5 + 7 * std::sin(radians) + noise(gen));
+        }
+        points = with_outliers(points);
+
+        const Ransac<T>::CircleFit fit = Ransac<T>(points.view()).circle(settings);
+        REQUIRE(fit.found);
+        REQUIRE(inliers_found(fit.inliers) > 1950);
+        REQUIRE(fit.center.x == Approx(20).epsilon(1e-3));
+        REQUIRE(fit.center.y == Approx(5).epsilon(1e-3));
+        REQUIRE(fit.radius == Approx(7).epsilon(1e-3));
+        REQUIRE(fit.radiansEnd > fit.radiansStart);
+
+        const Arc<T> arc = fit.arc(50);
+        REQUIRE(arc.size() == 50);
+        for(size_t i = 0; i < arc.size(); ++i)
+            REQUIRE(arc[i].distance_to(fit.center) == Approx(fit.radius));
+        REQUIRE(fit.circle(50).size() == 50);
+    }
+
+    SECTION("ellipse") {
+        PointCloud<T> points;
+        for(size_t i = 0; i < 2000; ++i) {
+            const T radians = T(0.003) * i;
+            const T x = 6 * std::cos(radians), y = 2 * std::sin(radians);
+            points.push_back(-20 + std::cos(T(0.4)) * x - std::sin(T(0.4)) * y + noise(gen),
+                             10 + std::sin(T(0.4)) * x + std::cos(T(0.4)) * y + noise(gen));
+        }
+        points = with_outliers(points);
+
+        const Ransac<T>::EllipseFit fit = Ransac<T>(points.view()).ellipse(settings);
+        REQUIRE(fit.found);
+        REQUIRE(inliers_found(fit.inliers) > 1900);
+        REQUIRE(fit.center.x == Approx(-20).epsilon(1e-2));
+        REQUIRE(fit.center.y == Approx(10).epsilon(1e-2));
+        const T major = std::max(fit.a, fit.b), minor = std::min(fit.a, fit.b);
+        REQUIRE(major == Approx(6).epsilon(1e-2));
+        REQUIRE(minor == Approx(2).epsilon(1e-2));
+        REQUIRE(fit.ellipse(100).size() == 100);
+    }
+
+    SECTION("prosac") {
+        PointCloud<T> points;
+        std::vector<T> quality;
+        for(size_t i = 0; i < 2000; ++i) {
+            points.push_back(T(0.01) * i, 5 + noise(gen));
+            quality.push_back(1);
+        }
+        points = with_outliers(points);
+        quality.resize(points.size(), 0);
+
+        const Ransac<T>::LineFit fit = Ransac<T>(points.view(), quality).line(settings);
+        REQUIRE(fit.found);
+        REQUIRE(inliers_found(fit.inliers) > 1950);
+        REQUIRE(fit.nHypotheses <= 256);
+        REQUIRE(fit.start.y == Approx(5).epsilon(1e-2));
+    }
+
+    SECTION("degenerate inputs") {
+        PointCloud<T> points;
+        REQUIRE(!Ransac<T>(points.view()).line().found);
+        points.push_back(1, 1);
+        points.push_back(2, 2);
+        REQUIRE(!Ransac<T>(points.view()).circle().found);
+        REQUIRE(Ransac<T>(points.view()).line().found);
+        points.push_back(3, 3);
+        points.push_back(4, 4);
+        points.push_back(5, 5);
+        REQUIRE(!Ransac<T>(points.view()).ellipse().found);
+    }
+}
+
+TEST_CASE("testing DistanceJoin") {
+    std::mt19937 gen(37);
+    std::uniform_real_distribution<T> dist(-10.0, 10.0);
+
+    PointCloud<T> a, b;
+    for(size_t i = 0; i < 800; ++i)
+        a.push_back(2 * dist(gen), dist(gen));
+    for(size_t i = 0; i < 600; ++i)
+        b.push_back(std::floor(dist(gen)), dist(gen)); //many equal x values
+    b.push_back(b[0]);
+    const T radius = T(0.7);
+    const T sqrRadius = radius * radius;
+
+    SECTION("join") {
+        const DistanceJoin<T> join(b.view(), radius);
+        REQUIRE(join.size() == b.size());
+        for(size_t nThreads = 1; nThreads < 5; nThreads += 3) {
+            std::vector<size_t> offsets, ids;
+            join.join(a.view(), offsets, ids, nThreads);
+            REQUIRE(offsets.size() == a.size() + 1);
+            REQUIRE(offsets.back() == ids.size());
+            for(size_t i = 0; i < a.size(); ++i) {
+                std::vector<size_t> expected;
+                for(size_t j = 0; j < b.size(); ++j) {
+                    if(a[i].sqr_distance_to(b[j]) <= sqrRadius)
+                        expected.push_back(j);
+                }
+                const size_t nFound = offsets[i + 1] - offsets[i];
+                REQUIRE(nFound == expected.size());
+                REQUIRE(std::equal(expected.begin(), expected.end(), ids.begin() + offsets[i]));
+            }
+
+            size_t nPairs(0);
+            bool valid(true);
+            join.for_each_pair(a.view(), [&](const DistanceJoin<T>::Pair *first, const DistanceJoin<T>::Pair *last) {
+                for(; first != last; ++first) {
+                    valid = valid && a[first->first].sqr_distance_to(b[first->second]) <= sqrRadius;
+                    ++nPairs;
+                }
+            }, nThreads);
+            REQUIRE(valid);
+            REQUIRE(nPairs == ids.size());
+        }
+    }
+
+    SECTION("self join") {
+        const DistanceJoin<T> join(b.view(), radius);
+        std::vector<size_t> offsets, ids;
+        join.self_join(offsets, ids, 3);
+        size_t nPairs(0);
+        for(size_t i = 0; i < b.size(); ++i) {
+            std::vector<size_t> expected;
+            for(size_t j = 0; j < b.size(); ++j) {
+                if(j != i && b[i].sqr_distance_to(b[j]) <= sqrRadius)
+                    expected.push_back(j);
+            }
+            nPairs += expected.size();
+            const size_t nFound = offsets[i + 1] - offsets[i];
+            REQUIRE(nFound == expected.size());
+            REQUIRE(std::equal(expected.begin(), expected.end(), ids.begin() + offsets[i]));
+        }
+
+        std::vector<DistanceJoin<T>::Pair> pairs;
+        join.for_each_self_pair([&](const DistanceJoin<T>::Pair *first, const DistanceJoin<T>::Pair *last) {
+            pairs.insert(pairs.end(), first, last);
+        }, 2);
+        REQUIRE(pairs.size() == nPairs / 2);
+        std::sort(pairs.begin(), pairs.end());
+        REQUIRE(std::unique(pairs.begin(), pairs.end()) == pairs.end());
+        for(const auto &p : pairs)
+            REQUIRE(p.first < p.second);
+        REQUIRE(std::binary_search(pairs.begin(), pairs.end(), DistanceJoin<T>::Pair(0, 600)));
+    }
+
+    SECTION("points exactly radius apart") {
+        //rounding within the cell computation must not place them two cells apart
+        const T r = T(0.1);
+        PointCloud<T> lattice;
+        lattice.push_back(-3, 0);
+        lattice.push_back(T(-0.1), 0);
+        lattice.push_back(0, 0);
+        for(int x = -30; x <= 30; ++x) {
+            for(int y = -3; y <= 3; ++y)
+                lattice.push_back(T(x) * r, T(y) * r + 7);
+        }
+
+        const DistanceJoin<T> join(lattice.view(), r);
+        std::vector<size_t> offsets, ids;
+        join.self_join(offsets, ids);
+        for(size_t i = 0; i < lattice.size(); ++i) {
+            std::vector<size_t> expected;
+            for(size_t j = 0; j < lattice.size(); ++j) {
+                const T dx = lattice[i].x - lattice[j].x, dy = lattice[i].y - lattice[j].y;
+                if(j != i && dx * dx + dy * dy <= r * r)
+                    expected.push_back(j);
+            }
+            const size_t nFound = offsets[i + 1] - offsets[i];
+            REQUIRE(nFound == expected.size());
+            REQUIRE(std::equal(expected.begin(), expected.end(), ids.begin() + offsets[i]));
+        }
+        const size_t nOrigin = offsets[3] - offsets[2];
+        REQUIRE(nOrigin == 1); //(0, 0) finds (-0.1, 0)
+    }
+
+    SECTION("degenerate inputs") {
+        REQUIRE_THROWS(DistanceJoin<T>(b.view(), 0));
+
+        const DistanceJoin<T> empty(PointCloud<T>().view(), 1);
+        std::vector<size_t> offsets, ids;
+        empty.join(a.view(), offsets, ids);
+        REQUIRE(offsets.size() == a.size() + 1);
+        REQUIRE(ids.empty());
+        empty.self_join(offsets, ids);
+        REQUIRE(offsets.size() == 1);
+
+        //huge extents and queries far outside
+        PointCloud<T> far;
+        far.push_back(0, 0);
+        far.push_back(T(0.5), 0);
+        far.push_back(T(1e12), 0);
+        const DistanceJoin<T> join(far.view(), 1);
+        PointCloud<T> queries;
+        queries.push_back(T(0.25), 0);
+        queries.push_back(T(-1e13), T(1e13));
+        queries.push_back(T(1e12), T(0.5));
+        join.join(queries.view(), offsets, ids);
+        REQUIRE(offsets[1] == 2);
+        REQUIRE(offsets[2] == 2);
+        REQUIRE(offsets[3] == 3);
+        REQUIRE(ids[2] == 2);
+    }
+}
+
+TEST_CASE("testing ReverseKNearest") {
+    std::mt19937 gen(41);
+    std::uniform_real_distribution<T> dist(-10.0, 10.0);
+    const size_t k = 4;
+
+    //squared distance of each client to its k-th nearest site
+    auto kth_sqr_distances = [k](const PointCloud<T> &clients, const PointCloud<T> &sites, bool monochromatic) {
+        std::vector<T> result;
+        for(size_t c = 0; c < clients.size(); ++c) {
+            std::vector<T> sqrDistances;
+            for(size_t s = 0; s < sites.size(); ++s) {
+                if(!monochromatic || s != c)
+                    sqrDistances.push_back(clients[c].sqr_distance_to(sites[s]));
+            }
+            std::sort(sqrDistances.begin(), sqrDistances.end());
+            result.push_back(sqrDistances.size() < k ? std::numeric_limits<T>::infinity() : sqrDistances[k - 1]);
+        }
+        return result;
+    };
+
+    //clients having q among their k nearest sites
+    auto brute_force = [](const PointCloud<T> &clients, const std::vector<T> &kth, const Point<T> &q, size_t exclude) {
+        std::vector<size_t> result;
+        for(size_t c = 0; c < clients.size(); ++c) {
+            if(c != exclude && clients[c].sqr_distance_to(q) <= kth[c])
+                result.push_back(c);
+        }
+        return result;
+    };
+
+    auto same = [](const Topology<1> &found, const std::vector<size_t> &expected) {
+        if(found.n_elements() != expected.size())
+            return false;
+        for(size_t i = 0; i < expected.size(); ++i) {
+            if(found[i][0] != expected[i])
+                return false;
+        }
+        return true;
+    };
+
+    const size_t none = static_cast<size_t>(-1);
+
+    SECTION("monochromatic") {
+        PointCloud<T> points;
+        for(size_t i = 0; i < 500; ++i)
+            points.push_back(dist(gen), dist(gen));
+        points.push_back(points[0]);
+
+        ReverseKNearest<T> rknn(points.view(), k);
+        auto kth = kth_sqr_distances(points, points, true);
+        REQUIRE(rknn.get_k() == k);
+        REQUIRE(rknn.n_clients() == points.size());
+
+        for(size_t i = 0; i < 50; ++i) {
+            const Point<T> q{dist(gen), dist(gen)};
+            REQUIRE(same(rknn.query(q), brute_force(points, kth, q, none)));
+        }
+        for(size_t s = 0; s < points.size(); s += 7)
+            REQUIRE(same(rknn.query_site(s), brute_force(points, kth, points[s], s)));
+
+        //enough insertions to pack new trees
+        for(size_t i = 0; i < 400; ++i) {
+            const Point<T> p{dist(gen), dist(gen)};
+            REQUIRE(rknn.insert(p) == points.size());
+            points.push_back(p);
+        }
+        kth = kth_sqr_distances(points, points, true);
+        for(size_t i = 0; i < 50; ++i) {
+            const Point<T> q{dist(gen), dist(gen)};
+            REQUIRE(same(rknn.query(q), brute_force(points, kth, q, none)));
+        }
+        for(size_t s = 0; s < points.size(); s += 11)
+            REQUIRE(same(rknn.query_site(s), brute_force(points, kth, points[s], s)));
+
+        REQUIRE_THROWS(rknn.insert_site(Point<T>{0, 0}));
+        REQUIRE_THROWS(rknn.insert_client(Point<T>{0, 0}));
+    }
+
+    SECTION("ties on lattices") {
+        //many clients have sites exactly at their k-th distance, rounding must not drop them
+        PointCloud<T> points;
+        for(int x = -10; x <= 10; ++x) {
+            for(int y = -10; y <= 10; ++y)
+                points.push_back(T(x) * T(0.3), T(y) * T(0.7));
+        }
+        const ReverseKNearest<T> rknn(points.view(), k + 1);
+        std::vector<T> kth;
+        for(size_t c = 0; c < points.size(); ++c) {
+            std::vector<T> sqrDistances;
+            for(size_t s = 0; s < points.size(); ++s) {
+                if(s != c)
+                    sqrDistances.push_back(points[c].sqr_distance_to(points[s]));
+            }
+            std::sort(sqrDistances.begin(), sqrDistances.end());
+            kth.push_back(sqrDistances[k]);
+        }
+        for(size_t s = 0; s < points.size(); ++s)
+            REQUIRE(same(rknn.query_site(s), brute_force(points, kth, points[s], s)));
+
+        PointCloud<T> clients, sites;
+        for(int x = 0; x < 12; ++x) {
+            for(int y = 0; y < 12; ++y) {
+                sites.push_back(T(x), T(y));
+                clients.push_back(T(x) + T(0.5) * (x % 2), T(y));
+            }
+        }
+        const ReverseKNearest<T> bichromatic(clients.view(), sites.view(), k);
+        const auto kthBichromatic = kth_sqr_distances(clients, sites, false);
+        for(size_t s = 0; s < sites.size(); ++s)
+            REQUIRE(same(bichromatic.query(sites[s]), brute_force(clients, kthBichromatic, sites[s], none)));
+    }
+
+    SECTION("bichromatic") {
+        PointCloud<T> clients, sites;
+        for(size_t i = 0; i < 300; ++i)
+            clients.push_back(dist(gen), dist(gen));
+        for(size_t i = 0; i < 3; ++i)
+            sites.push_back(dist(gen), dist(gen));
+
+        ReverseKNearest<T> rknn(clients.view(), sites.view(), k);
+        //less than k sites, every client contains everything
+        REQUIRE(std::isinf(rknn.radius(0)));
+        REQUIRE(rknn.query(Point<T>{100, 100}).n_elements() == clients.size());
+        REQUIRE_THROWS(rknn.insert(Point<T>{0, 0}));
+
+        for(size_t i = 0; i < 600; ++i) {
+            const Point<T> p{dist(gen), dist(gen)};
+            if(i % 2 == 0) {
+                REQUIRE(rknn.insert_site(p) == sites.size());
+                sites.push_back(p);
+            }
+            else {
+                REQUIRE(rknn.insert_client(p) == clients.size());
+                clients.push_back(p);
+            }
+        }
+        REQUIRE(rknn.n_sites() == sites.size());
+
+        PointCloud<T> probes;
+        std::vector<std::vector<size_t>> expected;
+        const auto kth = kth_sqr_distances(clients, sites, false);
+        for(size_t i = 0; i < 100; ++i) {
+            probes.push_back(dist(gen), dist(gen));
+            expected.push_back(brute_force(clients, kth, probes[i], none));
+        }
+        for(size_t nThreads = 1; nThreads < 5; nThreads += 3) {
+            std::vector<size_t> offsets, ids;
+            rknn.query(probes.view(), offsets, ids, nThreads);
+            REQUIRE(offsets.size() == probes.size() + 1);
+            REQUIRE(offsets.back() == ids.size());
+            for(size_t i = 0; i < probes.size(); ++i) {
+                const size_t nFound = offsets[i + 1] - offsets[i];
+                REQUIRE(nFound == expected[i].size());
+                REQUIRE(std::equal(expected[i].begin(), expected[i].end(), ids.begin() + offsets[i]));
+            }
+        }
+    }
+}
+
+TEST_CASE("testing MarchingSquares") {
+    SECTION("saddle") {
+        //corners (0, 0) and (1, 1) inside, the mean decides whether they are connected
+        const MarchingSquares<T> ms(std::vector<T>{1, 0, 0, 1}, 2, 2);
+        REQUIRE(ms.n_x() == 2);
+        REQUIRE(ms.value(1, 1) == 1);
+
+        const auto connected = ms.contour(T(0.5));
+        REQUIRE(connected.size() == 2);
+        REQUIRE(connected[0].size() == 2);
+        REQUIRE(connected[0][0].similar_to(Point<T>{T(0.5), 0}, MAX_DELTA));
+        REQUIRE(connected[0][1].similar_to(Point<T>{1, T(0.5)}, MAX_DELTA));
+        REQUIRE(connected[1][0].similar_to(Point<T>{T(0.5), 1}, MAX_DELTA));
+        REQUIRE(connected[1][1].similar_to(Point<T>{0, T(0.5)}, MAX_DELTA));
+
+        const auto separated = ms.contour(T(0.6));
+        REQUIRE(separated.size() == 2);
+        REQUIRE(separated[0][0].similar_to(Point<T>{T(0.4), 0}, MAX_DELTA));
+        REQUIRE(separated[0][1].similar_to(Point<T>{0, T(0.4)}, MAX_DELTA));
+        REQUIRE(separated[1][0].similar_to(Point<T>{T(0.6), 1}, MAX_DELTA));
+        REQUIRE(separated[1][1].similar_to(Point<T>{1, T(0.6)}, MAX_DELTA));
+
+        REQUIRE(ms.contour(2).empty());
+        REQUIRE(ms.contour(0).empty()); //all corners >= level
+    }
+
+    SECTION("circle") {
+        const size_t n = 61;
+        const T radius = 20;
+        std::vector<T> values;
+        for(size_t iy = 0; iy < n; ++iy) {
+            for(size_t ix = 0; ix < n; ++ix)
+                values.push_back(-std::hypot(T(ix) - 30, T(iy) - 30));
+        }
+        const MarchingSquares<T> ms(values, n, n, Point<T>{-3, -3}, Point<T>{T(0.1), T(0.1)});
+        const auto rings = ms.contour(-radius);
+        REQUIRE(rings.size() == 1);
+        const auto &ring = rings[0];
+        REQUIRE(ring[0] == ring.last());
+        for(size_t i = 0; i < ring.size(); ++i)
+            REQUIRE(std::abs(ring[i].abs() - radius / 10) < T(0.01));
+
+        //inside is left, so a maximum is surrounded counter clockwise
+        T area(0);
+        for(size_t i = 1; i < ring.size(); ++i)
+            area += ring[i - 1].x * ring[i].y - ring[i].x * ring[i - 1].y;
+        area /= 2;
+        REQUIRE(std::abs(area - T(LIB_2D_PI) * 4) < T(0.02));
+
+        const auto open = ms.contour(-radius, false);
+        const size_t nOpen = open[0].size();
+        REQUIRE(nOpen == ring.size() - 1);
+    }
+
+    SECTION("multiple levels and threads") {
+        const size_t nX = 157, nY = 901; //enough rows for several bands
+        std::vector<T> values;
+        for(size_t iy = 0; iy < nY; ++iy) {
+            for(size_t ix = 0; ix < nX; ++ix)
+                values.push_back(std::sin(T(0.07) * ix) * std::cos(T(0.09) * iy) + T(0.3) * std::sin(T(0.2) * ix + T(0.1) * iy));
+        }
+        const MarchingSquares<T> ms(values, nX, nY);
+        const std::vector<T> levels{T(-0.6), 0, T(0.25), T(0.8)};
+        const auto expected = ms.contours(levels, true, 1);
+        REQUIRE(expected.size() == levels.size());
+
+        for(size_t l = 0; l < levels.size(); ++l) {
+            //one point per crossed edge, closed polylines repeat their first point
+            size_t nCrossings(0), nPoints(0);
+            for(size_t iy = 0; iy < nY; ++iy) {
+                for(size_t ix = 0; ix < nX; ++ix) {
+                    const bool inside = ms.value(ix, iy) >= levels[l];
+                    if(ix + 1 < nX && inside != (ms.value(ix + 1, iy) >= levels[l]))
+                        ++nCrossings;
+                    if(iy + 1 < nY && inside != (ms.value(ix, iy + 1) >= levels[l]))
+                        ++nCrossings;
+                }
+            }
+            for(const auto &polyline : expected[l]) {
+                nPoints += polyline.size();
+                if(polyline[0] == polyline.last())
+                    --nPoints;
+                else {
+                    //open ones start and end on the border
+                    for(const auto &p : {polyline[0], polyline.last()}) {
+                        const bool border = p.x <= 0 || p.y <= 0 || p.x >= nX - 1 || p.y >= nY - 1;
+                        REQUIRE(border);
+                    }
+                }
+            }
+            REQUIRE(nPoints == nCrossings);
+
+            const auto single = ms.contour(levels[l], true, 1);
+            REQUIRE(single.size() == expected[l].size());
+            for(size_t i = 0; i < single.size(); ++i)
+                REQUIRE(single[i].equal_to(expected[l][i].view()));
+        }
+
+        for(size_t nThreads = 2; nThreads < 8; nThreads += 5) {
+            const auto result = ms.contours(levels, true, nThreads);
+            for(size_t l = 0; l < levels.size(); ++l) {
+                REQUIRE(result[l].size() == expected[l].size());
+                for(size_t i = 0; i < result[l].size(); ++i)
+                    REQUIRE(result[l][i].equal_to(expected[l][i].view()));
+            }
+        }
+    }
+
+    SECTION("degenerate grids") {
+        REQUIRE_THROWS(MarchingSquares<T>(std::vector<T>(5), 2, 2));
+        REQUIRE(MarchingSquares<T>(std::vector<T>(), 0, 0).contour(0).empty());
+        REQUIRE(MarchingSquares<T>(std::vector<T>{0, 1, 2}, 3, 1).contour(T(0.5)).empty());
+    }
+}
+
+TEST_CASE("testing SpatialGrid") {
+    auto inv = std::make_shared<InvolutCircle<T>>(1.0, 100);
+    auto topInv = std::make_shared<OrderedPointCloud<T>>(inv);
+
+    SpatialGrid<T> grid(topInv);
+    KdTree<T> tree(topInv);
+
+    REQUIRE(grid.size() == 100);
+    REQUIRE(grid.n_cells() <= 4 * 100 + 1);
+
+    Point<T> center{3.0, -2.0};
+    T radius(4.0);
+
+    SECTION("comparing with KdTree") {
+        REQUIRE(grid.nearest(center) == tree.nearest(center));
+        REQUIRE(grid.in_circle(center, radius).n_elements() == tree.in_circle(center, radius).n_elements());
+        REQUIRE(grid.in_box(center, 6.0, 3.0).n_elements() == tree.in_box(center, 6.0, 3.0).n_elements());
+
+        auto kGrid = grid.k_nearest(center, 7);
+        auto kTree = tree.k_nearest(center, 7);
+        REQUIRE(kGrid.n_elements() == 7);
+        for(size_t i = 0; i < kGrid.n_elements(); ++i)
+            REQUIRE(kGrid[i][0] == kTree[i][0]);
+
+        Point<T> farAway{1000.0, -500.0};
+        REQUIRE(grid.nearest(farAway) == tree.nearest(farAway));
+        REQUIRE(grid.k_nearest(farAway, 200).n_elements() == 100);
+    }
+
+    SECTION("inserting, removing and moving points") {
+        Point<T> inside{13.37, 1.337};
+        Point<T> outside{-100.0, 100.0};
+
+        size_t idInside = grid.insert(inside);
+        size_t idOutside = grid.insert(outside);
+        REQUIRE(grid.size() == 102);
+        REQUIRE(grid.nearest(Point<T>{13.38, 1.337}) == idInside);
+        REQUIRE(grid.nearest(Point<T>{-99.0, 99.0}) == idOutside);
+
+        grid.remove(idInside);
+        grid.remove(idInside); //removing twice has no effect
+        REQUIRE(grid.size() == 101);
+        REQUIRE(grid.nearest(Point<T>{13.38, 1.337}) != idInside);
+
+        grid.move(idOutside, Point<T>{3.1, -2.1});
+        REQUIRE(grid.nearest(center) == idOutside);
+        REQUIRE(grid.in_circle(center, radius).n_elements() == tree.in_circle(center, radius).n_elements() + 1);
+
+        //removing everything from the grid and adding it again
+        for(size_t i = 0; i < inv->size(); ++i)
+            grid.remove(i);
+        REQUIRE(grid.size() == 0);
+        REQUIRE(grid.k_nearest(center, 3).n_elements() == 0);
+        REQUIRE_THROWS(grid.nearest(center));
+
+        for(size_t i = 0; i < 100; ++i)
+            grid.insert(i);
+        REQUIRE(grid.nearest(center) == tree.nearest(center));
+        REQUIRE(grid.in_circle(center, radius).n_elements() == tree.in_circle(center, radius).n_elements());
+    }
+}
+
+TEST_CASE("testing QuadTree") {
+    auto inv = std::make_shared<InvolutCircle<T>>(1.0, 100);
+    auto topInv = std::make_shared<OrderedPointCloud<T>>(inv);
+
+    QuadTree<T> quad(topInv, 4);
+    KdTree<T> tree(topInv);
+
+    REQUIRE(quad.size() == 100);
+
+    Point<T> center{3.0, -2.0};
+    T radius(4.0);
+
+    SECTION("comparing with KdTree") {
+        REQUIRE(quad.nearest(center) == tree.nearest(center));
+        REQUIRE(quad.in_circle(center, radius).n_elements() == tree.in_circle(center, radius).n_elements());
+        REQUIRE(quad.in_box(center, 6.0, 3.0).n_elements() == tree.in_box(center, 6.0, 3.0).n_elements());
+        REQUIRE(quad.count_in_box(center, 6.0, 3.0) == tree.in_box(center, 6.0, 3.0).n_elements());
+        REQUIRE(quad.count_in_box(center, 1000.0, 1000.0) == 100);
+
+        auto kQuad = quad.k_nearest(center, 7);
+        auto kTree = tree.k_nearest(center, 7);
+        REQUIRE(kQuad.n_elements() == 7);
+        for(size_t i = 0; i < kQuad.n_elements(); ++i)
+            REQUIRE(kQuad[i][0] == kTree[i][0]);
+    }
+
+    SECTION("region aggregates") {
+        auto all = quad.region();
+        REQUIRE(all.count == 100);
+        REQUIRE(all.centroid.similar_to(inv->view().center(), 0.0001));
+
+        auto regions = quad.regions(2);
+        REQUIRE(regions.size() <= 16);
+        size_t count(0);
+        for(const auto &r : regions)
+            count += r.count;
+        REQUIRE(count == 100);
+        REQUIRE(quad.level_of_detail(2).size() == regions.size());
+    }
+
+    SECTION("inserting, removing and moving points") {
+        size_t nNodes = quad.n_nodes();
+
+        //many points at the same position and points far outside force splits and growth of the root
+        std::vector<size_t> added;
+        for(size_t i = 0; i < 20; ++i)
+            added.push_back(quad.insert(Point<T>{13.37, 1.337}));
+        added.push_back(quad.insert(Point<T>{-1000.0, 1000.0}));
+        REQUIRE(quad.size() == 121);
+        REQUIRE(quad.count_in_box(Point<T>{13.37, 1.337}, 0.001, 0.001) == 20);
+        REQUIRE(quad.nearest(Point<T>{-999.0, 999.0}) == added.back());
+
+        quad.move(added.back(), Point<T>{3.1, -2.1});
+        REQUIRE(quad.nearest(center) == added.back());
+
+        for(auto pId : added)
+            REQUIRE(quad.remove(pId));
+        REQUIRE_FALSE(quad.remove(added[0]));
+        REQUIRE(quad.size() == 100);
+        REQUIRE(quad.nearest(center) == tree.nearest(center));
+        REQUIRE(quad.in_circle(center, radius).n_elements() == tree.in_circle(center, radius).n_elements());
+
+        for(size_t i = 0; i < 100; ++i)
+            REQUIRE(quad.remove(i));
+        REQUIRE(quad.size() == 0);
+        REQUIRE(quad.n_nodes() == 1);
+        REQUIRE_THROWS(quad.nearest(center));
+        REQUIRE(nNodes > 1);
+
+        const size_t nParent = quad.get_parent()->get_parent()->size();
+        REQUIRE_THROWS(quad.insert(Point<T>{std::numeric_limits<T>::infinity(), 0}));
+        REQUIRE_THROWS(quad.insert(Point<T>{0, -std::numeric_limits<T>::infinity()}));
+        REQUIRE_THROWS(quad.insert(Point<T>{std::numeric_limits<T>::quiet_NaN(), 0}));
+        REQUIRE(quad.get_parent()->get_parent()->size() == nParent);
+    }
+
+    SECTION("duplicates after the root grew") {
+        auto duplicates = std::make_shared<PointCloud<T>>();
+        duplicates->push_back(0, 0);
+        duplicates->push_back(0, 0);
+        duplicates->push_back(1, 1);
+        QuadTree<T> small(std::make_shared<OrderedPointCloud<T>>(duplicates), 1);
+        small.insert(Point<T>{100, 100});
+        small.insert(Point<T>{0, 0});
+        REQUIRE(small.size() == 5);
+        REQUIRE(small.in_circle(Point<T>{0, 0}, 0.5).n_elements() == 3);
+    }
+
+    SECTION("points exactly on circles and node borders") {
+        //the root is centered on the lattice, so many points lie on node borders
+        const T spacing = T(0.37);
+        auto lattice = std::make_shared<PointCloud<T>>();
+        lattice->push_back(-1000, -1000);
+        lattice->push_back(1000, 1000);
+        for(int x = -12; x <= 12; ++x) {
+            for(int y = -12; y <= 12; ++y)
+                lattice->push_back(T(x) * spacing, T(y) * spacing);
+        }
+        QuadTree<T> borders(std::make_shared<OrderedPointCloud<T>>(lattice), 1);
+        for(size_t s = 2; s < lattice->size(); ++s) {
+            const T r = spacing * T(1 + s % 3);
+            size_t expected(0);
+            for(size_t i = 0; i < lattice->size(); ++i) {
+                if((*lattice)[s].sqr_distance_to((*lattice)[i]) <= r * r)
+                    ++expected;
+            }
+            REQUIRE(borders.in_circle((*lattice)[s], r).n_elements() == expected);
+        }
+    }
+}
+
+TEST_CASE("testing RTree") {
+    auto inv = InvolutCircle<T>(1.0, 200);
+    auto rec = lib_2d::Rectangle<T>(10, 6, true, Point<T>{2.0, 1.0}, 0.3);
+    auto arc = Arc<T>(8.0, 50, true, 0, LIB_2D_2PI, Point<T>{-3.0, 2.0});
+
+    std::vector< PointCloudView<T> > paths{inv, rec, arc};
+    RTree<T> network(paths, 4);
+
+    REQUIRE(network.size() == 199 + 4 + arc.size() - 1);
+
+    auto brute_force_segments = [&](std::function<bool(const Point<T>&, const Point<T>&)> f) {
+        size_t n(0);
+        for(const auto &path : paths)
+            for(size_t i = 0; i + 1 < path.size(); ++i)
+                if(f(path[i], path[i+1])) ++n;
+        return n;
+    };
+
+    SECTION("testing segment intersection") {
+        Point<T> intersection;
+        REQUIRE(segments_intersect(Point<T>{0, -1}, Point<T>{0, 1}, Point<T>{-1, 0}, Point<T>{1, 0}));
+        REQUIRE(segment_intersection(Point<T>{0, -1}, Point<T>{0, 1}, Point<T>{-1, 0.5}, Point<T>{1, 0.5}, intersection));
+        REQUIRE(intersection.similar_to(Point<T>{0, 0.5}, MAX_DELTA));
+        REQUIRE(segments_intersect(Point<T>{0, 0}, Point<T>{2, 0}, Point<T>{1, 0}, Point<T>{3, 0})); //colinear overlap
+        REQUIRE_FALSE(segments_intersect(Point<T>{0, 0}, Point<T>{1, 0}, Point<T>{2, 0}, Point<T>{3, 0}));
+        REQUIRE_FALSE(segment_intersection(Point<T>{0, 0}, Point<T>{1, 1}, Point<T>{0, 1}, Point<T>{0.4, 0.6}, intersection));
+        REQUIRE(sqr_distance_point_segment(Point<T>{3, 4}, Point<T>{0, 0}, Point<T>{0, 10}) == Approx(9.0));
+        REQUIRE(sqr_distance_point_segment(Point<T>{0, -2}, Point<T>{0, 0}, Point<T>{0, 10}) == Approx(4.0));
+    }
+
+    SECTION("comparing with brute force search") {
+        Point<T> search{1.0, -2.0};
+
+        auto nearest = network.nearest(search);
+        T distanceNearest = sqr_distance_point_segment(search, paths[nearest[0]][nearest[1]], paths[nearest[0]][nearest[1] + 1]);
+        REQUIRE(brute_force_segments([&](const Point<T> &a, const Point<T> &b) {
+            return sqr_distance_point_segment(search, a, b) < distanceNearest;
+        }) == 0);
+
+        auto inBox = network.in_box(search, 4.0, 3.0);
+        REQUIRE(inBox.n_elements() > 0);
+        for(size_t i = 0; i < inBox.n_elements(); ++i) {
+            const auto &a = paths[inBox[i][0]][inBox[i][1]];
+            const auto &b = paths[inBox[i][0]][inBox[i][1] + 1];
+            REQUIRE(std::min(a.x, b.x) <= 3.0);
+            REQUIRE(std::max(a.x, b.x) >= -1.0);
+        }
+
+        lib_2d::LineSegment<T> line(Point<T>{-10, -10}, Point<T>{10, 10});
+        size_t nIntersections = brute_force_segments([&](const Point<T> &a, const Point<T> &b) {
+            return segments_intersect(line[0], line[1], a, b);
+        });
+        REQUIRE(nIntersections > 0);
+        REQUIRE(network.intersections_with(line).size() == nIntersections);
+        REQUIRE(network.intersects_with(line));
+        REQUIRE_FALSE(network.intersects_with(lib_2d::LineSegment<T>(Point<T>{100, 100}, Point<T>{101, 100})));
+
+        RTree<T> lines(line.view(), 2);
+        auto joined = network.join(lines, true);
+        REQUIRE(joined.n_elements() == nIntersections);
+        REQUIRE(network.join(lines).n_elements() >= nIntersections);
+    }
+
+    SECTION("testing serialization") {
+        RTree<T> loaded;
+        REQUIRE(loaded.from_string(network.to_string()));
+        REQUIRE(loaded.size() == network.size());
+        REQUIRE(loaded.to_string() == network.to_string());
+
+        Point<T> search{-2.0, 3.0};
+        REQUIRE(loaded.nearest(search) == network.nearest(search));
+        REQUIRE(loaded.in_box(search, 2.0, 2.0).n_elements() == network.in_box(search, 2.0, 2.0).n_elements());
+
+        REQUIRE_FALSE(loaded.from_string("rtree 4 1 1\n0 0 0 0 1 1\n5 1 1 0 0 1 1\n"));
+        REQUIRE(loaded.size() == network.size());
+    }
+}
+
+TEST_CASE("testing MemoryResource") {
+    MonotonicResource arena(256);
+
+    SECTION("scoped default resource") {
+        REQUIRE(get_default_resource() == new_delete_resource());
+        {
+            ScopedResource scope(&arena);
+            PointCloud<T> tmp;
+            for(unsigned int i = 0; i < 100; ++i)
+                tmp.push_back(i, i);
+            Topology<1> top;
+            top.push_back(std::array<size_t, 1>{0});
+
+            REQUIRE(tmp.get_resource() == &arena);
+            REQUIRE(top.get_resource() == &arena);
+            REQUIRE(arena.n_blocks() > 0);
+
+            auto copy = tmp;
+            REQUIRE(copy.get_resource() == &arena);
+        }
+        REQUIRE(get_default_resource() == new_delete_resource());
+        arena.release();
+        REQUIRE(arena.n_blocks() == 0);
+    }
+
+    SECTION("explicit resource") {
+        PointCloud<T> tmp(&arena);
+        tmp.push_back(1, 2);
+        REQUIRE(tmp.get_resource() == &arena);
+
+        auto copy = tmp;
+        REQUIRE(copy.get_resource() == new_delete_resource());
+        REQUIRE(copy == tmp);
+    }
+
+    SECTION("KdTree within arena") {
+        auto inv = std::make_shared<InvolutCircle<T>>(1.0, 100);
+        auto topInv = std::make_shared<OrderedPointCloud<T>>(inv);
+        KdTree<T> tree(topInv, 0, &arena);
+
+        REQUIRE(tree.size() == 100);
+        REQUIRE(tree.nearest(inv->get_point(17)) == 17);
+    }
 }